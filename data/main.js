@@ -52,6 +52,7 @@ async function startMotor(motor, speed) {
     });
     const result = await response.json();
     if (result.success) {
+      holdMotors({ ['motor' + motor]: speed });
       document.getElementById('motor' + motor + '-speed').textContent = speed;
       updateMotorValue(motor, speed);
     }
@@ -69,6 +70,7 @@ async function setMotorSpeed(motor, speed) {
     });
     const result = await response.json();
     if (result.success) {
+      holdMotors({ ['motor' + motor]: speed });
       document.getElementById('motor' + motor + '-speed').textContent = speed;
       updateMotorValue(motor, speed);
     }
@@ -97,6 +99,7 @@ async function setMotorFromSlider(motor) {
     });
     const result = await response.json();
     if (result.success) {
+      holdMotors({ ['motor' + motor]: speed });
       document.getElementById('motor' + motor + '-speed').textContent = speed;
       showMessage('Motor ' + motor + ' установлен на ' + speed, 'success');
     } else {
@@ -131,6 +134,7 @@ async function setAllMotors() {
     });
     const result = await response.json();
     if (result.success) {
+      holdMotors({ motorA: motorA, motorB: motorB, motorC: motorC, motorD: motorD });
       document.getElementById('motorA-speed').textContent = motorA;
       document.getElementById('motorB-speed').textContent = motorB;
       document.getElementById('motorC-speed').textContent = motorC;
@@ -152,6 +156,7 @@ function stopMotor(motor) {
 }
 
 async function stopAllMotors() {
+  heldMotors = {};
   try {
     const response = await fetch(API_BASE + '/api/motor/stop', {
       method: 'POST'
@@ -168,9 +173,15 @@ async function stopAllMotors() {
 }
 
 // ===== ЭКСТРЕННАЯ ОСТАНОВКА =====
+// Кадр WebSocket доходит быстрее; POST дублирует его на случай обрыва сокета.
+// Робот остаётся остановленным до сброса (resetEmergencyStop)
 async function emergencyStopAll() {
+  heldMotors = {};
+  if (isControlSocketOpen()) {
+    controlSocket.send(encodeEstopFrame());
+  }
   try {
-    await fetch(API_BASE + '/api/motor/stop', { method: 'POST' });
+    await fetch(API_BASE + '/api/estop', { method: 'POST' });
     await fetch(API_BASE + '/api/camera/angle', {
       method: 'POST',
       headers: { 'Content-Type': 'application/json' },
@@ -199,6 +210,20 @@ async function emergencyStopAll() {
   }
 }
 
+async function resetEmergencyStop() {
+  try {
+    const response = await fetch(API_BASE + '/api/estop/reset', { method: 'POST' });
+    const result = await response.json();
+    if (response.ok) {
+      showMessage('Аварийная остановка сброшена', 'success');
+    } else {
+      showMessage('Ошибка: ' + result.error, 'error');
+    }
+  } catch (error) {
+    showMessage('Ошибка: ' + error, 'error');
+  }
+}
+
 async function loadStatus() {
   try {
     const response = await fetch(API_BASE + '/api/status');
@@ -267,9 +292,144 @@ window.onload = function () {
   loadStatus();
   loadServos();
   loadMotors();
-  setInterval(loadStatus, 5000);
+  connectControlSocket();
+  // Пока открыт WebSocket, состояние приходит потоком телеметрии
+  setInterval(() => { if (!isControlSocketOpen()) loadStatus(); }, 5000);
+  setInterval(resendHeldMotors, MOTOR_KEEPALIVE_INTERVAL);
 };
 
+// ===== WebSocket канал управления =====
+// Постоянное соединение с бинарными кадрами вместо POST на каждый тик джойстика.
+// При недоступности сокета команды уходят через REST API как раньше.
+const CTL_FRAME_SIZE = 20;
+const CTL_FRAME_MAGIC = 0xC7;
+const CTL_FRAME_TYPE_SETPOINT = 0x01;
+const CTL_FRAME_TYPE_ESTOP = 0x02;
+const CTL_ESTOP_FRAME_SIZE = 4;
+const CTL_FRAME_TYPE_SUBSCRIBE = 0x03;
+const CTL_SUBSCRIBE_FRAME_SIZE = 6;
+const CTL_TELEM_FORMAT_JSON = 1;
+const CTL_TELEM_MOTORS = 0x01;
+const CTL_TELEM_SERVOS = 0x02;
+const CTL_TELEM_SYSTEM = 0x10;
+const TELEMETRY_RATE_HZ = 5;
+const CTL_FLAG_MOTORS = 0x01;
+const WS_RECONNECT_DELAY = 2000;
+
+let controlSocket = null;
+let controlSeq = 0;
+
+// Deadman на роботе останавливает моторы без кадров дольше DEADMAN_TIMEOUT_MS (500 мс):
+// пока хоть один мотор крутится, последние скорости повторяются
+const MOTOR_KEEPALIVE_INTERVAL = 200;
+let heldMotors = {};
+
+function holdMotors(motors) {
+  Object.assign(heldMotors, motors);
+}
+
+function resendHeldMotors() {
+  if (!Object.values(heldMotors).some(speed => speed !== 0)) return;
+  sendMotorCommand(heldMotors);
+}
+
+function connectControlSocket() {
+  // WebSocket сервер слушает порт HTTP_PORT + 1 (см. WS_PORT в config.h)
+  const port = (parseInt(window.location.port) || 80) + 1;
+  const socket = new WebSocket('ws://' + window.location.hostname + ':' + port + '/');
+  socket.binaryType = 'arraybuffer';
+  socket.onopen = () => {
+    socket.send(encodeSubscribeFrame(TELEMETRY_RATE_HZ, CTL_TELEM_FORMAT_JSON,
+      CTL_TELEM_MOTORS | CTL_TELEM_SERVOS | CTL_TELEM_SYSTEM));
+  };
+  socket.onmessage = (event) => {
+    if (typeof event.data === 'string') updateTelemetry(JSON.parse(event.data));
+  };
+  socket.onclose = () => {
+    controlSocket = null;
+    setTimeout(connectControlSocket, WS_RECONNECT_DELAY);
+  };
+  socket.onerror = () => socket.close();
+  controlSocket = socket;
+}
+
+function isControlSocketOpen() {
+  return controlSocket !== null && controlSocket.readyState === WebSocket.OPEN;
+}
+
+// Формат кадра — src/ctlframe.h (20 байт, little-endian)
+function encodeControlFrame(motors, servos) {
+  const buffer = new ArrayBuffer(CTL_FRAME_SIZE);
+  const view = new DataView(buffer);
+  controlSeq = (controlSeq + 1) & 0xFFFF;
+
+  view.setUint8(0, CTL_FRAME_MAGIC);
+  view.setUint8(1, CTL_FRAME_TYPE_SETPOINT);
+  view.setUint16(2, controlSeq, true);
+  view.setUint8(4, motors ? CTL_FLAG_MOTORS : 0);
+
+  if (motors) {
+    ['motorA', 'motorB', 'motorC', 'motorD'].forEach((key, i) => {
+      view.setInt16(6 + i * 2, motors[key] || 0, true);
+    });
+  }
+
+  let servoMask = 0;
+  if (servos) {
+    servos.forEach((angle, i) => {
+      if (angle !== undefined) {
+        servoMask |= 1 << i;
+        view.setUint8(14 + i, angle);
+      }
+    });
+  }
+  view.setUint8(5, servoMask);
+
+  return buffer;
+}
+
+// Подписка на телеметрию: частота, формат и секции (CTL_TELEM_* в src/ctlframe.h)
+function encodeSubscribeFrame(rateHz, format, mask) {
+  const buffer = new ArrayBuffer(CTL_SUBSCRIBE_FRAME_SIZE);
+  const view = new DataView(buffer);
+  view.setUint8(0, CTL_FRAME_MAGIC);
+  view.setUint8(1, CTL_FRAME_TYPE_SUBSCRIBE);
+  view.setUint8(2, rateHz);
+  view.setUint8(3, format);
+  view.setUint8(4, mask);
+  return buffer;
+}
+
+// Кадр телеметрии в JSON: обновление индикаторов вместо опроса REST API
+function updateTelemetry(t) {
+  if (t.motors) {
+    ['A', 'B', 'C', 'D'].forEach((motor, i) => {
+      document.getElementById('motor' + motor + '-speed').textContent = t.motors.speed[i];
+    });
+  }
+  if (t.servos) {
+    for (let id = 0; id < 4; id++) {
+      const value = document.getElementById('servo' + id + '-value');
+      if (value) value.textContent = t.servos[id];
+    }
+  }
+  if (t.system) {
+    document.getElementById('robot-rssi').textContent = t.system.rssi ? t.system.rssi + ' dBm' : 'N/A';
+    document.getElementById('robot-heap').textContent = Math.round(t.system.heap / 1024) + ' KB';
+  }
+}
+
+function encodeEstopFrame() {
+  const buffer = new ArrayBuffer(CTL_ESTOP_FRAME_SIZE);
+  const view = new DataView(buffer);
+  controlSeq = (controlSeq + 1) & 0xFFFF;
+
+  view.setUint8(0, CTL_FRAME_MAGIC);
+  view.setUint8(1, CTL_FRAME_TYPE_ESTOP);
+  view.setUint16(2, controlSeq, true);
+  return buffer;
+}
+
 // ===== Функции джойстика =====
 let joystickInterval = null;
 let currentJoystickMode = 'drive';
@@ -430,6 +590,12 @@ function updateJoystickControl(x, y) {
 }
 
 function sendMotorCommand(motors) {
+  holdMotors(motors);
+  if (isControlSocketOpen()) {
+    controlSocket.send(encodeControlFrame(motors, null));
+    return;
+  }
+
   fetch(API_BASE + '/api/motor', {
     method: 'POST',
     headers: { 'Content-Type': 'application/json' },
@@ -440,36 +606,27 @@ function sendMotorCommand(motors) {
 }
 
 function sendServoCommand(servoCommand) {
-  const promises = [];
-  if (servoCommand.s0 !== undefined) {
-    promises.push(fetch(API_BASE + '/api/servo', {
-      method: 'POST',
-      headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ id: 0, angle: servoCommand.s0 })
-    }).then(r => r.json()));
-  }
-  if (servoCommand.s1 !== undefined) {
-    promises.push(fetch(API_BASE + '/api/servo', {
-      method: 'POST',
-      headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ id: 1, angle: servoCommand.s1 })
-    }).then(r => r.json()));
-  }
-  if (servoCommand.s2 !== undefined) {
-    promises.push(fetch(API_BASE + '/api/servo', {
-      method: 'POST',
-      headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ id: 2, angle: servoCommand.s2 })
-    }).then(r => r.json()));
-  }
-  if (servoCommand.s3 !== undefined) {
-    promises.push(fetch(API_BASE + '/api/servo', {
-      method: 'POST',
-      headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ id: 3, angle: servoCommand.s3 })
-    }).then(r => r.json()));
+  if (isControlSocketOpen()) {
+    const servos = [servoCommand.s0, servoCommand.s1, servoCommand.s2, servoCommand.s3];
+    controlSocket.send(encodeControlFrame(null, servos));
+    return;
   }
-  Promise.all(promises).catch(err => console.error('[Joystick Servo] Error:', err));
+
+  // Все серво одним запросом: изменившиеся каналы пишутся в PCA9685 одной транзакцией
+  const servos = [];
+  ['s0', 's1', 's2', 's3'].forEach((key, id) => {
+    if (servoCommand[key] !== undefined) {
+      servos.push({ id: id, angle: servoCommand[key] });
+    }
+  });
+
+  fetch(API_BASE + '/api/servo/batch', {
+    method: 'POST',
+    headers: { 'Content-Type': 'application/json' },
+    body: JSON.stringify({ servos: servos })
+  })
+    .then(r => r.json())
+    .catch(err => console.error('[Joystick Servo] Error:', err));
 }
 
 function updateMotorStatusDisplay(motors) {
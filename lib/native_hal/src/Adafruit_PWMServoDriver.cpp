@@ -0,0 +1,198 @@
+#include <Adafruit_PWMServoDriver.h>
+
+#include <atomic>
+
+#include "hal_i2c.h"
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define PCA9685_BUS 0
+#define PCA9685_REGISTERS 256
+#define PCA9685_LED_REGS_END (PCA9685_LED0_ON_L + 4 * HAL_PCA9685_CHANNELS)
+
+// ===== Фейковый PCA9685 =====
+
+// Регистровая модель: автоинкремент адреса при MODE1.AI, бит FULL_OFF в OFF_H,
+// делитель PRESCALE пишется только в режиме сна — как у микросхемы
+class FakePca9685 : public HalI2cDevice {
+ public:
+  FakePca9685() : pointer_(0), channelWrites_(0) {
+    memset(regs_, 0, sizeof(regs_));
+    regs_[PCA9685_MODE1] = MODE1_SLEEP;
+    regs_[PCA9685_PRESCALE] = 0x1E;   // 200 Гц после сброса
+  }
+
+  bool write(const uint8_t* data, size_t length) override {
+    if (length == 0) return true;
+    pointer_ = data[0];
+    bool ledTouched = false;
+    for (size_t i = 1; i < length; i++) {
+      writeRegister(pointer_, data[i]);
+      if (pointer_ >= PCA9685_LED0_ON_L && pointer_ < PCA9685_LED_REGS_END) ledTouched = true;
+      if (regs_[PCA9685_MODE1] & MODE1_AI) pointer_++;
+    }
+    if (ledTouched) channelWrites_++;
+    return true;
+  }
+
+  size_t read(uint8_t* data, size_t length) override {
+    for (size_t i = 0; i < length; i++) {
+      data[i] = regs_[pointer_];
+      if (regs_[PCA9685_MODE1] & MODE1_AI) pointer_++;
+    }
+    return length;
+  }
+
+  uint16_t off(uint8_t channel) const {
+    uint8_t base = PCA9685_LED0_ON_L + 4 * channel;
+    if (regs_[base + 3] & 0x10) return 0;   // FULL_OFF
+    return (regs_[base + 2] | (regs_[base + 3] << 8)) & 0x0FFF;
+  }
+
+  float frequency() const {
+    return (float)FREQUENCY_OSCILLATOR / (4096.0f * (regs_[PCA9685_PRESCALE] + 1));
+  }
+
+  uint32_t channelWrites() const { return channelWrites_; }
+
+ private:
+  void writeRegister(uint8_t reg, uint8_t value) {
+    if (reg == PCA9685_PRESCALE && !(regs_[PCA9685_MODE1] & MODE1_SLEEP)) return;
+    if (reg == PCA9685_MODE1 && (value & MODE1_RESTART)) value &= ~MODE1_RESTART;
+    regs_[reg] = value;
+  }
+
+  uint8_t regs_[PCA9685_REGISTERS];
+  uint8_t pointer_;
+  std::atomic<uint32_t> channelWrites_;
+};
+
+static FakePca9685* fakeDevice() {
+  static FakePca9685* device = [] {
+    FakePca9685* created = new FakePca9685();
+    hal_i2cAttach(PCA9685_BUS, HAL_PCA9685_ADDR, HAL_I2C_DIRECT, created);
+    return created;
+  }();
+  return device;
+}
+
+// Устройство появляется на шине при загрузке, как на плате
+static FakePca9685* const attachedDevice = fakeDevice();
+
+uint16_t hal_pca9685GetOff(uint8_t channel) {
+  return channel < HAL_PCA9685_CHANNELS ? fakeDevice()->off(channel) : 0;
+}
+
+float hal_pca9685GetFrequency() {
+  return fakeDevice()->frequency();
+}
+
+uint32_t hal_pca9685GetChannelWrites() {
+  return fakeDevice()->channelWrites();
+}
+
+// ===== Драйвер =====
+
+Adafruit_PWMServoDriver::Adafruit_PWMServoDriver(uint8_t address, TwoWire& i2c)
+    : address_(address), i2c_(&i2c), oscillatorFrequency_(FREQUENCY_OSCILLATOR) {}
+
+bool Adafruit_PWMServoDriver::begin(uint8_t prescale) {
+  i2c_->begin();
+  i2c_->beginTransmission(address_);
+  if (i2c_->endTransmission() != 0) return false;
+  reset();
+  if (prescale) {
+    sleep();
+    write8(PCA9685_PRESCALE, prescale);
+    wakeup();
+  } else {
+    setPWMFreq(1000);
+  }
+  return true;
+}
+
+void Adafruit_PWMServoDriver::reset() {
+  write8(PCA9685_MODE1, MODE1_RESTART);
+  delay(10);
+}
+
+void Adafruit_PWMServoDriver::sleep() {
+  write8(PCA9685_MODE1, read8(PCA9685_MODE1) | MODE1_SLEEP);
+  delay(5);
+}
+
+void Adafruit_PWMServoDriver::wakeup() {
+  write8(PCA9685_MODE1, read8(PCA9685_MODE1) & ~MODE1_SLEEP);
+}
+
+void Adafruit_PWMServoDriver::setPWMFreq(float freq) {
+  if (freq < 1) freq = 1;
+  if (freq > 3500) freq = 3500;
+
+  float prescaleval = ((oscillatorFrequency_ / (freq * 4096.0f)) + 0.5f) - 1;
+  if (prescaleval < PCA9685_PRESCALE_MIN) prescaleval = PCA9685_PRESCALE_MIN;
+  if (prescaleval > PCA9685_PRESCALE_MAX) prescaleval = PCA9685_PRESCALE_MAX;
+  uint8_t prescale = (uint8_t)prescaleval;
+
+  uint8_t oldmode = read8(PCA9685_MODE1);
+  uint8_t newmode = (oldmode & ~MODE1_RESTART) | MODE1_SLEEP;
+  write8(PCA9685_MODE1, newmode);
+  write8(PCA9685_PRESCALE, prescale);
+  write8(PCA9685_MODE1, oldmode & ~MODE1_SLEEP);
+  delay(5);
+  // Автоинкремент: setPWM и пакетная запись каналов одной транзакцией
+  write8(PCA9685_MODE1, (oldmode & ~MODE1_SLEEP) | MODE1_RESTART | MODE1_AI);
+}
+
+uint8_t Adafruit_PWMServoDriver::setPWM(uint8_t num, uint16_t on, uint16_t off) {
+  i2c_->beginTransmission(address_);
+  i2c_->write(PCA9685_LED0_ON_L + 4 * num);
+  i2c_->write(on & 0xFF);
+  i2c_->write(on >> 8);
+  i2c_->write(off & 0xFF);
+  i2c_->write(off >> 8);
+  return i2c_->endTransmission();
+}
+
+void Adafruit_PWMServoDriver::setPin(uint8_t num, uint16_t val, bool invert) {
+  val = min(val, (uint16_t)4095);
+  if (invert) val = 4095 - val;
+  if (val == 4095) {
+    setPWM(num, 4096, 0);
+  } else if (val == 0) {
+    setPWM(num, 0, 4096);
+  } else {
+    setPWM(num, 0, val);
+  }
+}
+
+uint16_t Adafruit_PWMServoDriver::getPWM(uint8_t num, bool off) {
+  uint8_t reg = PCA9685_LED0_ON_L + 4 * num + (off ? 2 : 0);
+  i2c_->beginTransmission(address_);
+  i2c_->write(reg);
+  i2c_->endTransmission();
+  if (i2c_->requestFrom(address_, 2) != 2) return 0;
+  uint16_t low = i2c_->read();
+  uint16_t high = i2c_->read();
+  return low | (high << 8);
+}
+
+uint8_t Adafruit_PWMServoDriver::readPrescale() {
+  return read8(PCA9685_PRESCALE);
+}
+
+uint8_t Adafruit_PWMServoDriver::read8(uint8_t reg) {
+  i2c_->beginTransmission(address_);
+  i2c_->write(reg);
+  i2c_->endTransmission();
+  if (i2c_->requestFrom(address_, 1) != 1) return 0;
+  return (uint8_t)i2c_->read();
+}
+
+void Adafruit_PWMServoDriver::write8(uint8_t reg, uint8_t value) {
+  i2c_->beginTransmission(address_);
+  i2c_->write(reg);
+  i2c_->write(value);
+  i2c_->endTransmission();
+}
@@ -0,0 +1,52 @@
+#ifndef _NATIVE_ADAFRUIT_PWMSERVODRIVER_H
+#define _NATIVE_ADAFRUIT_PWMSERVODRIVER_H
+
+#include <Wire.h>
+
+// Драйвер PCA9685 с интерфейсом Adafruit PWM Servo Driver Library: те же
+// регистры и транзакции I2C, что у оригинала. На шине 0 висит фейковый PCA9685
+// по адресу 0x40 (Adafruit_PWMServoDriver.cpp).
+
+// ===== Константы =====
+
+#define PCA9685_MODE1 0x00
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_ALLLED_ON_L 0xFA
+#define PCA9685_PRESCALE 0xFE
+
+#define MODE1_RESTART 0x80
+#define MODE1_AI 0x20
+#define MODE1_SLEEP 0x10
+
+#define FREQUENCY_OSCILLATOR 25000000
+#define PCA9685_PRESCALE_MIN 3
+#define PCA9685_PRESCALE_MAX 255
+
+// ===== Классы =====
+
+class Adafruit_PWMServoDriver {
+ public:
+  Adafruit_PWMServoDriver(uint8_t address = 0x40, TwoWire& i2c = Wire);
+
+  bool begin(uint8_t prescale = 0);
+  void reset();
+  void sleep();
+  void wakeup();
+  void setPWMFreq(float freq);
+  uint8_t setPWM(uint8_t num, uint16_t on, uint16_t off);
+  void setPin(uint8_t num, uint16_t val, bool invert = false);
+  uint16_t getPWM(uint8_t num, bool off = false);
+  uint8_t readPrescale();
+  void setOscillatorFrequency(uint32_t freq) { oscillatorFrequency_ = freq; }
+  uint32_t getOscillatorFrequency() { return oscillatorFrequency_; }
+
+ private:
+  uint8_t read8(uint8_t reg);
+  void write8(uint8_t reg, uint8_t value);
+
+  uint8_t address_;
+  TwoWire* i2c_;
+  uint32_t oscillatorFrequency_;
+};
+
+#endif
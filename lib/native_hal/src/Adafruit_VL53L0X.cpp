@@ -0,0 +1,295 @@
+#include <Adafruit_VL53L0X.h>
+
+#include <mutex>
+
+#include "hal_i2c.h"
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define VL53L0X_BUS 1
+#define VL53L0X_MODEL_ID 0xEE
+
+// Регистры микросхемы
+#define REG_SYSRANGE_START 0x00
+#define REG_SYSTEM_INTERRUPT_CLEAR 0x0B
+#define REG_RESULT_INTERRUPT_STATUS 0x13
+#define REG_RESULT_RANGE_STATUS 0x14
+#define REG_IDENTIFICATION_MODEL_ID 0xC0
+#define REG_INTERMEASUREMENT_PERIOD 0x04
+
+// Регистр фейка (у микросхемы бюджет задаётся через таймауты пред- и финальной
+// фаз, здесь — одним 32-битным значением в микросекундах)
+#define REG_FAKE_TIMING_BUDGET 0xF0
+
+#define SYSRANGE_START_SINGLE 0x01
+#define SYSRANGE_START_BACK_TO_BACK 0x02
+#define SYSRANGE_START_TIMED 0x04
+#define RANGE_STATUS_BYTES 12       // RESULT_RANGE_STATUS .. дальность (смещение 10)
+
+#define DEFAULT_BUDGET_US 33000
+#define RANGE_OUT_OF_RANGE_MM 8190
+#define WAIT_TIMEOUT_MS 500
+
+// ===== Фейковый VL53L0X =====
+
+class FakeVl53l0x : public HalI2cDevice {
+ public:
+  FakeVl53l0x() : pointer_(0), budgetUs_(DEFAULT_BUDGET_US), periodUs_(0), running_(false),
+                  nextReadyUs_(0), rangeMm_(RANGE_OUT_OF_RANGE_MM), status_(4), readError_(false) {}
+
+  bool write(const uint8_t* data, size_t length) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (length == 0) return true;
+    pointer_ = data[0];
+    if (length > 1) writeRegister(pointer_, data + 1, length - 1);
+    return true;
+  }
+
+  size_t read(uint8_t* data, size_t length) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool ready = running_ && (uint64_t)esp_timer_get_time() >= nextReadyUs_;
+    memset(data, 0, length);
+    switch (pointer_) {
+      case REG_IDENTIFICATION_MODEL_ID:
+        data[0] = VL53L0X_MODEL_ID;
+        break;
+      case REG_RESULT_INTERRUPT_STATUS:
+        data[0] = ready ? 0x04 : 0x00;   // GPIO_INTERRUPT_NEW_SAMPLE_READY
+        break;
+      case REG_RESULT_RANGE_STATUS:
+        if (readError_) return 0;        // NACK на чтении результата
+        if (length > 0) data[0] = status_ << 3;
+        if (length > 11) {
+          data[10] = rangeMm_ >> 8;
+          data[11] = rangeMm_ & 0xFF;
+        }
+        break;
+    }
+    return length;
+  }
+
+  void setRange(uint16_t rangeMm, uint8_t status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rangeMm_ = rangeMm;
+    status_ = status;
+  }
+
+  void setReadError(bool error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    readError_ = error;
+  }
+
+ private:
+  void writeRegister(uint8_t reg, const uint8_t* data, size_t length) {
+    uint64_t now = esp_timer_get_time();
+    switch (reg) {
+      case REG_SYSRANGE_START:
+        running_ = data[0] & (SYSRANGE_START_SINGLE | SYSRANGE_START_BACK_TO_BACK | SYSRANGE_START_TIMED);
+        if (running_) nextReadyUs_ = now + measurementUs();
+        break;
+      case REG_INTERMEASUREMENT_PERIOD:
+        if (length >= 4) periodUs_ = ((uint32_t)data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3]) * 1000;
+        break;
+      case REG_SYSTEM_INTERRUPT_CLEAR:
+        // Следующий результат — через период после предыдущего (не позже чем через период от сейчас)
+        if (running_ && now >= nextReadyUs_) {
+          nextReadyUs_ += measurementUs();
+          if (nextReadyUs_ < now) nextReadyUs_ = now + measurementUs();
+        }
+        break;
+      case REG_FAKE_TIMING_BUDGET:
+        if (length >= 4) budgetUs_ = (uint32_t)data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
+        break;
+    }
+  }
+
+  uint32_t measurementUs() const {
+    return periodUs_ > budgetUs_ ? periodUs_ : budgetUs_;
+  }
+
+  std::mutex mutex_;
+  uint8_t pointer_;
+  uint32_t budgetUs_;
+  uint32_t periodUs_;
+  bool running_;
+  uint64_t nextReadyUs_;
+  uint16_t rangeMm_;
+  uint8_t status_;
+  bool readError_;
+};
+
+// Датчик на каждом канале мультиплексора; отключённый — отвязан от шины
+struct FakeSlot {
+  FakeVl53l0x* device;
+  bool attached;
+};
+
+static FakeSlot* fakeSlots() {
+  static FakeSlot* slots = [] {
+    FakeSlot* created = new FakeSlot[HAL_VL53L0X_CHANNELS];
+    for (int ch = 0; ch < HAL_VL53L0X_CHANNELS; ch++) {
+      created[ch].device = new FakeVl53l0x();
+      created[ch].attached = true;
+      hal_i2cAttach(VL53L0X_BUS, HAL_VL53L0X_ADDR, ch, created[ch].device);
+    }
+    return created;
+  }();
+  return slots;
+}
+
+static FakeSlot* const attachedSlots = fakeSlots();
+
+// Отключённый датчик не отвечает (NACK)
+class AbsentDevice : public HalI2cDevice {
+ public:
+  bool write(const uint8_t*, size_t) override { return false; }
+  size_t read(uint8_t*, size_t) override { return 0; }
+};
+
+void hal_vl53l0xSetPresent(uint8_t channel, bool present) {
+  if (channel >= HAL_VL53L0X_CHANNELS) return;
+  FakeSlot& slot = fakeSlots()[channel];
+  if (slot.attached == present) return;
+  slot.attached = present;
+  static AbsentDevice absent;
+  hal_i2cAttach(VL53L0X_BUS, HAL_VL53L0X_ADDR, channel, present ? (HalI2cDevice*)slot.device : &absent);
+}
+
+void hal_vl53l0xSetRange(uint8_t channel, uint16_t rangeMm, uint8_t status) {
+  if (channel >= HAL_VL53L0X_CHANNELS) return;
+  fakeSlots()[channel].device->setRange(rangeMm, status);
+}
+
+void hal_vl53l0xSetReadError(uint8_t channel, bool error) {
+  if (channel >= HAL_VL53L0X_CHANNELS) return;
+  fakeSlots()[channel].device->setReadError(error);
+}
+
+// ===== Драйвер =====
+
+Adafruit_VL53L0X::Adafruit_VL53L0X()
+    : Status(VL53L0X_ERROR_NONE), i2c_(&Wire), address_(VL53L0X_I2C_ADDR),
+      budgetUs_(DEFAULT_BUDGET_US), rangeStatus_(0), timeout_(false) {}
+
+bool Adafruit_VL53L0X::begin(uint8_t i2cAddr, bool debug, TwoWire* i2c, VL53L0X_Sense_config_t senseConfig) {
+  (void)debug;
+  (void)senseConfig;
+  i2c_ = i2c;
+  address_ = i2cAddr;
+
+  uint8_t model = 0;
+  if (!readRegisters(REG_IDENTIFICATION_MODEL_ID, &model, 1) || model != VL53L0X_MODEL_ID) {
+    Status = VL53L0X_ERROR_CONTROL_INTERFACE;
+    return false;
+  }
+  Status = VL53L0X_ERROR_NONE;
+  return setMeasurementTimingBudgetMicroSeconds(budgetUs_);
+}
+
+bool Adafruit_VL53L0X::setMeasurementTimingBudgetMicroSeconds(uint32_t budgetUs) {
+  uint8_t data[4] = {(uint8_t)(budgetUs >> 24), (uint8_t)(budgetUs >> 16), (uint8_t)(budgetUs >> 8), (uint8_t)budgetUs};
+  Status = writeRegisters(REG_FAKE_TIMING_BUDGET, data, sizeof(data)) ? VL53L0X_ERROR_NONE : VL53L0X_ERROR_CONTROL_INTERFACE;
+  if (Status != VL53L0X_ERROR_NONE) return false;
+  budgetUs_ = budgetUs;
+  return true;
+}
+
+uint32_t Adafruit_VL53L0X::getMeasurementTimingBudgetMicroSeconds() {
+  return budgetUs_;
+}
+
+VL53L0X_Error Adafruit_VL53L0X::rangingTest(VL53L0X_RangingMeasurementData_t* data, bool debug) {
+  (void)debug;
+  memset(data, 0, sizeof(*data));
+  if (!writeRegister8(REG_SYSRANGE_START, SYSRANGE_START_SINGLE)) {
+    Status = VL53L0X_ERROR_CONTROL_INTERFACE;
+    return Status;
+  }
+  waitRangeComplete();
+  if (timeout_) return Status;
+  uint8_t result[RANGE_STATUS_BYTES];
+  if (!readRegisters(REG_RESULT_RANGE_STATUS, result, sizeof(result))) {
+    Status = VL53L0X_ERROR_CONTROL_INTERFACE;
+    return Status;
+  }
+  rangeStatus_ = result[0] >> 3;
+  data->RangeMilliMeter = (uint16_t)(result[10] << 8 | result[11]);
+  data->RangeStatus = rangeStatus_;
+  data->MeasurementTimeUsec = budgetUs_;
+  writeRegister8(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+  writeRegister8(REG_SYSRANGE_START, 0);
+  Status = VL53L0X_ERROR_NONE;
+  return Status;
+}
+
+uint16_t Adafruit_VL53L0X::readRange() {
+  VL53L0X_RangingMeasurementData_t measure;
+  rangingTest(&measure);
+  return (Status == VL53L0X_ERROR_NONE && measure.RangeStatus != 4) ? measure.RangeMilliMeter : 0xFFFF;
+}
+
+bool Adafruit_VL53L0X::startRangeContinuous(uint16_t periodMs) {
+  uint8_t period[4] = {0, 0, (uint8_t)(periodMs >> 8), (uint8_t)periodMs};
+  bool ok = writeRegisters(REG_INTERMEASUREMENT_PERIOD, period, sizeof(period)) &&
+            writeRegister8(REG_SYSRANGE_START, periodMs > 0 ? SYSRANGE_START_TIMED : SYSRANGE_START_BACK_TO_BACK);
+  Status = ok ? VL53L0X_ERROR_NONE : VL53L0X_ERROR_CONTROL_INTERFACE;
+  return ok;
+}
+
+void Adafruit_VL53L0X::stopRangeContinuous() {
+  writeRegister8(REG_SYSRANGE_START, 0);
+}
+
+bool Adafruit_VL53L0X::isRangeComplete() {
+  uint8_t interrupt = 0;
+  if (!readRegisters(REG_RESULT_INTERRUPT_STATUS, &interrupt, 1)) return false;
+  return (interrupt & 0x07) != 0;
+}
+
+void Adafruit_VL53L0X::waitRangeComplete() {
+  unsigned long start = millis();
+  timeout_ = false;
+  while (!isRangeComplete()) {
+    if (millis() - start > WAIT_TIMEOUT_MS) {
+      timeout_ = true;
+      Status = VL53L0X_ERROR_TIME_OUT;
+      return;
+    }
+    delay(1);
+  }
+}
+
+// Как в библиотеке: ошибка драйвера остаётся в локальной переменной (Status не
+// меняется), 0xFFFF — и при ошибке, и вне зоны видимости (RangeStatus 4).
+// При ошибке RangeStatus не читается и остаётся прежним.
+uint16_t Adafruit_VL53L0X::readRangeResult() {
+  uint8_t result[RANGE_STATUS_BYTES];
+  if (!readRegisters(REG_RESULT_RANGE_STATUS, result, sizeof(result))) return 0xFFFF;
+  rangeStatus_ = result[0] >> 3;
+  if (!writeRegister8(REG_SYSTEM_INTERRUPT_CLEAR, 0x01)) return 0xFFFF;
+  return rangeStatus_ != 4 ? (uint16_t)(result[10] << 8 | result[11]) : 0xFFFF;
+}
+
+uint8_t Adafruit_VL53L0X::readRangeStatus() {
+  return rangeStatus_;
+}
+
+bool Adafruit_VL53L0X::timeoutOccurred() {
+  return timeout_;
+}
+
+bool Adafruit_VL53L0X::readRegisters(uint8_t reg, uint8_t* data, size_t length) {
+  i2c_->beginTransmission(address_);
+  i2c_->write(reg);
+  if (i2c_->endTransmission(false) != 0 || i2c_->requestFrom(address_, length) != length) return false;
+  for (size_t i = 0; i < length; i++) data[i] = (uint8_t)i2c_->read();
+  return true;
+}
+
+bool Adafruit_VL53L0X::writeRegisters(uint8_t reg, const uint8_t* data, size_t length) {
+  i2c_->beginTransmission(address_);
+  i2c_->write(reg);
+  i2c_->write(data, length);
+  return i2c_->endTransmission() == 0;
+}
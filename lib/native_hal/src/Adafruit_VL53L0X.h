@@ -0,0 +1,78 @@
+#ifndef _NATIVE_ADAFRUIT_VL53L0X_H
+#define _NATIVE_ADAFRUIT_VL53L0X_H
+
+#include <Wire.h>
+
+// Драйвер VL53L0X с интерфейсом Adafruit_VL53L0X. Обмен идёт через I2C по
+// регистрам результата микросхемы, поэтому датчик за мультиплексором виден
+// только при выбранном канале. Фейковые датчики — на шине 1 за TCA9548A,
+// по одному на каждый канал 0-7 (Adafruit_VL53L0X.cpp). Калибровка и бюджет
+// времени упрощены: период замера равен бюджету (или периоду непрерывного
+// режима, если он больше).
+
+// ===== Константы =====
+
+#define VL53L0X_I2C_ADDR 0x29
+
+#define VL53L0X_ERROR_NONE 0
+#define VL53L0X_ERROR_CONTROL_INTERFACE -20
+#define VL53L0X_ERROR_TIME_OUT -7
+
+// ===== Типы =====
+
+typedef int8_t VL53L0X_Error;
+
+typedef struct {
+  uint32_t TimeStamp;
+  uint32_t MeasurementTimeUsec;
+  uint16_t RangeMilliMeter;
+  uint16_t RangeDMaxMilliMeter;
+  uint8_t RangeStatus;
+} VL53L0X_RangingMeasurementData_t;
+
+// ===== Классы =====
+
+class Adafruit_VL53L0X {
+ public:
+  enum VL53L0X_Sense_config_t {
+    VL53L0X_SENSE_DEFAULT = 0,
+    VL53L0X_SENSE_LONG_RANGE,
+    VL53L0X_SENSE_HIGH_SPEED,
+    VL53L0X_SENSE_HIGH_ACCURACY
+  };
+
+  Adafruit_VL53L0X();
+
+  bool begin(uint8_t i2cAddr = VL53L0X_I2C_ADDR, bool debug = false, TwoWire* i2c = &Wire,
+             VL53L0X_Sense_config_t senseConfig = VL53L0X_SENSE_DEFAULT);
+  bool setMeasurementTimingBudgetMicroSeconds(uint32_t budgetUs);
+  uint32_t getMeasurementTimingBudgetMicroSeconds();
+
+  VL53L0X_Error rangingTest(VL53L0X_RangingMeasurementData_t* data, bool debug = false);
+  uint16_t readRange();
+
+  bool startRangeContinuous(uint16_t periodMs = 50);
+  void stopRangeContinuous();
+  bool isRangeComplete();
+  void waitRangeComplete();
+  uint16_t readRangeResult();
+  uint8_t readRangeStatus();
+  bool timeoutOccurred();
+
+  // Как в библиотеке: пишут begin, бюджет, rangingTest и старт непрерывного
+  // режима; isRangeComplete и readRangeResult хранят ошибку локально
+  VL53L0X_Error Status;
+
+ private:
+  bool readRegisters(uint8_t reg, uint8_t* data, size_t length);
+  bool writeRegisters(uint8_t reg, const uint8_t* data, size_t length);
+  bool writeRegister8(uint8_t reg, uint8_t value) { return writeRegisters(reg, &value, 1); }
+
+  TwoWire* i2c_;
+  uint8_t address_;
+  uint32_t budgetUs_;
+  uint8_t rangeStatus_;
+  bool timeout_;
+};
+
+#endif
@@ -0,0 +1,409 @@
+#include <Arduino.h>
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "native_hal.h"
+
+// ===== Структуры данных =====
+
+struct GpioPin {
+  uint8_t mode;
+  int level;
+  void (*handler)(void);
+  int interruptMode;
+};
+
+struct hw_timer_s {
+  uint32_t frequency;
+  void (*handler)(void);
+  std::atomic<uint64_t> periodTicks;
+  std::atomic<bool> running;
+  std::thread thread;
+};
+
+// ===== Глобальные переменные =====
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static std::mutex gpioMutex;
+static GpioPin gpio[NATIVE_GPIO_COUNT] = {};
+
+static std::mutex serialMutex;
+
+// ===== String =====
+
+static std::string formatInteger(unsigned long long value, unsigned char base, bool negative) {
+  static const char digits[] = "0123456789abcdef";
+  if (base < 2 || base > 16) base = DEC;
+  std::string text;
+  do {
+    text.insert(text.begin(), digits[value % base]);
+    value /= base;
+  } while (value > 0);
+  if (negative) text.insert(text.begin(), '-');
+  return text;
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+  if (value < 0 && base == DEC) return formatInteger(0ULL - (unsigned long long)value, base, true);
+  return formatInteger((unsigned long long)value, base, false);
+}
+
+String::String(int value, unsigned char base) : data_(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : data_(formatInteger(value, base, false)) {}
+String::String(long value, unsigned char base) : data_(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : data_(formatInteger(value, base, false)) {}
+String::String(long long value, unsigned char base) : data_(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : data_(formatInteger(value, base, false)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+  data_ = buffer;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  return data_.size() == other.data_.size() && strcasecmp(data_.c_str(), other.data_.c_str()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return data_.size() >= suffix.data_.size() &&
+         data_.compare(data_.size() - suffix.data_.size(), suffix.data_.size(), suffix.data_) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  if (from >= data_.size()) return String();
+  return String(data_.substr(from, to - from));
+}
+
+void String::replace(const String& from, const String& to) {
+  if (from.data_.empty()) return;
+  size_t pos = 0;
+  while ((pos = data_.find(from.data_, pos)) != std::string::npos) {
+    data_.replace(pos, from.data_.size(), to.data_);
+    pos += to.data_.size();
+  }
+}
+
+void String::toLowerCase() {
+  for (char& c : data_) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : data_) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t begin = data_.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    data_.clear();
+    return;
+  }
+  size_t end = data_.find_last_not_of(" \t\r\n");
+  data_ = data_.substr(begin, end - begin + 1);
+}
+
+String operator+(const String& lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+// ===== Print / Stream =====
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (written < size && write(buffer[written]) == 1) written++;
+  return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char stackBuffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(stackBuffer)) return write((const uint8_t*)stackBuffer, length);
+
+  std::string buffer(length + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&buffer[0], buffer.size(), format, args);
+  va_end(args);
+  return write((const uint8_t*)buffer.data(), length);
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0) break;
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0 || c == terminator) break;
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  std::string text;
+  int c;
+  while ((c = read()) >= 0) text += (char)c;
+  return String(text);
+}
+
+// Построчная буферизация: вывод не теряется, если процесс остановлен извне
+void HardwareSerial::begin(unsigned long baud) {
+  (void)baud;
+  setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  return fwrite(buffer, 1, size, stdout);
+}
+
+String IPAddress::toString() const {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", address_[0], address_[1], address_[2], address_[3]);
+  return String(buffer);
+}
+
+// ===== Время =====
+
+unsigned long millis() {
+  return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)esp_timer_get_time();
+}
+
+// Отсчёт от первого вызова — время доступно и из статических конструкторов
+int64_t esp_timer_get_time() {
+  static const auto startTime = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+// ===== GPIO =====
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= NATIVE_GPIO_COUNT) return;
+  std::lock_guard<std::mutex> lock(gpioMutex);
+  gpio[pin].mode = mode;
+  if (mode == INPUT_PULLUP) gpio[pin].level = HIGH;
+  if (mode == INPUT_PULLDOWN) gpio[pin].level = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= NATIVE_GPIO_COUNT) return;
+  std::lock_guard<std::mutex> lock(gpioMutex);
+  gpio[pin].level = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= NATIVE_GPIO_COUNT) return LOW;
+  std::lock_guard<std::mutex> lock(gpioMutex);
+  return gpio[pin].level;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+  if (pin >= NATIVE_GPIO_COUNT) return;
+  std::lock_guard<std::mutex> lock(gpioMutex);
+  gpio[pin].handler = handler;
+  gpio[pin].interruptMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  attachInterrupt(pin, NULL, 0);
+}
+
+void hal_gpioSetInput(uint8_t pin, int level) {
+  if (pin >= NATIVE_GPIO_COUNT) return;
+  void (*handler)(void) = NULL;
+  {
+    std::lock_guard<std::mutex> lock(gpioMutex);
+    GpioPin& p = gpio[pin];
+    int previous = p.level;
+    p.level = level ? HIGH : LOW;
+    bool rising = previous == LOW && p.level == HIGH;
+    bool falling = previous == HIGH && p.level == LOW;
+    if ((rising && (p.interruptMode & RISING)) || (falling && (p.interruptMode & FALLING))) {
+      handler = p.handler;
+    }
+  }
+  if (handler != NULL) handler();
+}
+
+int hal_gpioGetOutput(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin) return outMin;
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long max) {
+  return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+// ===== Аппаратный таймер =====
+
+static void timerThread(hw_timer_t* timer) {
+  auto next = std::chrono::steady_clock::now();
+  while (timer->running) {
+    uint64_t ticks = timer->periodTicks;
+    next += std::chrono::microseconds(ticks * 1000000ULL / timer->frequency);
+    std::this_thread::sleep_until(next);
+    if (timer->running && timer->handler != NULL) timer->handler();
+  }
+}
+
+hw_timer_t* timerBegin(uint32_t frequency) {
+  if (frequency == 0) return NULL;
+  hw_timer_t* timer = new hw_timer_t();
+  timer->frequency = frequency;
+  timer->handler = NULL;
+  timer->periodTicks = 0;
+  timer->running = false;
+  return timer;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*handler)(void)) {
+  if (timer != NULL) timer->handler = handler;
+}
+
+void timerDetachInterrupt(hw_timer_t* timer) {
+  if (timer != NULL) timer->handler = NULL;
+}
+
+// Поддерживается только периодический режим (autoreload), которым пользуется прошивка
+void timerAlarm(hw_timer_t* timer, uint64_t alarmValue, bool autoreload, uint64_t reloadCount) {
+  (void)autoreload;
+  (void)reloadCount;
+  if (timer == NULL || alarmValue == 0) return;
+  timer->periodTicks = alarmValue;
+  if (!timer->running) {
+    timer->running = true;
+    timer->thread = std::thread(timerThread, timer);
+  }
+}
+
+void timerEnd(hw_timer_t* timer) {
+  if (timer == NULL) return;
+  timer->running = false;
+  if (timer->thread.joinable()) timer->thread.join();
+  delete timer;
+}
+
+// ===== ESP =====
+
+// Модель кучи: 256 КБ свободно при первом обращении, дальше — минус байты,
+// выделенные процессом сверх этого уровня (mallinfo2, одна арена malloc — main())
+#define NATIVE_FREE_HEAP (256 * 1024)
+
+static std::atomic<uint32_t> minFreeHeap(NATIVE_FREE_HEAP);
+
+uint32_t EspClass::getFreeHeap() {
+  static const size_t baseline = mallinfo2().uordblks;
+  size_t used = mallinfo2().uordblks;
+  size_t grown = used > baseline ? used - baseline : 0;
+  uint32_t free = grown < NATIVE_FREE_HEAP ? NATIVE_FREE_HEAP - grown : 0;
+  uint32_t min = minFreeHeap.load();
+  while (free < min && !minFreeHeap.compare_exchange_weak(min, free)) {
+  }
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() { return minFreeHeap.load(); }
+uint32_t EspClass::getMaxAllocHeap() { return 128 * 1024; }
+uint32_t EspClass::getHeapSize() { return 320 * 1024; }
+uint32_t EspClass::getPsramSize() { return 8 * 1024 * 1024; }
+uint32_t EspClass::getFreePsram() { return 8 * 1024 * 1024; }
+
+bool psramFound() { return true; }
+void* ps_malloc(size_t size) { return malloc(size); }
+
+const char* esp_err_to_name(esp_err_t code) {
+  switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    default: return "UNKNOWN ERROR";
+  }
+}
+
+void EspClass::restart() {
+  Serial.println("ESP.restart()");
+  fflush(stdout);
+  exit(0);
+}
+
+// ===== Точка входа =====
+
+// В тестах PlatformIO (pio test) main() даёт Unity, модули вызываются напрямую
+#ifndef PIO_UNIT_TESTING
+int main() {
+  // Потоки выделяют из общей арены — getFreeHeap() видит выделения всех задач.
+  // Блоки от 128 КБ (модель flash, буферы тестов) — через mmap и в куче не считаются.
+  mallopt(M_ARENA_MAX, 1);
+  mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+  setup();
+  for (;;) loop();
+}
+#endif
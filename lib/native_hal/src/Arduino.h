@@ -0,0 +1,263 @@
+#ifndef _NATIVE_ARDUINO_H
+#define _NATIVE_ARDUINO_H
+
+// Минимальное ядро Arduino для сборки прошивки на Linux (env:native).
+// Реализует только то, что используют модули src/: String, Print/Serial,
+// время, GPIO с прерываниями, аппаратный таймер и ESP. Serial пишет в stdout.
+// Состояние «железа» доступно тестам через native_hal.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+// ===== Константы =====
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define NATIVE_GPIO_COUNT 49
+
+#define IRAM_ATTR
+#define PROGMEM
+#define F(string) (string)
+typedef const char* PGM_P;
+
+#define digitalPinToInterrupt(pin) (pin)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+// ===== String =====
+
+class String {
+ public:
+  String() {}
+  String(const char* value) : data_(value != NULL ? value : "") {}
+  String(const std::string& value) : data_(value) {}
+  String(char value) : data_(1, value) {}
+  String(int value, unsigned char base = DEC);
+  String(unsigned int value, unsigned char base = DEC);
+  String(long value, unsigned char base = DEC);
+  String(unsigned long value, unsigned char base = DEC);
+  String(long long value, unsigned char base = DEC);
+  String(unsigned long long value, unsigned char base = DEC);
+  String(float value, unsigned int decimals = 2);
+  String(double value, unsigned int decimals = 2);
+
+  const char* c_str() const { return data_.c_str(); }
+  unsigned int length() const { return data_.size(); }
+  bool isEmpty() const { return data_.empty(); }
+  bool reserve(unsigned int size) { data_.reserve(size); return true; }
+
+  bool concat(const String& value) { data_ += value.data_; return true; }
+  bool concat(const char* value) { if (value != NULL) data_ += value; return true; }
+  bool concat(const char* value, unsigned int length) { data_.append(value, length); return true; }
+  bool concat(char value) { data_ += value; return true; }
+  template <typename T> bool concat(T value) { return concat(String(value)); }
+  template <typename T> String& operator+=(const T& value) { concat(value); return *this; }
+
+  char charAt(unsigned int index) const { return index < data_.size() ? data_[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  bool equals(const String& other) const { return data_ == other.data_; }
+  bool equals(const char* other) const { return data_ == (other != NULL ? other : ""); }
+  bool equalsIgnoreCase(const String& other) const;
+  bool startsWith(const String& prefix) const { return data_.compare(0, prefix.data_.size(), prefix.data_) == 0; }
+  bool endsWith(const String& suffix) const;
+  int indexOf(char ch, unsigned int from = 0) const { return toIndex(data_.find(ch, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return toIndex(data_.find(str.data_, from)); }
+  int lastIndexOf(char ch) const { return toIndex(data_.rfind(ch)); }
+  String substring(unsigned int from) const { return from < data_.size() ? String(data_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const;
+  void remove(unsigned int index) { if (index < data_.size()) data_.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < data_.size()) data_.erase(index, count); }
+  void replace(const String& from, const String& to);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  long toInt() const { return atol(data_.c_str()); }
+  float toFloat() const { return (float)atof(data_.c_str()); }
+
+  bool operator==(const String& other) const { return data_ == other.data_; }
+  bool operator==(const char* other) const { return equals(other); }
+  bool operator!=(const String& other) const { return data_ != other.data_; }
+  bool operator!=(const char* other) const { return !equals(other); }
+  bool operator<(const String& other) const { return data_ < other.data_; }
+
+ private:
+  static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  std::string data_;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+template <typename T> String operator+(const String& lhs, T rhs) { return lhs + String(rhs); }
+
+// ===== Print / Stream =====
+
+class Print;
+
+class Printable {
+ public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) { return str != NULL ? write((const uint8_t*)str, strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* str) { return write(str); }
+  size_t print(const String& str) { return write(str.c_str(), str.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(const Printable& value) { return value.printTo(*this); }
+  size_t print(int value, int base = DEC) { return print((long long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long long)value, base); }
+  size_t print(long value, int base = DEC) { return print((long long)value, base); }
+  size_t print(unsigned long value, int base = DEC) { return print((unsigned long long)value, base); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long long)value, base); }
+  size_t print(long long value, int base = DEC) { return print(String(value, base)); }
+  size_t print(unsigned long long value, int base = DEC) { return print(String(value, base)); }
+  size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T& value) { return print(value) + println(); }
+  template <typename T> size_t println(const T& value, int format) { return print(value, format) + println(); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+  String readString();
+  void setTimeout(unsigned long timeout) { (void)timeout; }
+};
+
+// Serial — stdout процесса, ввода нет
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud);
+  void end() {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return 4096; }
+  void flush() override { fflush(stdout); }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// ===== IPAddress =====
+
+class IPAddress : public Printable {
+ public:
+  IPAddress() : address_{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address_{a, b, c, d} {}
+  uint8_t operator[](int index) const { return address_[index]; }
+  String toString() const;
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+  bool operator==(const IPAddress& other) const { return memcmp(address_, other.address_, 4) == 0; }
+
+ private:
+  uint8_t address_[4];
+};
+
+// ===== Время =====
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ===== GPIO =====
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long max);
+long random(long min, long max);
+
+// ===== Аппаратный таймер =====
+
+// Прерывание таймера — отдельный поток, вызывающий обработчик с заданным периодом
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t* timerBegin(uint32_t frequency);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*handler)(void));
+void timerDetachInterrupt(hw_timer_t* timer);
+void timerAlarm(hw_timer_t* timer, uint64_t alarmValue, bool autoreload, uint64_t reloadCount);
+
+// ===== PSRAM =====
+
+// PSRAM хостовой сборки — обычная куча (учитывается в getFreeHeap)
+bool psramFound();
+void* ps_malloc(size_t size);
+
+// ===== ESP =====
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getHeapSize();
+  uint32_t getPsramSize();
+  uint32_t getFreePsram();
+  uint32_t getCpuFreqMHz() { return 240; }
+  const char* getSdkVersion() { return "native"; }
+  void restart();
+};
+
+extern EspClass ESP;
+
+void setup();
+void loop();
+
+#endif
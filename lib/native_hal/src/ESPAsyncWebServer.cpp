@@ -0,0 +1,544 @@
+#include <ESPAsyncWebServer.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define HTTP_SEGMENT_SIZE 1436      // тело приходит частями размером с TCP-сегмент
+#define UPLOAD_FILENAME "upload.bin"
+#define HTTP_MAX_HEADER_SIZE 8192
+
+// ===== Глобальные переменные =====
+
+static const String emptyString;
+
+// Один обработчик за раз — как в задаче async_tcp
+static std::recursive_mutex dispatchMutex;
+
+// ===== Вспомогательные функции =====
+
+// Порядок создания = порядок опроса. Серверы — глобальные объекты других
+// единиц трансляции, поэтому список создаётся при первом обращении.
+static std::list<AsyncWebServer*>& servers() {
+  static std::list<AsyncWebServer*> list;
+  return list;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static String urlDecode(const std::string& text) {
+  std::string decoded;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] == '+') {
+      decoded += ' ';
+    } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+      decoded += (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+      i += 2;
+    } else {
+      decoded += text[i];
+    }
+  }
+  return String(decoded);
+}
+
+// Первая часть multipart/form-data с файлом (как upload-обработчик библиотеки):
+// false, если тело не multipart — тогда файлом считается всё тело
+static bool findMultipartFile(const String& contentType, const uint8_t* body, size_t bodyLength,
+                              size_t* offset, size_t* length, String* filename) {
+  if (!contentType.startsWith("multipart/form-data")) return false;
+  int mark = contentType.indexOf("boundary=");
+  if (mark < 0) return false;
+  std::string boundary = std::string("--") + contentType.substring(mark + 9).c_str();
+
+  std::string data((const char*)body, bodyLength);
+  size_t partStart = data.find(boundary);
+  while (partStart != std::string::npos) {
+    size_t headersStart = partStart + boundary.size() + 2;
+    size_t headersEnd = data.find("\r\n\r\n", headersStart);
+    if (headersEnd == std::string::npos) return false;
+    size_t contentStart = headersEnd + 4;
+    size_t next = data.find("\r\n" + boundary, contentStart);
+    if (next == std::string::npos) return false;
+
+    std::string partHeaders = data.substr(headersStart, headersEnd - headersStart);
+    size_t name = partHeaders.find("filename=\"");
+    if (name != std::string::npos) {
+      size_t nameEnd = partHeaders.find('"', name + 10);
+      *filename = String(partHeaders.substr(name + 10, nameEnd - name - 10));
+      *offset = contentStart;
+      *length = next - contentStart;
+      return true;
+    }
+    partStart = next + 2;
+  }
+  return false;
+}
+
+static WebRequestMethodComposite parseMethod(const char* method) {
+  static const struct { const char* name; WebRequestMethod method; } methods[] = {
+    {"GET", HTTP_GET}, {"POST", HTTP_POST}, {"DELETE", HTTP_DELETE}, {"PUT", HTTP_PUT},
+    {"PATCH", HTTP_PATCH}, {"HEAD", HTTP_HEAD}, {"OPTIONS", HTTP_OPTIONS}};
+  for (const auto& m : methods) {
+    if (strcasecmp(method, m.name) == 0) return m.method;
+  }
+  return HTTP_GET;
+}
+
+static const char* reasonPhrase(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static bool sendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+// Одно соединение — один запрос: заголовки, тело по Content-Length, ответ, закрытие
+static void serveConnection(int fd) {
+  std::string buffer;
+  char chunk[HTTP_SEGMENT_SIZE];
+  size_t headerEnd;
+  while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0 || buffer.size() > HTTP_MAX_HEADER_SIZE) {
+      close(fd);
+      return;
+    }
+    buffer.append(chunk, n);
+  }
+
+  std::string head = buffer.substr(0, headerEnd);
+  size_t lineEnd = head.find("\r\n");
+  std::string requestLine = head.substr(0, lineEnd);
+  std::string headers = lineEnd == std::string::npos ? "" : head.substr(lineEnd + 2);
+  size_t methodEnd = requestLine.find(' ');
+  size_t targetEnd = requestLine.find(' ', methodEnd + 1);
+  if (methodEnd == std::string::npos || targetEnd == std::string::npos) {
+    close(fd);
+    return;
+  }
+  std::string method = requestLine.substr(0, methodEnd);
+  std::string target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+  size_t contentLength = 0;
+  size_t from = 0;
+  while (from < headers.size()) {
+    size_t end = headers.find("\r\n", from);
+    if (end == std::string::npos) end = headers.size();
+    std::string line = headers.substr(from, end - from);
+    if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) contentLength = strtoul(line.c_str() + 15, NULL, 10);
+    from = end + 2;
+  }
+
+  std::string body = buffer.substr(headerEnd + 4);
+  while (body.size() < contentLength) {
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      close(fd);
+      return;
+    }
+    body.append(chunk, n);
+  }
+  body.resize(contentLength);
+
+  HalHttpResponse result = hal_httpRequest(method.c_str(), target.c_str(), (const uint8_t*)body.data(),
+                                           body.size(), headers.c_str());
+  if (result.code == 0) result.code = 503;
+
+  String response = String("HTTP/1.1 ") + String(result.code) + " " + reasonPhrase(result.code) + "\r\n";
+  if (result.contentType.length() > 0) response += String("Content-Type: ") + result.contentType + "\r\n";
+  response += String("Content-Length: ") + String(result.body.length()) + "\r\n";
+  response += result.headers;
+  response += "Connection: close\r\n\r\n";
+
+  std::string data(response.c_str(), response.length());
+  data.append(result.body.c_str(), result.body.length());
+  sendAll(fd, data);
+  close(fd);
+}
+
+// ===== AsyncWebServerResponse =====
+
+void AsyncWebServerResponse::addHeader(const String& name, const String& value, bool replaceExisting) {
+  for (auto& header : headers_) {
+    if (header.first.equalsIgnoreCase(name)) {
+      if (replaceExisting) header.second = value;
+      return;
+    }
+  }
+  headers_.push_back({name, value});
+}
+
+// ===== AsyncWebServerRequest =====
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethodComposite method, const String& url,
+                                             size_t contentLength)
+    : _tempObject(NULL), method_(method), url_(url), contentLength_(contentLength), response_(NULL) {}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  delete response_;
+  // Как у библиотеки: _tempObject выделяется обработчиком через malloc
+  free(_tempObject);
+}
+
+const char* AsyncWebServerRequest::methodToString() const {
+  switch (method_) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_PUT: return "PUT";
+    case HTTP_PATCH: return "PATCH";
+    case HTTP_HEAD: return "HEAD";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "UNKNOWN";
+  }
+}
+
+bool AsyncWebServerRequest::hasParam(const char* name, bool post, bool file) const {
+  return getParam(name, post, file) != NULL;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const char* name, bool post, bool file) const {
+  (void)file;
+  for (const AsyncWebParameter& param : params_) {
+    if (param.isPost() == post && param.name().equals(name)) return &param;
+  }
+  return NULL;
+}
+
+const String& AsyncWebServerRequest::arg(const char* name) const {
+  const AsyncWebParameter* param = getParam(name);
+  return param != NULL ? param->value() : emptyString;
+}
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const {
+  for (const auto& header : headers_) {
+    if (header.first.equalsIgnoreCase(name)) return true;
+  }
+  return false;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const {
+  for (const auto& header : headers_) {
+    if (header.first.equalsIgnoreCase(name)) return header.second;
+  }
+  return emptyString;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  if (response == NULL) return;
+  if (response_ != NULL) {
+    // Библиотека игнорирует повторный ответ на тот же запрос
+    delete response;
+    return;
+  }
+  for (const auto& header : DefaultHeaders::Instance().headers()) {
+    response->addHeader(header.first, header.second, false);
+  }
+  response_ = response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const char* content) {
+  return new AsyncWebServerResponse(code, contentType, content != NULL ? content : "");
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const String& content) {
+  return new AsyncWebServerResponse(code, contentType, std::string(content.c_str(), content.length()));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType,
+                                                             const uint8_t* content, size_t length) {
+  return new AsyncWebServerResponse(code, contentType, std::string((const char*)content, length));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(File content, const String& path,
+                                                             const char* contentType, bool download) {
+  std::string body;
+  uint8_t buffer[512];
+  size_t length;
+  while ((length = content.read(buffer, sizeof(buffer))) > 0) body.append((const char*)buffer, length);
+
+  AsyncWebServerResponse* response = new AsyncWebServerResponse(200, contentType, body);
+  // Файл *.gz отдаётся с Content-Encoding, если запрошен путь без .gz
+  if (String(content.path()).endsWith(".gz") && !path.endsWith(".gz")) {
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  if (download) response->addHeader("Content-Disposition", "attachment");
+  return response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path,
+                                                             const char* contentType, bool download) {
+  File file = fs.open(path, "r");
+  if (!file) return new AsyncWebServerResponse(404);
+  return beginResponse(file, path, contentType, download);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const char* contentType,
+                                                                    AwsResponseFiller filler) {
+  std::string body;
+  uint8_t buffer[HTTP_SEGMENT_SIZE];
+  size_t length;
+  while ((length = filler(buffer, sizeof(buffer), body.size())) > 0) {
+    body.append((const char*)buffer, length);
+  }
+  return new AsyncWebServerResponse(200, contentType, body);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const char* contentType, size_t bufferSize) {
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::takeResponse() {
+  AsyncWebServerResponse* response = response_;
+  response_ = NULL;
+  return response;
+}
+
+void AsyncWebServerRequest::disconnect() {
+  if (onDisconnect_) onDisconnect_();
+}
+
+// ===== AsyncCallbackWebHandler =====
+
+// Правила совпадения как у ESPAsyncWebServer: "/x" обслуживает и "/x/...",
+// "/x*" — любой URL с префиксом "/x", "/*.ext" — любой URL с расширением
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) const {
+  if (!onRequest || !(method_ & request->method())) return false;
+  if (filter_ && !filter_(request)) return false;
+
+  const String& url = request->url();
+  if (uri_.length() == 0) return true;
+  if (uri_.startsWith("/*.")) return url.endsWith(uri_.substring(uri_.lastIndexOf('.')));
+  if (uri_.endsWith("*")) return url.startsWith(uri_.substring(0, uri_.length() - 1));
+  return url == uri_ || url.startsWith(uri_ + "/");
+}
+
+// ===== AsyncWebServer =====
+
+AsyncWebServer::AsyncWebServer(uint16_t port) : port_(port), running_(false), listenFd_(-1) {
+  servers().push_back(this);
+}
+
+AsyncWebServer::~AsyncWebServer() {
+  end();
+  servers().remove(this);
+}
+
+// Порт занят — сервер доступен только через hal_httpRequest()
+void AsyncWebServer::begin() {
+  running_ = true;
+  if (listenFd_ >= 0) return;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port_);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+    fprintf(stderr, "[native_hal] HTTP port %u unavailable, TCP disabled\n", port_);
+    close(fd);
+    return;
+  }
+  listenFd_ = fd;
+  listener_ = std::thread(&AsyncWebServer::listen, this);
+}
+
+void AsyncWebServer::end() {
+  running_ = false;
+  if (listenFd_ < 0) return;
+  // accept() в потоке приёма завершается ошибкой
+  shutdown(listenFd_, SHUT_RDWR);
+  if (listener_.joinable()) listener_.join();
+  close(listenFd_);
+  listenFd_ = -1;
+}
+
+void AsyncWebServer::listen() {
+  for (;;) {
+    int client = accept(listenFd_, NULL, NULL);
+    if (client < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    std::thread(serveConnection, client).detach();
+  }
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest) {
+  return on(uri, method, onRequest, NULL, NULL);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload) {
+  return on(uri, method, onRequest, onUpload, NULL);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload,
+                                            ArBodyHandlerFunction onBody) {
+  handlers_.emplace_back(uri, method);
+  AsyncCallbackWebHandler& handler = handlers_.back();
+  handler.onRequest = onRequest;
+  handler.onUpload = onUpload;
+  handler.onBody = onBody;
+  return handler;
+}
+
+void AsyncWebServer::reset() {
+  handlers_.clear();
+  notFound_ = NULL;
+}
+
+AsyncCallbackWebHandler* AsyncWebServer::findHandler(AsyncWebServerRequest* request) {
+  for (AsyncCallbackWebHandler& handler : handlers_) {
+    if (handler.canHandle(request)) return &handler;
+  }
+  return NULL;
+}
+
+// ===== DefaultHeaders =====
+
+DefaultHeaders& DefaultHeaders::Instance() {
+  static DefaultHeaders instance;
+  return instance;
+}
+
+// ===== Доступ тестов =====
+
+HalHttpResponse hal_httpRequest(const char* method, const char* url, const uint8_t* body, size_t bodyLength,
+                                const char* headers) {
+  HalHttpResponse result = {0, "", "", ""};
+  std::lock_guard<std::recursive_mutex> lock(dispatchMutex);
+
+  std::string target = url != NULL ? url : "/";
+  std::string query;
+  size_t mark = target.find('?');
+  if (mark != std::string::npos) {
+    query = target.substr(mark + 1);
+    target.resize(mark);
+  }
+
+  AsyncWebServerRequest request(parseMethod(method), urlDecode(target), bodyLength);
+
+  size_t start = 0;
+  while (start < query.size()) {
+    size_t end = query.find('&', start);
+    if (end == std::string::npos) end = query.size();
+    std::string pair = query.substr(start, end - start);
+    size_t eq = pair.find('=');
+    request.addParam(urlDecode(pair.substr(0, eq)), eq == std::string::npos ? String() : urlDecode(pair.substr(eq + 1)));
+    start = end + 1;
+  }
+
+  if (headers != NULL) {
+    String lines(headers);
+    int from = 0;
+    while (from < (int)lines.length()) {
+      int end = lines.indexOf('\n', from);
+      if (end < 0) end = lines.length();
+      String line = lines.substring(from, end);
+      int colon = line.indexOf(':');
+      if (colon > 0) {
+        String value = line.substring(colon + 1);
+        value.trim();
+        request.addHeaderValue(line.substring(0, colon), value);
+      }
+      from = end + 1;
+    }
+  }
+
+  AsyncWebServer* server = NULL;
+  AsyncCallbackWebHandler* handler = NULL;
+  for (AsyncWebServer* candidate : servers()) {
+    if (!candidate->isRunning()) continue;
+    if (server == NULL) server = candidate;
+    handler = candidate->findHandler(&request);
+    if (handler != NULL) {
+      server = candidate;
+      break;
+    }
+  }
+  if (server == NULL) return result;
+
+  if (handler != NULL) {
+    // Загрузка файла: из multipart — содержимое части с файлом, иначе всё тело
+    String filename = UPLOAD_FILENAME;
+    size_t fileOffset = 0;
+    if (handler->onUpload &&
+        findMultipartFile(request.header("Content-Type"), body, bodyLength, &fileOffset, &bodyLength, &filename)) {
+      body += fileOffset;
+    }
+
+    // Тело — частями, как оно приходит по TCP
+    for (size_t index = 0; index < bodyLength || (index == 0 && handler->onUpload); index += HTTP_SEGMENT_SIZE) {
+      size_t length = std::min((size_t)HTTP_SEGMENT_SIZE, bodyLength - index);
+      uint8_t* chunk = (uint8_t*)body + index;
+      bool final = index + length >= bodyLength;
+      if (handler->onUpload) {
+        handler->onUpload(&request, filename, index, chunk, length, final);
+      } else if (handler->onBody) {
+        handler->onBody(&request, chunk, length, index, bodyLength);
+      }
+      if (final) break;
+    }
+    handler->onRequest(&request);
+  } else if (server->notFoundHandler()) {
+    server->notFoundHandler()(&request);
+  } else {
+    request.send(404);
+  }
+
+  AsyncWebServerResponse* response = request.takeResponse();
+  if (response != NULL) {
+    result.code = response->code();
+    result.contentType = response->contentType();
+    std::string content = response->content();
+    result.body = String(content);
+    for (const auto& header : response->headers()) {
+      result.headers += header.first + ": " + header.second + "\r\n";
+    }
+    delete response;
+  }
+  request.disconnect();
+  return result;
+}
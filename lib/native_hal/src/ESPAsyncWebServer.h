@@ -0,0 +1,242 @@
+#ifndef _NATIVE_ESPASYNCWEBSERVER_H
+#define _NATIVE_ESPASYNCWEBSERVER_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <functional>
+#include <list>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ESPAsyncWebServer для хоста: запрос подаётся hal_httpRequest() (native_hal.h)
+// и проходит те же этапы, что у библиотеки — выбор обработчика (метод и
+// префиксное совпадение URL), тело частями по TCP-сегменту, ответ,
+// DefaultHeaders, освобождение _tempObject и onDisconnect.
+// Обработчики выполняются по одному, как в единственной задаче async_tcp.
+// begin() также принимает HTTP/1.1 на 127.0.0.1:port (Connection: close, как
+// у библиотеки) — скрипты scripts/bench.py работают с хостовой сборкой.
+// Обработчику загрузки (onUpload) тело передаётся как один файл, без разбора multipart.
+
+// ===== Константы =====
+
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_DELETE = 0b00000100,
+  HTTP_PUT = 0b00001000,
+  HTTP_PATCH = 0b00010000,
+  HTTP_HEAD = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY = 0b01111111
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+// ===== Классы =====
+
+class AsyncWebServerRequest;
+class AsyncWebServer;
+
+class AsyncWebParameter {
+ public:
+  AsyncWebParameter(const String& name, const String& value, bool post = false)
+      : name_(name), value_(value), post_(post) {}
+  const String& name() const { return name_; }
+  const String& value() const { return value_; }
+  bool isPost() const { return post_; }
+  bool isFile() const { return false; }
+
+ private:
+  String name_;
+  String value_;
+  bool post_;
+};
+
+class AsyncWebServerResponse {
+ public:
+  AsyncWebServerResponse(int code = 200, const String& contentType = "", const std::string& content = "")
+      : code_(code), contentType_(contentType), content_(content) {}
+  virtual ~AsyncWebServerResponse() {}
+
+  void setCode(int code) { code_ = code; }
+  int code() const { return code_; }
+  void setContentType(const String& type) { contentType_ = type; }
+  const String& contentType() const { return contentType_; }
+  void addHeader(const String& name, const String& value, bool replaceExisting = true);
+  const std::vector<std::pair<String, String>>& headers() const { return headers_; }
+  virtual std::string content() { return content_; }
+
+ protected:
+  int code_;
+  String contentType_;
+  std::string content_;
+  std::vector<std::pair<String, String>> headers_;
+};
+
+// Ответ, который пишется как Print (serializeJson и т. п.)
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+ public:
+  AsyncResponseStream(const String& contentType, size_t bufferSize)
+      : AsyncWebServerResponse(200, contentType) {
+    content_.reserve(bufferSize);
+  }
+  size_t write(uint8_t data) override {
+    content_ += (char)data;
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t length) override {
+    content_.append((const char*)data, length);
+    return length;
+  }
+  using Print::write;
+  size_t available() const { return content_.size(); }
+};
+
+typedef std::function<void(void)> ArDisconnectHandler;
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebServerRequest {
+ public:
+  AsyncWebServerRequest(WebRequestMethodComposite method, const String& url, size_t contentLength);
+  ~AsyncWebServerRequest();
+
+  void* _tempObject;
+
+  WebRequestMethodComposite method() const { return method_; }
+  const char* methodToString() const;
+  const String& url() const { return url_; }
+  size_t contentLength() const { return contentLength_; }
+  IPAddress client_ip() const { return IPAddress(127, 0, 0, 1); }
+
+  size_t params() const { return params_.size(); }
+  bool hasParam(const char* name, bool post = false, bool file = false) const;
+  bool hasParam(const String& name, bool post = false, bool file = false) const {
+    return hasParam(name.c_str(), post, file);
+  }
+  const AsyncWebParameter* getParam(const char* name, bool post = false, bool file = false) const;
+  const AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const {
+    return getParam(name.c_str(), post, file);
+  }
+  bool hasArg(const char* name) const { return getParam(name) != NULL; }
+  const String& arg(const char* name) const;
+  const String& arg(const String& name) const { return arg(name.c_str()); }
+
+  bool hasHeader(const char* name) const;
+  bool hasHeader(const String& name) const { return hasHeader(name.c_str()); }
+  const String& header(const char* name) const;
+  const String& header(const String& name) const { return header(name.c_str()); }
+
+  void onDisconnect(ArDisconnectHandler handler) { onDisconnect_ = handler; }
+
+  void send(AsyncWebServerResponse* response);
+  void send(int code, const char* contentType = "", const char* content = "") {
+    send(beginResponse(code, contentType, content));
+  }
+  void send(int code, const char* contentType, const String& content) {
+    send(beginResponse(code, contentType, content));
+  }
+  void send(int code, const String& contentType, const String& content) {
+    send(beginResponse(code, contentType.c_str(), content));
+  }
+
+  AsyncWebServerResponse* beginResponse(int code, const char* contentType = "", const char* content = "");
+  AsyncWebServerResponse* beginResponse(int code, const char* contentType, const String& content);
+  AsyncWebServerResponse* beginResponse(int code, const char* contentType, const uint8_t* content, size_t length);
+  AsyncWebServerResponse* beginResponse(File content, const String& path, const char* contentType = "",
+                                        bool download = false);
+  AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const char* contentType = "",
+                                        bool download = false);
+  AsyncWebServerResponse* beginChunkedResponse(const char* contentType, AwsResponseFiller filler);
+  AsyncResponseStream* beginResponseStream(const char* contentType, size_t bufferSize = 1460);
+
+  // Доступ HAL
+  void addHeaderValue(const String& name, const String& value) { headers_.push_back({name, value}); }
+  void addParam(const String& name, const String& value) { params_.emplace_back(name, value); }
+  AsyncWebServerResponse* takeResponse();
+  void disconnect();
+
+ private:
+  WebRequestMethodComposite method_;
+  String url_;
+  size_t contentLength_;
+  std::vector<std::pair<String, String>> headers_;
+  std::vector<AsyncWebParameter> params_;
+  AsyncWebServerResponse* response_;
+  ArDisconnectHandler onDisconnect_;
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index,
+                           uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                           size_t index, size_t total)> ArBodyHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+
+class AsyncCallbackWebHandler {
+ public:
+  AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method)
+      : uri_(uri), method_(method) {}
+
+  AsyncCallbackWebHandler& setFilter(ArRequestFilterFunction filter) {
+    filter_ = filter;
+    return *this;
+  }
+  bool canHandle(AsyncWebServerRequest* request) const;
+
+  String uri_;
+  WebRequestMethodComposite method_;
+  ArRequestHandlerFunction onRequest;
+  ArUploadHandlerFunction onUpload;
+  ArBodyHandlerFunction onBody;
+  ArRequestFilterFunction filter_;
+};
+
+class AsyncWebServer {
+ public:
+  explicit AsyncWebServer(uint16_t port);
+  ~AsyncWebServer();
+
+  void begin();
+  void end();
+
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method,
+                              ArRequestHandlerFunction onRequest);
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method,
+                              ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload);
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method,
+                              ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload,
+                              ArBodyHandlerFunction onBody);
+  void onNotFound(ArRequestHandlerFunction handler) { notFound_ = handler; }
+  void reset();
+
+  // Доступ HAL: обработчик запроса или NULL (тогда — onNotFound)
+  AsyncCallbackWebHandler* findHandler(AsyncWebServerRequest* request);
+  const ArRequestHandlerFunction& notFoundHandler() const { return notFound_; }
+  bool isRunning() const { return running_; }
+
+ private:
+  void listen();
+
+  uint16_t port_;
+  bool running_;
+  int listenFd_;
+  std::thread listener_;
+  std::list<AsyncCallbackWebHandler> handlers_;   // адреса элементов стабильны
+  ArRequestHandlerFunction notFound_;
+};
+
+// Заголовки, добавляемые ко всем ответам
+class DefaultHeaders {
+ public:
+  static DefaultHeaders& Instance();
+  void addHeader(const String& name, const String& value) { headers_.push_back({name, value}); }
+  const std::vector<std::pair<String, String>>& headers() const { return headers_; }
+
+ private:
+  std::vector<std::pair<String, String>> headers_;
+};
+
+#endif
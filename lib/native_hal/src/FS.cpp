@@ -0,0 +1,213 @@
+#include <FS.h>
+#include <LittleFS.h>
+
+#include <map>
+#include <mutex>
+
+#include "esp_partition.h"
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define LITTLEFS_TOTAL_BYTES (1536 * 1024)
+
+// ===== Структуры данных =====
+
+namespace fs {
+struct FileData {
+  std::string content;
+};
+}  // namespace fs
+
+using fs::FileData;
+
+// ===== Глобальные переменные =====
+
+fs::LittleFSFS LittleFS;
+
+static std::recursive_mutex fsMutex;   // File::seek() вызывается под ним из FS::open()
+static std::map<std::string, std::shared_ptr<FileData>> files;
+static bool mountable = true;
+
+// ===== Вспомогательные функции =====
+
+static std::string normalize(const char* path) {
+  std::string normalized = path != NULL ? path : "";
+  if (normalized.empty() || normalized[0] != '/') normalized.insert(normalized.begin(), '/');
+  return normalized;
+}
+
+// Образ, записанный в раздел через Update (U_SPIFFS), монтируется, только если
+// в нём суперблок LittleFS. Файлы модели при этом не меняются: образ не разбирается.
+static bool partitionMountable() {
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "spiffs");
+  uint8_t head[16];
+  if (partition == NULL || esp_partition_read(partition, 0, head, sizeof(head)) != ESP_OK) return true;
+  bool erased = true;
+  for (uint8_t byte : head) erased = erased && byte == 0xFF;
+  return erased || memcmp(head + 8, "littlefs", 8) == 0;
+}
+
+// ===== File =====
+
+namespace fs {
+
+File::File(const std::shared_ptr<FileData>& data, const std::string& path, bool writable)
+    : data_(data), path_(path), position_(0), writable_(writable) {}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!data_ || !writable_) return 0;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  std::string& content = data_->content;
+  if (position_ + size > content.size()) content.resize(position_ + size);
+  memcpy(&content[position_], buffer, size);
+  position_ += size;
+  return size;
+}
+
+int File::available() {
+  if (!data_) return 0;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  return position_ < data_->content.size() ? (int)(data_->content.size() - position_) : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (!data_) return -1;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  return position_ < data_->content.size() ? (uint8_t)data_->content[position_] : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!data_) return 0;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  const std::string& content = data_->content;
+  if (position_ >= content.size()) return 0;
+  size_t count = std::min(size, content.size() - position_);
+  memcpy(buffer, content.data() + position_, count);
+  position_ += count;
+  return count;
+}
+
+bool File::seek(uint32_t position) {
+  if (!data_ || position > size()) return false;
+  position_ = position;
+  return true;
+}
+
+size_t File::size() const {
+  if (!data_) return 0;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  return data_->content.size();
+}
+
+void File::close() {
+  data_.reset();
+}
+
+const char* File::name() const {
+  size_t slash = path_.rfind('/');
+  return path_.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+// ===== FS =====
+
+File FS::open(const char* path, const char* mode, bool create) {
+  if (!mounted_) return File();
+  std::string name = normalize(path);
+  bool write = mode != NULL && (mode[0] == 'w' || mode[0] == 'a');
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+
+  auto it = files.find(name);
+  if (it == files.end()) {
+    if (!write && !create) return File();
+    it = files.emplace(name, std::make_shared<FileData>()).first;
+  }
+  // Открытый файл видит новое содержимое только после повторного открытия
+  if (mode != NULL && mode[0] == 'w') it->second = std::make_shared<FileData>();
+
+  File file(it->second, name, write || (mode != NULL && strchr(mode, '+') != NULL));
+  if (mode != NULL && mode[0] == 'a') file.seek(it->second->content.size());
+  return file;
+}
+
+bool FS::exists(const char* path) {
+  if (!mounted_) return false;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  return files.count(normalize(path)) > 0;
+}
+
+bool FS::remove(const char* path) {
+  if (!mounted_) return false;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  return files.erase(normalize(path)) > 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  if (!mounted_) return false;
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  auto it = files.find(normalize(from));
+  if (it == files.end()) return false;
+  std::shared_ptr<FileData> data = it->second;
+  files.erase(it);
+  files[normalize(to)] = data;
+  return true;
+}
+
+// ===== LittleFS =====
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  if ((!mountable || !partitionMountable()) && !formatOnFail) return false;
+  if (!mountable) format();
+  mounted_ = true;
+  return true;
+}
+
+void LittleFSFS::end() {
+  mounted_ = false;
+}
+
+bool LittleFSFS::format() {
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  files.clear();
+  mountable = true;
+  return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+  return LITTLEFS_TOTAL_BYTES;
+}
+
+size_t LittleFSFS::usedBytes() {
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  size_t used = 0;
+  for (const auto& entry : files) used += entry.second->content.size();
+  return used;
+}
+
+}  // namespace fs
+
+// ===== Доступ тестов =====
+
+void hal_fsWriteFile(const char* path, const uint8_t* data, size_t length) {
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  std::shared_ptr<FileData> file = std::make_shared<FileData>();
+  file->content.assign((const char*)data, length);
+  files[normalize(path)] = file;
+}
+
+void hal_fsSetMountable(bool value) {
+  std::lock_guard<std::recursive_mutex> lock(fsMutex);
+  mountable = value;
+}
@@ -0,0 +1,69 @@
+#ifndef _NATIVE_FS_H
+#define _NATIVE_FS_H
+
+#include <Arduino.h>
+
+#include <memory>
+#include <string>
+
+// Файловая система в памяти с интерфейсом fs::FS Arduino-ESP32.
+// Каталогов нет: путь — просто имя файла.
+
+namespace fs {
+
+struct FileData;
+
+class File : public Stream {
+ public:
+  File() : position_(0), writable_(false) {}
+  File(const std::shared_ptr<FileData>& data, const std::string& path, bool writable);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buffer, size_t size);
+  void flush() override {}
+  bool seek(uint32_t position);
+  size_t position() const { return position_; }
+  size_t size() const;
+  void close();
+  bool isDirectory() const { return false; }
+  const char* path() const { return path_.c_str(); }
+  const char* name() const;
+  operator bool() const { return data_ != nullptr; }
+
+ private:
+  std::shared_ptr<FileData> data_;
+  std::string path_;
+  size_t position_;
+  bool writable_;
+};
+
+class FS {
+ public:
+  File open(const char* path, const char* mode = "r", bool create = false);
+  File open(const String& path, const char* mode = "r", bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* from, const char* to);
+  bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+  bool mkdir(const char* path) { (void)path; return true; }
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+ protected:
+  bool mounted_ = false;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
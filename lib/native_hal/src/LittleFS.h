@@ -0,0 +1,25 @@
+#ifndef _NATIVE_LITTLEFS_H
+#define _NATIVE_LITTLEFS_H
+
+#include <FS.h>
+
+// LittleFS в памяти. Содержимое заполняется тестом через hal_fsWriteFile()
+// и переживает end()/begin(); format() его стирает.
+
+namespace fs {
+
+class LittleFSFS : public FS {
+ public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  void end();
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif
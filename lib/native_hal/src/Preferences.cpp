@@ -0,0 +1,92 @@
+#include <Preferences.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ===== Глобальные переменные =====
+
+typedef std::map<std::string, std::vector<uint8_t>> PrefsNamespace;
+
+static std::mutex nvsMutex;
+static std::map<std::string, PrefsNamespace> nvs;
+
+// ===== Публичные функции =====
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+  (void)partitionLabel;
+  if (started_ || name == NULL) return false;
+
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  if (readOnly && nvs.find(name) == nvs.end()) return false;
+  if (!readOnly) nvs[name];
+
+  name_ = name;
+  readOnly_ = readOnly;
+  started_ = true;
+  return true;
+}
+
+void Preferences::end() {
+  started_ = false;
+}
+
+bool Preferences::clear() {
+  if (!started_ || readOnly_) return false;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  nvs[name_.c_str()].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!started_ || readOnly_ || key == NULL) return false;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  return nvs[name_.c_str()].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!started_ || key == NULL) return false;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const PrefsNamespace& space = nvs[name_.c_str()];
+  return space.find(key) != space.end();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  if (!started_ || readOnly_ || key == NULL || value == NULL || length == 0) return 0;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const uint8_t* bytes = (const uint8_t*)value;
+  nvs[name_.c_str()][key].assign(bytes, bytes + length);
+  return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!started_ || key == NULL) return 0;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const PrefsNamespace& space = nvs[name_.c_str()];
+  PrefsNamespace::const_iterator it = space.find(key);
+  return it == space.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+  if (!started_ || key == NULL || buffer == NULL) return 0;
+  std::lock_guard<std::mutex> lock(nvsMutex);
+  const PrefsNamespace& space = nvs[name_.c_str()];
+  PrefsNamespace::const_iterator it = space.find(key);
+  // Как у библиотеки: буфер меньше значения — ничего не читается
+  if (it == space.end() || it->second.size() > maxLength) return 0;
+  memcpy(buffer, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+// Как у библиотеки: bool хранится одним байтом
+size_t Preferences::putBool(const char* key, bool value) {
+  uint8_t byte = value ? 1 : 0;
+  return putBytes(key, &byte, sizeof(byte));
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+  uint8_t byte;
+  if (getBytesLength(key) != sizeof(byte) || getBytes(key, &byte, sizeof(byte)) != sizeof(byte)) return defaultValue;
+  return byte != 0;
+}
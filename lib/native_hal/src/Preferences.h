@@ -0,0 +1,37 @@
+#ifndef _NATIVE_PREFERENCES_H
+#define _NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+
+// Preferences Arduino-ESP32 поверх NVS: пространства имён и ключи хранятся
+// в памяти процесса (между запусками не сохраняются). Семантика как у
+// библиотеки: begin() только для чтения не создаёт пространство и возвращает
+// false, если его нет; запись в режиме только для чтения не выполняется.
+
+// ===== Классы =====
+
+class Preferences {
+ public:
+  ~Preferences() { end(); }
+
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = NULL);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putBytes(const char* key, const void* value, size_t length);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+  size_t putBool(const char* key, bool value);
+  bool getBool(const char* key, bool defaultValue = false);
+
+ private:
+  String name_;
+  bool started_ = false;
+  bool readOnly_ = false;
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include <Update.h>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "esp_ota_ops.h"
+
+// ===== Константы =====
+
+#define APP_IMAGE_MAGIC 0xE9
+#define FLASH_SECTOR_SIZE 4096
+
+// ===== Глобальные переменные =====
+
+UpdateClass Update;
+
+static const esp_partition_t partitions[] = {
+  {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, 0x640000, FLASH_SECTOR_SIZE, "app0", false},
+  {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x650000, 0x640000, FLASH_SECTOR_SIZE, "app1", false},
+  {ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0xc90000, 0x360000, FLASH_SECTOR_SIZE, "spiffs", false},
+};
+
+#define PARTITION_COUNT (sizeof(partitions) / sizeof(partitions[0]))
+
+static std::mutex flashMutex;
+static std::map<const esp_partition_t*, std::vector<uint8_t>> flash;   // записанная часть раздела
+static const esp_partition_t* bootPartition = &partitions[0];
+
+// ===== Вспомогательные функции =====
+
+// Образ «работающей» прошивки в app0 из файла HAL_APP_IMAGE — база для дельта-OTA
+static void loadRunningImage(std::vector<uint8_t>& content) {
+  static bool loaded = false;
+  if (loaded) return;
+  loaded = true;
+  const char* path = getenv("HAL_APP_IMAGE");
+  if (path == NULL) return;
+  std::ifstream file(path, std::ios::binary);
+  content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool inRange(const esp_partition_t* partition, size_t offset, size_t size) {
+  return partition != NULL && offset <= partition->size && size <= partition->size - offset;
+}
+
+// MD5 (RFC 1321) — для md5String()/setMD5(), как у UpdateClass
+static std::string md5Hex(const uint8_t* data, size_t length) {
+  static const uint32_t k[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+  static const uint8_t r[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+  std::vector<uint8_t> message(data, data + length);
+  message.push_back(0x80);
+  while (message.size() % 64 != 56) message.push_back(0);
+  uint64_t bits = (uint64_t)length * 8;
+  for (int i = 0; i < 8; i++) message.push_back((uint8_t)(bits >> (8 * i)));
+
+  uint32_t h[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+  for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &message[chunk + 4 * i];
+      w[i] = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+    for (int i = 0; i < 64; i++) {
+      uint32_t f;
+      int g;
+      if (i < 16) { f = (b & c) | (~b & d); g = i; }
+      else if (i < 32) { f = (d & b) | (~d & c); g = (5 * i + 1) % 16; }
+      else if (i < 48) { f = b ^ c ^ d; g = (3 * i + 5) % 16; }
+      else { f = c ^ (b | ~d); g = (7 * i) % 16; }
+      uint32_t rotated = a + f + k[i] + w[g];
+      a = d;
+      d = c;
+      c = b;
+      b = b + ((rotated << r[i]) | (rotated >> (32 - r[i])));
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+  }
+
+  char hex[33];
+  for (int i = 0; i < 16; i++) snprintf(hex + 2 * i, 3, "%02x", (h[i / 4] >> (8 * (i % 4))) & 0xFF);
+  return std::string(hex, 32);
+}
+
+// ===== Разделы =====
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+  for (size_t i = 0; i < PARTITION_COUNT; i++) {
+    const esp_partition_t* p = &partitions[i];
+    if (type != ESP_PARTITION_TYPE_ANY && p->type != type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p->subtype != subtype) continue;
+    if (label != NULL && strcmp(p->label, label) != 0) continue;
+    return p;
+  }
+  return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+  if (dst == NULL || !inRange(partition, offset, size)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(flashMutex);
+  std::vector<uint8_t>& content = flash[partition];
+  if (partition == &partitions[0]) loadRunningImage(content);
+  for (size_t i = 0; i < size; i++) {
+    ((uint8_t*)dst)[i] = offset + i < content.size() ? content[offset + i] : 0xFF;
+  }
+  return ESP_OK;
+}
+
+// Как у NOR flash: запись только сбрасывает биты, поднимает их стирание
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+  if (src == NULL || !inRange(partition, offset, size)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(flashMutex);
+  std::vector<uint8_t>& content = flash[partition];
+  if (content.size() < offset + size) content.resize(offset + size, 0xFF);
+  for (size_t i = 0; i < size; i++) content[offset + i] &= ((const uint8_t*)src)[i];
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  if (!inRange(partition, offset, size) || offset % FLASH_SECTOR_SIZE || size % FLASH_SECTOR_SIZE) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(flashMutex);
+  std::vector<uint8_t>& content = flash[partition];
+  for (size_t i = offset; i < offset + size && i < content.size(); i++) content[i] = 0xFF;
+  return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_running_partition() {
+  return &partitions[0];
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+  std::lock_guard<std::mutex> lock(flashMutex);
+  return bootPartition;
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* startFrom) {
+  const esp_partition_t* from = startFrom != NULL ? startFrom : esp_ota_get_running_partition();
+  return from == &partitions[0] ? &partitions[1] : &partitions[0];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+  if (partition == NULL || partition->type != ESP_PARTITION_TYPE_APP) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(flashMutex);
+  bootPartition = partition;
+  return ESP_OK;
+}
+
+// ===== UpdateClass =====
+
+void UpdateClass::reset() {
+  partition_ = NULL;
+  size_ = 0;
+  progress_ = 0;
+  expectedMd5_ = "";
+}
+
+bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, const char* label) {
+  (void)ledPin;
+  (void)ledOn;
+  if (size_ > 0) return false;
+  error_ = UPDATE_ERROR_OK;
+  md5_ = "";
+  if (size == 0) {
+    error_ = UPDATE_ERROR_SIZE;
+    return false;
+  }
+
+  if (command == U_FLASH) {
+    partition_ = esp_ota_get_next_update_partition(NULL);
+  } else if (command == U_SPIFFS) {
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  } else {
+    error_ = UPDATE_ERROR_BAD_ARGUMENT;
+    return false;
+  }
+  if (partition_ == NULL) {
+    error_ = UPDATE_ERROR_NO_PARTITION;
+    return false;
+  }
+
+  if (size == UPDATE_SIZE_UNKNOWN) size = partition_->size;
+  if (size > partition_->size) {
+    error_ = UPDATE_ERROR_SIZE;
+    partition_ = NULL;
+    return false;
+  }
+
+  command_ = command;
+  size_ = size;
+  progress_ = 0;
+  std::lock_guard<std::mutex> lock(flashMutex);
+  flash[partition_].clear();
+  // Раздел целиком сразу: запись образа не должна выглядеть как рост кучи
+  flash[partition_].reserve(partition_->size);
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t length) {
+  if (hasError() || !isRunning()) return 0;
+  if (length > remaining()) {
+    error_ = UPDATE_ERROR_SPACE;
+    return 0;
+  }
+  if (progress_ == 0 && command_ == U_FLASH && length > 0 && data[0] != APP_IMAGE_MAGIC) {
+    error_ = UPDATE_ERROR_MAGIC_BYTE;
+    return 0;
+  }
+  if (esp_partition_write(partition_, progress_, data, length) != ESP_OK) {
+    error_ = UPDATE_ERROR_WRITE;
+    return 0;
+  }
+  progress_ += length;
+  return length;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+  if (hasError() || size_ == 0) return false;
+  if (!isFinished() && !evenIfRemaining) {
+    error_ = UPDATE_ERROR_ABORT;
+    reset();
+    return false;
+  }
+
+  std::vector<uint8_t> image(progress_);
+  esp_partition_read(partition_, 0, image.data(), image.size());
+  md5_ = md5Hex(image.data(), image.size()).c_str();
+  if (expectedMd5_.length() > 0 && !md5_.equalsIgnoreCase(expectedMd5_)) {
+    error_ = UPDATE_ERROR_MD5;
+    reset();
+    return false;
+  }
+
+  if (command_ == U_FLASH && esp_ota_set_boot_partition(partition_) != ESP_OK) {
+    error_ = UPDATE_ERROR_ACTIVATE;
+    reset();
+    return false;
+  }
+  reset();
+  return true;
+}
+
+void UpdateClass::abort() {
+  reset();
+  error_ = UPDATE_ERROR_ABORT;
+}
+
+bool UpdateClass::setMD5(const char* expectedMD5) {
+  if (expectedMD5 == NULL || strlen(expectedMD5) != 32) return false;
+  expectedMd5_ = expectedMD5;
+  return true;
+}
+
+const char* UpdateClass::errorString() {
+  static const char* const messages[] = {
+    "No Error", "Flash Write Failed", "Flash Erase Failed", "Flash Read Failed", "Not Enough Space",
+    "Bad Size Given", "Stream Read Timeout", "MD5 Check Failed", "Wrong Magic Byte",
+    "Could Not Activate The Firmware", "Partition Could Not be Found", "Bad Argument", "Aborted"};
+  return error_ < sizeof(messages) / sizeof(messages[0]) ? messages[error_] : "UNKNOWN";
+}
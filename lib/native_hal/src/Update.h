@@ -0,0 +1,70 @@
+#ifndef _NATIVE_UPDATE_H
+#define _NATIVE_UPDATE_H
+
+#include <Arduino.h>
+
+#include "esp_partition.h"
+
+// UpdateClass Arduino-ESP32: образ пишется в следующий OTA раздел (U_FLASH)
+// или в раздел файловой системы (U_SPIFFS) в памяти (esp_partition.h).
+// Проверки образа (магическое число, MD5 при setMD5) — как у библиотеки.
+
+// ===== Константы =====
+
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+#define UPDATE_ERROR_OK 0
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_ERASE 2
+#define UPDATE_ERROR_READ 3
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_SIZE 5
+#define UPDATE_ERROR_STREAM 6
+#define UPDATE_ERROR_MD5 7
+#define UPDATE_ERROR_MAGIC_BYTE 8
+#define UPDATE_ERROR_ACTIVATE 9
+#define UPDATE_ERROR_NO_PARTITION 10
+#define UPDATE_ERROR_BAD_ARGUMENT 11
+#define UPDATE_ERROR_ABORT 12
+
+// ===== Классы =====
+
+class UpdateClass {
+ public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH, int ledPin = -1,
+             uint8_t ledOn = LOW, const char* label = NULL);
+  size_t write(uint8_t* data, size_t length);
+  bool end(bool evenIfRemaining = false);
+  void abort();
+
+  bool setMD5(const char* expectedMD5);
+  String md5String() { return md5_; }
+
+  bool isRunning() { return size_ > 0; }
+  bool isFinished() { return progress_ == size_; }
+  bool hasError() { return error_ != UPDATE_ERROR_OK; }
+  uint8_t getError() { return error_; }
+  void clearError() { error_ = UPDATE_ERROR_OK; }
+  const char* errorString();
+  size_t size() { return size_; }
+  size_t progress() { return progress_; }
+  size_t remaining() { return size_ - progress_; }
+
+ private:
+  void reset();
+
+  const esp_partition_t* partition_ = NULL;
+  int command_ = U_FLASH;
+  size_t size_ = 0;
+  size_t progress_ = 0;
+  uint8_t error_ = UPDATE_ERROR_OK;
+  String expectedMd5_;
+  String md5_;
+};
+
+extern UpdateClass Update;
+
+#endif
@@ -0,0 +1,150 @@
+#include <WebSocketsServer.h>
+
+#include "native_hal.h"
+
+// ===== Глобальные переменные =====
+
+// Сервер, которому адресованы hal_ws*() (на плате он один — wsctl)
+static WebSocketsServer* activeServer = NULL;
+
+// ===== WebSocketsServer =====
+
+WebSocketsServer::WebSocketsServer(uint16_t port, const String& origin, const String& protocol)
+    : port_(port), running_(false), callback_(NULL), connected_{} {
+  (void)origin;
+  (void)protocol;
+}
+
+WebSocketsServer::~WebSocketsServer() {
+  if (activeServer == this) activeServer = NULL;
+}
+
+void WebSocketsServer::begin() {
+  running_ = true;
+  activeServer = this;
+}
+
+void WebSocketsServer::close() {
+  running_ = false;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) disconnect(num);
+}
+
+void WebSocketsServer::loop() {
+  for (;;) {
+    Event event;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (events_.empty()) return;
+      event = events_.front();
+      events_.pop_front();
+
+      // Состояние клиента меняется до вызова обработчика, как у библиотеки
+      if (event.type == WStype_CONNECTED) connected_[event.num] = true;
+      if (event.type == WStype_DISCONNECTED) {
+        connected_[event.num] = false;
+        outbox_[event.num].clear();
+      }
+    }
+    if (callback_ != NULL) {
+      callback_(event.num, event.type, (uint8_t*)&event.payload[0], event.payload.size());
+    }
+  }
+}
+
+bool WebSocketsServer::enqueue(uint8_t num, bool binary, const uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!connected_[num]) return false;
+  std::deque<Message>& outbox = outbox_[num];
+  if (outbox.size() >= NATIVE_WS_QUEUE_MAX) outbox.pop_front();
+  outbox.push_back({binary, std::string((const char*)payload, length)});
+  return true;
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+  if (length == 0) length = strlen(payload);
+  return enqueue(num, false, (const uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t* payload, size_t length) {
+  return enqueue(num, true, payload, length);
+}
+
+bool WebSocketsServer::broadcastTXT(const char* payload, size_t length) {
+  if (length == 0) length = strlen(payload);
+  bool sent = true;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    if (clientIsConnected(num)) sent &= enqueue(num, false, (const uint8_t*)payload, length);
+  }
+  return sent;
+}
+
+bool WebSocketsServer::broadcastBIN(const uint8_t* payload, size_t length) {
+  bool sent = true;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    if (clientIsConnected(num)) sent &= enqueue(num, true, payload, length);
+  }
+  return sent;
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  if (clientIsConnected(num)) postEvent(num, WStype_DISCONNECTED, NULL, 0);
+}
+
+uint8_t WebSocketsServer::connectedClients() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint8_t count = 0;
+  for (bool connected : connected_) count += connected;
+  return count;
+}
+
+bool WebSocketsServer::clientIsConnected(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connected_[num];
+}
+
+IPAddress WebSocketsServer::remoteIP(uint8_t num) {
+  return clientIsConnected(num) ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+void WebSocketsServer::postEvent(uint8_t num, WStype_t type, const uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back({num, type, payload != NULL ? std::string((const char*)payload, length) : std::string()});
+}
+
+bool WebSocketsServer::takeMessage(uint8_t num, Message* message) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (outbox_[num].empty()) return false;
+  *message = outbox_[num].front();
+  outbox_[num].pop_front();
+  return true;
+}
+
+// ===== Доступ тестов =====
+
+void hal_wsConnect(uint8_t num) {
+  if (activeServer != NULL) activeServer->postEvent(num, WStype_CONNECTED, (const uint8_t*)"/", 1);
+}
+
+void hal_wsDisconnect(uint8_t num) {
+  if (activeServer != NULL) activeServer->postEvent(num, WStype_DISCONNECTED, NULL, 0);
+}
+
+void hal_wsSendBinary(uint8_t num, const uint8_t* data, size_t length) {
+  if (activeServer != NULL) activeServer->postEvent(num, WStype_BIN, data, length);
+}
+
+void hal_wsSendText(uint8_t num, const char* text) {
+  if (activeServer != NULL) activeServer->postEvent(num, WStype_TEXT, (const uint8_t*)text, strlen(text));
+}
+
+bool hal_wsReceive(uint8_t num, std::string* message, bool* binary) {
+  WebSocketsServer::Message next;
+  if (activeServer == NULL || !activeServer->takeMessage(num, &next)) return false;
+  if (message != NULL) *message = next.payload;
+  if (binary != NULL) *binary = next.binary;
+  return true;
+}
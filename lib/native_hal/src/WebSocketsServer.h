@@ -0,0 +1,86 @@
+#ifndef _NATIVE_WEBSOCKETSSERVER_H
+#define _NATIVE_WEBSOCKETSSERVER_H
+
+#include <Arduino.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+// WebSocketsServer (links2004) без сети: клиенты и их кадры подаются через
+// hal_ws*() (native_hal.h), события доставляются в onEvent из loop() — в той же
+// задаче, что и на плате. Отправленные сервером сообщения копятся в очереди
+// клиента до hal_wsReceive().
+
+// ===== Константы =====
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#define NATIVE_WS_QUEUE_MAX 256      // сообщений в очереди клиента, старые отбрасываются
+
+// ===== Типы =====
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG
+} WStype_t;
+
+// ===== Классы =====
+
+class WebSocketsServer {
+ public:
+  typedef void (*WebSocketServerEvent)(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
+
+  explicit WebSocketsServer(uint16_t port, const String& origin = "", const String& protocol = "arduino");
+  ~WebSocketsServer();
+
+  void begin();
+  void close();
+  void loop();
+  void onEvent(WebSocketServerEvent callback) { callback_ = callback; }
+
+  bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, const String& payload) { return sendTXT(num, payload.c_str(), payload.length()); }
+  bool sendBIN(uint8_t num, const uint8_t* payload, size_t length);
+  bool broadcastTXT(const char* payload, size_t length = 0);
+  bool broadcastBIN(const uint8_t* payload, size_t length);
+
+  void disconnect(uint8_t num);
+  uint8_t connectedClients();
+  bool clientIsConnected(uint8_t num);
+  IPAddress remoteIP(uint8_t num);
+
+  // Доступ HAL (native_hal.h)
+  struct Event {
+    uint8_t num;
+    WStype_t type;
+    std::string payload;
+  };
+  struct Message {
+    bool binary;
+    std::string payload;
+  };
+  void postEvent(uint8_t num, WStype_t type, const uint8_t* payload, size_t length);
+  bool takeMessage(uint8_t num, Message* message);
+
+ private:
+  bool enqueue(uint8_t num, bool binary, const uint8_t* payload, size_t length);
+
+  uint16_t port_;
+  bool running_;
+  WebSocketServerEvent callback_;
+  bool connected_[WEBSOCKETS_SERVER_CLIENT_MAX];
+  std::mutex mutex_;
+  std::deque<Event> events_;
+  std::deque<Message> outbox_[WEBSOCKETS_SERVER_CLIENT_MAX];
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include <WiFi.h>
+
+// ===== Константы =====
+
+#define NATIVE_WIFI_RSSI -50
+
+// ===== Глобальные переменные =====
+
+WiFiClass WiFi;
+
+// ===== WiFiClass =====
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  (void)passphrase;
+  ssid_ = ssid;
+  if (mode_ == WIFI_OFF) mode_ = WIFI_STA;
+  status_ = WL_CONNECTED;
+  return status_;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+  status_ = WL_DISCONNECTED;
+  if (wifiOff) mode_ = WIFI_OFF;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  return status_;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  mode_ = mode;
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+  return mode_;
+}
+
+bool WiFiClass::setSleep(bool enabled) {
+  (void)enabled;
+  return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase) {
+  (void)ssid;
+  (void)passphrase;
+  mode_ = mode_ == WIFI_STA ? WIFI_AP_STA : WIFI_AP;
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return status_ == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return (mode_ == WIFI_AP || mode_ == WIFI_AP_STA) ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+String WiFiClass::macAddress() {
+  return String("02:00:00:00:00:01");
+}
+
+String WiFiClass::SSID() {
+  return ssid_;
+}
+
+int8_t WiFiClass::RSSI() {
+  return status_ == WL_CONNECTED ? NATIVE_WIFI_RSSI : 0;
+}
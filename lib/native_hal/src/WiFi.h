@@ -0,0 +1,47 @@
+#ifndef _NATIVE_WIFI_H
+#define _NATIVE_WIFI_H
+
+#include <Arduino.h>
+
+// WiFi хостовой сборки: подключение к точке доступа происходит сразу,
+// сеть — loopback процесса.
+
+// ===== Константы =====
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+// ===== Классы =====
+
+class WiFiClass {
+ public:
+  wl_status_t begin(const char* ssid, const char* passphrase = NULL);
+  bool disconnect(bool wifiOff = false);
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode();
+  bool setSleep(bool enabled);
+  bool softAP(const char* ssid, const char* passphrase = NULL);
+  IPAddress localIP();
+  IPAddress softAPIP();
+  String macAddress();
+  String SSID();
+  int8_t RSSI();
+
+ private:
+  wl_status_t status_ = WL_DISCONNECTED;
+  wifi_mode_t mode_ = WIFI_OFF;
+  String ssid_;
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,192 @@
+#include <Wire.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "hal_i2c.h"
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define I2C_DEFAULT_CLOCK 100000
+#define TCA9548A_BUS 1
+
+// Коды endTransmission() как у Arduino-ESP32
+#define I2C_OK 0
+#define I2C_ERROR_LENGTH 1
+#define I2C_ERROR_ADDRESS_NACK 2
+#define I2C_ERROR_DATA_NACK 3
+#define I2C_ERROR_OTHER 4
+
+// ===== Структуры данных =====
+
+struct Attachment {
+  uint8_t address;
+  int8_t muxChannel;
+  HalI2cDevice* device;
+};
+
+struct Bus {
+  std::recursive_mutex lock;
+  std::vector<Attachment> devices;
+  uint8_t muxSelected;          // маска каналов TCA9548A на этой шине
+  std::atomic<uint32_t> transactions;
+};
+
+// TCA9548A: один регистр — маска включённых каналов
+class Tca9548a : public HalI2cDevice {
+ public:
+  explicit Tca9548a(Bus* bus) : bus_(bus) {}
+
+  bool write(const uint8_t* data, size_t length) override {
+    if (length > 0) bus_->muxSelected = data[length - 1];
+    return true;
+  }
+
+  size_t read(uint8_t* data, size_t length) override {
+    for (size_t i = 0; i < length; i++) data[i] = bus_->muxSelected;
+    return length;
+  }
+
+ private:
+  Bus* bus_;
+};
+
+// ===== Глобальные переменные =====
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+// ===== Вспомогательные функции =====
+
+// Шины создаются при первом обращении: устройства регистрируются из статических
+// конструкторов других единиц трансляции, порядок которых не определён
+static Bus* buses() {
+  static Bus* instance = [] {
+    Bus* created = new Bus[HAL_I2C_BUSES];
+    for (int i = 0; i < HAL_I2C_BUSES; i++) {
+      created[i].muxSelected = 0;
+      created[i].transactions = 0;
+    }
+    created[TCA9548A_BUS].devices.push_back({HAL_TCA9548A_ADDR, HAL_I2C_DIRECT, new Tca9548a(&created[TCA9548A_BUS])});
+    return created;
+  }();
+  return instance;
+}
+
+// ===== Шина =====
+
+void hal_i2cAttach(uint8_t bus, uint8_t address, int8_t muxChannel, HalI2cDevice* device) {
+  if (bus >= HAL_I2C_BUSES || device == NULL) return;
+  Bus& b = buses()[bus];
+  std::lock_guard<std::recursive_mutex> lock(b.lock);
+  b.devices.push_back({address, muxChannel, device});
+}
+
+HalI2cDevice* hal_i2cFind(uint8_t bus, uint8_t address) {
+  if (bus >= HAL_I2C_BUSES) return NULL;
+  Bus& b = buses()[bus];
+  std::lock_guard<std::recursive_mutex> lock(b.lock);
+  for (auto it = b.devices.rbegin(); it != b.devices.rend(); ++it) {
+    const Attachment& a = *it;
+    if (a.address != address) continue;
+    if (a.muxChannel == HAL_I2C_DIRECT || (b.muxSelected & (1 << a.muxChannel))) return a.device;
+  }
+  return NULL;
+}
+
+uint32_t hal_i2cGetTransactions(uint8_t bus) {
+  return bus < HAL_I2C_BUSES ? buses()[bus].transactions.load() : 0;
+}
+
+uint8_t hal_tca9548aGetSelected() {
+  Bus& b = buses()[TCA9548A_BUS];
+  std::lock_guard<std::recursive_mutex> lock(b.lock);
+  return b.muxSelected;
+}
+
+// ===== TwoWire =====
+
+TwoWire::TwoWire(uint8_t bus)
+    : bus_(bus), clock_(I2C_DEFAULT_CLOCK), txAddress_(0), txLength_(0), txActive_(false),
+      rxLength_(0), rxIndex_(0) {}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency != 0) clock_ = frequency;
+  return true;
+}
+
+bool TwoWire::end() {
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  clock_ = frequency;
+  return true;
+}
+
+uint32_t TwoWire::getClock() {
+  return clock_;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  txAddress_ = address;
+  txLength_ = 0;
+  txActive_ = true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  if (!txActive_) return I2C_ERROR_OTHER;
+  txActive_ = false;
+
+  Bus& b = buses()[bus_];
+  std::lock_guard<std::recursive_mutex> lock(b.lock);
+  b.transactions++;
+  HalI2cDevice* device = hal_i2cFind(bus_, txAddress_);
+  if (device == NULL) return I2C_ERROR_ADDRESS_NACK;
+  if (txLength_ > 0 && !device->write(txBuffer_, txLength_)) return I2C_ERROR_DATA_NACK;
+  return I2C_OK;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t size, bool sendStop) {
+  (void)sendStop;
+  rxLength_ = 0;
+  rxIndex_ = 0;
+  if (size > I2C_BUFFER_LENGTH) size = I2C_BUFFER_LENGTH;
+
+  Bus& b = buses()[bus_];
+  std::lock_guard<std::recursive_mutex> lock(b.lock);
+  b.transactions++;
+  HalI2cDevice* device = hal_i2cFind(bus_, address);
+  if (device == NULL) return 0;
+  rxLength_ = device->read(rxBuffer_, size);
+  return rxLength_;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!txActive_ || txLength_ >= I2C_BUFFER_LENGTH) return 0;
+  txBuffer_[txLength_++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t size) {
+  size_t written = 0;
+  while (written < size && write(data[written]) == 1) written++;
+  return written;
+}
+
+int TwoWire::available() {
+  return (int)(rxLength_ - rxIndex_);
+}
+
+int TwoWire::read() {
+  return rxIndex_ < rxLength_ ? rxBuffer_[rxIndex_++] : -1;
+}
+
+int TwoWire::peek() {
+  return rxIndex_ < rxLength_ ? rxBuffer_[rxIndex_] : -1;
+}
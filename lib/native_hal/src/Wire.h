@@ -0,0 +1,54 @@
+#ifndef _NATIVE_WIRE_H
+#define _NATIVE_WIRE_H
+
+#include <Arduino.h>
+
+// TwoWire поверх фейковой шины (hal_i2c.h). Wire — шина 0 (PCA9685),
+// Wire1 — шина 1 (TCA9548A с VL53L0X на каналах 0-7).
+
+// ===== Константы =====
+
+#define I2C_BUFFER_LENGTH 128
+
+// ===== Классы =====
+
+class TwoWire : public Stream {
+ public:
+  explicit TwoWire(uint8_t bus);
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end();
+  bool setClock(uint32_t frequency);
+  uint32_t getClock();
+
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool sendStop = true);
+  size_t requestFrom(uint8_t address, size_t size, bool sendStop = true);
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* data, size_t size) override;
+  using Print::write;
+  size_t write(unsigned long n) { return write((uint8_t)n); }
+  size_t write(long n) { return write((uint8_t)n); }
+  size_t write(unsigned int n) { return write((uint8_t)n); }
+  size_t write(int n) { return write((uint8_t)n); }
+  int available() override;
+  int read() override;
+  int peek() override;
+
+ private:
+  uint8_t bus_;
+  uint32_t clock_;
+  uint8_t txAddress_;
+  uint8_t txBuffer_[I2C_BUFFER_LENGTH];
+  size_t txLength_;
+  bool txActive_;
+  uint8_t rxBuffer_[I2C_BUFFER_LENGTH];
+  size_t rxLength_;
+  size_t rxIndex_;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
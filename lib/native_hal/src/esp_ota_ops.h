@@ -0,0 +1,13 @@
+#ifndef _NATIVE_ESP_OTA_OPS_H
+#define _NATIVE_ESP_OTA_OPS_H
+
+#include "esp_partition.h"
+
+// Прошивка «запущена» из app0, обновление пишется в app1
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_boot_partition();
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* startFrom);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef _NATIVE_ESP_ROM_CRC_H
+#define _NATIVE_ESP_ROM_CRC_H
+
+#include <stdint.h>
+#include <zlib.h>
+
+// CRC32 из ROM (полином IEEE, как в gzip/zlib); crc = 0 — начало, затем предыдущий результат
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const* buf, uint32_t len) {
+  return (uint32_t)crc32(crc, buf, len);
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef _NATIVE_ESP_TIMER_H
+#define _NATIVE_ESP_TIMER_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Монотонное время процесса в микросекундах (steady_clock)
+int64_t esp_timer_get_time();
+
+#endif
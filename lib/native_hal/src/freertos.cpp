@@ -0,0 +1,183 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <pthread.h>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+#include <thread>
+
+#include "esp_timer.h"
+
+// ===== Структуры данных =====
+
+struct HalTask {
+  std::string name = "loopTask";   // главный поток (setup/loop) задачей не создаётся
+  TaskFunction_t code = NULL;
+  void* parameters = NULL;
+  std::mutex notifyMutex;
+  std::condition_variable notifyCondition;
+  uint32_t notifyValue = 0;
+  bool notifyPending = false;
+};
+
+// ===== Глобальные переменные =====
+
+static thread_local HalTask* currentTask = NULL;
+static HalTask mainTask;
+
+// ===== Вспомогательные функции =====
+
+static HalTask* selfTask() {
+  if (currentTask == NULL) {
+    // Поток без задачи — главный (setup/loop) или поток таймера
+    currentTask = &mainTask;
+  }
+  return currentTask;
+}
+
+static void taskEntry(HalTask* task) {
+  currentTask = task;
+  task->code(task->parameters);
+  // Задача FreeRTOS не должна возвращаться; на хосте просто завершаем поток
+}
+
+// Ожидание уведомления до таймаута; вызывается под notifyMutex
+static bool waitNotification(HalTask* task, std::unique_lock<std::mutex>& lock, TickType_t ticksToWait) {
+  if (task->notifyPending) return true;
+  if (ticksToWait == 0) return false;
+  if (ticksToWait == portMAX_DELAY) {
+    task->notifyCondition.wait(lock, [task] { return task->notifyPending; });
+    return true;
+  }
+  auto timeout = std::chrono::milliseconds((uint64_t)ticksToWait * portTICK_PERIOD_MS);
+  return task->notifyCondition.wait_for(lock, timeout, [task] { return task->notifyPending; });
+}
+
+// ===== Задачи =====
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId) {
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+  HalTask* task = new HalTask();
+  task->name = name != NULL ? name : "";
+  task->code = code;
+  task->parameters = parameters;
+  if (createdTask != NULL) *createdTask = task;
+
+  std::thread thread(taskEntry, task);
+  pthread_setname_np(thread.native_handle(), task->name.substr(0, 15).c_str());
+  thread.detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                       void* parameters, UBaseType_t priority, TaskHandle_t* createdTask) {
+  return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task != NULL && task != selfTask()) return;   // удаление чужой задачи не поддерживается
+  if (selfTask() == &mainTask) {
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+  pthread_exit(NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return selfTask();
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+  return (task != NULL ? task : selfTask())->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  (void)task;
+  return 4096;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds((uint64_t)ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+  *previousWakeTime += increment;
+  int32_t remaining = (int32_t)(*previousWakeTime - xTaskGetTickCount());
+  if (remaining > 0) vTaskDelay(remaining);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+BaseType_t xPortGetCoreID() {
+  return 0;
+}
+
+BaseType_t xPortInIsrContext() {
+  return pdFALSE;
+}
+
+// ===== Уведомления =====
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+  if (task == NULL) return pdFAIL;
+  {
+    std::lock_guard<std::mutex> lock(task->notifyMutex);
+    switch (action) {
+      case eSetBits: task->notifyValue |= value; break;
+      case eIncrement: task->notifyValue++; break;
+      case eSetValueWithOverwrite: task->notifyValue = value; break;
+      case eSetValueWithoutOverwrite:
+        if (task->notifyPending) return pdFAIL;
+        task->notifyValue = value;
+        break;
+      case eNoAction: break;
+    }
+    task->notifyPending = true;
+  }
+  task->notifyCondition.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != NULL) *higherPriorityTaskWoken = pdFALSE;
+  return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value,
+                           TickType_t ticksToWait) {
+  HalTask* task = selfTask();
+  std::unique_lock<std::mutex> lock(task->notifyMutex);
+  if (!task->notifyPending) task->notifyValue &= ~clearOnEntry;
+  bool received = waitNotification(task, lock, ticksToWait);
+  if (value != NULL) *value = task->notifyValue;
+  if (!received) return pdFALSE;
+  task->notifyValue &= ~clearOnExit;
+  task->notifyPending = false;
+  return pdTRUE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+  xTaskNotifyFromISR(task, 0, eIncrement, higherPriorityTaskWoken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  HalTask* task = selfTask();
+  std::unique_lock<std::mutex> lock(task->notifyMutex);
+  if (task->notifyValue == 0) task->notifyPending = false;
+  waitNotification(task, lock, ticksToWait);
+  uint32_t count = task->notifyValue;
+  if (count > 0) task->notifyValue = clearCountOnExit ? 0 : count - 1;
+  task->notifyPending = task->notifyValue > 0;
+  return count;
+}
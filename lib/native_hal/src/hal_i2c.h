@@ -0,0 +1,35 @@
+#ifndef _NATIVE_HAL_I2C_H
+#define _NATIVE_HAL_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Шина I2C хостовой сборки: TwoWire передаёт транзакции фейковым устройствам.
+// Устройство подключается к шине напрямую или к каналу мультиплексора TCA9548A
+// и видно только при выбранном канале — как на плате. Внутренний заголовок HAL.
+
+// ===== Константы =====
+
+#define HAL_I2C_BUSES 2
+#define HAL_I2C_DIRECT -1     // устройство подключено к шине без мультиплексора
+
+// ===== Структуры данных =====
+
+// Регистровое устройство: запись — адрес регистра и данные, чтение — с текущего
+// адреса регистра. Вызовы сериализованы мьютексом шины.
+class HalI2cDevice {
+ public:
+  virtual ~HalI2cDevice() {}
+  virtual bool write(const uint8_t* data, size_t length) = 0;   // false — NACK
+  virtual size_t read(uint8_t* data, size_t length) = 0;
+};
+
+// ===== Функции =====
+
+void hal_i2cAttach(uint8_t bus, uint8_t address, int8_t muxChannel, HalI2cDevice* device);
+
+// Устройство, видимое по адресу при текущем выборе мультиплексора, или NULL.
+// Более позднее подключение по тому же адресу и каналу перекрывает прежнее.
+HalI2cDevice* hal_i2cFind(uint8_t bus, uint8_t address);
+
+#endif
@@ -0,0 +1,105 @@
+#include "driver/ledc.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "native_hal.h"
+
+// ===== Константы =====
+
+#define LEDC_SOURCE_CLOCK_HZ 80000000UL   // APB, как у LEDC_AUTO_CLK на ESP32-S3
+
+// ===== Структуры данных =====
+
+struct LedcTimer {
+  uint32_t freqHz;
+  uint32_t resolutionBits;
+};
+
+struct LedcChannel {
+  bool configured;
+  int gpio;
+  ledc_timer_t timer;
+  uint32_t pendingDuty;
+  uint32_t duty;
+};
+
+// ===== Глобальные переменные =====
+
+static std::mutex ledcMutex;
+static LedcTimer timers[LEDC_TIMER_MAX] = {};
+static LedcChannel channels[LEDC_CHANNEL_MAX] = {};
+static std::atomic<uint32_t> updates(0);
+
+// ===== Функции =====
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+  if (config == NULL || config->timer_num >= LEDC_TIMER_MAX || config->freq_hz == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // Как в ESP-IDF: делитель таймера должен уместиться в разрядность
+  if ((uint64_t)config->freq_hz << config->duty_resolution > LEDC_SOURCE_CLOCK_HZ) {
+    return ESP_FAIL;
+  }
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  timers[config->timer_num].freqHz = config->freq_hz;
+  timers[config->timer_num].resolutionBits = config->duty_resolution;
+  return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+  if (config == NULL || config->channel >= LEDC_CHANNEL_MAX || config->timer_sel >= LEDC_TIMER_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  LedcChannel& channel = channels[config->channel];
+  channel.configured = true;
+  channel.gpio = config->gpio_num;
+  channel.timer = config->timer_sel;
+  channel.pendingDuty = config->duty;
+  channel.duty = config->duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty) {
+  (void)mode;
+  if (channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  if (!channels[channel].configured) return ESP_ERR_INVALID_STATE;
+  channels[channel].pendingDuty = duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
+  (void)mode;
+  if (channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  if (!channels[channel].configured) return ESP_ERR_INVALID_STATE;
+  channels[channel].duty = channels[channel].pendingDuty;
+  updates++;
+  return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t channel) {
+  (void)mode;
+  return hal_ledcGetDuty(channel);
+}
+
+uint32_t ledc_get_freq(ledc_mode_t mode, ledc_timer_t timer) {
+  (void)mode;
+  if (timer >= LEDC_TIMER_MAX) return 0;
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  return timers[timer].freqHz;
+}
+
+// ===== Доступ тестов =====
+
+uint32_t hal_ledcGetDuty(uint8_t channel) {
+  if (channel >= LEDC_CHANNEL_MAX) return 0;
+  std::lock_guard<std::mutex> lock(ledcMutex);
+  return channels[channel].duty;
+}
+
+uint32_t hal_ledcGetUpdates() {
+  return updates;
+}
@@ -0,0 +1,26 @@
+#ifndef _NATIVE_MBEDTLS_SHA256_H
+#define _NATIVE_MBEDTLS_SHA256_H
+
+// SHA-256 (FIPS 180-4) с API mbedtls 3.x — для контроля образов OTA на хосте
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===== Типы =====
+
+typedef struct {
+  uint32_t state[8];
+  uint64_t total;          // байт обработано
+  unsigned char buffer[64];
+  int is224;
+} mbedtls_sha256_context;
+
+// ===== Функции =====
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx);
+int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char* output);
+
+#endif
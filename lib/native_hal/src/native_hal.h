@@ -0,0 +1,81 @@
+#ifndef _NATIVE_HAL_H
+#define _NATIVE_HAL_H
+
+#include <Arduino.h>
+
+// Доступ тестов и бенчмарков к состоянию «железа» хостовой сборки (env:native).
+// Модули прошивки этот заголовок не используют — они работают через обычные
+// Arduino/ESP-IDF API, а здесь можно подать вход (GPIO, дальность лидара,
+// HTTP запрос, кадр WebSocket) и прочитать выход (скважность LEDC, импульсы
+// PCA9685, ответ сервера).
+
+// ===== Константы =====
+
+#define HAL_PCA9685_CHANNELS 16
+#define HAL_TCA9548A_ADDR 0x70
+#define HAL_PCA9685_ADDR 0x40
+#define HAL_VL53L0X_ADDR 0x29
+#define HAL_VL53L0X_CHANNELS 8
+
+// ===== Структуры данных =====
+
+struct HalHttpResponse {
+  int code;
+  String contentType;
+  String body;
+  String headers;            // "Имя: значение\r\n" для каждого заголовка
+};
+
+// ===== GPIO =====
+
+// Уровень входа; фронт вызывает обработчик attachInterrupt в потоке вызывающего
+void hal_gpioSetInput(uint8_t pin, int level);
+int hal_gpioGetOutput(uint8_t pin);
+
+// ===== LEDC =====
+
+uint32_t hal_ledcGetDuty(uint8_t channel);        // скважность после ledc_update_duty
+uint32_t hal_ledcGetUpdates();                    // вызовов ledc_update_duty
+
+// ===== I2C =====
+
+uint32_t hal_i2cGetTransactions(uint8_t bus);     // 0 — Wire, 1 — Wire1
+uint8_t hal_tca9548aGetSelected();                // маска выбранных каналов мультиплексора
+
+// ===== PCA9685 (Wire, 0x40) =====
+
+uint16_t hal_pca9685GetOff(uint8_t channel);      // OFF-отсчёт канала (ширина импульса)
+float hal_pca9685GetFrequency();
+uint32_t hal_pca9685GetChannelWrites();
+
+// ===== VL53L0X (Wire1, за мультиплексором 0x70) =====
+
+void hal_vl53l0xSetPresent(uint8_t channel, bool present);   // по умолчанию есть все
+void hal_vl53l0xSetRange(uint8_t channel, uint16_t rangeMm, uint8_t status = 0);
+void hal_vl53l0xSetReadError(uint8_t channel, bool error);  // чтение результата — NACK
+
+// ===== HTTP (ESPAsyncWebServer) =====
+
+// Синхронно выполняет запрос через зарегистрированные маршруты сервера.
+// headers — "Имя: значение" через "\n".
+HalHttpResponse hal_httpRequest(const char* method, const char* url,
+                                const uint8_t* body = NULL, size_t bodyLength = 0,
+                                const char* headers = NULL);
+
+// ===== WebSocket (WebSocketsServer) =====
+
+// События доставляются в onEvent при следующем WebSocketsServer::loop()
+void hal_wsConnect(uint8_t num);
+void hal_wsDisconnect(uint8_t num);
+void hal_wsSendBinary(uint8_t num, const uint8_t* data, size_t length);
+void hal_wsSendText(uint8_t num, const char* text);
+
+// Следующее сообщение сервера клиенту num; false — очередь пуста
+bool hal_wsReceive(uint8_t num, std::string* message, bool* binary);
+
+// ===== LittleFS =====
+
+void hal_fsWriteFile(const char* path, const uint8_t* data, size_t length);
+void hal_fsSetMountable(bool mountable);          // false — LittleFS.begin() вернёт false
+
+#endif
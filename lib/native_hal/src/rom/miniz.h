@@ -0,0 +1,54 @@
+#ifndef _NATIVE_ROM_MINIZ_H
+#define _NATIVE_ROM_MINIZ_H
+
+// tinfl из ROM (miniz): потоковый inflate в кольцевое окно вывода.
+// На хосте — поверх zlib (сборка с -lz). Состояние zlib размещается в арене
+// внутри tinfl_decompressor, поэтому, как и в ROM, освобождать его не нужно.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+// ===== Типы =====
+
+typedef uint8_t mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// Состояние inflate (~7 КБ) и окно zlib (32 КБ)
+#define TINFL_NATIVE_ARENA_SIZE (48 * 1024)
+
+typedef struct {
+  z_stream stream;
+  int started;           // inflateInit2 выполнен (при первом tinfl_decompress)
+  size_t arenaUsed;
+  unsigned char arena[TINFL_NATIVE_ARENA_SIZE];
+} tinfl_decompressor;
+
+// ===== Функции =====
+
+void tinfl_native_init(tinfl_decompressor* r);
+#define tinfl_init(r) tinfl_native_init(r)
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next, size_t* pIn_buf_size,
+                              mz_uint8* pOut_buf_start, mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                              const mz_uint32 decomp_flags);
+
+#endif
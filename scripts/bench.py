@@ -0,0 +1,772 @@
+#!/usr/bin/env python3
+"""
+Хост-бенчмарки для робота (запускаются с ПК в той же сети, что и ESP32).
+
+Использование:
+  python3 scripts/bench.py control --host 192.168.1.50 [--port 8080] [-n 500]
+  python3 scripts/bench.py scan --host 192.168.1.50 [--seconds 10]
+  python3 scripts/bench.py logging --host 192.168.1.50 [-n 300]
+  python3 scripts/bench.py assets --host 192.168.1.50 [--rounds 5]
+  python3 scripts/bench.py load --host 192.168.1.50 [--seconds 10]
+  python3 scripts/bench.py soak --host 192.168.1.50 [--minutes 30] [--csv soak.csv]
+  python3 scripts/bench.py replay --host 127.0.0.1 joystick [--speed 0] [--baseline base.json]
+  python3 scripts/bench.py ota --host 192.168.1.50 .pio/build/esp32-s3-devkitc1-n16r8/firmware.bin [--base old.bin]
+
+Команды моторов отправляются с нулевой скоростью: путь обработки тот же,
+но робот остаётся на месте.
+
+Только стандартная библиотека Python — без дополнительных зависимостей.
+"""
+
+import argparse
+import base64
+import gzip
+import hashlib
+import http.client
+import json
+import math
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+from datetime import datetime
+
+# Формат кадра — src/ctlframe.h
+CTL_FRAME_MAGIC = 0xC7
+CTL_FRAME_TYPE_SETPOINT = 0x01
+CTL_FRAME_TYPE_ACK = 0x81
+CTL_FRAME_TYPE_SCAN = 0x82
+CTL_FLAG_MOTORS = 0x01
+CTL_FRAME_FORMAT = "<BBHBB4h6B"
+
+
+# ===== Статистика =====
+
+def percentile(samples, p):
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def report(name, latencies_ms, elapsed_s):
+    count = len(latencies_ms)
+    rate = count / elapsed_s if elapsed_s > 0 else 0.0
+    print("%-10s n=%-5d cmd/s=%-8.1f p50=%-7.2f p99=%-7.2f max=%-7.2f ms" % (
+        name, count, rate,
+        percentile(latencies_ms, 50), percentile(latencies_ms, 99),
+        max(latencies_ms) if latencies_ms else 0.0))
+
+
+# ===== Минимальный WebSocket клиент (RFC 6455, только бинарные кадры) =====
+
+class WsClient:
+    def __init__(self, host, port, timeout=2.0):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = ("GET / HTTP/1.1\r\nHost: %s:%d\r\nUpgrade: websocket\r\n"
+                   "Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                   "Sec-WebSocket-Version: 13\r\n\r\n") % (host, port, key)
+        self.sock.sendall(request.encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("WebSocket handshake failed")
+            response += chunk
+        if b" 101 " not in response.split(b"\r\n", 1)[0]:
+            raise ConnectionError("WebSocket handshake rejected")
+        self.buffer = response.split(b"\r\n\r\n", 1)[1]
+
+    def send_binary(self, payload):
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(struct.pack("!BB", 0x82, 0x80 | len(payload)) + mask + masked)
+
+    def _read(self, count):
+        while len(self.buffer) < count:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("WebSocket closed")
+            self.buffer += chunk
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def recv_binary(self):
+        _, length = struct.unpack("!BB", self._read(2))
+        length &= 0x7F
+        if length == 126:
+            length = struct.unpack("!H", self._read(2))[0]
+        return self._read(length)
+
+    def close(self):
+        self.sock.close()
+
+
+# ===== Бенчмарк канала управления =====
+
+def bench_json(host, port, count):
+    latencies = []
+    start = time.perf_counter()
+    for i in range(count):
+        speed = 0
+        body = json.dumps({"motorA": speed, "motorB": speed, "motorC": speed, "motorD": speed})
+        t0 = time.perf_counter()
+        conn = http.client.HTTPConnection(host, port, timeout=5)
+        conn.request("POST", "/api/motor", body, {"Content-Type": "application/json"})
+        conn.getresponse().read()
+        conn.close()
+        latencies.append((time.perf_counter() - t0) * 1000.0)
+    return latencies, time.perf_counter() - start
+
+
+def bench_ws(host, port, count):
+    client = WsClient(host, port)
+    latencies = []
+    start = time.perf_counter()
+    for i in range(count):
+        seq = (i + 1) & 0xFFFF
+        speed = 0
+        frame = struct.pack(CTL_FRAME_FORMAT, CTL_FRAME_MAGIC, CTL_FRAME_TYPE_SETPOINT, seq,
+                            CTL_FLAG_MOTORS, 0, speed, speed, speed, speed, 0, 0, 0, 0, 0, 0)
+        t0 = time.perf_counter()
+        client.send_binary(frame)
+        while True:
+            magic, kind, ack_seq = struct.unpack("<BBH", client.recv_binary()[:4])
+            if magic == CTL_FRAME_MAGIC and kind == CTL_FRAME_TYPE_ACK and ack_seq == seq:
+                break
+        latencies.append((time.perf_counter() - t0) * 1000.0)
+    elapsed = time.perf_counter() - start
+    client.close()
+    return latencies, elapsed
+
+
+def cmd_control(args):
+    ws_port = args.ws_port or args.port + 1
+    print("JSON POST /api/motor vs WebSocket binary frames, %d commands each" % args.count)
+    report("json", *bench_json(args.host, args.port, args.count))
+    report("ws", *bench_ws(args.host, ws_port, args.count))
+    # Оставляем робота остановленным
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=5)
+    conn.request("POST", "/api/motor/stop")
+    conn.getresponse().read()
+    conn.close()
+    return 0
+
+
+# ===== Скан дальномером: точек/с для разных конфигураций =====
+
+# (шаг, время успокоения): от быстрого грубого к медленному точному
+SCAN_CONFIGS = [(10, 30), (5, 30), (5, 60), (2, 60), (1, 100)]
+
+
+def post_json(host, port, path, payload):
+    conn = http.client.HTTPConnection(host, port, timeout=5)
+    conn.request("POST", path, json.dumps(payload), {"Content-Type": "application/json"})
+    response = conn.getresponse()
+    body = response.read()
+    conn.close()
+    if response.status != 200:
+        raise RuntimeError("%s -> %d %s" % (path, response.status, body.decode(errors="replace")))
+
+
+def get_json(host, port, path):
+    conn = http.client.HTTPConnection(host, port, timeout=5)
+    conn.request("GET", path)
+    response = conn.getresponse()
+    body = response.read()
+    conn.close()
+    if response.status != 200:
+        raise RuntimeError("%s -> %d %s" % (path, response.status, body.decode(errors="replace")))
+    return json.loads(body)
+
+
+def count_scan_points(client, seconds):
+    points = 0
+    deadline = time.perf_counter() + seconds
+    client.sock.settimeout(0.5)
+    while time.perf_counter() < deadline:
+        try:
+            frame = client.recv_binary()
+        except socket.timeout:
+            continue
+        if len(frame) >= 6 and frame[0] == CTL_FRAME_MAGIC and frame[1] == CTL_FRAME_TYPE_SCAN:
+            points += frame[4]
+    return points
+
+
+def cmd_scan(args):
+    ws_port = args.ws_port or args.port + 1
+    print("%-6s %-10s %-8s %-10s" % ("step", "settle_ms", "pts/s", "sweep_s"))
+    client = WsClient(args.host, ws_port)
+    try:
+        for step, settle in SCAN_CONFIGS:
+            post_json(args.host, args.port, "/api/scan",
+                      {"enabled": True, "start": args.start, "end": args.end, "step": step, "settle_ms": settle})
+            points = count_scan_points(client, args.seconds)
+            rate = points / args.seconds
+            per_sweep = (args.end - args.start) // step + 1
+            print("%-6d %-10d %-8.1f %-10.2f" % (step, settle, rate, per_sweep / rate if rate else 0.0))
+    finally:
+        post_json(args.host, args.port, "/api/scan", {"enabled": False})
+        client.close()
+    return 0
+
+
+# ===== Логирование: задержка обработчика при разных уровнях =====
+
+# 0 — логирование выключено, 3 — INFO (по умолчанию), 4 — DEBUG (тело каждого запроса)
+LOG_LEVELS = [0, 3, 4]
+
+
+def cmd_logging(args):
+    initial = get_json(args.host, args.port, "/api/log")
+    print("JSON POST /api/motor, %d commands per log level (max level %d)" % (args.count, initial["max_level"]))
+    try:
+        for level in LOG_LEVELS:
+            if level > initial["max_level"]:
+                print("level %d skipped: compiled out (LOG_LEVEL=%d)" % (level, initial["max_level"]))
+                continue
+            post_json(args.host, args.port, "/api/log", {"level": level})
+            before = get_json(args.host, args.port, "/api/log")
+            report("level=%d" % level, *bench_json(args.host, args.port, args.count))
+            after = get_json(args.host, args.port, "/api/log")
+            print("           records=%d dropped=%d max_pending=%d" % (
+                after["written"] - before["written"], after["dropped"] - before["dropped"],
+                after["max_pending"]))
+    finally:
+        post_json(args.host, args.port, "/api/log", {"level": initial["level"]})
+    return 0
+
+
+# ===== Статические файлы UI: холодная и повторная загрузка =====
+
+ASSET_PATHS = ["/", "/style.css", "/joystick.js", "/main.js"]
+
+
+def fetch_asset(host, port, path, etags):
+    # Возвращает (статус, байт в теле, TTFB мс, всего мс, ETag)
+    headers = {"Accept-Encoding": "gzip"}
+    if path in etags:
+        headers["If-None-Match"] = etags[path]
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    t0 = time.perf_counter()
+    conn.request("GET", path, headers=headers)
+    response = conn.getresponse()
+    ttfb = (time.perf_counter() - t0) * 1000.0
+    body = response.read()
+    total = (time.perf_counter() - t0) * 1000.0
+    conn.close()
+    return response.status, len(body), ttfb, total, response.getheader("ETag")
+
+
+def cmd_assets(args):
+    print("%-6s %-13s %-7s %-8s %-9s %-9s" % ("load", "path", "status", "bytes", "ttfb_ms", "total_ms"))
+    for round_index in range(args.rounds):
+        etags = {}
+        for load in ("cold", "warm"):
+            bytes_total = 0
+            time_total = 0.0
+            for path in ASSET_PATHS:
+                status, size, ttfb, total, etag = fetch_asset(args.host, args.port, path, etags)
+                if etag:
+                    etags[path] = etag
+                bytes_total += size
+                time_total += total
+                if round_index == 0:
+                    print("%-6s %-13s %-7d %-8d %-9.1f %-9.1f" % (load, path, status, size, ttfb, total))
+            print("%-6s %-13s %-7s %-8d %-9s %-9.1f" % (load, "TOTAL", "", bytes_total, "", time_total))
+    ui = get_json(args.host, args.port, "/api/status").get("ui")
+    if ui:
+        print("ui_init=%d us, source: %s, served flash=%d fs=%d 304=%d, handler max=%d us" % (
+            ui["init_us"], "LittleFS override" if ui["fs_override"] else "flash",
+            ui["served_flash"], ui["served_fs"], ui["not_modified"], ui["max_us"]))
+    return 0
+
+
+# ===== Нагрузка: параллельные клиенты =====
+
+LOAD_CONCURRENCY = [1, 4, 16]
+LOAD_REQUESTS = [
+    ("GET", "/api/status", None),
+    ("GET", "/api/motor", None),
+    ("POST", "/api/motor", {"motorA": 0, "motorB": 0, "motorC": 0, "motorD": 0}),
+]
+
+
+def load_worker(host, port, deadline, latencies, errors, lock):
+    # Постоянное соединение (keep-alive); http.client переподключается, если сервер его закрыл
+    conn = http.client.HTTPConnection(host, port, timeout=5)
+    local, failed, i = [], 0, 0
+    while time.perf_counter() < deadline:
+        method, path, payload = LOAD_REQUESTS[i % len(LOAD_REQUESTS)]
+        i += 1
+        body = json.dumps(payload) if payload is not None else None
+        headers = {"Content-Type": "application/json"} if body else {}
+        t0 = time.perf_counter()
+        try:
+            conn.request(method, path, body, headers)
+            response = conn.getresponse()
+            response.read()
+            if response.status != 200:
+                failed += 1
+                continue
+            local.append((time.perf_counter() - t0) * 1000.0)
+        except (OSError, http.client.HTTPException):
+            failed += 1
+            conn.close()
+            conn = http.client.HTTPConnection(host, port, timeout=5)
+    conn.close()
+    with lock:
+        latencies.extend(local)
+        errors.append(failed)
+
+
+def cmd_load(args):
+    print("Mixed GET/POST load, %.0f s per level" % args.seconds)
+    for clients in LOAD_CONCURRENCY:
+        latencies, errors, lock = [], [], threading.Lock()
+        start = time.perf_counter()
+        deadline = start + args.seconds
+        workers = [threading.Thread(target=load_worker,
+                                    args=(args.host, args.port, deadline, latencies, errors, lock))
+                   for _ in range(clients)]
+        for worker in workers:
+            worker.start()
+        for worker in workers:
+            worker.join()
+        report("c=%d" % clients, latencies, time.perf_counter() - start)
+        if sum(errors):
+            print("           errors=%d" % sum(errors))
+    return 0
+
+
+# ===== Длительный прогон: фрагментация кучи =====
+
+# GET-маршруты с JSON ответами и POST без движения робота
+SOAK_GETS = ["/api/status", "/api/servo", "/api/motor", "/api/camera", "/api/lidar", "/api/scan", "/api/sched"]
+SOAK_POSTS = [("/api/motor", {"motorA": 0, "motorB": 0, "motorC": 0, "motorD": 0})]
+
+
+def cmd_soak(args):
+    deadline = time.perf_counter() + args.minutes * 60.0
+    next_sample = 0.0
+    requests = 0
+    rows = []
+    print("%-8s %-9s %-9s %-9s %-6s %-10s %-10s" % (
+        "t_s", "requests", "free", "largest", "frag%", "last_alloc", "heap_alloc"))
+    start = time.perf_counter()
+    while True:
+        now = time.perf_counter()
+        if now >= next_sample:
+            status = get_json(args.host, args.port, "/api/status")
+            heap, js = status["heap"], status["json"]
+            row = (now - start, requests, heap["free"], heap["largest_block"], heap["fragmentation"],
+                   js["last_allocs"], js["heap_allocs"])
+            rows.append(row)
+            print("%-8.0f %-9d %-9d %-9d %-6d %-10d %-10d" % row)
+            next_sample = now + args.interval
+            if now >= deadline:
+                break
+        for path in SOAK_GETS:
+            get_json(args.host, args.port, path)
+        for path, payload in SOAK_POSTS:
+            post_json(args.host, args.port, path, payload)
+        requests += len(SOAK_GETS) + len(SOAK_POSTS)
+
+    first, last = rows[0], rows[-1]
+    print("largest block: %d -> %d bytes, fragmentation: %d%% -> %d%% (max %d%%), min free %d" % (
+        first[3], last[3], first[4], last[4], max(r[4] for r in rows), status["heap"]["min_free"]))
+    if args.csv:
+        with open(args.csv, "w") as out:
+            out.write("t_s,requests,free,largest,fragmentation,last_allocs,heap_allocs\n")
+            for row in rows:
+                out.write("%.0f,%d,%d,%d,%d,%d,%d\n" % row)
+    return 0
+
+
+# ===== Воспроизведение записанного трафика REST API =====
+
+# Поток запросов джойстика как в data/main.js (updateJoystickControl)
+JOYSTICK_SEND_INTERVAL_MS = 100     # SEND_INTERVAL
+JOYSTICK_MAX_SPEED = 255            # JOYSTICK_CONFIG.maxSpeed
+JOYSTICK_MODES = ["drive", "servo", "mixed"]
+MOTOR_KEYS = ("motorA", "motorB", "motorC", "motorD")
+
+# Сравнение с базовым прогоном: метрика -> допуск в абсолютных единицах (шум таймера)
+REPLAY_GATED_METRICS = {"fw_avg_us": "min_us", "allocs_per_req": None, "bytes_per_req": None}
+
+
+def js_round(value):
+    # Math.round: половина округляется вверх
+    return int(math.floor(value + 0.5))
+
+
+def constrain(value, low, high):
+    return max(low, min(high, value))
+
+
+def joystick_session(seconds):
+    """Перетаскивания джойстика по кругу; режим drive/servo/mixed меняется с каждым"""
+    entries, last_servos, t, drag = [], None, 0, 0
+    drag_ms, pause_ms = 3000, 500
+
+    def post(path, payload):
+        entries.append({"t": t, "method": "POST", "path": path, "body": json.dumps(payload, separators=(",", ":"))})
+
+    while t < seconds * 1000:
+        mode = JOYSTICK_MODES[drag % len(JOYSTICK_MODES)]
+        for step in range(drag_ms // JOYSTICK_SEND_INTERVAL_MS):
+            phase = 2 * math.pi * step * JOYSTICK_SEND_INTERVAL_MS / drag_ms
+            x, y = js_round(100 * math.sin(phase)), js_round(100 * math.cos(phase))
+            if mode in ("servo", "mixed"):
+                angle = js_round(90 - x)
+                front, rear = constrain(angle, 0, 180), constrain(180 - angle, 0, 180)
+                servos = [front, front, rear, rear]
+                if servos != last_servos:
+                    post("/api/servo/batch", {"servos": [{"id": i, "angle": a} for i, a in enumerate(servos)]})
+                    last_servos = servos
+            if mode == "drive":
+                left = constrain((y - x) / 100 * JOYSTICK_MAX_SPEED, -255, 255)
+                right = constrain((y + x) / 100 * JOYSTICK_MAX_SPEED, -255, 255)
+                post("/api/motor", {"motorA": js_round(right), "motorB": js_round(left),
+                                    "motorC": js_round(left), "motorD": js_round(right)})
+            elif mode == "mixed":
+                speed = js_round(-y * 255 / 100)
+                post("/api/motor", dict.fromkeys(MOTOR_KEYS, speed))
+            t += JOYSTICK_SEND_INTERVAL_MS
+        # Отпускание джойстика — stopMotorsSmooth()
+        post("/api/motor", dict.fromkeys(MOTOR_KEYS, 0))
+        t += pause_ms
+        drag += 1
+    return entries
+
+
+def load_har(path):
+    # Экспорт вкладки Network браузера; берутся только запросы к /api/
+    with open(path) as f:
+        har = json.load(f)
+    entries, start = [], None
+    for entry in har["log"]["entries"]:
+        request = entry["request"]
+        url = request["url"]
+        target = "/" + url.split("://", 1)[-1].split("/", 1)[-1] if "://" in url else url
+        if not target.startswith("/api/"):
+            continue
+        started = datetime.fromisoformat(entry["startedDateTime"].replace("Z", "+00:00")).timestamp()
+        start = started if start is None else start
+        body = request.get("postData", {}).get("text")
+        entries.append({"t": round((started - start) * 1000.0, 1), "method": request["method"], "path": target, "body": body})
+    return entries
+
+
+def load_session(source):
+    """joystick[:секунды], запись .har или .jsonl ({"t": мс, "method", "path", "body"})"""
+    if source.split(":")[0] == "joystick":
+        return joystick_session(float(source.split(":")[1]) if ":" in source else 30.0)
+    if source.endswith(".har"):
+        return load_har(source)
+    entries = []
+    with open(source) as f:
+        for line in f:
+            if line.strip():
+                entry = json.loads(line)
+                if isinstance(entry.get("body"), (dict, list)):
+                    entry["body"] = json.dumps(entry["body"], separators=(",", ":"))
+                entries.append(entry)
+    return entries
+
+
+def zero_motors(entry):
+    if entry["path"].split("?")[0] != "/api/motor" or not entry.get("body"):
+        return entry
+    try:
+        payload = json.loads(entry["body"])
+    except ValueError:
+        return entry
+    if isinstance(payload, dict):
+        payload.update({key: 0 for key in MOTOR_KEYS if key in payload})
+    return dict(entry, body=json.dumps(payload, separators=(",", ":")))
+
+
+def request_once(host, port, method, path, body):
+    headers = {"Content-Type": "application/json"} if body else {}
+    conn = http.client.HTTPConnection(host, port, timeout=5)
+    t0 = time.perf_counter()
+    conn.request(method, path, body, headers)
+    response = conn.getresponse()
+    response.read()
+    latency = (time.perf_counter() - t0) * 1000.0
+    conn.close()
+    return response.status, latency
+
+
+def histogram_percentile(histogram, limits, p):
+    # Верхняя граница корзины, в которую попадает p-й процентиль (последняя — без границы)
+    total = sum(histogram)
+    if total == 0:
+        return 0
+    needed, seen = math.ceil(p / 100.0 * total), 0
+    for i, count in enumerate(histogram):
+        seen += count
+        if seen >= needed:
+            return limits[i] if i < len(limits) else float("inf")
+    return float("inf")
+
+
+def replay_summary(source, client, firmware):
+    limits = firmware["hist_us"]
+    routes = {}
+    for route in firmware["routes"]:
+        key = "%s %s" % (route["method"], route["path"])
+        # Только маршруты записи: служебные запросы бенчмарка не учитываются
+        if key not in client:
+            continue
+        n = route["requests"]
+        routes[key] = {
+            "requests": n,
+            "fw_avg_us": route["total_us"] / n,
+            "fw_p50_us": histogram_percentile(route["hist"], limits, 50),
+            "fw_p99_us": histogram_percentile(route["hist"], limits, 99),
+            "fw_max_us": route["max_us"],
+            "allocs_per_req": route["allocs"] / n,
+            "bytes_per_req": route["bytes"] / n,
+            "hist": route["hist"],
+        }
+    for key, stats in client.items():
+        route = routes.setdefault(key, {"requests": len(stats["latencies"])})
+        route.update({"errors": stats["errors"], "client_p50_ms": percentile(stats["latencies"], 50),
+                      "client_p99_ms": percentile(stats["latencies"], 99)})
+    return {"session": source, "hist_us": limits, "routes": routes}
+
+
+def print_replay(summary):
+    print("%-24s %-6s %-4s %-8s %-8s %-7s %-8s %-7s %-7s %-7s" % (
+        "route", "n", "err", "cli_p50", "cli_p99", "fw_avg", "fw_p99<=", "fw_max", "allocs", "bytes"))
+    limits = summary["hist_us"]
+    for key, route in sorted(summary["routes"].items()):
+        if "fw_avg_us" not in route:
+            print("%-24s %-6d %-4d %-8.2f %-8.2f (нет статистики прошивки)" % (
+                key, route["requests"], route["errors"], route["client_p50_ms"], route["client_p99_ms"]))
+            continue
+        print("%-24s %-6d %-4d %-8.2f %-8.2f %-7.0f %-8s %-7d %-7.1f %-7.1f" % (
+            key, route["requests"], route.get("errors", 0), route.get("client_p50_ms", 0.0),
+            route.get("client_p99_ms", 0.0), route["fw_avg_us"], "%g" % route["fw_p99_us"],
+            route["fw_max_us"], route["allocs_per_req"], route["bytes_per_req"]))
+        buckets = ["%s%d:%d" % ("<" if i < len(limits) else ">=", limits[min(i, len(limits) - 1)], count)
+                   for i, count in enumerate(route["hist"]) if count]
+        print("%-24s us %s" % ("", " ".join(buckets)))
+
+
+def compare_replay(baseline, summary, threshold, min_us):
+    """Регрессии относительно базового прогона: список строк"""
+    slack = {"min_us": min_us}
+    regressions = []
+    for key, base in baseline["routes"].items():
+        current = summary["routes"].get(key)
+        if current is None or "fw_avg_us" not in base or "fw_avg_us" not in current:
+            continue
+        for metric, slack_name in REPLAY_GATED_METRICS.items():
+            before, after = base[metric], current[metric]
+            limit = before * (1.0 + threshold / 100.0)
+            if slack_name:
+                limit = max(limit, before + slack[slack_name])
+            if after > limit:
+                change = (after - before) * 100.0 / before if before else float("inf")
+                regressions.append("%s %s: %.1f -> %.1f (%+.0f%%)" % (key, metric, before, after, change))
+    return regressions
+
+
+def cmd_replay(args):
+    entries = load_session(args.source)
+    if not args.live_motors:
+        entries = [zero_motors(entry) for entry in entries]
+    if args.dump:
+        with open(args.dump, "w") as out:
+            for entry in entries:
+                out.write(json.dumps(entry) + "\n")
+    if not entries:
+        print("no /api/ requests in %s" % args.source)
+        return 1
+
+    status, _ = request_once(args.host, args.port, "POST", "/api/routes/reset", None)
+    if status != 200:
+        print("POST /api/routes/reset -> %d: firmware without per-route statistics" % status)
+        return 1
+
+    print("Replaying %d requests from %s (speed %s)" % (len(entries), args.source, args.speed or "max"))
+    client = {}
+    start = time.perf_counter()
+    try:
+        for entry in entries:
+            if args.speed > 0:
+                delay = start + entry["t"] / 1000.0 / args.speed - time.perf_counter()
+                if delay > 0:
+                    time.sleep(delay)
+            key = "%s %s" % (entry["method"], entry["path"].split("?")[0])
+            stats = client.setdefault(key, {"latencies": [], "errors": 0})
+            status, latency = request_once(args.host, args.port, entry["method"], entry["path"], entry.get("body"))
+            stats["latencies"].append(latency)
+            if status >= 300:
+                stats["errors"] += 1
+        firmware = get_json(args.host, args.port, "/api/routes")
+    finally:
+        request_once(args.host, args.port, "POST", "/api/motor/stop", None)
+
+    summary = replay_summary(args.source, client, firmware)
+    print_replay(summary)
+    if args.save:
+        with open(args.save, "w") as out:
+            json.dump(summary, out, indent=2)
+    if not args.baseline:
+        return 0
+
+    with open(args.baseline) as f:
+        regressions = compare_replay(json.load(f), summary, args.threshold, args.min_us)
+    for line in regressions:
+        print("REGRESSION " + line)
+    print("%d regression(s) beyond %.0f%% vs %s" % (len(regressions), args.threshold, args.baseline))
+    return 1 if regressions else 0
+
+
+# ===== OTA: сжатый образ против несжатого =====
+
+OTA_BOUNDARY = "----robot-ota-bench"
+OTA_REBOOT_TIMEOUT_S = 60.0
+
+
+def ota_upload(host, port, filename, image, md5, sha256):
+    """Загрузка как data/ota.html (multipart, поле firmware); (секунды, ответ JSON)"""
+    head = ('--%s\r\nContent-Disposition: form-data; name="firmware"; filename="%s"\r\n'
+            'Content-Type: application/octet-stream\r\n\r\n' % (OTA_BOUNDARY, filename)).encode()
+    tail = ("\r\n--%s--\r\n" % OTA_BOUNDARY).encode()
+    path = "/api/ota/upload?md5=%s&sha256=%s" % (md5, sha256)
+
+    conn = http.client.HTTPConnection(host, port, timeout=120)
+    start = time.perf_counter()
+    conn.request("POST", path, head + image + tail,
+                 {"Content-Type": "multipart/form-data; boundary=" + OTA_BOUNDARY})
+    response = conn.getresponse()
+    body = response.read()
+    elapsed = time.perf_counter() - start
+    conn.close()
+    if response.status != 200:
+        raise RuntimeError("%s -> %d %s" % (path, response.status, body.decode(errors="replace")))
+    return elapsed, json.loads(body)
+
+
+def wait_reboot(host, port):
+    """Ожидание перезагрузки после OTA: сначала /api/status пропадает, потом снова отвечает"""
+    deadline = time.perf_counter() + OTA_REBOOT_TIMEOUT_S
+    went_down = False
+    while time.perf_counter() < deadline:
+        try:
+            get_json(host, port, "/api/status")
+            if went_down:
+                return True
+        except (OSError, RuntimeError, http.client.HTTPException):
+            went_down = True
+        time.sleep(0.5)
+    return False
+
+
+def cmd_ota(args):
+    with open(args.image, "rb") as f:
+        image = f.read()
+    md5 = hashlib.md5(image).hexdigest()
+    sha256 = hashlib.sha256(image).hexdigest()
+    compressed = gzip.compress(image, compresslevel=9)
+    variants = [("raw", os.path.basename(args.image), image),
+                ("gzip", os.path.basename(args.image) + ".gz", compressed)]
+    if args.base:
+        # Патч — первым: база должна быть прошивкой, которая сейчас работает на роботе
+        import mkdelta
+        with open(args.base, "rb") as f:
+            patch = mkdelta.compress(mkdelta.make_delta(f.read(), image))
+        variants.insert(0, ("delta", os.path.basename(args.image) + ".delta.gz", patch))
+
+    print("image: %d bytes, gzip: %d bytes (%.0f%%), sha256 %s" % (
+        len(image), len(compressed), 100.0 * len(compressed) / len(image), sha256))
+    print("%-6s %-10s %-9s %-9s %-10s %-10s %-7s %-9s %-10s %-10s" % (
+        "mode", "upload_B", "time_s", "KB/s", "device_ms", "peak_heap", "stalls", "stall_ms", "max_flush", "jitter_us"))
+    for i, (name, filename, payload) in enumerate(variants):
+        elapsed, result = ota_upload(args.host, args.port, filename, payload, md5, sha256)
+        if result.get("sha256") != sha256 or result.get("image_bytes") != len(image):
+            raise RuntimeError("%s: device reported %s" % (name, result))
+        writer, control = result["writer"], result["control"]
+        print("%-6s %-10d %-9.2f %-9.1f %-10d %-10d %-7d %-9d %-10d %-10d" % (
+            name, len(payload), elapsed, len(payload) / 1024.0 / elapsed,
+            result["elapsed_ms"], result["peak_heap_bytes"], writer["stalls"], writer["stall_ms"],
+            writer["max_flush_ms"], control["max_jitter_us"]))
+        # После каждой загрузки робот перезагружается в новый образ
+        if (i + 1 < len(variants) or args.wait) and not wait_reboot(args.host, args.port):
+            print("robot did not come back after OTA within %.0f s" % OTA_REBOOT_TIMEOUT_S)
+            return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ESP32 robot host benchmarks")
+    parser.add_argument("--host", required=True, help="IP адрес робота")
+    parser.add_argument("--port", type=int, default=8080, help="HTTP порт (HTTP_PORT)")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    control = sub.add_parser("control", help="JSON POST vs WebSocket: cmd/s и p99")
+    control.add_argument("-n", "--count", type=int, default=500)
+    control.add_argument("--ws-port", type=int, default=0, help="WS_PORT (по умолчанию HTTP_PORT + 1)")
+    control.set_defaults(func=cmd_control)
+
+    scan = sub.add_parser("scan", help="скан дальномером: точек/с для набора (шаг, успокоение)")
+    scan.add_argument("--seconds", type=float, default=10.0, help="время измерения на конфигурацию")
+    scan.add_argument("--start", type=int, default=30)
+    scan.add_argument("--end", type=int, default=150)
+    scan.add_argument("--ws-port", type=int, default=0, help="WS_PORT (по умолчанию HTTP_PORT + 1)")
+    scan.set_defaults(func=cmd_scan)
+
+    logging = sub.add_parser("logging", help="задержка JSON-обработчика: логирование выключено/INFO/DEBUG")
+    logging.add_argument("-n", "--count", type=int, default=300)
+    logging.set_defaults(func=cmd_logging)
+
+    assets = sub.add_parser("assets", help="UI: байты и TTFB при холодной загрузке и повторной (ETag/304)")
+    assets.add_argument("--rounds", type=int, default=3)
+    assets.set_defaults(func=cmd_assets)
+
+    load = sub.add_parser("load", help="параллельные клиенты 1/4/16: запросов/с и p99")
+    load.add_argument("--seconds", type=float, default=10.0, help="время на каждый уровень")
+    load.set_defaults(func=cmd_load)
+
+    soak = sub.add_parser("soak", help="длительный прогон API: свободная память и фрагментация кучи")
+    soak.add_argument("--minutes", type=float, default=30.0)
+    soak.add_argument("--interval", type=float, default=10.0, help="период снятия /api/status, с")
+    soak.add_argument("--csv", default="", help="сохранить замеры в CSV (для сравнения прошивок)")
+    soak.set_defaults(func=cmd_soak)
+
+    replay = sub.add_parser("replay", help="записанный поток запросов через обработчики API: "
+                                           "гистограммы времени, выделения и байты по маршрутам")
+    replay.add_argument("source", help="joystick[:секунды] (как data/main.js), запись .har или .jsonl")
+    replay.add_argument("--speed", type=float, default=1.0, help="множитель темпа записи, 0 — без пауз")
+    replay.add_argument("--live-motors", action="store_true", help="не обнулять скорости в /api/motor")
+    replay.add_argument("--dump", default="", help="сохранить поток запросов в .jsonl")
+    replay.add_argument("--save", default="", help="сохранить результат (базовый прогон для --baseline)")
+    replay.add_argument("--baseline", default="", help="сравнить с сохранённым прогоном; код 1 при регрессии")
+    replay.add_argument("--threshold", type=float, default=10.0, help="допустимый рост метрики, %%")
+    replay.add_argument("--min-us", type=float, default=20.0, help="рост времени обработчика меньше этого не считается")
+    replay.set_defaults(func=cmd_replay)
+
+    ota = sub.add_parser("ota", help="OTA несжатым образом, gzip и дельтой: время загрузки, пик памяти, "
+                                     "ожидание записи и джиттер такта управления")
+    ota.add_argument("image", help="образ прошивки (firmware.bin)")
+    ota.add_argument("--base", default="", help="образ, работающий на роботе: добавить загрузку дельта-патча")
+    ota.add_argument("--wait", action="store_true", help="дождаться перезагрузки и после последней загрузки")
+    ota.set_defaults(func=cmd_ota)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
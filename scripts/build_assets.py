@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Подготовка веб-интерфейса для LittleFS (PlatformIO pre-скрипт).
+
+Из исходников data/ собирается каталог образа файловой системы (data_dir в
+platformio.ini, по умолчанию .pio/assets):
+  - каждый файл сжимается gzip (-9, без времени в заголовке — результат
+    воспроизводим) и сохраняется как <имя>.gz;
+  - для каждого файла считается хэш содержимого (SHA-256, 16 hex-символов);
+  - ссылки на ресурсы в HTML дополняются ?v=<хэш>, такие URL кэшируются
+    браузером навсегда (immutable) — новая сборка меняет хэш и URL;
+  - assets.manifest: строки "<путь> <хэш>" для ETag на стороне прошивки.
+
+Те же gzip-данные записываются в webassets.h (каталог сборки, добавляется в
+CPPPATH): constexpr массивы во flash с длиной, MIME-типом и хэшем и таблица
+маршрутов WEB_ASSETS (структура WebAsset — src/webasset.h).
+
+Исходники в data/ не изменяются.
+
+Ручной запуск (без PlatformIO):
+  python3 scripts/build_assets.py [data] [.pio/assets] [webassets.h]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+MANIFEST_NAME = "assets.manifest"
+HASH_LENGTH = 16
+ASSET_EXTENSIONS = (".html", ".js", ".css")
+HEADER_NAME = "webassets.h"
+MIME_TYPES = {".html": "text/html", ".js": "application/javascript", ".css": "text/css"}
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def rewrite_references(html, hashes):
+    # href="style.css", loadScript('main.js') -> ...?v=<хэш>
+    def replace(match):
+        quote, name = match.group(1), match.group(2)
+        return "%s%s?v=%s%s" % (quote, name, hashes["/" + name], quote)
+
+    names = "|".join(re.escape(path[1:]) for path in hashes if not path.endswith(".html"))
+    if not names:
+        return html
+    return re.sub(r"([\"'])(%s)\1" % names, replace, html)
+
+
+def write_if_changed(path, data):
+    if os.path.exists(path):
+        with open(path, "rb") as existing:
+            if existing.read() == data:
+                return False
+    with open(path, "wb") as out:
+        out.write(data)
+    return True
+
+
+def c_identifier(path):
+    return "webasset_" + re.sub(r"[^0-9A-Za-z]", "_", path[1:])
+
+
+def render_header(packed, hashes):
+    lines = [
+        "// Сгенерировано scripts/build_assets.py из data/ — не редактировать",
+        "#ifndef _WEBASSETS_H",
+        "#define _WEBASSETS_H",
+        "",
+        "#include \"webasset.h\"",
+        "",
+    ]
+    for path, data in packed.items():
+        lines.append("static constexpr uint8_t %s[%d] = {" % (c_identifier(path), len(data)))
+        for offset in range(0, len(data), 16):
+            lines.append("  " + ", ".join("0x%02x" % b for b in data[offset:offset + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("static constexpr WebAsset WEB_ASSETS[] = {")
+    for path, data in packed.items():
+        mime = MIME_TYPES[os.path.splitext(path)[1]]
+        lines.append("  {\"%s\", \"%s\", \"%s\", %s, %d}," % (path, mime, hashes[path], c_identifier(path), len(data)))
+    lines.append("};")
+    lines.append("")
+    lines.append("#define WEB_ASSETS_COUNT %d" % len(packed))
+    lines.append("")
+    lines.append("#endif")
+    return "\n".join(lines) + "\n"
+
+
+def build_assets(source_dir, output_dir, header_path=None):
+    if os.path.realpath(source_dir) == os.path.realpath(output_dir):
+        raise ValueError("output dir must differ from source dir: %s" % source_dir)
+    os.makedirs(output_dir, exist_ok=True)
+
+    sources = {}
+    for name in sorted(os.listdir(source_dir)):
+        if name.endswith(ASSET_EXTENSIONS):
+            with open(os.path.join(source_dir, name), "rb") as f:
+                sources["/" + name] = f.read()
+
+    # Сначала ресурсы, на которые ссылаются страницы, затем сами страницы
+    hashes = {path: content_hash(data) for path, data in sources.items() if not path.endswith(".html")}
+    for path, data in sources.items():
+        if path.endswith(".html"):
+            data = rewrite_references(data.decode("utf-8"), hashes).encode("utf-8")
+            sources[path] = data
+            hashes[path] = content_hash(data)
+
+    expected = {MANIFEST_NAME}
+    packed = {}
+    raw_bytes = gz_bytes = 0
+    for path, data in sources.items():
+        packed[path] = gzip.compress(data, compresslevel=9, mtime=0)
+        write_if_changed(os.path.join(output_dir, path[1:] + ".gz"), packed[path])
+        expected.add(path[1:] + ".gz")
+        raw_bytes += len(data)
+        gz_bytes += len(packed[path])
+
+    manifest = "".join("%s %s\n" % (path, hashes[path]) for path in sorted(hashes))
+    write_if_changed(os.path.join(output_dir, MANIFEST_NAME), manifest.encode("ascii"))
+
+    # Удаляем устаревшие файлы (например, удалённые из data/)
+    for name in os.listdir(output_dir):
+        if name not in expected:
+            os.remove(os.path.join(output_dir, name))
+
+    if header_path:
+        os.makedirs(os.path.dirname(header_path) or ".", exist_ok=True)
+        # Перезапись только при изменении — иначе ui.cpp пересобирается каждый раз
+        write_if_changed(header_path, render_header(packed, hashes).encode("utf-8"))
+
+    print("Assets: %d file(s), %d -> %d bytes gzip -> %s" % (len(sources), raw_bytes, gz_bytes, output_dir))
+    return hashes
+
+
+try:
+    Import("env")  # noqa: F821 — глобальная функция SCons, есть только внутри PlatformIO
+except NameError:
+    env = None
+
+if env is not None:
+    generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    build_assets(os.path.join(env.subst("$PROJECT_DIR"), "data"), env.subst("$PROJECT_DATA_DIR"),
+                 os.path.join(generated_dir, HEADER_NAME))
+    env.Append(CPPPATH=[generated_dir])
+else:
+    source = sys.argv[1] if len(sys.argv) > 1 else "data"
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(".pio", "assets")
+    header = sys.argv[3] if len(sys.argv) > 3 else None
+    build_assets(source, output, header)
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+Дельта-патч прошивки для OTA (применяется на роботе — src/delta.h).
+
+Патч переводит образ, который сейчас работает на роботе (старый firmware.bin),
+в новый. Как в bsdiff, совпадающие участки передаются разностью с базой, а не
+копией: при небольшой правке исходников код за ней сдвигается, и в нём меняются
+только адреса переходов и литералов. Разность почти вся из нулей и хорошо
+сжимается gzip, который прошивка распаковывает на лету. Новые байты, не
+найденные в базе, идут в патч как есть.
+
+Формат (little-endian):
+  заголовок: "RDLT", версия (1), 3 байта резерва, размер базы, размер результата,
+             SHA-256 базы, SHA-256 результата
+  записи:    diffLen (u32), extraLen (u32), seek (i32),
+             diffLen байт (новый - база) mod 256, extraLen новых байт
+
+Использование:
+  python3 scripts/mkdelta.py old.bin new.bin -o update.delta.gz
+  curl -F firmware=@update.delta.gz http://<IP>:8080/api/ota/upload
+
+Только стандартная библиотека Python — без дополнительных зависимостей.
+"""
+
+import argparse
+import gzip
+import hashlib
+import struct
+import sys
+
+DELTA_MAGIC = b"RDLT"
+DELTA_VERSION = 1
+HEADER_FORMAT = "<4sB3xII32s32s"
+RECORD_FORMAT = "<IIi"
+
+# Поиск совпадений: ключ — KEY_SIZE байт базы с шагом INDEX_STEP (память
+# индекса ~len/INDEX_STEP), совпадение со сдвигом внутри шага находится
+# на следующей позиции и достраивается назад
+KEY_SIZE = 16
+INDEX_STEP = 4
+EXACT_RUN = 64
+# Неточное продолжение совпадения обрывается, когда счёт (совпавшие - несовпавшие
+# байты) падает на столько ниже лучшего
+GIVE_UP_SCORE = 32
+
+
+def build_index(old):
+    index = {}
+    for offset in range(0, len(old) - KEY_SIZE + 1, INDEX_STEP):
+        index.setdefault(old[offset:offset + KEY_SIZE], offset)
+    return index
+
+
+def extend_match(old, new, o, n):
+    """Длина участка от old[o]/new[n] с наибольшим счётом 2 * совпавшие - длина"""
+    limit = min(len(old) - o, len(new) - n)
+    length = score = best_score = best_length = 0
+    while length < limit:
+        # Точные серии — срезами, побайтно только участки с разностью
+        while length + EXACT_RUN <= limit and old[o + length:o + length + EXACT_RUN] == \
+                new[n + length:n + length + EXACT_RUN]:
+            length += EXACT_RUN
+            score += EXACT_RUN
+        if score > best_score:
+            best_score, best_length = score, length
+        if length >= limit:
+            break
+        score += 1 if old[o + length] == new[n + length] else -1
+        length += 1
+        if score > best_score:
+            best_score, best_length = score, length
+        elif score < best_score - GIVE_UP_SCORE:
+            break
+    return best_length
+
+
+def find_matches(old, new):
+    """Список (позиция в new, позиция в old, длина) по возрастанию позиции в new"""
+    index = build_index(old)
+    matches = []
+    n = 0
+    pending = 0        # начало байт new, ещё не покрытых совпадением
+    shift = None       # o - n последнего совпадения: сначала пробуем продолжить его
+    while n + KEY_SIZE <= len(new):
+        key = new[n:n + KEY_SIZE]
+        o = None
+        if shift is not None and 0 <= n + shift <= len(old) - KEY_SIZE and \
+                old[n + shift:n + shift + KEY_SIZE] == key:
+            o = n + shift
+        if o is None:
+            o = index.get(key)
+        if o is None:
+            n += 1
+            continue
+
+        while n > pending and o > 0 and old[o - 1] == new[n - 1]:
+            n -= 1
+            o -= 1
+        length = extend_match(old, new, o, n)
+        matches.append((n, o, length))
+        n += length
+        pending = n
+        shift = o - (n - length)
+    return matches
+
+
+def make_delta(old, new):
+    """Патч без сжатия"""
+    out = [struct.pack(HEADER_FORMAT, DELTA_MAGIC, DELTA_VERSION, len(old), len(new),
+                       hashlib.sha256(old).digest(), hashlib.sha256(new).digest())]
+    # Первая запись без разности — новые байты до первого совпадения
+    segments = [(0, 0, 0)] + find_matches(old, new)
+    for i, (n, o, length) in enumerate(segments):
+        next_n, next_o = segments[i + 1][:2] if i + 1 < len(segments) else (len(new), o + length)
+        diff = bytes((a - b) & 0xFF for a, b in zip(new[n:n + length], old[o:o + length]))
+        extra = new[n + length:next_n]
+        out.append(struct.pack(RECORD_FORMAT, length, len(extra), next_o - (o + length)))
+        out.append(diff)
+        out.append(extra)
+    return b"".join(out)
+
+
+def apply_delta(old, patch):
+    """Применение как на роботе (проверка патча до загрузки)"""
+    magic, version, base_size, target_size, base_sha, target_sha = struct.unpack_from(HEADER_FORMAT, patch)
+    if magic != DELTA_MAGIC or version != DELTA_VERSION:
+        raise ValueError("not a delta patch")
+    if base_size != len(old) or hashlib.sha256(old).digest() != base_sha:
+        raise ValueError("base mismatch")
+    pos = struct.calcsize(HEADER_FORMAT)
+    old_pos = 0
+    new = bytearray()
+    while len(new) < target_size:
+        diff_len, extra_len, seek = struct.unpack_from(RECORD_FORMAT, patch, pos)
+        pos += struct.calcsize(RECORD_FORMAT)
+        new += bytes((a + b) & 0xFF for a, b in zip(patch[pos:pos + diff_len], old[old_pos:old_pos + diff_len]))
+        pos += diff_len
+        new += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += diff_len + seek
+    if pos != len(patch):
+        raise ValueError("data after the last record")
+    if hashlib.sha256(new).digest() != target_sha:
+        raise ValueError("result mismatch")
+    return bytes(new)
+
+
+def compress(patch):
+    return gzip.compress(patch, compresslevel=9, mtime=0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Delta OTA patch between two firmware images")
+    parser.add_argument("old", help="образ, работающий на роботе")
+    parser.add_argument("new", help="новый образ")
+    parser.add_argument("-o", "--output", required=True, help="файл патча")
+    parser.add_argument("--no-gzip", action="store_true", help="не сжимать патч")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    patch = make_delta(old, new)
+    if apply_delta(old, patch) != new:
+        raise RuntimeError("patch self-check failed")
+    data = patch if args.no_gzip else compress(patch)
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    print("base %d bytes, new %d bytes (gzip %d), patch %d bytes, %.1fx smaller than gzip image" % (
+        len(old), len(new), len(compress(new)), len(data), len(compress(new)) / float(len(data))))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -5,21 +5,36 @@
 
 // Явное объявление WiFi класса для ESP32 Arduino 3.x
 #include <WiFi.h>
-#include <WebServer.h>
+#include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 
 extern WiFiClass WiFi;
 
 #include "servo.h"
+#include "servocal.h"
 #include "dcmotor.h"
 #include "ui.h"
 #include "rwifi.h"
 #include "apiota.h"
+#include "wsctl.h"
+#include "control.h"
+#include "scheduler.h"
+#include "lidar.h"
+#include "scan.h"
+#include "log.h"
+#include "apijson.h"
+#include "apistats.h"
+#include "safety.h"
+#include "reflex.h"
+#include "telemetry.h"
 
 // ===== Константы =====
 
 #define API_LOG_ENABLED true
 
+#define API_LOG(fmt, ...) do { if (API_LOG_ENABLED) LOG_I("API", fmt, ##__VA_ARGS__); } while (0)
+#define API_LOG_ERROR(fmt, ...) LOG_E("API", "ERROR: " fmt, ##__VA_ARGS__)
+
 #define SERVO_ID_MIN 0
 #define SERVO_ID_MAX 15
 #define SERVO_ANGLE_MIN 0
@@ -28,50 +43,93 @@ extern WiFiClass WiFi;
 #define PWM_MAX_VALUE 4095
 #define MOTOR_SPEED_MIN -255
 #define MOTOR_SPEED_MAX 255
+#define SERVO_SPEED_MAX 2000     // °/с
+#define SERVO_ACCEL_MAX 20000    // °/с²
+
+// Тело POST запроса накапливается в буфере соединения не больше этого размера
+#define API_MAX_BODY_SIZE 1024
+
+// ===== Структуры данных =====
+
+// Тело запроса, накопленное по частям (request->_tempObject, освобождается сервером)
+struct RequestBody {
+  size_t length;
+  bool overflow;         // тело больше API_MAX_BODY_SIZE — не сохраняется
+  char data[];
+};
 
 // ===== Глобальные объекты =====
 
-WebServer server(HTTP_PORT);
+AsyncWebServer server(HTTP_PORT);
 
 // ===== Вспомогательные функции =====
 
-void api_log(const String& message) {
-  if (API_LOG_ENABLED) {
-    Serial.println("[API] " + message);
-  }
+// Отправка готового JSON (CORS заголовки добавляются ко всем ответам — DefaultHeaders)
+void sendJSONResponse(AsyncWebServerRequest* request, int code, const char* json) {
+  API_LOG("Response [%d]: %s", code, json);
+  // send() копирует JSON в String ответа — одно выделение из кучи
+  request->send(code, "application/json", json);
+  apijson_countResponse(strlen(json), 1);
 }
 
-void sendJSONResponse(int code, const String& json) {
-  api_log("Response [" + String(code) + "]: " + json);
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  server.send(code, "application/json", json);
+// Сериализация документа напрямую в буфер ответа соединения
+void sendJSONDocument(AsyncWebServerRequest* request, int code, const JsonDocument& doc) {
+  size_t length = apijson_measure(doc);
+  if (length == 0) {
+    API_LOG_ERROR("Response exceeds %d bytes", APIJSON_RESPONSE_SIZE);
+    sendJSONResponse(request, 500, "{\"error\":\"Response too large\"}");
+    return;
+  }
+
+  // Буфер ответа — из кучи, ровно под длину по measureJson
+  AsyncResponseStream* response = request->beginResponseStream("application/json", length);
+  response->setCode(code);
+  serializeJson(doc, *response);
+  API_LOG("Response [%d]: %u bytes", code, (unsigned)length);
+  request->send(response);
+  apijson_countResponse(length, 1);
 }
 
-void sendHTMLResponse(const String& html) {
-  api_log("Sending HTML page (" + String(html.length()) + " bytes)");
-  server.sendHeader("Content-Type", "text/html");
-  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  server.sendHeader("Pragma", "no-cache");
-  server.sendHeader("Expires", "0");
-  server.send(200, "text/html", html);
+// Накопление тела POST запроса по частям (обработчик тела ESPAsyncWebServer)
+static void collectRequestBody(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                               size_t index, size_t total) {
+  if (index == 0) {
+    bool overflow = total > API_MAX_BODY_SIZE;
+    RequestBody* body = (RequestBody*)malloc(sizeof(RequestBody) + (overflow ? 0 : total + 1));
+    if (body == NULL) return;
+    body->length = 0;
+    body->overflow = overflow;
+    request->_tempObject = body;
+  }
+
+  RequestBody* body = (RequestBody*)request->_tempObject;
+  if (body == NULL || body->overflow) return;
+  if (index + len > total) len = total - index;
+  memcpy(body->data + index, data, len);
+  body->length = index + len;
+  body->data[body->length] = '\0';
 }
 
 // Проверка наличия и валидности JSON тела запроса
-static bool validateRequestBody(JsonDocument& doc, const String& endpointName) {
-  if (!server.hasArg("plain")) {
-    api_log("ERROR: No data provided");
-    sendJSONResponse(400, "{\"error\":\"No data provided\"}");
+static bool validateRequestBody(AsyncWebServerRequest* request, JsonDocument& doc, const char* endpointName) {
+  RequestBody* body = (RequestBody*)request->_tempObject;
+  if (body == NULL || body->length == 0) {
+    if (body != NULL && body->overflow) {
+      API_LOG_ERROR("Body too large for %s", endpointName);
+      sendJSONResponse(request, 413, "{\"error\":\"Request body too large\"}");
+      return false;
+    }
+    API_LOG_ERROR("No data provided");
+    sendJSONResponse(request, 400, "{\"error\":\"No data provided\"}");
     return false;
   }
   
-  api_log("Request body: " + server.arg("plain"));
+  LOG_D("API", "Request body: %s", body->data);
   
-  DeserializationError error = deserializeJson(doc, server.arg("plain"));
+  DeserializationError error = deserializeJson(doc, body->data, body->length);
   if (error) {
-    api_log("ERROR: Invalid JSON - " + String(error.c_str()));
-    sendJSONResponse(400, "{\"error\":\"Invalid JSON\"}");
+    API_LOG_ERROR("Invalid JSON - %s", error.c_str());
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid JSON\"}");
     return false;
   }
   
@@ -88,308 +146,997 @@ static bool isValidMotorSpeed(int speed) {
   return speed >= MOTOR_SPEED_MIN && speed <= MOTOR_SPEED_MAX;
 }
 
-// Проверка и установка скорости мотора с валидацией
-static bool setMotorIfValid(const JsonDocument& doc, const char* motorName, 
-                           int speed, void (*setSpeedFunc)(int)) {
+// Проверка скорости мотора и добавление её в команду
+static bool setMotorIfValid(AsyncWebServerRequest* request, const JsonDocument& doc, const char* motorName, 
+                           int index, ControlCommand* command) {
   if (doc[motorName].is<int>()) {
+    int speed = doc[motorName];
     if (!isValidMotorSpeed(speed)) {
-      api_log("ERROR: Invalid " + String(motorName) + " speed: " + String(speed));
-      sendJSONResponse(400, "{\"error\":\"Invalid " + String(motorName) + 
-                 " speed (must be -255 to 255)\"}");
+      API_LOG_ERROR("Invalid %s speed: %d", motorName, speed);
+      char error[64];
+      snprintf(error, sizeof(error), "{\"error\":\"Invalid %s speed (must be -255 to 255)\"}", motorName);
+      sendJSONResponse(request, 400, error);
       return false;
     }
-    api_log("Motor " + String(motorName) + " speed: " + String(speed));
-    setSpeedFunc(speed);
+    API_LOG("Motor %s speed: %d", motorName, speed);
+    command->motorMask |= (1 << index);
+    command->motor[index] = speed;
+  }
+  return true;
+}
+
+// Режим перемещения серво: "immediate": true — сразу, иначе по профилю канала
+static uint8_t servoMoveOf(const JsonDocument& doc) {
+  return (doc["immediate"] | false) ? SERVO_MOVE_IMMEDIATE : SERVO_MOVE_PROFILED;
+}
+
+// Отправка команды в задачу управления; при переполнении очереди — 503
+static bool postControlCommand(AsyncWebServerRequest* request, const ControlCommand& command) {
+  if (!control_post(command)) {
+    API_LOG_ERROR("Control queue full, command dropped");
+    sendJSONResponse(request, 503, "{\"error\":\"Control queue full\"}");
+    return false;
+  }
+  return true;
+}
+
+// Чтение снимка состояния задачи управления; при отсутствии — 503
+static bool readControlState(AsyncWebServerRequest* request, ControlState* state) {
+  if (!control_getState(state)) {
+    API_LOG_ERROR("Control state unavailable");
+    sendJSONResponse(request, 503, "{\"error\":\"Control state unavailable\"}");
+    return false;
   }
   return true;
 }
 
 // ===== Обработчики REST API =====
 
-void handleStatus() {
-  api_log("GET /api/status");
+void handleStatus(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/status");
   
-  JsonDocument doc;
+  JsonDocument doc(apijson_allocator());
   doc["status"] = "ok";
   doc["ip"] = WiFi.localIP();
   doc["servos_count"] = 4;
+
+  WsCtlStats ws;
+  wsctl_getStats(&ws);
+  JsonObject wsObj = doc["ws"].to<JsonObject>();
+  wsObj["clients"] = ws.clients;
+  wsObj["frames"] = ws.framesReceived;
+  wsObj["applied"] = ws.framesApplied;
+  wsObj["stale"] = ws.framesStale;
+  wsObj["invalid"] = ws.framesInvalid;
+  wsObj["estops"] = ws.estops;
+
+  TelemetryStats telemetry;
+  telemetry_getStats(&telemetry);
+  JsonObject telemetryObj = doc["telemetry"].to<JsonObject>();
+  telemetryObj["snapshots"] = telemetry.snapshots;
+  telemetryObj["frames"] = telemetry.frames;
+  telemetryObj["bytes"] = telemetry.bytes;
+  telemetryObj["dropped"] = ws.telemetryDropped;
+  telemetryObj["encode_us"] = telemetry.lastEncodeUs;
+  telemetryObj["max_encode_us"] = telemetry.maxEncodeUs;
+
+  ApiJsonStats json;
+  apijson_getStats(&json);
+  JsonObject jsonObj = doc["json"].to<JsonObject>();
+  jsonObj["responses"] = json.responses;
+  jsonObj["arena_allocs"] = json.arenaAllocs;
+  jsonObj["heap_allocs"] = json.heapAllocs;
+  jsonObj["buffer_allocs"] = json.bufferAllocs;
+  jsonObj["last_allocs"] = json.lastAllocs;
+  jsonObj["max_allocs"] = json.maxAllocs;
+  jsonObj["arena_peak"] = json.arenaPeak;
+  jsonObj["overflows"] = json.overflows;
+
+  UiStats ui;
+  ui_getStats(&ui);
+  JsonObject uiObj = doc["ui"].to<JsonObject>();
+  uiObj["init_us"] = ui.initUs;
+  uiObj["embedded"] = ui.embeddedAssets;
+  uiObj["fs_override"] = ui.fsOverride;
+  uiObj["served_flash"] = ui.servedEmbedded;
+  uiObj["served_fs"] = ui.servedFs;
+  uiObj["not_modified"] = ui.notModified;
+  uiObj["last_us"] = ui.lastServeUs;
+  uiObj["max_us"] = ui.maxServeUs;
+
+  // Фрагментация: насколько наибольший свободный блок меньше всей свободной памяти
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t largestBlock = ESP.getMaxAllocHeap();
+  JsonObject heapObj = doc["heap"].to<JsonObject>();
+  heapObj["free"] = freeHeap;
+  heapObj["min_free"] = ESP.getMinFreeHeap();
+  heapObj["largest_block"] = largestBlock;
+  heapObj["fragmentation"] = freeHeap > 0 ? 100 - (largestBlock * 100 / freeHeap) : 0;
   
-  String response;
-  serializeJson(doc, response);
-  sendJSONResponse(200, response);
+  sendJSONDocument(request, 200, doc);
 }
 
-void handleGetServos() {
-  api_log("GET /api/servo");
+void handleGetServos(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/servo");
   
-  JsonDocument doc;
+  ControlState state;
+  if (!readControlState(request, &state)) return;
+
+  JsonDocument doc(apijson_allocator());
   JsonArray servos = doc["servos"].to<JsonArray>();
   
-  for (int i = 0; i < 4; i++) {
+  for (int i = 0; i < CONTROL_STEERING_SERVOS; i++) {
     JsonObject servo = servos.add<JsonObject>();
     servo["id"] = i;
-    servo["angle"] = servo_getAngle(i);
+    servo["angle"] = state.servoAngle[i];
+    servo["target"] = state.servoTarget[i];
+    servo["moving"] = (state.servoMovingMask & (1 << i)) != 0;
   }
   
-  String response;
-  serializeJson(doc, response);
-  sendJSONResponse(200, response);
+  sendJSONDocument(request, 200, doc);
 }
 
-void handleSetServo() {
-  api_log("POST /api/servo");
+void handleSetServo(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/servo");
   
-  JsonDocument doc;
-  if (!validateRequestBody(doc, "servo")) return;
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "servo")) return;
   
   int id = doc["id"] | -1;
   int angle = doc["angle"] | -1;
   
-  api_log("Servo ID: " + String(id) + ", Angle: " + String(angle));
+  API_LOG("Servo ID: %d, Angle: %d", id, angle);
   
   if (id < SERVO_ID_MIN || id > SERVO_ID_MAX) {
-    api_log("ERROR: Invalid servo ID: " + String(id));
-    sendJSONResponse(400, "{\"error\":\"Invalid servo ID\"}");
+    API_LOG_ERROR("Invalid servo ID: %d", id);
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid servo ID\"}");
     return;
   }
   
   if (angle < SERVO_ANGLE_MIN || angle > SERVO_ANGLE_MAX) {
-    api_log("ERROR: Invalid angle: " + String(angle));
-    sendJSONResponse(400, "{\"error\":\"Invalid angle (must be 0-180)\"}");
+    API_LOG_ERROR("Invalid angle: %d", angle);
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid angle (must be 0-180)\"}");
     return;
   }
   
-  servo_setAngle(id, angle);
-  api_log("Servo " + String(id) + " set to " + String(angle) + "°");
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SETPOINT);
+  command.servoMask = (1 << id);
+  command.servo[id] = angle;
+  command.servoMove = servoMoveOf(doc);
+  if (!postControlCommand(request, command)) return;
+  API_LOG("Servo %d set to %d°", id, angle);
   
-  JsonDocument response;
+  JsonDocument response(apijson_allocator());
   response["success"] = true;
   response["servo"] = id;
   response["angle"] = angle;
   
-  String jsonResponse;
-  serializeJson(response, jsonResponse);
-  sendJSONResponse(200, jsonResponse);
+  sendJSONDocument(request, 200, response);
+}
+
+void handleSetServoBatch(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/servo/batch");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "servo batch")) return;
+
+  JsonArray servos = doc["servos"].as<JsonArray>();
+  if (servos.isNull() || servos.size() == 0) {
+    API_LOG_ERROR("No servos array");
+    sendJSONResponse(request, 400, "{\"error\":\"No servos array\"}");
+    return;
+  }
+
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SETPOINT);
+
+  for (JsonObject servo : servos) {
+    int id = servo["id"] | -1;
+    int angle = servo["angle"] | -1;
+
+    if (id < SERVO_ID_MIN || id > SERVO_ID_MAX) {
+      API_LOG_ERROR("Invalid servo ID: %d", id);
+      sendJSONResponse(request, 400, "{\"error\":\"Invalid servo ID\"}");
+      return;
+    }
+
+    if (angle < SERVO_ANGLE_MIN || angle > SERVO_ANGLE_MAX) {
+      API_LOG_ERROR("Invalid angle: %d", angle);
+      sendJSONResponse(request, 400, "{\"error\":\"Invalid angle (must be 0-180)\"}");
+      return;
+    }
+
+    command.servoMask |= (1 << id);
+    command.servo[id] = angle;
+  }
+  command.servoMove = servoMoveOf(doc);
+
+  if (!postControlCommand(request, command)) return;
+  API_LOG("Servo batch queued: mask=0x%x", command.servoMask);
+
+  // Запись в PCA9685 выполнит задача управления на следующем такте,
+  // поэтому статистика шины — по последнему уже применённому обновлению
+  ControlState state;
+  if (!readControlState(request, &state)) return;
+
+  JsonDocument response(apijson_allocator());
+  response["success"] = true;
+  response["mask"] = command.servoMask;
+  response["saved_us"] = state.servoBusSavedUs;
+  response["total_saved_us"] = state.servoBusTotalSavedUs;
+  response["i2c_errors"] = state.servoBusErrors;
+
+  sendJSONDocument(request, 200, response);
+}
+
+// ===== API профиля перемещения сервоприводов =====
+
+void handleGetServoProfile(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/servo/profile");
+
+  ControlState state;
+  if (!readControlState(request, &state)) return;
+
+  JsonDocument doc(apijson_allocator());
+  JsonArray channels = doc["channels"].to<JsonArray>();
+  for (int ch = SERVO_ID_MIN; ch <= SERVO_ID_MAX; ch++) {
+    JsonObject channel = channels.add<JsonObject>();
+    channel["id"] = ch;
+    channel["speed"] = state.servoMaxSpeed[ch];
+    channel["accel"] = state.servoMaxAccel[ch];
+  }
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleSetServoProfile(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/servo/profile");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "servo profile")) return;
+
+  // Без "id" — все каналы
+  int id = doc["id"] | -1;
+  int maxSpeed = doc["speed"] | -1;
+  int maxAccel = doc["accel"] | -1;
+
+  if (!doc["id"].isNull() && (id < SERVO_ID_MIN || id > SERVO_ID_MAX)) {
+    API_LOG_ERROR("Invalid servo ID: %d", id);
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid servo ID\"}");
+    return;
+  }
+  if (maxSpeed < 0 || maxSpeed > SERVO_SPEED_MAX || maxAccel < 0 || maxAccel > SERVO_ACCEL_MAX) {
+    API_LOG_ERROR("Invalid servo profile: speed=%d accel=%d", maxSpeed, maxAccel);
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid profile (speed 0-2000, accel 0-20000)\"}");
+    return;
+  }
+
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SERVO_PROFILE);
+  command.servoMask = doc["id"].isNull() ? 0xFFFF : (1 << id);
+  command.maxSpeed = maxSpeed;
+  command.maxAccel = maxAccel;
+  if (!postControlCommand(request, command)) return;
+  API_LOG("Servo profile: mask=0x%x speed=%d accel=%d", command.servoMask, maxSpeed, maxAccel);
+
+  JsonDocument response(apijson_allocator());
+  response["success"] = true;
+  response["mask"] = command.servoMask;
+  response["speed"] = maxSpeed;
+  response["accel"] = maxAccel;
+
+  sendJSONDocument(request, 200, response);
+}
+
+// ===== API калибровки сервоприводов =====
+
+static void addCalibration(JsonObject obj, uint8_t channel) {
+  ServoCalibration calibration;
+  bool custom;
+  servocal_get(channel, &calibration, &custom);
+
+  obj["channel"] = channel;
+  obj["custom"] = custom;
+  JsonArray points = obj["points"].to<JsonArray>();
+  for (uint8_t i = 0; i < calibration.count; i++) {
+    JsonArray point = points.add<JsonArray>();
+    point.add(calibration.points[i].angle);
+    point.add(calibration.points[i].pulse);
+  }
+}
+
+// Пересборка таблицы импульсов канала задачей управления
+static bool postCalibrationCommand(AsyncWebServerRequest* request, uint8_t channel) {
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SERVO_CALIBRATION);
+  command.servoMask = (1 << channel);
+  return postControlCommand(request, command);
+}
+
+static void sendCalibrationError(AsyncWebServerRequest* request, ServoCalResult result) {
+  API_LOG_ERROR("Servo calibration: %s", servocal_resultName(result));
+  char error[64];
+  snprintf(error, sizeof(error), "{\"error\":\"%s\"}", servocal_resultName(result));
+  sendJSONResponse(request, result == SERVOCAL_ERR_STORAGE ? 500 : 400, error);
+}
+
+void handleGetServoCalibration(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/servo/calibration");
+
+  JsonDocument doc(apijson_allocator());
+
+  if (request->hasParam("channel")) {
+    int channel = request->getParam("channel")->value().toInt();
+    if (channel < SERVO_ID_MIN || channel > SERVO_ID_MAX) {
+      sendCalibrationError(request, SERVOCAL_ERR_CHANNEL);
+      return;
+    }
+    addCalibration(doc.to<JsonObject>(), channel);
+  } else {
+    JsonArray channels = doc["channels"].to<JsonArray>();
+    for (int ch = SERVO_ID_MIN; ch <= SERVO_ID_MAX; ch++) {
+      addCalibration(channels.add<JsonObject>(), ch);
+    }
+  }
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleSetServoCalibration(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/servo/calibration");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "servo calibration")) return;
+
+  int channel = doc["channel"] | -1;
+  bool save = doc["save"] | true;
+  JsonArray points = doc["points"].as<JsonArray>();
+
+  if (channel < SERVO_ID_MIN || channel > SERVO_ID_MAX) {
+    sendCalibrationError(request, SERVOCAL_ERR_CHANNEL);
+    return;
+  }
+  if (points.isNull() || points.size() < 2 || points.size() > SERVOCAL_MAX_POINTS) {
+    sendCalibrationError(request, SERVOCAL_ERR_COUNT);
+    return;
+  }
+
+  // Точки — пары [угол, импульс]; диапазоны проверяет servocal_validate()
+  ServoCalibration calibration;
+  memset(&calibration, 0, sizeof(calibration));
+  calibration.count = points.size();
+  for (uint8_t i = 0; i < calibration.count; i++) {
+    int angle = points[i][0] | -1;
+    int pulse = points[i][1] | -1;
+    if (angle < SERVO_ANGLE_MIN || angle > SERVO_ANGLE_MAX) {
+      sendCalibrationError(request, SERVOCAL_ERR_ORDER);
+      return;
+    }
+    if (pulse < SERVOCAL_PULSE_MIN || pulse > SERVOCAL_PULSE_MAX) {
+      sendCalibrationError(request, SERVOCAL_ERR_PULSE);
+      return;
+    }
+    calibration.points[i].angle = angle;
+    calibration.points[i].pulse = pulse;
+  }
+
+  // В NVS — только после того, как пересборка таблицы поставлена в очередь;
+  // очередь заполнена — прежняя калибровка возвращается
+  ServoCalibration previous;
+  bool previousCustom = false;
+  servocal_get(channel, &previous, &previousCustom);
+
+  ServoCalResult result = servocal_set(channel, &calibration, false);
+  if (result != SERVOCAL_OK) {
+    sendCalibrationError(request, result);
+    return;
+  }
+  if (!postCalibrationCommand(request, channel)) {
+    servocal_restore(channel, &previous, previousCustom);
+    return;
+  }
+  if (save) {
+    // Калибровка уже действует, но только до перезагрузки
+    result = servocal_save(channel);
+    if (result != SERVOCAL_OK) {
+      sendCalibrationError(request, result);
+      return;
+    }
+  }
+
+  JsonDocument response(apijson_allocator());
+  response["success"] = true;
+  response["saved"] = save;
+  addCalibration(response["calibration"].to<JsonObject>(), channel);
+
+  sendJSONDocument(request, 200, response);
+}
+
+void handleResetServoCalibration(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/servo/calibration/reset");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "servo calibration reset")) return;
+
+  int channel = doc["channel"] | -1;
+  if (channel < SERVO_ID_MIN || channel > SERVO_ID_MAX) {
+    sendCalibrationError(request, SERVOCAL_ERR_CHANNEL);
+    return;
+  }
+
+  ServoCalibration previous;
+  bool previousCustom = false;
+  servocal_get(channel, &previous, &previousCustom);
+
+  servocal_reset(channel, false);
+  if (!postCalibrationCommand(request, channel)) {
+    servocal_restore(channel, &previous, previousCustom);
+    return;
+  }
+  servocal_save(channel);
+
+  JsonDocument response(apijson_allocator());
+  response["success"] = true;
+  addCalibration(response["calibration"].to<JsonObject>(), channel);
+
+  sendJSONDocument(request, 200, response);
 }
 
 // ===== API для управления камерой =====
 
-void handleGetCamera() {
-  api_log("GET /api/camera");
+void handleGetCamera(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/camera");
 
-  uint16_t panAngle, tiltAngle;
-  camera_getAngle(&panAngle, &tiltAngle);
+  ControlState state;
+  if (!readControlState(request, &state)) return;
 
-  JsonDocument doc;
-  doc["pan_angle"] = panAngle;
-  doc["tilt_angle"] = tiltAngle;
+  JsonDocument doc(apijson_allocator());
+  doc["pan_angle"] = state.panAngle;
+  doc["tilt_angle"] = state.tiltAngle;
 
-  String response;
-  serializeJson(doc, response);
-  sendJSONResponse(200, response);
+  sendJSONDocument(request, 200, doc);
 }
 
-void handleSetCameraAngle() {
-  api_log("POST /api/camera/angle");
+void handleSetCameraAngle(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/camera/angle");
 
-  JsonDocument doc;
-  if (!validateRequestBody(doc, "camera angle")) return;
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "camera angle")) return;
 
   uint16_t panAngle = doc["pan_angle"] | 90;
   uint16_t tiltAngle = doc["tilt_angle"] | 90;
 
   if (panAngle > 180 || tiltAngle > 180) {
-    api_log("ERROR: Invalid angle values (must be 0-180)");
-    sendJSONResponse(400, "{\"error\":\"Invalid angle (must be 0-180)\"}");
+    API_LOG_ERROR("Invalid angle values (must be 0-180)");
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid angle (must be 0-180)\"}");
     return;
   }
 
-  camera_setAngle(panAngle, tiltAngle);
-  api_log("Camera set: PAN=" + String(panAngle) + "°, TILT=" + String(tiltAngle) + "°");
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SETPOINT);
+  command.cameraMask = CONTROL_CAMERA_PAN | CONTROL_CAMERA_TILT;
+  command.pan = panAngle;
+  command.tilt = tiltAngle;
+  command.servoMove = servoMoveOf(doc);
+  if (!postControlCommand(request, command)) return;
+  API_LOG("Camera set: PAN=%u°, TILT=%u°", panAngle, tiltAngle);
 
-  JsonDocument response;
+  JsonDocument response(apijson_allocator());
   response["success"] = true;
   response["pan_angle"] = panAngle;
   response["tilt_angle"] = tiltAngle;
 
-  String jsonResponse;
-  serializeJson(response, jsonResponse);
-  sendJSONResponse(200, jsonResponse);
+  sendJSONDocument(request, 200, response);
 }
 
 // Для обратной совместимости - PWM endpoint
-void handleGetCameraPWM() {
-  api_log("GET /api/camera/pwm");
+void handleGetCameraPWM(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/camera/pwm");
 
-  uint16_t panPWM, tiltPWM;
-  camera_getPWM(&panPWM, &tiltPWM);
+  ControlState state;
+  if (!readControlState(request, &state)) return;
 
-  JsonDocument doc;
-  doc["pan_pwm"] = panPWM;
-  doc["tilt_pwm"] = tiltPWM;
+  JsonDocument doc(apijson_allocator());
+  doc["pan_pwm"] = state.panPWM;
+  doc["tilt_pwm"] = state.tiltPWM;
 
-  String response;
-  serializeJson(doc, response);
-  sendJSONResponse(200, response);
+  sendJSONDocument(request, 200, doc);
 }
 
-void handleSetCameraPWM() {
-  api_log("POST /api/camera/pwm");
+void handleSetCameraPWM(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/camera/pwm");
 
-  JsonDocument doc;
-  if (!validateRequestBody(doc, "camera pwm")) return;
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "camera pwm")) return;
 
   uint16_t panPWM = doc["pan_pwm"] | 1435;
   uint16_t tiltPWM = doc["tilt_pwm"] | 1435;
 
   if (panPWM > 4095 || tiltPWM > 4095) {
-    api_log("ERROR: Invalid PWM values");
-    sendJSONResponse(400, "{\"error\":\"Invalid PWM values (must be 0-4095)\"}");
+    API_LOG_ERROR("Invalid PWM values");
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid PWM values (must be 0-4095)\"}");
     return;
   }
 
-  camera_setPWM(panPWM, tiltPWM);
-  api_log("Camera PWM set: PAN=" + String(panPWM) + ", TILT=" + String(tiltPWM));
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_CAMERA_PWM);
+  command.pan = panPWM;
+  command.tilt = tiltPWM;
+  if (!postControlCommand(request, command)) return;
+  API_LOG("Camera PWM set: PAN=%u, TILT=%u", panPWM, tiltPWM);
 
-  JsonDocument response;
+  JsonDocument response(apijson_allocator());
   response["success"] = true;
   response["pan_pwm"] = panPWM;
   response["tilt_pwm"] = tiltPWM;
 
-  String jsonResponse;
-  serializeJson(response, jsonResponse);
-  sendJSONResponse(200, jsonResponse);
+  sendJSONDocument(request, 200, response);
 }
 
 // ===== API для управления моторами =====
 
-void handleGetMotors() {
-  api_log("GET /api/motor");
+void handleGetMotors(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/motor");
   
-  JsonDocument doc;
-  doc["motorA"] = motor_getSpeedA();
-  doc["motorB"] = motor_getSpeedB();
-  doc["motorC"] = motor_getSpeedC();
-  doc["motorD"] = motor_getSpeedD();
+  ControlState state;
+  if (!readControlState(request, &state)) return;
+
+  JsonDocument doc(apijson_allocator());
+  doc["motorA"] = state.motor[0];
+  doc["motorB"] = state.motor[1];
+  doc["motorC"] = state.motor[2];
+  doc["motorD"] = state.motor[3];
+
+  JsonObject output = doc["output"].to<JsonObject>();
+  output["motorA"] = state.motorOutput[0];
+  output["motorB"] = state.motorOutput[1];
+  output["motorC"] = state.motorOutput[2];
+  output["motorD"] = state.motorOutput[3];
   
-  String response;
-  serializeJson(doc, response);
-  sendJSONResponse(200, response);
+  sendJSONDocument(request, 200, doc);
 }
 
-void handleSetMotor() {
-  api_log("POST /api/motor");
-  
-  JsonDocument doc;
-  if (!validateRequestBody(doc, "motor")) return;
+void handleSetMotor(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/motor");
   
-  if (!setMotorIfValid(doc, "motorA", doc["motorA"], motor_setSpeedA)) return;
-  if (!setMotorIfValid(doc, "motorB", doc["motorB"], motor_setSpeedB)) return;
-  if (!setMotorIfValid(doc, "motorC", doc["motorC"], motor_setSpeedC)) return;
-  if (!setMotorIfValid(doc, "motorD", doc["motorD"], motor_setSpeedD)) return;
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "motor")) return;
   
-  JsonDocument response;
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_SETPOINT);
+
+  if (!setMotorIfValid(request, doc, "motorA", 0, &command)) return;
+  if (!setMotorIfValid(request, doc, "motorB", 1, &command)) return;
+  if (!setMotorIfValid(request, doc, "motorC", 2, &command)) return;
+  if (!setMotorIfValid(request, doc, "motorD", 3, &command)) return;
+
+  ControlState state;
+  if (!readControlState(request, &state)) return;
+  if (!postControlCommand(request, command)) return;
+
+  // Команда применится на следующем такте: отвечаем принятыми уставками,
+  // для незатронутых моторов — текущими скоростями
+  const char* motorNames[CONTROL_MOTOR_COUNT] = {"motorA", "motorB", "motorC", "motorD"};
+
+  JsonDocument response(apijson_allocator());
   response["success"] = true;
-  response["motorA"] = motor_getSpeedA();
-  response["motorB"] = motor_getSpeedB();
-  response["motorC"] = motor_getSpeedC();
-  response["motorD"] = motor_getSpeedD();
+  for (int i = 0; i < CONTROL_MOTOR_COUNT; i++) {
+    response[motorNames[i]] = (command.motorMask & (1 << i)) ? command.motor[i] : state.motor[i];
+  }
   
-  String jsonResponse;
-  serializeJson(response, jsonResponse);
-  sendJSONResponse(200, jsonResponse);
+  sendJSONDocument(request, 200, response);
 }
 
-void handleStopMotors() {
-  api_log("POST /api/motor/stop");
+void handleStopMotors(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/motor/stop");
   
-  motor_stopAll();
-  api_log("All motors stopped");
+  ControlCommand command;
+  control_initCommand(&command, CONTROL_CMD_STOP);
+  if (!postControlCommand(request, command)) return;
+  API_LOG("All motors stopped");
   
-  JsonDocument response;
+  JsonDocument response(apijson_allocator());
   response["success"] = true;
   response["message"] = "All motors stopped";
   
-  String jsonResponse;
-  serializeJson(response, jsonResponse);
-  sendJSONResponse(200, jsonResponse);
+  sendJSONDocument(request, 200, response);
 }
 
-// ===== Маршруты UI =====
+// ===== API аварийной остановки =====
+
+static void sendSafetyState(AsyncWebServerRequest* request, int code) {
+  SafetyStats stats;
+  safety_getStats(&stats);
+
+  JsonDocument doc(apijson_allocator());
+  doc["estop"] = stats.estop;
+  doc["source"] = safety_sourceName(stats.estopSource);
+  doc["estops"] = stats.estops;
+  doc["last_latency_us"] = stats.lastStopLatencyUs;
+  doc["max_latency_us"] = stats.maxStopLatencyUs;
+
+  JsonObject deadman = doc["deadman"].to<JsonObject>();
+  deadman["timeout_ms"] = stats.deadmanTimeoutMs;
+  deadman["tripped"] = stats.deadmanTripped;
+  deadman["trips"] = stats.deadmanTrips;
+  deadman["last_ramp_down_ms"] = stats.lastRampDownMs;
 
-void handleRoot() {
-  api_log("GET / (HTML page)");
-  ui_serveIndex(server);
+  ReflexStats reflex;
+  reflex_getStats(&reflex);
+  JsonObject reflexObj = doc["reflex"].to<JsonObject>();
+  reflexObj["active"] = reflex.active;
+  reflexObj["limit"] = reflex.limit;
+  if (reflex.rangeMm != REFLEX_RANGE_NONE) reflexObj["range_mm"] = reflex.rangeMm;
+  else reflexObj["range_mm"] = nullptr;
+  reflexObj["overrides"] = reflex.overrides;
+  reflexObj["clamps"] = reflex.clamps;
+  reflexObj["last_reaction_us"] = reflex.lastReactionUs;
+  reflexObj["max_reaction_us"] = reflex.maxReactionUs;
+
+  sendJSONDocument(request, code, doc);
 }
 
-void handleJoystickJS() {
-  ui_serveStaticFile(server, "/joystick.js", "application/javascript");
+// Остановка выполняется задачей safety, ответ не ждёт такта управления
+void handleEstop(AsyncWebServerRequest* request) {
+  int64_t receivedUs = esp_timer_get_time();
+  safety_estop(SAFETY_SOURCE_API, receivedUs);
+  API_LOG("POST /api/estop");
+  sendJSONResponse(request, 200, "{\"success\":true,\"estop\":true}");
 }
 
-void handleStyleCSS() {
-  ui_serveStaticFile(server, "/style.css", "text/css");
+void handleResetEstop(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/estop/reset");
+
+  if (!safety_clearEstop()) {
+    API_LOG_ERROR("E-stop button is still pressed");
+    sendJSONResponse(request, 409, "{\"error\":\"E-stop button is still pressed\"}");
+    return;
+  }
+  sendSafetyState(request, 200);
 }
 
-void handleMainJS() {
-  ui_serveStaticFile(server, "/main.js", "application/javascript");
+void handleGetSafety(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/safety");
+  sendSafetyState(request, 200);
 }
 
-void handleOptions() {
-  api_log("OPTIONS (CORS preflight)");
-  server.sendHeader("Access-Control-Allow-Origin", "*");
-  server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  server.send(204);
+// ===== API дальномера =====
+
+void handleGetLidar(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/lidar");
+
+  LidarStats stats;
+  lidar_getStats(&stats);
+
+  JsonDocument doc(apijson_allocator());
+  LidarFrame frame = {};
+  if (lidar_getFrame(&frame)) {
+    doc["frame"] = frame.seq;
+    doc["age_ms"] = (uint32_t)((esp_timer_get_time() - frame.timestampUs) / 1000);
+    doc["present_mask"] = frame.presentMask;
+    doc["valid_mask"] = frame.validMask;
+  }
+
+  // Направление i соответствует каналу i мультиплексора (i * 45°)
+  JsonArray sensors = doc["sensors"].to<JsonArray>();
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    LidarSensorStats sensorStats;
+    if (!lidar_getSensorStats(ch, &sensorStats) || !sensorStats.present) continue;
+
+    JsonObject sensor = sensors.add<JsonObject>();
+    sensor["channel"] = ch;
+    if (frame.seq != 0 && (frame.validMask & (1 << ch))) {
+      sensor["range_mm"] = frame.rangeMm[ch];
+      sensor["sample_age_ms"] = frame.ageMs[ch];
+    }
+    sensor["samples"] = sensorStats.samples;
+    sensor["invalid"] = sensorStats.invalid;
+    sensor["errors"] = sensorStats.errors;
+    sensor["timeouts"] = sensorStats.timeouts;
+    sensor["latency_us"] = sensorStats.lastLatencyUs;
+    sensor["max_latency_us"] = sensorStats.maxLatencyUs;
+  }
+
+  doc["samples"] = stats.samples;
+  doc["invalid"] = stats.invalid;
+  doc["rate_hz"] = stats.rateHz;
+  doc["frames"] = stats.frames;
+  doc["mux_selects"] = stats.muxSelects;
+  doc["mux_skipped"] = stats.muxSkipped;
+
+  sendJSONDocument(request, 200, doc);
+}
+
+// ===== API скана дальномером =====
+
+void handleGetScan(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/scan");
+
+  ScanConfig config;
+  ScanStats stats;
+  scan_getConfig(&config);
+  scan_getStats(&stats);
+
+  JsonDocument doc(apijson_allocator());
+  doc["enabled"] = config.enabled;
+  doc["start"] = config.startAngle;
+  doc["end"] = config.endAngle;
+  doc["step"] = config.stepDeg;
+  doc["settle_ms"] = config.settleMs;
+  doc["points"] = stats.points;
+  doc["sweeps"] = stats.sweeps;
+  doc["timeouts"] = stats.timeouts;
+  doc["dropped"] = stats.dropped;
+  doc["points_per_sec"] = stats.pointsPerSec;
+  doc["expected_points_per_sec"] = stats.expectedPointsPerSec;
+  doc["last_sweep_ms"] = stats.lastSweepMs;
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleSetScan(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/scan");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "scan")) return;
+
+  ScanConfig config;
+  scan_getConfig(&config);
+  config.enabled = doc["enabled"] | config.enabled;
+  config.startAngle = doc["start"] | config.startAngle;
+  config.endAngle = doc["end"] | config.endAngle;
+  config.stepDeg = doc["step"] | config.stepDeg;
+  config.settleMs = doc["settle_ms"] | config.settleMs;
+
+  if (!scan_configure(config)) {
+    API_LOG_ERROR("Invalid scan config");
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid scan config (0 <= start < end <= 180, 1 <= step <= end - start)\"}");
+    return;
+  }
+
+  API_LOG("Scan %s: %u-%u° step %u°, settle %u ms", config.enabled ? "on" : "off",
+          config.startAngle, config.endAngle, config.stepDeg, config.settleMs);
+  sendJSONResponse(request, 200, "{\"success\":true}");
 }
 
-void handleNotFound() {
-  String message = "Not Found: " + String(server.method()) + " " + server.uri();
-  api_log(message);
+// ===== API планировщика =====
+
+void handleGetSched(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/sched");
+
+  JsonDocument doc(apijson_allocator());
+  doc["tick_us"] = SCHED_TICK_US;
+  JsonArray jobs = doc["jobs"].to<JsonArray>();
+
+  for (int i = 0; i < sched_jobCount(); i++) {
+    SchedJobStats stats;
+    if (!sched_getStats(i, &stats)) continue;
+
+    JsonObject job = jobs.add<JsonObject>();
+    job["name"] = stats.name;
+    job["period_us"] = stats.periodUs;
+    job["budget_us"] = stats.budgetUs;
+    job["priority"] = stats.priority;
+    job["runs"] = stats.runs;
+    job["overruns"] = stats.overruns;
+    job["missed"] = stats.missed;
+    job["last_us"] = stats.lastUs;
+    job["avg_us"] = stats.avgUs;
+    job["wcet_us"] = stats.wcetUs;
+    job["jitter_us"] = stats.lastJitterUs;
+    job["max_jitter_us"] = stats.maxJitterUs;
+  }
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleResetSched(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/sched/reset");
+
+  sched_resetStats();
+  sendJSONResponse(request, 200, "{\"success\":true}");
+}
+
+// ===== API статистики маршрутов =====
+
+void handleGetRoutes(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/routes");
+
+  JsonDocument doc(apijson_allocator());
+  JsonArray limits = doc["hist_us"].to<JsonArray>();
+  for (int i = 0; i < APISTATS_BUCKETS - 1; i++) limits.add(apistats_bucketLimitUs(i));
+
+  // Только маршруты с запросами — ответ ограничен APIJSON_RESPONSE_SIZE
+  JsonArray routes = doc["routes"].to<JsonArray>();
+  for (int i = 0; i < apistats_routeCount(); i++) {
+    ApiRouteStats stats;
+    if (!apistats_getRoute(i, &stats) || stats.requests == 0) continue;
+
+    JsonObject route = routes.add<JsonObject>();
+    route["method"] = stats.method;
+    route["path"] = stats.path;
+    route["requests"] = stats.requests;
+    route["total_us"] = stats.totalUs;
+    route["max_us"] = stats.maxUs;
+    route["allocs"] = stats.allocs;
+    route["bytes"] = stats.bytes;
+
+    // Гистограмма без хвоста из пустых корзин
+    int last = APISTATS_BUCKETS - 1;
+    while (last > 0 && stats.histogram[last] == 0) last--;
+    JsonArray histogram = route["hist"].to<JsonArray>();
+    for (int b = 0; b <= last; b++) histogram.add(stats.histogram[b]);
+  }
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleResetRoutes(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/routes/reset");
+
+  apistats_reset();
+  sendJSONResponse(request, 200, "{\"success\":true}");
+}
+
+// ===== API логирования =====
+
+static void sendLogState(AsyncWebServerRequest* request) {
+  LogStats stats;
+  log_getStats(&stats);
+
+  JsonDocument doc(apijson_allocator());
+  doc["level"] = log_getLevel();
+  doc["max_level"] = LOG_LEVEL;
+  doc["written"] = stats.written;
+  doc["dropped"] = stats.dropped;
+  doc["truncated"] = stats.truncated;
+  doc["max_pending"] = stats.maxPending;
+
+  sendJSONDocument(request, 200, doc);
+}
+
+void handleGetLog(AsyncWebServerRequest* request) {
+  API_LOG("GET /api/log");
+  sendLogState(request);
+}
+
+void handleSetLog(AsyncWebServerRequest* request) {
+  API_LOG("POST /api/log");
+
+  JsonDocument doc(apijson_allocator());
+  if (!validateRequestBody(request, doc, "log")) return;
+
+  if (!doc["level"].is<int>()) {
+    API_LOG_ERROR("Missing log level");
+    sendJSONResponse(request, 400, "{\"error\":\"Missing level (0-4)\"}");
+    return;
+  }
+
+  int level = doc["level"];
+  if (level < LOG_LEVEL_NONE || level > LOG_LEVEL_DEBUG) {
+    API_LOG_ERROR("Invalid log level: %d", level);
+    sendJSONResponse(request, 400, "{\"error\":\"Invalid level (0-4)\"}");
+    return;
+  }
+
+  log_setLevel(level);
+  sendLogState(request);
+}
+
+// ===== Служебные маршруты =====
+
+void handleOptions(AsyncWebServerRequest* request) {
+  API_LOG("OPTIONS (CORS preflight)");
+  request->send(204);
+}
+
+void handleNotFound(AsyncWebServerRequest* request) {
+  if (request->method() == HTTP_OPTIONS) {
+    handleOptions(request);
+    return;
+  }
+
+  API_LOG("Not Found: %s %s", request->methodToString(), request->url().c_str());
   
-  if (server.uri().startsWith("/api/")) {
-    sendJSONResponse(404, "{\"error\":\"Endpoint not found\"}");
+  if (request->url().startsWith("/api/")) {
+    sendJSONResponse(request, 404, "{\"error\":\"Endpoint not found\"}");
   } else {
-    server.send(404, "text/plain", "404 Not Found");
+    request->send(404, "text/plain", "404 Not Found");
   }
 }
 
+// Обработчик с замером времени, выделений и байт ответа по маршруту (apistats)
+static ArRequestHandlerFunction timed(const char* method, const char* path, ArRequestHandlerFunction handler) {
+  int route = apistats_addRoute(method, path);
+  return [route, handler](AsyncWebServerRequest* request) {
+    ApiStatsProbe probe;
+    apistats_begin(&probe);
+    handler(request);
+    apistats_end(route, &probe);
+  };
+}
+
+static void onGet(const char* path, ArRequestHandlerFunction handler) {
+  server.on(path, HTTP_GET, timed("GET", path, handler));
+}
+
+static void onPost(const char* path, ArRequestHandlerFunction handler) {
+  server.on(path, HTTP_POST, timed("POST", path, handler));
+}
+
+// POST с JSON телом: обработчик вызывается после получения всего тела
+static void onJsonPost(const char* path, ArRequestHandlerFunction handler) {
+  server.on(path, HTTP_POST, timed("POST", path, handler), NULL, collectRequestBody);
+}
+
 // ===== Инициализация =====
 
 void api_init() {
   Serial.println("\n=== API Initialization ===");
+
+  // CORS заголовки для всех ответов
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
   
-  // Маршруты UI
-  server.on("/", HTTP_GET, handleRoot);
-  server.on("/joystick.js", HTTP_GET, handleJoystickJS);
-  server.on("/style.css", HTTP_GET, handleStyleCSS);
-  server.on("/main.js", HTTP_GET, handleMainJS);
+  // Маршруты UI (таблица встроенных файлов / манифест LittleFS)
+  ui_registerRoutes(server);
   
   // OTA маршруты
   apiota_init(server);
   
   // Маршруты API
-  server.on("/api/status", HTTP_GET, handleStatus);
-  server.on("/api/servo", HTTP_GET, handleGetServos);
-  server.on("/api/servo", HTTP_POST, handleSetServo);
+  // Маршрут "/api/x" совпадает и с "/api/x/..." — вложенные регистрируются первыми
+  onGet("/api/status", handleStatus);
+  onJsonPost("/api/servo/calibration/reset", handleResetServoCalibration);
+  onGet("/api/servo/calibration", handleGetServoCalibration);
+  onJsonPost("/api/servo/calibration", handleSetServoCalibration);
+  onGet("/api/servo/profile", handleGetServoProfile);
+  onJsonPost("/api/servo/profile", handleSetServoProfile);
+  onGet("/api/servo", handleGetServos);
+  onJsonPost("/api/servo/batch", handleSetServoBatch);
+  onJsonPost("/api/servo", handleSetServo);
   
   // Маршруты для управления камерой
-  server.on("/api/camera", HTTP_GET, handleGetCamera);
-  server.on("/api/camera/angle", HTTP_POST, handleSetCameraAngle);
-  server.on("/api/camera/pwm", HTTP_GET, handleGetCameraPWM);
-  server.on("/api/camera/pwm", HTTP_POST, handleSetCameraPWM);
+  onGet("/api/camera", handleGetCamera);
+  onJsonPost("/api/camera/angle", handleSetCameraAngle);
+  onGet("/api/camera/pwm", handleGetCameraPWM);
+  onJsonPost("/api/camera/pwm", handleSetCameraPWM);
 
   // Маршруты для управления моторами
-  server.on("/api/motor", HTTP_GET, handleGetMotors);
-  server.on("/api/motor", HTTP_POST, handleSetMotor);
-  server.on("/api/motor/stop", HTTP_POST, handleStopMotors);
+  onPost("/api/motor/stop", handleStopMotors);
+  onGet("/api/motor", handleGetMotors);
+  onJsonPost("/api/motor", handleSetMotor);
+
+  // Аварийная остановка и deadman
+  onPost("/api/estop/reset", handleResetEstop);
+  onPost("/api/estop", handleEstop);
+  onGet("/api/safety", handleGetSafety);
+
+  // Дальномер
+  onGet("/api/lidar", handleGetLidar);
+
+  // Скан дальномером на pan-сервоприводе
+  onGet("/api/scan", handleGetScan);
+  onJsonPost("/api/scan", handleSetScan);
+
+  // Статистика планировщика
+  onPost("/api/sched/reset", handleResetSched);
+  onGet("/api/sched", handleGetSched);
+
+  // Время обработчиков, выделения и байты ответов по маршрутам
+  onPost("/api/routes/reset", handleResetRoutes);
+  onGet("/api/routes", handleGetRoutes);
+
+  // Уровень и статистика логирования
+  onGet("/api/log", handleGetLog);
+  onJsonPost("/api/log", handleSetLog);
   
-  // Обработчик неизвестных маршрутов
-  server.onNotFound(handleNotFound);
+  // Обработчик неизвестных маршрутов и CORS preflight
+  server.onNotFound(timed("*", "(not found)", handleNotFound));
   
+  // Запросы обслуживаются задачей async_tcp по событиям — опрос в цикле не нужен
   server.begin();
   Serial.println("HTTP server started on port " + String(HTTP_PORT));
 }
-
-void api_loop() {
-  server.handleClient();
-}
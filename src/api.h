@@ -3,10 +3,7 @@
 
 #include <Arduino.h>
 
-// Инициализация API сервера
+// Инициализация и запуск асинхронного API сервера (запросы обрабатываются задачей async_tcp)
 void api_init();
 
-// Обработка клиентских запросов (должна вызываться в loop)
-void api_loop();
-
 #endif
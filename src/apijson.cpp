@@ -0,0 +1,151 @@
+#include "apijson.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// ===== Константы =====
+
+#define APIJSON_ALIGN 8
+
+// ===== Структуры данных =====
+
+// Заголовок блока арены: размер нужен для reallocate
+struct ArenaBlock {
+  uint32_t size;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(ArenaBlock) % APIJSON_ALIGN == 0, "ArenaBlock must keep payload aligned");
+
+// ===== Глобальные переменные =====
+
+static uint8_t arena[APIJSON_ARENA_SIZE] __attribute__((aligned(APIJSON_ALIGN)));
+static size_t arenaUsed = 0;          // смещение следующего блока
+static size_t arenaLast = SIZE_MAX;   // смещение последнего блока (можно расти на месте)
+static uint32_t arenaLive = 0;        // неосвобождённых блоков арены
+
+static uint32_t allocsAtLastResponse = 0;
+
+static ApiJsonStats stats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// ===== Вспомогательные функции =====
+
+static size_t alignUp(size_t size) {
+  return (size + APIJSON_ALIGN - 1) & ~(size_t)(APIJSON_ALIGN - 1);
+}
+
+static bool inArena(const void* ptr) {
+  return ptr >= (const void*)arena && ptr < (const void*)(arena + APIJSON_ARENA_SIZE);
+}
+
+static ArenaBlock* blockOf(void* ptr) {
+  return (ArenaBlock*)((uint8_t*)ptr - sizeof(ArenaBlock));
+}
+
+static void* arenaAllocate(size_t size) {
+  size_t need = sizeof(ArenaBlock) + alignUp(size);
+  if (arenaUsed + need > APIJSON_ARENA_SIZE) return NULL;
+
+  ArenaBlock* block = (ArenaBlock*)(arena + arenaUsed);
+  block->size = size;
+  arenaLast = arenaUsed;
+  arenaUsed += need;
+  arenaLive++;
+  if (arenaUsed > stats.arenaPeak) stats.arenaPeak = arenaUsed;
+  stats.arenaAllocs++;
+  return block + 1;
+}
+
+// Последний блок меняет размер на месте, не занимая новую память арены
+static bool arenaResizeLast(void* ptr, size_t size) {
+  size_t offset = (uint8_t*)blockOf(ptr) - arena;
+  if (offset != arenaLast) return false;
+
+  size_t end = offset + sizeof(ArenaBlock) + alignUp(size);
+  if (end > APIJSON_ARENA_SIZE) return false;
+
+  blockOf(ptr)->size = size;
+  arenaUsed = end;
+  if (arenaUsed > stats.arenaPeak) stats.arenaPeak = arenaUsed;
+  return true;
+}
+
+static void* heapAllocate(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr != NULL) stats.heapAllocs++;
+  return ptr;
+}
+
+// ===== Аллокатор =====
+
+class ArenaAllocator : public ArduinoJson::Allocator {
+ public:
+  void* allocate(size_t size) override {
+    void* ptr = arenaAllocate(size);
+    return ptr != NULL ? ptr : heapAllocate(size);
+  }
+
+  void deallocate(void* ptr) override {
+    if (ptr == NULL) return;
+    if (!inArena(ptr)) {
+      free(ptr);
+      return;
+    }
+
+    // Арена освобождается целиком, когда не осталось живых блоков
+    if (arenaLive > 0) arenaLive--;
+    if (arenaLive == 0) {
+      arenaUsed = 0;
+      arenaLast = SIZE_MAX;
+    }
+  }
+
+  void* reallocate(void* ptr, size_t size) override {
+    if (ptr == NULL) return allocate(size);
+    if (!inArena(ptr)) return realloc(ptr, size);
+    if (arenaResizeLast(ptr, size)) return ptr;
+
+    void* moved = allocate(size);
+    if (moved == NULL) return NULL;
+    size_t oldSize = blockOf(ptr)->size;
+    memcpy(moved, ptr, oldSize < size ? oldSize : size);
+    deallocate(ptr);
+    return moved;
+  }
+};
+
+static ArenaAllocator allocator;
+
+// ===== Публичные функции =====
+
+ArduinoJson::Allocator* apijson_allocator() {
+  return &allocator;
+}
+
+size_t apijson_measure(const JsonDocument& doc) {
+  size_t length = measureJson(doc);
+  if (length > APIJSON_RESPONSE_SIZE) {
+    stats.overflows++;
+    return 0;
+  }
+  return length;
+}
+
+void apijson_countResponse(size_t length, uint32_t bufferAllocs) {
+  stats.bufferAllocs += bufferAllocs;
+  uint32_t allocs = apijson_totalAllocs(&stats);
+  stats.responses++;
+  stats.lastAllocs = allocs - allocsAtLastResponse;
+  if (stats.lastAllocs > stats.maxAllocs) stats.maxAllocs = stats.lastAllocs;
+  stats.lastLength = length;
+  allocsAtLastResponse = allocs;
+}
+
+uint32_t apijson_totalAllocs(const ApiJsonStats* stats) {
+  return stats->arenaAllocs + stats->heapAllocs + stats->bufferAllocs;
+}
+
+void apijson_getStats(ApiJsonStats* out) {
+  if (out == NULL) return;
+  *out = stats;
+}
@@ -0,0 +1,51 @@
+#ifndef _APIJSON_H
+#define _APIJSON_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Сериализация JSON ответов API без промежуточных String.
+// JsonDocument получает память из статической арены (apijson_allocator), а ответ
+// сериализуется напрямую в буфер ответа соединения (AsyncResponseStream). Этот
+// буфер не статический: библиотека выделяет его из кучи на каждый ответ, размером
+// по measureJson (не больше APIJSON_RESPONSE_SIZE), — он учитывается в bufferAllocs
+// вместе с копией String готового JSON в request->send().
+// Арена сбрасывается, когда освобождён последний документ; при её исчерпании
+// память берётся из кучи и учитывается отдельно (heapAllocs).
+// Все функции вызываются только из задачи async_tcp (обработчики HTTP).
+
+// ===== Константы =====
+
+#define APIJSON_ARENA_SIZE 8192       // байт арены для JsonDocument
+#define APIJSON_RESPONSE_SIZE 4096    // максимальный размер JSON ответа
+
+// ===== Структуры данных =====
+
+struct ApiJsonStats {
+  uint32_t responses;         // отправлено ответов
+  uint32_t arenaAllocs;       // выделений из арены (всего)
+  uint32_t heapAllocs;        // выделений из кучи, когда арена исчерпана (всего)
+  uint32_t bufferAllocs;      // буферов тела ответа из кучи при отправке (всего)
+  uint32_t lastAllocs;        // выделений при подготовке последнего ответа
+  uint32_t maxAllocs;         // максимум выделений на один ответ
+  uint32_t arenaPeak;         // максимальная занятость арены, байт
+  uint32_t overflows;         // ответов, не поместившихся в буфер
+  uint32_t lastLength;        // длина последнего ответа, байт
+};
+
+// Аллокатор для JsonDocument: JsonDocument doc(apijson_allocator());
+ArduinoJson::Allocator* apijson_allocator();
+
+// Размер сериализованного документа или 0, если он больше APIJSON_RESPONSE_SIZE
+size_t apijson_measure(const JsonDocument& doc);
+
+// Учёт отправленного ответа (выделения с предыдущего ответа относятся к этому).
+// bufferAllocs — выделений из кучи при отправке: буфер AsyncResponseStream или копия String
+void apijson_countResponse(size_t length, uint32_t bufferAllocs);
+
+// Выделений при подготовке ответов (арена, куча, буферы ответа) с запуска
+uint32_t apijson_totalAllocs(const ApiJsonStats* stats);
+
+void apijson_getStats(ApiJsonStats* stats);
+
+#endif
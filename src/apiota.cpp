@@ -2,208 +2,583 @@
 
 #include <Arduino.h>
 #include <Update.h>
-#include <WebServer.h>
 #include <LittleFS.h>
 #include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
 
 #include "ui.h"
+#include "log.h"
+#include "gunzip.h"
+#include "delta.h"
+#include "otawriter.h"
+#include "scheduler.h"
 
 // ===== Константы =====
 
-#define OTA_REBOOT_DELAY_MS 1000
+#define OTA_LOG(fmt, ...) LOG_I("OTA", fmt, ##__VA_ARGS__)
+#define OTA_LOG_ERROR(fmt, ...) LOG_E("OTA", "ERROR: " fmt, ##__VA_ARGS__)
+
+#define OTA_REBOOT_DELAY_MS 1000     // время на отправку ответа перед перезагрузкой
 #define OTA_MAX_FILE_SIZE 6553600  // Максимальный размер файла для OTA (6.25 MB)
+#define OTA_SHA256_SIZE 32
+
+// Образ LittleFS: суперблок в начале первого блока, "littlefs" по смещению 8
+#define OTA_FS_MAGIC "littlefs"
+#define OTA_FS_MAGIC_OFFSET 8
+#define OTA_FS_MAGIC_SIZE 8
+
+// Начало данных после распаковки: по нему выбирается дельта-патч и проверяется суперблок
+#define OTA_HEAD_SIZE (OTA_FS_MAGIC_OFFSET + OTA_FS_MAGIC_SIZE)
 
 // ===== Глобальные переменные =====
 
-extern WebServer server;
+static AsyncWebServerRequest* otaRequest = NULL;   // загрузка, владеющая Update (одна за раз)
+static int otaCommand = U_FLASH;                   // U_FLASH — прошивка, U_SPIFFS — образ LittleFS
 static bool otaUpdateSuccess = false;
+static unsigned long otaRebootAt = 0;             // 0 — перезагрузка не запланирована
 static String otaErrorMessage = "";
+static bool otaFsBusy = false;             // образ LittleFS отклонён: файлы ещё отправляются
 static unsigned long otaStartTime = 0;
-static size_t otaTotalBytesWritten = 0;
+static unsigned long otaElapsedTime = 0;
+static size_t otaTotalBytesWritten = 0;    // байт образа (после распаковки)
+static size_t otaUploadBytes = 0;          // байт принято (сжатых для gzip)
 static int otaChunkCount = 0;
 
+// Сжатая загрузка (gzip): распаковка на лету
+static bool otaCompressed = false;
+static Gunzip* otaGunzip = NULL;
+
+// Дельта-патч: образ собирается из работающего раздела и патча (после распаковки)
+static Delta* otaDelta = NULL;
+static bool otaIsDelta = false;
+static size_t otaPayloadBytes = 0;         // байт после распаковки (патч или образ)
+static uint8_t otaHead[OTA_HEAD_SIZE];     // первые байты: распаковка может отдать их по частям
+static size_t otaHeadLength = 0;
+static const esp_partition_t* otaBasePartition = NULL;
+
+// Данные загрузки идут через буферы otawriter (после успешного Update.begin)
+static bool otaWriting = false;
+static OtaWriterStats otaWriterStats;
+static SchedJobStats otaControlStats;     // такт управления за время загрузки
+
+// SHA-256 образа считается по мере записи; ожидаемый — параметр ?sha256=
+static mbedtls_sha256_context otaSha256;
+static uint8_t otaExpectedSha256[OTA_SHA256_SIZE];
+static bool otaCheckSha256 = false;
+static char otaSha256Hex[OTA_SHA256_SIZE * 2 + 1] = "";
+
+// Память: свободно (куча + PSRAM) до начала и минимум во время загрузки
+static uint32_t otaHeapStart = 0;
+static uint32_t otaHeapMin = 0;
+
 // ===== Вспомогательные функции =====
 
-void apiota_log(const String& message) {
-  Serial.println("[OTA] " + message);
+static void logPartitionInfo(const esp_partition_t* partition, const char* name) {
+  OTA_LOG("%s partition: %s @ 0x%x, size: %u bytes", name, partition->label,
+          (unsigned)partition->address, (unsigned)partition->size);
+}
+
+static void sendOTAError(AsyncWebServerRequest* request, int code, const String& message) {
+  request->send(code, "application/json", "{\"error\":\"" + message + "\"}");
 }
 
-static void logPartitionInfo(const esp_partition_t* partition, const String& name) {
-  apiota_log(name + " partition: " + String(partition->label) + 
-             " @ 0x" + String(partition->address, HEX) + 
-             ", size: " + String(partition->size) + " bytes");
+static void sendOTASuccess(AsyncWebServerRequest* request, const char* message) {
+  char json[640];
+  snprintf(json, sizeof(json),
+           "{\"success\":true,\"message\":\"%s\","
+           "\"compressed\":%s,\"delta\":%s,\"upload_bytes\":%u,\"image_bytes\":%u,\"elapsed_ms\":%lu,"
+           "\"kbps\":%.1f,\"peak_heap_bytes\":%u,\"sha256\":\"%s\","
+           "\"writer\":{\"buffer_bytes\":%u,\"psram\":%s,\"flushes\":%u,\"avg_flush_ms\":%u,"
+           "\"max_flush_ms\":%u,\"stalls\":%u,\"stall_ms\":%u,\"max_stall_ms\":%u},"
+           "\"control\":{\"runs\":%u,\"missed\":%u,\"overruns\":%u,\"max_jitter_us\":%u,\"wcet_us\":%u}}",
+           message, otaCompressed ? "true" : "false", otaIsDelta ? "true" : "false", (unsigned)otaUploadBytes, (unsigned)otaTotalBytesWritten,
+           otaElapsedTime, otaElapsedTime ? otaUploadBytes / 1.024 / otaElapsedTime : 0.0,
+           (unsigned)(otaHeapStart - otaHeapMin), otaSha256Hex,
+           (unsigned)otaWriterStats.bufferSize, otaWriterStats.psram ? "true" : "false", (unsigned)otaWriterStats.flushes,
+           (unsigned)(otaWriterStats.flushes ? otaWriterStats.flushUs / otaWriterStats.flushes / 1000 : 0),
+           (unsigned)(otaWriterStats.maxFlushUs / 1000), (unsigned)otaWriterStats.stalls,
+           (unsigned)(otaWriterStats.stallUs / 1000), (unsigned)(otaWriterStats.maxStallUs / 1000),
+           (unsigned)otaControlStats.runs, (unsigned)otaControlStats.missed, (unsigned)otaControlStats.overruns,
+           (unsigned)otaControlStats.maxJitterUs, (unsigned)otaControlStats.wcetUs);
+  AsyncWebServerResponse* response = request->beginResponse(200, "application/json", json);
+  response->addHeader("Connection", "close");
+  request->send(response);
 }
 
-static void sendOTAError(const String& message) {
-  server.send(500, "application/json", "{\"error\":\"" + message + "\"}");
+static uint32_t freeMemory() {
+  return ESP.getFreeHeap() + ESP.getFreePsram();
 }
 
-static void sendOTASuccess() {
-  server.sendHeader("Connection", "close");
-  server.send(200, "application/json", 
-               "{\"success\":true,\"message\":\"Firmware uploaded successfully. Rebooting...\"}");
+static void trackMemory() {
+  uint32_t free = freeMemory();
+  if (free < otaHeapMin) otaHeapMin = free;
+}
+
+static bool parseSha256(const String& hex, uint8_t digest[OTA_SHA256_SIZE]) {
+  if (hex.length() != OTA_SHA256_SIZE * 2) return false;
+  for (int i = 0; i < OTA_SHA256_SIZE; i++) {
+    char byte[3] = {hex[i * 2], hex[i * 2 + 1], 0};
+    char* end;
+    digest[i] = (uint8_t)strtoul(byte, &end, 16);
+    if (*end != 0) return false;
+  }
+  return true;
+}
+
+// Освобождение распаковщика и SHA-256 (успех, ошибка или обрыв загрузки)
+static void releaseStream() {
+  if (otaGunzip != NULL) {
+    gunzip_destroy(otaGunzip);
+    otaGunzip = NULL;
+  }
+  if (otaDelta != NULL) {
+    delta_destroy(otaDelta);
+    otaDelta = NULL;
+  }
+  mbedtls_sha256_free(&otaSha256);
+}
+
+// Запись части образа: Update (MD5 по ?md5= проверит Update.end) и SHA-256
+static bool writeImage(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  size_t written = Update.write((uint8_t*)data, length);
+  otaTotalBytesWritten += written;
+  mbedtls_sha256_update(&otaSha256, data, written);
+
+  if (written != length) {
+    OTA_LOG_ERROR("Update.write() failed - %s", Update.errorString());
+    OTA_LOG("Written: %u, Expected: %u", (unsigned)written, (unsigned)length);
+    OTA_LOG("Error code: %u", Update.getError());
+    otaErrorMessage = "Update.write() failed: " + String(Update.errorString());
+    return false;
+  }
+  return true;
+}
+
+// База дельта-патча — образ в работающем разделе
+static bool readBase(uint32_t offset, uint8_t* data, size_t length, void* context) {
+  (void)context;
+  return esp_partition_read(otaBasePartition, offset, data, length) == ESP_OK;
+}
+
+// Образ или патч после выбора по первым байтам
+static bool dispatchPayload(const uint8_t* data, size_t length) {
+  if (otaDelta == NULL) return writeImage(data, length, NULL);
+
+  DeltaStatus status = delta_write(otaDelta, data, length);
+  if (status != DELTA_OK && otaErrorMessage.length() == 0) {
+    otaErrorMessage = delta_statusName(status);
+  }
+  return status == DELTA_OK;
+}
+
+// Начало данных собрано (или данные кончились раньше): дельта-патч прошивки по
+// сигнатуре, для LittleFS — проверка суперблока до первой записи, пока раздел не стёрт
+static bool startPayload() {
+  if (otaCommand == U_SPIFFS &&
+      (otaHeadLength < OTA_HEAD_SIZE ||
+       memcmp(otaHead + OTA_FS_MAGIC_OFFSET, OTA_FS_MAGIC, OTA_FS_MAGIC_SIZE) != 0)) {
+    otaErrorMessage = "Not a LittleFS image";
+    return false;
+  }
+
+  if (otaCommand == U_FLASH && delta_isDelta(otaHead, otaHeadLength)) {
+    otaBasePartition = esp_ota_get_running_partition();
+    otaDelta = delta_create(readBase, writeImage, NULL);
+    if (otaDelta == NULL) {
+      otaErrorMessage = delta_statusName(DELTA_ERR_MEMORY);
+      return false;
+    }
+    otaIsDelta = true;
+    OTA_LOG("Delta patch against %s, state: %u bytes", otaBasePartition->label, (unsigned)delta_memoryBytes());
+  }
+  return otaHeadLength == 0 || dispatchPayload(otaHead, otaHeadLength);
+}
+
+// Распакованные данные загрузки: первые OTA_HEAD_SIZE байт копятся через
+// границы частей (inflate может отдать их понемногу), затем — без копирования
+static bool writePayload(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  otaPayloadBytes += length;
+
+  if (otaHeadLength < OTA_HEAD_SIZE) {
+    size_t count = OTA_HEAD_SIZE - otaHeadLength < length ? OTA_HEAD_SIZE - otaHeadLength : length;
+    memcpy(otaHead + otaHeadLength, data, count);
+    otaHeadLength += count;
+    data += count;
+    length -= count;
+    if (otaHeadLength < OTA_HEAD_SIZE) return true;
+    if (!startPayload()) return false;
+  }
+  return length == 0 || dispatchPayload(data, length);
+}
+
+// Буфер загрузки в задаче otawriter: распаковка, дельта, запись во flash
+static bool processUpload(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  bool ok;
+  if (otaGunzip != NULL) {
+    GunzipStatus status = gunzip_write(otaGunzip, data, length);
+    if (status != GUNZIP_OK && otaErrorMessage.length() == 0) {
+      otaErrorMessage = gunzip_statusName(status);
+    }
+    ok = status == GUNZIP_OK;
+  } else {
+    ok = writePayload(data, length, NULL);
+  }
+  trackMemory();
+  return ok;
+}
+
+// Статистика задачи "control" планировщика
+static void getControlStats(SchedJobStats* stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (int i = 0; i < sched_jobCount(); i++) {
+    if (sched_getStats(i, stats) && strcmp(stats->name, "control") == 0) return;
+  }
+  memset(stats, 0, sizeof(*stats));
+}
+
+// Ошибка обработки: otaErrorMessage пишет задача otawriter, читать его можно
+// только после того, как она закончила с текущим буфером
+static void abortUpload() {
+  otawriter_abort();
+  otaWriting = false;
+  OTA_LOG_ERROR("%s", otaErrorMessage.c_str());
+  Update.abort();
+  releaseStream();
 }
 
 // ===== Обработчики =====
 
-void handleOtaPage() {
-  apiota_log("GET /api/ota (OTA page)");
+void handleOtaPage(AsyncWebServerRequest* request) {
+  OTA_LOG("GET /api/ota (OTA page)");
 
   if (!ui_fileExists("/ota.html")) {
-    apiota_log("ERROR: ota.html not found");
-    server.send(404, "text/plain", "OTA page not found");
+    OTA_LOG_ERROR("ota.html not found");
+    request->send(404, "text/plain", "OTA page not found");
     return;
   }
 
-  File file = LittleFS.open("/ota.html", "r");
-  if (file) {
-    server.streamFile(file, "text/html");
-    file.close();
-  }
+  ui_serveStaticFile(request, "/ota.html", "text/html");
 }
 
-void handleOtaUpload() {
-  HTTPUpload& upload = server.upload();
+// Части файла приходят по мере приёма: index == 0 — начало, final — последняя часть.
+// command — раздел: U_FLASH (следующий OTA-раздел прошивки) или U_SPIFFS (LittleFS).
+static void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                         uint8_t* data, size_t len, bool final, int command) {
+  if (index == 0) {
+    // Вторая загрузка, пока идёт первая, не должна писать в тот же раздел
+    if (otaRequest != NULL) {
+      OTA_LOG_ERROR("Another OTA upload is in progress");
+      return;
+    }
+    otaRequest = request;
+    request->onDisconnect([request]() {
+      if (otaRequest != request) return;
+      otaRequest = NULL;
+      // Сначала задача записи: она ещё может работать с распаковщиком и Update
+      if (otaWriting) {
+        otawriter_abort();
+        otaWriting = false;
+      }
+      if (!otaUpdateSuccess && Update.isRunning()) {
+        OTA_LOG_ERROR("Upload aborted");
+        OTA_LOG("Total written before abort: %u bytes", (unsigned)otaTotalBytesWritten);
+        Update.abort();
+      }
+      releaseStream();
+      if (otaCommand == U_SPIFFS) ui_remountFs(false);
+    });
 
-  if (upload.status == UPLOAD_FILE_START) {
+    size_t totalSize = request->contentLength();
+    otaCommand = command;
     otaUpdateSuccess = false;
     otaErrorMessage = "";
+    otaFsBusy = false;
     otaStartTime = millis();
+    otaElapsedTime = 0;
     otaTotalBytesWritten = 0;
+    otaUploadBytes = 0;
     otaChunkCount = 0;
+    otaSha256Hex[0] = '\0';
+    otaHeapStart = freeMemory();
+    otaHeapMin = otaHeapStart;
+    otaCompressed = gunzip_isGzip(data, len);
+    otaIsDelta = false;
+    otaPayloadBytes = 0;
+    otaHeadLength = 0;
+    otaCheckSha256 = false;
+    mbedtls_sha256_init(&otaSha256);
     
-    apiota_log("POST /api/ota/upload");
-    apiota_log("OTA Start: " + String(upload.filename.c_str()));
-    apiota_log("Content length: " + String(upload.totalSize) + " bytes");
-    apiota_log("Free heap before OTA: " + String(ESP.getFreeHeap()) + " bytes");
-    apiota_log("Free PSRAM: " + String(ESP.getPsramSize()) + " bytes");
+    OTA_LOG("POST %s", request->url().c_str());
+    OTA_LOG("OTA Start: %s", filename.c_str());
+    OTA_LOG("Content length: %u bytes%s", (unsigned)totalSize, otaCompressed ? " (gzip)" : "");
+    OTA_LOG("Free heap before OTA: %u bytes", (unsigned)ESP.getFreeHeap());
+    OTA_LOG("Free PSRAM: %u bytes", (unsigned)ESP.getPsramSize());
     
     // Проверка размера файла
-    if (upload.totalSize > OTA_MAX_FILE_SIZE) {
-      apiota_log("ERROR: File too large: " + String(upload.totalSize) + " bytes (max: " + String(OTA_MAX_FILE_SIZE) + ")");
+    if (totalSize > OTA_MAX_FILE_SIZE) {
+      OTA_LOG_ERROR("File too large: %u bytes (max: %u)", (unsigned)totalSize, (unsigned)OTA_MAX_FILE_SIZE);
       otaErrorMessage = "File too large";
       return;
     }
     
     const esp_partition_t* running = esp_ota_get_running_partition();
-    const esp_partition_t* update = esp_ota_get_next_update_partition(NULL);
+    const esp_partition_t* update = command == U_FLASH
+        ? esp_ota_get_next_update_partition(NULL)
+        : esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
     
     if (!update) {
-      apiota_log("ERROR: No OTA update partition found");
-      otaErrorMessage = "No OTA partition";
+      OTA_LOG_ERROR("No %s partition found", command == U_FLASH ? "OTA update" : "filesystem");
+      otaErrorMessage = command == U_FLASH ? "No OTA partition" : "No filesystem partition";
       return;
     }
     
     logPartitionInfo(running, "Running");
     logPartitionInfo(update, "Update");
     
-    apiota_log("Update partition size: " + String(update->size) + " bytes");
-    apiota_log("Update started with partition size, free heap: " + String(ESP.getFreeHeap()) + " bytes");
+    OTA_LOG("Update partition size: %u bytes", (unsigned)update->size);
+    OTA_LOG("Update started with partition size, free heap: %u bytes", (unsigned)ESP.getFreeHeap());
     
-    // Используем размер файла вместо размера раздела для Update.begin()
-    // Это может помочь избежать проблем с большими разделами
-    size_t updateSize = (upload.totalSize > 0) ? upload.totalSize : update->size;
-    apiota_log("Using update size: " + String(updateSize) + " bytes");
+    // Размер образа известен из Content-Length только для несжатого образа;
+    // распакованный или собранный из патча образ ограничен размером раздела
+    bool rawImage = !otaCompressed && !(command == U_FLASH && delta_isDelta(data, len));
+    size_t updateSize = (totalSize > 0 && rawImage) ? totalSize : UPDATE_SIZE_UNKNOWN;
+    OTA_LOG("Using update size: %u bytes", (unsigned)(updateSize == UPDATE_SIZE_UNKNOWN ? update->size : updateSize));
+
+    // Раздел LittleFS не должен быть смонтирован во время записи: до ответа
+    // интерфейс раздаётся из встроенных файлов. Пока ответы читают файлы
+    // LittleFS, раздел не отключается и загрузка отклоняется (409)
+    if (command == U_SPIFFS && !ui_unmountFs()) {
+      OTA_LOG_ERROR("Filesystem is busy: files are still being sent");
+      otaErrorMessage = "Filesystem is busy, retry the upload";
+      otaFsBusy = true;
+      return;
+    }
     
-    if (!Update.begin(updateSize)) {
-      apiota_log("ERROR: Update.begin() failed - " + String(Update.errorString()));
-      apiota_log("Error code: " + String(Update.getError()));
+    if (!Update.begin(updateSize, command)) {
+      OTA_LOG_ERROR("Update.begin() failed - %s", Update.errorString());
+      OTA_LOG("Error code: %u", Update.getError());
       otaErrorMessage = "Update.begin() failed: " + String(Update.errorString());
       return;
     }
+
+    // Контроль образа (после распаковки): ?md5= проверяет Update.end(), ?sha256= — здесь
+    if (request->hasParam("md5") && !Update.setMD5(request->getParam("md5")->value().c_str())) {
+      otaErrorMessage = "Invalid md5 parameter";
+    }
+    otaCheckSha256 = request->hasParam("sha256");
+    if (otaCheckSha256 && !parseSha256(request->getParam("sha256")->value(), otaExpectedSha256)) {
+      otaErrorMessage = "Invalid sha256 parameter";
+    }
+    if (otaErrorMessage.length() > 0) {
+      OTA_LOG_ERROR("%s", otaErrorMessage.c_str());
+      Update.abort();
+      return;
+    }
+
+    mbedtls_sha256_starts(&otaSha256, 0);
+
+    if (otaCompressed) {
+      otaGunzip = gunzip_create(writePayload, NULL);
+      if (otaGunzip == NULL) {
+        OTA_LOG_ERROR("%s", gunzip_statusName(GUNZIP_ERR_MEMORY));
+        otaErrorMessage = gunzip_statusName(GUNZIP_ERR_MEMORY);
+        Update.abort();
+        return;
+      }
+      OTA_LOG("Decompressing on the fly, window: %u bytes", (unsigned)gunzip_memoryBytes());
+    }
+
+    // Приём только копирует в буферы, запись во flash — в задаче otawriter
+    if (!otawriter_begin(processUpload, NULL)) {
+      OTA_LOG_ERROR("Not enough memory for OTA buffers");
+      otaErrorMessage = "Not enough memory for OTA buffers";
+      Update.abort();
+      releaseStream();
+      return;
+    }
+    otaWriting = true;
+    trackMemory();
+
+    // Джиттер такта управления — за время этой загрузки
+    sched_resetStats();
     
-    apiota_log("Update.begin() successful");
+    OTA_LOG("Update.begin() successful");
   }
-  else if (upload.status == UPLOAD_FILE_WRITE) {
+
+  // После ошибки остаток загрузки только принимается
+  if (otaRequest != request || !otaWriting) return;
+
+  if (len > 0) {
     otaChunkCount++;
-    int written = Update.write(upload.buf, upload.currentSize);
-    otaTotalBytesWritten += written;
-    
-    // Логируем каждые 50 чанков или при ошибке
-    if (otaChunkCount % 50 == 0 || written != upload.currentSize) {
-      apiota_log("Chunk #" + String(otaChunkCount) + 
-                 ": received=" + String(upload.currentSize) + 
-                 ", written=" + String(written) + 
-                 ", total=" + String(otaTotalBytesWritten) + 
-                 "/" + String(upload.totalSize) + " bytes");
-    }
-    
-    if (written != upload.currentSize) {
-      apiota_log("ERROR: Update.write() failed - " + String(Update.errorString()));
-      apiota_log("Written: " + String(written) + ", Expected: " + String(upload.currentSize));
-      apiota_log("Error code: " + String(Update.getError()));
-      otaErrorMessage = "Update.write() failed: " + String(Update.errorString());
+    otaUploadBytes += len;
+    if (!otawriter_write(data, len)) {
+      abortUpload();
+      return;
     }
   }
-  else if (upload.status == UPLOAD_FILE_END) {
-    unsigned long elapsedTime = millis() - otaStartTime;
-    float speedKBps = (otaTotalBytesWritten / 1024.0) / (elapsedTime / 1000.0);
-    
-    apiota_log("OTA End: " + String(upload.totalSize) + " bytes total");
-    apiota_log("Total written: " + String(otaTotalBytesWritten) + " bytes");
-    apiota_log("Chunks processed: " + String(otaChunkCount));
-    apiota_log("Time elapsed: " + String(elapsedTime) + " ms");
-    apiota_log("Average speed: " + String(speedKBps, 2) + " KB/s");
-    apiota_log("Free heap after OTA: " + String(ESP.getFreeHeap()) + " bytes");
+
+  if (final) {
+    bool written = otawriter_finish();
+    otaWriting = false;
+    otawriter_getStats(&otaWriterStats);
+    getControlStats(&otaControlStats);
+    if (!written) {
+      OTA_LOG_ERROR("%s", otaErrorMessage.c_str());
+      Update.abort();
+      releaseStream();
+      return;
+    }
+
+    otaElapsedTime = millis() - otaStartTime;
+    float speedKBps = (otaUploadBytes / 1024.0) / (otaElapsedTime / 1000.0);
     
-    if (Update.hasError()) {
-      apiota_log("ERROR: Update has errors - " + String(Update.errorString()));
-      apiota_log("Error code: " + String(Update.getError()));
-      otaErrorMessage = "Write error: " + String(Update.errorString());
+    OTA_LOG("OTA End: %u bytes total", (unsigned)(index + len));
+    OTA_LOG("Total written: %u bytes", (unsigned)otaTotalBytesWritten);
+    OTA_LOG("Chunks processed: %d", otaChunkCount);
+    OTA_LOG("Time elapsed: %lu ms", otaElapsedTime);
+    OTA_LOG("Average speed: %.2f KB/s", speedKBps);
+    OTA_LOG("Peak memory used: %u bytes", (unsigned)(otaHeapStart - otaHeapMin));
+    OTA_LOG("Writer: %u flushes, max %u us, %u stalls (%u us), control max jitter %u us, missed %u",
+            (unsigned)otaWriterStats.flushes, (unsigned)otaWriterStats.maxFlushUs, (unsigned)otaWriterStats.stalls,
+            (unsigned)otaWriterStats.stallUs, (unsigned)otaControlStats.maxJitterUs, (unsigned)otaControlStats.missed);
+    OTA_LOG("Free heap after OTA: %u bytes", (unsigned)ESP.getFreeHeap());
+
+    if (otaGunzip != NULL) {
+      GunzipStatus status = gunzip_finish(otaGunzip);
+      OTA_LOG("Compression ratio: %.1f%%", otaTotalBytesWritten ? 100.0 * otaUploadBytes / otaTotalBytesWritten : 0.0);
+      if (status != GUNZIP_OK) {
+        OTA_LOG_ERROR("%s", gunzip_statusName(status));
+        otaErrorMessage = gunzip_statusName(status);
+        Update.abort();
+        releaseStream();
+        return;
+      }
+    }
+
+    // Данных меньше OTA_HEAD_SIZE: начало ещё не разобрано и не записано
+    if (otaHeadLength < OTA_HEAD_SIZE && !startPayload()) {
+      OTA_LOG_ERROR("%s", otaErrorMessage.c_str());
+      Update.abort();
+      releaseStream();
+      return;
+    }
+
+    if (otaDelta != NULL) {
+      DeltaStatus status = delta_finish(otaDelta);
+      OTA_LOG("Delta: patch %u bytes, base read %u bytes", (unsigned)otaPayloadBytes,
+              (unsigned)delta_baseReadBytes(otaDelta));
+      if (status != DELTA_OK) {
+        OTA_LOG_ERROR("%s", delta_statusName(status));
+        otaErrorMessage = delta_statusName(status);
+        Update.abort();
+        releaseStream();
+        return;
+      }
+    }
+
+    uint8_t digest[OTA_SHA256_SIZE];
+    mbedtls_sha256_finish(&otaSha256, digest);
+    for (int i = 0; i < OTA_SHA256_SIZE; i++) {
+      snprintf(otaSha256Hex + i * 2, 3, "%02x", digest[i]);
+    }
+    OTA_LOG("Firmware SHA-256: %s", otaSha256Hex);
+    releaseStream();
+
+    if (otaCheckSha256 && memcmp(digest, otaExpectedSha256, OTA_SHA256_SIZE) != 0) {
+      OTA_LOG_ERROR("SHA-256 mismatch");
+      otaErrorMessage = "SHA-256 mismatch";
+      Update.abort();
       return;
     }
     
-    apiota_log("Calling Update.end(true) - skipping size check...");
+    OTA_LOG("Calling Update.end(true) - skipping size check...");
     if (Update.end(true)) {
-      apiota_log("OTA Success: " + String(upload.totalSize) + " bytes");
-      apiota_log("Firmware MD5: " + String(Update.md5String()));
+      OTA_LOG("OTA Success: %u bytes", (unsigned)otaTotalBytesWritten);
+      OTA_LOG("Image MD5: %s", Update.md5String().c_str());
       otaUpdateSuccess = true;
+      // Новая прошивка приносит свои встроенные файлы интерфейса
+      if (otaCommand == U_FLASH) ui_resetFsOverride();
     } else {
-      apiota_log("ERROR: Update.end() failed - " + String(Update.errorString()));
-      apiota_log("Error code: " + String(Update.getError()));
+      OTA_LOG_ERROR("Update.end() failed - %s", Update.errorString());
+      OTA_LOG("Error code: %u", Update.getError());
       
       const esp_partition_t* update = esp_ota_get_next_update_partition(NULL);
-      apiota_log("Update partition address: 0x" + String(update->address, HEX));
-      apiota_log("Update partition size: " + String(update->size));
+      OTA_LOG("Update partition address: 0x%x", (unsigned)update->address);
+      OTA_LOG("Update partition size: %u", (unsigned)update->size);
       
       otaErrorMessage = "Update.end() failed: " + String(Update.errorString());
     }
   }
-  else if (upload.status == UPLOAD_FILE_ABORTED) {
-    apiota_log("ERROR: Upload aborted");
-    apiota_log("Total written before abort: " + String(otaTotalBytesWritten) + " bytes");
-    otaErrorMessage = "Upload aborted";
-  }
 }
 
-void handleOtaUploadResponse() {
-  if (otaUpdateSuccess) {
-    apiota_log("OTA update successful, sending response and rebooting...");
-    apiota_log("Total time: " + String(millis() - otaStartTime) + " ms");
-    apiota_log("Total bytes written: " + String(otaTotalBytesWritten));
-    sendOTASuccess();
-    delay(OTA_REBOOT_DELAY_MS);
-    ESP.restart();
+void handleOtaUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                     uint8_t* data, size_t len, bool final) {
+  handleUpload(request, filename, index, data, len, final, U_FLASH);
+}
+
+void handleOtaFsUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                       uint8_t* data, size_t len, bool final) {
+  handleUpload(request, filename, index, data, len, final, U_SPIFFS);
+}
+
+void handleOtaUploadResponse(AsyncWebServerRequest* request) {
+  if (otaRequest != request) {
+    sendOTAError(request, 409, "Another OTA upload is in progress");
+    return;
+  }
+  otaRequest = NULL;
+
+  if (otaFsBusy) {
+    sendOTAError(request, 409, otaErrorMessage);
+    return;
+  }
+
+  // Образ LittleFS проверяется монтированием; после ошибки — прежнее состояние
+  if (otaCommand == U_SPIFFS && !ui_remountFs(otaUpdateSuccess) && otaUpdateSuccess) {
+    otaUpdateSuccess = false;
+    otaErrorMessage = "Filesystem image written but mount failed";
+  }
+
+  if (otaUpdateSuccess && otaCommand == U_SPIFFS) {
+    OTA_LOG("Filesystem updated and remounted in %lu ms", millis() - otaStartTime);
+    sendOTASuccess(request, "Filesystem updated and remounted");
+  } else if (otaUpdateSuccess) {
+    OTA_LOG("OTA update successful, sending response and rebooting...");
+    OTA_LOG("Total time: %lu ms", millis() - otaStartTime);
+    OTA_LOG("Total bytes written: %u", (unsigned)otaTotalBytesWritten);
+    sendOTASuccess(request, "Firmware uploaded successfully. Rebooting...");
+    // Перезагрузка из apiota_loop: обработчик не должен блокировать async_tcp
+    otaRebootAt = millis() + OTA_REBOOT_DELAY_MS;
   } else if (otaErrorMessage.length() > 0) {
-    apiota_log("OTA update failed: " + otaErrorMessage);
-    apiota_log("Trying to diagnose the issue...");
+    OTA_LOG_ERROR("OTA update failed: %s", otaErrorMessage.c_str());
+    OTA_LOG("Trying to diagnose the issue...");
     
     // Дополнительная диагностика
     const esp_partition_t* update = esp_ota_get_next_update_partition(NULL);
     if (update) {
-      apiota_log("Update partition address: 0x" + String(update->address, HEX));
-      apiota_log("Update partition size: " + String(update->size));
+      OTA_LOG("Update partition address: 0x%x", (unsigned)update->address);
+      OTA_LOG("Update partition size: %u", (unsigned)update->size);
     }
     
-    apiota_log("OTA update failed: Update.end() failed: " + otaErrorMessage);
-    sendOTAError(otaErrorMessage);
+    OTA_LOG_ERROR("OTA update failed: Update.end() failed: %s", otaErrorMessage.c_str());
+    sendOTAError(request, 500, otaErrorMessage);
   } else {
-    apiota_log("OTA update failed with unknown error");
-    sendOTAError("Unknown OTA error");
+    OTA_LOG_ERROR("OTA update failed with unknown error");
+    sendOTAError(request, 500, "Unknown OTA error");
   }
 }
 
-void apiota_init(WebServer& server) {
+void apiota_init(AsyncWebServer& server) {
   server.on("/api/ota", HTTP_GET, handleOtaPage);
   server.on("/api/ota/upload", HTTP_POST, handleOtaUploadResponse, handleOtaUpload);
+  server.on("/api/ota/fs", HTTP_POST, handleOtaUploadResponse, handleOtaFsUpload);
+}
+
+void apiota_loop() {
+  if (otaRebootAt != 0 && (long)(millis() - otaRebootAt) >= 0) {
+    ESP.restart();
+  }
 }
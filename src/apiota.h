@@ -1,14 +1,20 @@
 #ifndef _API_OTA_H
 #define _API_OTA_H
 
-#include <WebServer.h>
+#include <ESPAsyncWebServer.h>
 
 // Инициализация OTA маршрутов
-void apiota_init(WebServer& server);
+void apiota_init(AsyncWebServer& server);
+
+// Отложенная перезагрузка после успешного OTA (вызывается из сетевой задачи)
+void apiota_loop();
 
 // Обработчики OTA
-void handleOtaPage();
-void handleOtaUpload();
-void handleOtaUploadResponse();
+void handleOtaPage(AsyncWebServerRequest* request);
+void handleOtaUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                     uint8_t* data, size_t len, bool final);
+void handleOtaFsUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                       uint8_t* data, size_t len, bool final);
+void handleOtaUploadResponse(AsyncWebServerRequest* request);
 
 #endif
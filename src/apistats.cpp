@@ -0,0 +1,82 @@
+#include "apistats.h"
+
+#include "apijson.h"
+
+// ===== Глобальные переменные =====
+
+static ApiRouteStats routes[APISTATS_MAX_ROUTES];
+static int routeCount = 0;
+
+// ===== Вспомогательные функции =====
+
+static int bucketOf(uint32_t us) {
+  uint32_t limit = APISTATS_FIRST_BUCKET_US;
+  for (int i = 0; i < APISTATS_BUCKETS - 1; i++, limit <<= 1) {
+    if (us < limit) return i;
+  }
+  return APISTATS_BUCKETS - 1;
+}
+
+static void clearRoute(ApiRouteStats* route) {
+  route->requests = 0;
+  route->totalUs = 0;
+  route->maxUs = 0;
+  route->allocs = 0;
+  route->bytes = 0;
+  memset(route->histogram, 0, sizeof(route->histogram));
+}
+
+// ===== Публичные функции =====
+
+int apistats_addRoute(const char* method, const char* path) {
+  if (routeCount >= APISTATS_MAX_ROUTES) return -1;
+  ApiRouteStats* route = &routes[routeCount];
+  route->method = method;
+  route->path = path;
+  clearRoute(route);
+  return routeCount++;
+}
+
+void apistats_begin(ApiStatsProbe* probe) {
+  ApiJsonStats json;
+  apijson_getStats(&json);
+  probe->allocs = apijson_totalAllocs(&json);
+  probe->responses = json.responses;
+  probe->startUs = esp_timer_get_time();
+}
+
+void apistats_end(int route, const ApiStatsProbe* probe) {
+  uint32_t us = (uint32_t)(esp_timer_get_time() - probe->startUs);
+  if (route < 0 || route >= routeCount) return;
+
+  ApiJsonStats json;
+  apijson_getStats(&json);
+
+  ApiRouteStats* stats = &routes[route];
+  stats->requests++;
+  stats->totalUs += us;
+  if (us > stats->maxUs) stats->maxUs = us;
+  stats->histogram[bucketOf(us)]++;
+  stats->allocs += apijson_totalAllocs(&json) - probe->allocs;
+  // Ответ без JSON (204, файл) — 0 байт
+  if (json.responses != probe->responses) stats->bytes += json.lastLength;
+}
+
+int apistats_routeCount() {
+  return routeCount;
+}
+
+bool apistats_getRoute(int route, ApiRouteStats* stats) {
+  if (route < 0 || route >= routeCount || stats == NULL) return false;
+  *stats = routes[route];
+  return true;
+}
+
+uint32_t apistats_bucketLimitUs(int bucket) {
+  if (bucket < 0 || bucket >= APISTATS_BUCKETS - 1) return 0;
+  return (uint32_t)APISTATS_FIRST_BUCKET_US << bucket;
+}
+
+void apistats_reset() {
+  for (int i = 0; i < routeCount; i++) clearRoute(&routes[i]);
+}
@@ -0,0 +1,54 @@
+#ifndef _APISTATS_H
+#define _APISTATS_H
+
+#include <Arduino.h>
+
+// Статистика обработчиков REST API по маршрутам: число запросов, время
+// обработчика (среднее, максимум и гистограмма), выделения памяти JsonDocument
+// и байты сериализованного JSON ответа (по данным apijson).
+// Маршрут регистрируется один раз при api_init(), замер — вокруг onRequest.
+// Все функции вызываются только из задачи async_tcp (обработчики HTTP).
+
+// ===== Константы =====
+
+#define APISTATS_MAX_ROUTES 32
+#define APISTATS_BUCKETS 12            // корзины гистограммы времени обработчика
+#define APISTATS_FIRST_BUCKET_US 16    // граница первой корзины; каждая следующая вдвое больше
+
+// ===== Структуры данных =====
+
+struct ApiRouteStats {
+  const char* method;
+  const char* path;
+  uint32_t requests;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t allocs;                     // выделений JsonDocument и буферов ответа (всего)
+  uint32_t bytes;                      // байт JSON ответов (всего)
+  uint32_t histogram[APISTATS_BUCKETS];  // [i] — время < 16 << i мкс, последняя — остальное
+};
+
+// Начало замера одного запроса
+struct ApiStatsProbe {
+  uint64_t startUs;
+  uint32_t allocs;
+  uint32_t responses;
+};
+
+// ===== Функции =====
+
+// Индекс маршрута или -1, если таблица заполнена. method и path должны жить всё время работы.
+int apistats_addRoute(const char* method, const char* path);
+
+void apistats_begin(ApiStatsProbe* probe);
+void apistats_end(int route, const ApiStatsProbe* probe);
+
+int apistats_routeCount();
+bool apistats_getRoute(int route, ApiRouteStats* stats);
+
+// Верхняя граница корзины, мкс (0 — последняя, без ограничения)
+uint32_t apistats_bucketLimitUs(int bucket);
+
+void apistats_reset();
+
+#endif
@@ -0,0 +1,174 @@
+#include "control.h"
+
+#include <Arduino.h>
+
+#include "spsc_queue.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "servo.h"
+#include "dcmotor.h"
+#include "safety.h"
+
+// ===== Константы =====
+
+#define CONTROL_PERIOD_US 10000
+#define CONTROL_BUDGET_US 2000
+#define CONTROL_JOB_PRIORITY 3
+#define CONTROL_QUEUE_SIZE 32
+#define CONTROL_MAX_COMMANDS_PER_TICK CONTROL_QUEUE_SIZE
+
+// ===== Глобальные переменные =====
+
+static SpscQueue<ControlCommand, CONTROL_QUEUE_SIZE> commandQueue;
+static Snapshot<ControlState> stateSnapshot;
+
+// Сериализация производителей очереди команд (HTTP и WebSocket в разных задачах)
+static portMUX_TYPE postMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Уставки моторов после всех принятых в очередь команд (под postMux): команда
+// по части моторов не должна снимать deadman, пока остальные едут.
+// Остановку по safety здесь не видно — deadman останется взведённым и лишь
+// повторно остановит уже стоящие моторы.
+static int16_t postedMotor[CONTROL_MOTOR_COUNT];
+
+static ControlState state;
+
+static void (*const motorSetters[CONTROL_MOTOR_COUNT])(int) = {
+  motor_setSpeedA, motor_setSpeedB, motor_setSpeedC, motor_setSpeedD
+};
+
+static int (*const motorGetters[CONTROL_MOTOR_COUNT])() = {
+  motor_getSpeedA, motor_getSpeedB, motor_getSpeedC, motor_getSpeedD
+};
+
+// ===== Вспомогательные функции =====
+
+// Уставки с учётом принятой команды; true — хотя бы один мотор едет.
+// Вызывается под postMux.
+static bool mergePostedMotors(const ControlCommand& command) {
+  bool moving = false;
+  for (int i = 0; i < CONTROL_MOTOR_COUNT; i++) {
+    if (command.type == CONTROL_CMD_STOP) {
+      postedMotor[i] = 0;
+    } else if (command.motorMask & (1 << i)) {
+      postedMotor[i] = command.motor[i];
+    }
+    if (postedMotor[i] != 0) moving = true;
+  }
+  return moving;
+}
+
+static void applySetpoint(const ControlCommand& command) {
+  for (int i = 0; i < CONTROL_MOTOR_COUNT; i++) {
+    if (command.motorMask & (1 << i)) {
+      motorSetters[i](command.motor[i]);
+    }
+  }
+
+  ServoMove move = (ServoMove)command.servoMove;
+  if (command.servoMask) {
+    servo_setAngles(command.servoMask, command.servo, move);
+  }
+
+  if (command.cameraMask) {
+    // Ось без новой цели сохраняет прежнюю (а не текущее положение на траектории)
+    uint16_t panAngle, tiltAngle;
+    camera_getTarget(&panAngle, &tiltAngle);
+    if (command.cameraMask & CONTROL_CAMERA_PAN) panAngle = command.pan;
+    if (command.cameraMask & CONTROL_CAMERA_TILT) tiltAngle = command.tilt;
+    camera_setAngle(panAngle, tiltAngle, move);
+  }
+}
+
+static void applyCommand(const ControlCommand& command) {
+  switch (command.type) {
+    case CONTROL_CMD_SETPOINT:
+      applySetpoint(command);
+      break;
+
+    case CONTROL_CMD_CAMERA_PWM:
+      camera_setPWM(command.pan, command.tilt);
+      break;
+
+    case CONTROL_CMD_STOP:
+      motor_stopAll();
+      break;
+
+    case CONTROL_CMD_SERVO_CALIBRATION:
+      servo_applyCalibration(command.servoMask);
+      break;
+
+    case CONTROL_CMD_SERVO_PROFILE:
+      servo_setProfile(command.servoMask, command.maxSpeed, command.maxAccel);
+      break;
+  }
+  state.commandsApplied++;
+}
+
+static void publishState() {
+  for (int i = 0; i < CONTROL_MOTOR_COUNT; i++) {
+    state.motor[i] = motorGetters[i]();
+    state.motorOutput[i] = motor_getOutput(i);
+  }
+  for (int i = 0; i < CONTROL_SERVO_COUNT; i++) {
+    state.servoAngle[i] = servo_getAngle(i);
+    state.servoTarget[i] = servo_getTarget(i);
+    servo_getProfile(i, &state.servoMaxSpeed[i], &state.servoMaxAccel[i]);
+  }
+  state.servoMovingMask = servo_getMovingMask();
+  camera_getAngle(&state.panAngle, &state.tiltAngle);
+  camera_getPWM(&state.panPWM, &state.tiltPWM);
+
+  ServoBusStats bus;
+  servo_getBusStats(&bus);
+  state.servoBusSavedUs = bus.lastSavedUs;
+  state.servoBusTotalSavedUs = bus.totalSavedUs;
+  state.servoBusErrors = bus.errors;
+  state.commandsDropped = commandQueue.droppedCount();
+
+  stateSnapshot.publish(state);
+}
+
+// Такт управления: команды из очереди -> моторы/серво -> снимок состояния
+static void controlJob() {
+  ControlCommand command;
+  for (int i = 0; i < CONTROL_MAX_COMMANDS_PER_TICK && commandQueue.pop(command); i++) {
+    applyCommand(command);
+  }
+
+  state.tick++;
+  publishState();
+}
+
+// ===== Публичные функции =====
+
+void control_init() {
+  memset(&state, 0, sizeof(state));
+  publishState();
+
+  sched_addJob("control", CONTROL_PERIOD_US, CONTROL_JOB_PRIORITY, CONTROL_BUDGET_US, controlJob);
+}
+
+bool control_post(const ControlCommand& command) {
+  // Производителей двое (async_tcp — HTTP, сетевая задача — WebSocket):
+  // короткая секция делает их одним производителем для SPSC очереди
+  bool motorCommand = command.type == CONTROL_CMD_STOP ||
+                      (command.type == CONTROL_CMD_SETPOINT && command.motorMask);
+  portENTER_CRITICAL(&postMux);
+  bool queued = commandQueue.push(command);
+  // Команды моторов продлевают deadman; снимает его только стоп или
+  // нулевые уставки всех четырёх моторов. Внутри секции: порядок взвода
+  // и снятия совпадает с порядком команд в очереди.
+  if (queued && motorCommand) safety_feed(mergePostedMotors(command));
+  portEXIT_CRITICAL(&postMux);
+  return queued;
+}
+
+bool control_getState(ControlState* out) {
+  return stateSnapshot.read(out);
+}
+
+void control_initCommand(ControlCommand* command, ControlCommandType type) {
+  memset(command, 0, sizeof(*command));
+  command->type = type;
+}
@@ -0,0 +1,79 @@
+#ifndef _CONTROL_H
+#define _CONTROL_H
+
+#include <stdint.h>
+
+// Контур управления: единственный владелец моторов и сервоприводов.
+// Выполняется задачей планировщика "control" (scheduler.h) на ядре 1.
+// Сетевые обработчики (API, WebSocket) не трогают железо напрямую — они
+// отправляют команды через lock-free очередь и читают снимок состояния.
+
+// ===== Константы =====
+
+#define CONTROL_MOTOR_COUNT 4
+#define CONTROL_SERVO_COUNT 16
+#define CONTROL_STEERING_SERVOS 4
+
+#define CONTROL_CAMERA_PAN  0x01
+#define CONTROL_CAMERA_TILT 0x02
+
+// Типы команд
+enum ControlCommandType : uint8_t {
+  CONTROL_CMD_SETPOINT = 0,    // уставки моторов / серво / углов камеры по маскам
+  CONTROL_CMD_CAMERA_PWM,      // точные значения PWM камеры (pan/tilt)
+  CONTROL_CMD_STOP,            // остановка всех моторов
+  CONTROL_CMD_SERVO_CALIBRATION,  // пересборка таблиц импульсов каналов servoMask (servocal.h)
+  CONTROL_CMD_SERVO_PROFILE    // скорость и ускорение траектории каналов servoMask
+};
+
+// ===== Структуры данных =====
+
+struct ControlCommand {
+  uint8_t type;                            // ControlCommandType
+  uint8_t motorMask;                       // бит i -> motor[i] (A, B, C, D)
+  uint8_t cameraMask;                      // CONTROL_CAMERA_PAN / CONTROL_CAMERA_TILT
+  uint16_t servoMask;                      // бит i -> servo[i]
+  int16_t motor[CONTROL_MOTOR_COUNT];      // -255...255
+  uint16_t servo[CONTROL_SERVO_COUNT];     // углы 0-180°
+  uint16_t pan;                            // угол или PWM (для CONTROL_CMD_CAMERA_PWM)
+  uint16_t tilt;
+  uint8_t servoMove;                       // ServoMove для servo[] и углов камеры (0 — по профилю)
+  uint16_t maxSpeed;                       // CONTROL_CMD_SERVO_PROFILE: °/с
+  uint16_t maxAccel;                       // CONTROL_CMD_SERVO_PROFILE: °/с²
+};
+
+// Снимок состояния, публикуемый задачей управления раз в такт
+struct ControlState {
+  uint32_t tick;                                // номер такта
+  int16_t motor[CONTROL_MOTOR_COUNT];           // уставки скорости A, B, C, D
+  int16_t motorOutput[CONTROL_MOTOR_COUNT];     // текущий ШИМ после генератора разгона
+  uint16_t servoAngle[CONTROL_SERVO_COUNT];     // текущие углы серво (положение на траектории)
+  uint16_t servoTarget[CONTROL_SERVO_COUNT];    // цели траекторий
+  uint16_t servoMovingMask;                     // каналы, ещё не дошедшие до цели
+  uint16_t servoMaxSpeed[CONTROL_SERVO_COUNT];  // профиль траектории, °/с
+  uint16_t servoMaxAccel[CONTROL_SERVO_COUNT];  // °/с²
+  uint16_t panAngle;
+  uint16_t tiltAngle;
+  uint16_t panPWM;
+  uint16_t tiltPWM;
+  uint32_t servoBusSavedUs;                     // последняя экономия шины PCA9685, мкс
+  uint32_t servoBusTotalSavedUs;
+  uint32_t servoBusErrors;                      // неудачных транзакций PCA9685
+  uint32_t commandsApplied;
+  uint32_t commandsDropped;                     // отброшено из-за переполнения очереди
+};
+
+// Инициализация очереди и регистрация такта управления в планировщике
+void control_init();
+
+// Отправка команды в задачу управления (из любой задачи, кроме самой задачи управления).
+// false — очередь заполнена, команда отброшена.
+bool control_post(const ControlCommand& command);
+
+// Чтение последнего снимка состояния (без блокировок)
+bool control_getState(ControlState* state);
+
+// Подготовка пустой команды заданного типа
+void control_initCommand(ControlCommand* command, ControlCommandType type);
+
+#endif
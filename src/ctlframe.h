@@ -0,0 +1,193 @@
+#ifndef _CTLFRAME_H
+#define _CTLFRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Бинарный кадр управления для WebSocket канала (little-endian, фиксированный размер).
+// Формат описан здесь и в data/main.js (encodeControlFrame) — менять синхронно!
+
+// ===== Константы =====
+
+#define CTL_FRAME_MAGIC 0xC7
+#define CTL_FRAME_MOTORS 4
+#define CTL_FRAME_SERVOS 6          // 0-3 — рулевые серво, 4-5 — камера (pan/tilt)
+#define CTL_FRAME_SERVO_PAN  4
+#define CTL_FRAME_SERVO_TILT 5
+
+// Типы кадров
+#define CTL_FRAME_TYPE_SETPOINT 0x01  // клиент -> робот: уставки моторов/серво
+#define CTL_FRAME_TYPE_ESTOP    0x02  // клиент -> робот: аварийная остановка (CtlEstop)
+#define CTL_FRAME_TYPE_SUBSCRIBE 0x03 // клиент -> робот: подписка на телеметрию (CtlSubscribe)
+#define CTL_FRAME_TYPE_ACK      0x81  // робот -> клиент: подтверждение seq
+#define CTL_FRAME_TYPE_SCAN     0x82  // робот -> клиент: точки скана дальномером (CtlScanHeader + CtlScanPoint[])
+#define CTL_FRAME_TYPE_TELEMETRY 0x83 // робот -> клиент: телеметрия (CtlTelemetryHeader + секции по маске)
+
+#define CTL_SCAN_MAX_POINTS 32        // точек в одном кадре скана
+
+// Флаги кадра уставок
+#define CTL_FLAG_MOTORS 0x01          // поле motor[] содержит валидные скорости
+
+// Секции телеметрии (маска подписки); в кадре идут в порядке возрастания бита
+#define CTL_TELEM_MOTORS 0x01         // CtlTelemMotors
+#define CTL_TELEM_SERVOS 0x02         // CtlTelemServos
+#define CTL_TELEM_LIDAR  0x04         // CtlTelemLidar
+#define CTL_TELEM_TIMING 0x08         // CtlTelemTiming
+#define CTL_TELEM_SYSTEM 0x10         // CtlTelemSystem
+#define CTL_TELEM_ALL    0x1F
+#define CTL_TELEM_SECTIONS 5
+
+// Кодирование телеметрии: бинарный кадр или текстовый JSON
+#define CTL_TELEM_FORMAT_BINARY 0
+#define CTL_TELEM_FORMAT_JSON   1
+
+#define CTL_TELEM_RATE_MAX_HZ 50      // 0 — подписка отключена
+#define CTL_TELEM_LIDAR_DIRECTIONS 8
+
+// ===== Структуры данных =====
+
+struct __attribute__((packed)) CtlFrame {
+  uint8_t magic;                          // CTL_FRAME_MAGIC
+  uint8_t type;                           // CTL_FRAME_TYPE_*
+  uint16_t seq;                           // порядковый номер (с переполнением)
+  uint8_t flags;                          // CTL_FLAG_*
+  uint8_t servoMask;                      // бит i -> servo[i] валиден
+  int16_t motor[CTL_FRAME_MOTORS];        // A, B, C, D: -255...255
+  uint8_t servo[CTL_FRAME_SERVOS];        // углы 0-180°
+};
+
+struct __attribute__((packed)) CtlAck {
+  uint8_t magic;
+  uint8_t type;                           // CTL_FRAME_TYPE_ACK
+  uint16_t seq;                           // подтверждённый seq
+};
+
+// Аварийная остановка: короткий кадр, обрабатывается до разбора уставок
+struct __attribute__((packed)) CtlEstop {
+  uint8_t magic;
+  uint8_t type;                           // CTL_FRAME_TYPE_ESTOP
+  uint16_t seq;                           // подтверждается CtlAck
+};
+
+// Подписка на телеметрию: частота и набор секций выбирает каждый клиент
+struct __attribute__((packed)) CtlSubscribe {
+  uint8_t magic;
+  uint8_t type;                           // CTL_FRAME_TYPE_SUBSCRIBE
+  uint8_t rateHz;                         // 1...CTL_TELEM_RATE_MAX_HZ, 0 — отписка
+  uint8_t format;                         // CTL_TELEM_FORMAT_*
+  uint8_t mask;                           // CTL_TELEM_*
+  uint8_t reserved;
+};
+
+// Кадр телеметрии: заголовок, затем секции из mask
+struct __attribute__((packed)) CtlTelemetryHeader {
+  uint8_t magic;
+  uint8_t type;                           // CTL_FRAME_TYPE_TELEMETRY
+  uint8_t mask;                           // секции в кадре
+  uint8_t reserved;
+  uint32_t seq;                           // номер снимка (общий для всех клиентов)
+  uint32_t timestampMs;                   // время снимка, мс от старта
+};
+
+struct __attribute__((packed)) CtlTelemMotors {
+  int16_t speed[CTL_FRAME_MOTORS];        // уставки A, B, C, D
+  int16_t output[CTL_FRAME_MOTORS];       // текущий ШИМ после генератора разгона
+};
+
+struct __attribute__((packed)) CtlTelemServos {
+  uint8_t angle[CTL_FRAME_SERVOS];        // 0-3 — рулевые, 4-5 — камера (pan/tilt)
+};
+
+struct __attribute__((packed)) CtlTelemLidar {
+  uint16_t rangeMm[CTL_TELEM_LIDAR_DIRECTIONS];  // 0xFFFF — нет данных
+  uint8_t validMask;                      // направления со свежим корректным отсчётом
+  uint8_t reserved;
+};
+
+struct __attribute__((packed)) CtlTelemTiming {
+  uint32_t controlTick;                   // номер такта управления
+  uint16_t controlLastUs;                 // время последнего такта управления, мкс
+  uint16_t controlWcetUs;                 // наихудшее время такта управления, мкс
+  uint16_t dcWcetUs;                      // наихудшее время такта моторов, мкс
+  uint16_t maxJitterUs;                   // наибольший джиттер старта такта управления, мкс
+};
+
+struct __attribute__((packed)) CtlTelemSystem {
+  uint32_t freeHeap;                      // байт
+  uint32_t uptimeMs;
+  int8_t rssi;                            // дБм, 0 — нет подключения
+  uint8_t wsClients;
+  uint16_t reserved;
+};
+
+// Кадр скана: заголовок и count точек в полярных координатах
+struct __attribute__((packed)) CtlScanHeader {
+  uint8_t magic;
+  uint8_t type;                           // CTL_FRAME_TYPE_SCAN
+  uint16_t sweep;                         // номер прохода (с переполнением)
+  uint8_t count;                          // число точек в кадре
+  uint8_t reserved;
+};
+
+struct __attribute__((packed)) CtlScanPoint {
+  uint32_t timestampMs;                   // время замера (мс от старта, младшие 32 бита)
+  uint16_t angleCdeg;                     // фактически заданный угол pan, сотые доли градуса
+  uint16_t rangeMm;                       // 0xFFFF — нет отражения
+};
+
+static_assert(sizeof(CtlFrame) == 20, "CtlFrame must stay 20 bytes");
+static_assert(sizeof(CtlAck) == 4, "CtlAck must stay 4 bytes");
+static_assert(sizeof(CtlEstop) == 4, "CtlEstop must stay 4 bytes");
+static_assert(sizeof(CtlSubscribe) == 6, "CtlSubscribe must stay 6 bytes");
+static_assert(sizeof(CtlTelemetryHeader) == 12, "CtlTelemetryHeader must stay 12 bytes");
+static_assert(sizeof(CtlTelemMotors) == 16, "CtlTelemMotors must stay 16 bytes");
+static_assert(sizeof(CtlTelemServos) == 6, "CtlTelemServos must stay 6 bytes");
+static_assert(sizeof(CtlTelemLidar) == 18, "CtlTelemLidar must stay 18 bytes");
+static_assert(sizeof(CtlTelemTiming) == 12, "CtlTelemTiming must stay 12 bytes");
+static_assert(sizeof(CtlTelemSystem) == 12, "CtlTelemSystem must stay 12 bytes");
+static_assert(sizeof(CtlScanHeader) == 6, "CtlScanHeader must stay 6 bytes");
+static_assert(sizeof(CtlScanPoint) == 8, "CtlScanPoint must stay 8 bytes");
+
+// ===== Вспомогательные функции =====
+
+// true, если seq новее last с учётом переполнения 16-битного счётчика
+static inline bool ctlframe_isNewer(uint16_t seq, uint16_t last) {
+  return (int16_t)(seq - last) > 0;
+}
+
+// Кадр аварийной остановки (seq не проверяется — остановка не бывает устаревшей)
+static inline bool ctlframe_isEstop(const uint8_t* payload, size_t length) {
+  return length == sizeof(CtlEstop) && payload[0] == CTL_FRAME_MAGIC && payload[1] == CTL_FRAME_TYPE_ESTOP;
+}
+
+// Кадр подписки на телеметрию
+static inline bool ctlframe_isSubscribe(const uint8_t* payload, size_t length) {
+  if (length != sizeof(CtlSubscribe)) return false;
+  if (payload[0] != CTL_FRAME_MAGIC || payload[1] != CTL_FRAME_TYPE_SUBSCRIBE) return false;
+
+  const CtlSubscribe* frame = (const CtlSubscribe*)payload;
+  return frame->rateHz <= CTL_TELEM_RATE_MAX_HZ &&
+         frame->format <= CTL_TELEM_FORMAT_JSON &&
+         (frame->mask & ~CTL_TELEM_ALL) == 0;
+}
+
+// Проверка заголовка и диапазонов кадра уставок
+static inline bool ctlframe_isValid(const CtlFrame* frame, size_t length) {
+  if (length != sizeof(CtlFrame)) return false;
+  if (frame->magic != CTL_FRAME_MAGIC) return false;
+  if (frame->type != CTL_FRAME_TYPE_SETPOINT) return false;
+
+  if (frame->flags & CTL_FLAG_MOTORS) {
+    for (int i = 0; i < CTL_FRAME_MOTORS; i++) {
+      if (frame->motor[i] < -255 || frame->motor[i] > 255) return false;
+    }
+  }
+
+  for (int i = 0; i < CTL_FRAME_SERVOS; i++) {
+    if ((frame->servoMask & (1 << i)) && frame->servo[i] > 180) return false;
+  }
+
+  return true;
+}
+
+#endif
@@ -1,14 +1,36 @@
 #include <Arduino.h>
 
+#include "config.h"
 #include "dcmotor.h"
+#include "motormix.h"
+#include "motorpwm.h"
 #include "pins.h"
+#include "ramp.h"
+#include "reflex.h"
+#include "safety.h"
+#include "scheduler.h"
+#include "log.h"
 
 // ===== Константы =====
 
-#define MOTOR_SPEED_MIN -255
-#define MOTOR_SPEED_MAX 255
+#define MOTOR_SPEED_MIN -MOTORMIX_SPEED_MAX
+#define MOTOR_SPEED_MAX MOTORMIX_SPEED_MAX
 #define MOTOR_COUNT 4
 
+#define DC_LOOP_PERIOD_US 10000
+#define DC_LOOP_BUDGET_US 500
+#define DC_LOOP_PRIORITY 2
+
+// Ограничения разгона по моторам A, B, C, D: изменение ШИМ в секунду
+// и изменение ускорения в секунду² (0 — без ограничения), переопределяются в config.h
+#ifndef MOTOR_RAMP_ACCEL
+#define MOTOR_RAMP_ACCEL {1000, 1000, 1000, 1000}
+#endif
+
+#ifndef MOTOR_RAMP_JERK
+#define MOTOR_RAMP_JERK {10000, 10000, 10000, 10000}
+#endif
+
 // ===== Структуры данных =====
 
 struct MotorPins {
@@ -17,85 +39,138 @@ struct MotorPins {
 };
 
 struct MotorState {
-  int speed;
+  int speed;          // уставка (-255...255)
   MotorPins pins;
+  int output;         // текущий ШИМ после генератора разгона
+  Ramp ramp;
+  RampLimits limits;
 };
 
 // ===== Глобальные переменные =====
 
 static MotorState motors[MOTOR_COUNT] = {
-  {0, {A_IA, A_IB}},  // Motor A
-  {0, {B_IA, B_IB}},  // Motor B
-  {0, {C_IA, C_IB}},  // Motor C
-  {0, {D_IA, D_IB}}   // Motor D
+  {0, {A_IA, A_IB}, 0, {0, 0, 0}, {0, 0}},  // Motor A
+  {0, {B_IA, B_IB}, 0, {0, 0, 0}, {0, 0}},  // Motor B
+  {0, {C_IA, C_IB}, 0, {0, 0, 0}, {0, 0}},  // Motor C
+  {0, {D_IA, D_IB}, 0, {0, 0, 0}, {0, 0}}   // Motor D
 };
 
+static const uint32_t rampAccel[MOTOR_COUNT] = MOTOR_RAMP_ACCEL;
+static const uint32_t rampJerk[MOTOR_COUNT] = MOTOR_RAMP_JERK;
+
 // ===== Вспомогательные функции =====
 
-// Установка скорости для одного мотора
-static void setMotorSpeed(MotorState& motor, int speed) {
-  speed = constrain(speed, MOTOR_SPEED_MIN, MOTOR_SPEED_MAX);
-  
-  if (speed > 0) {
-    analogWrite(motor.pins.pinA, speed);
-    analogWrite(motor.pins.pinB, 0);
-  } else if (speed < 0) {
-    analogWrite(motor.pins.pinA, 0);
-    analogWrite(motor.pins.pinB, abs(speed));
-  } else {
-    analogWrite(motor.pins.pinA, 0);
-    analogWrite(motor.pins.pinB, 0);
-  }
+// Запись скважностей входов мотора (применяются в motorpwm_commit)
+static void setMotorSpeed(int index, int speed) {
+  MotorDuty duty = motormix_duty(speed, motorpwm_maxDuty());
+  motorpwm_setDuty(index * 2, duty.forward);
+  motorpwm_setDuty(index * 2 + 1, duty.reverse);
+}
+
+// Новая уставка применяется генератором разгона на следующем такте dc_loop
+static void setMotorTarget(MotorState& motor, int speed) {
+  motor.speed = constrain(speed, MOTOR_SPEED_MIN, MOTOR_SPEED_MAX);
 }
 
 // Вывод информации о скорости мотора
 static void printMotorSpeed(const char* motorName, int speed) {
-  Serial.print("Motor ");
-  Serial.print(motorName);
-  Serial.print(" speed: ");
-  Serial.println(speed);
+  LOG_D("MOTOR", "Motor %s speed: %d", motorName, speed);
 }
 
 // ===== Публичные функции =====
 
 void dc_init() {
-  const char* motorNames[] = {"A", "B", "C", "D"};
-  
+  int pins[MOTOR_COUNT * 2];
   for (int i = 0; i < MOTOR_COUNT; i++) {
-    pinMode(motors[i].pins.pinA, OUTPUT);
-    pinMode(motors[i].pins.pinB, OUTPUT);
+    pins[i * 2] = motors[i].pins.pinA;
+    pins[i * 2 + 1] = motors[i].pins.pinB;
+    motors[i].limits = ramp_limits(rampAccel[i], rampJerk[i], DC_LOOP_PERIOD_US);
   }
-  
+
+  if (!motorpwm_init(pins, MOTOR_COUNT * 2)) {
+    Serial.println("DC motors PWM init failed");
+    return;
+  }
+
   motor_stopAll();
+  sched_addJob("dc", DC_LOOP_PERIOD_US, DC_LOOP_PRIORITY, DC_LOOP_BUDGET_US, dc_loop);
   Serial.println("DC motors initialized (A, B, C, D)");
 }
 
+// Такт генератора разгона: шаг рампы каждого мотора, затем все скважности
+// применяются одним обновлением (только если что-то изменилось)
 void dc_loop() {
-  // Резерв для будущей логики автоматического управления
+  // Аварийная остановка: ШИМ уже снят задачей safety, уставки сбрасываются
+  if (safety_isEstopped()) {
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+      motors[i].speed = 0;
+      motors[i].output = 0;
+      ramp_reset(&motors[i].ramp, 0);
+    }
+    return;
+  }
+
+  // Deadman: нет кадров управления — плавная остановка
+  bool deadman = safety_isDeadmanTripped();
+  if (deadman) {
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+      setMotorTarget(motors[i], 0);
+    }
+  }
+
+  // Рефлекс: скорость вперёд не больше допустимой по дальномеру,
+  // превышение снимается в этом же такте без рампы
+  int forwardLimit = reflex_update();
+  int32_t limitFixed = ramp_toFixed(forwardLimit);
+  bool clamped = false;
+  bool cut = false;
+  for (int i = 0; i < MOTOR_COUNT; i++) {
+    if (motors[i].ramp.value > limitFixed) {
+      ramp_reset(&motors[i].ramp, limitFixed);
+      clamped = true;
+      cut = true;
+    }
+    int target = motors[i].speed;
+    if (target > forwardLimit) {
+      target = forwardLimit;
+      clamped = true;
+    }
+    motors[i].ramp.target = ramp_toFixed(target);
+  }
+  bool changed = false;
+  bool stopped = true;
+  for (int i = 0; i < MOTOR_COUNT; i++) {
+    int output = ramp_toInt(ramp_step(&motors[i].ramp, &motors[i].limits));
+    if (output != motors[i].output) {
+      motors[i].output = output;
+      setMotorSpeed(i, output);
+      changed = true;
+    }
+    if (output != 0) stopped = false;
+  }
+  if (changed) motorpwm_commit();
+  if (clamped) reflex_countClamp(cut);
+  if (deadman && stopped) safety_notifyStopped();
 }
 
 void motor_setSpeedA(int speed) {
-  motors[0].speed = speed;
-  setMotorSpeed(motors[0], speed);
-  printMotorSpeed("A", speed);
+  setMotorTarget(motors[0], speed);
+  printMotorSpeed("A", motors[0].speed);
 }
 
 void motor_setSpeedB(int speed) {
-  motors[1].speed = speed;
-  setMotorSpeed(motors[1], speed);
-  printMotorSpeed("B", speed);
+  setMotorTarget(motors[1], speed);
+  printMotorSpeed("B", motors[1].speed);
 }
 
 void motor_setSpeedC(int speed) {
-  motors[2].speed = speed;
-  setMotorSpeed(motors[2], speed);
-  printMotorSpeed("C", speed);
+  setMotorTarget(motors[2], speed);
+  printMotorSpeed("C", motors[2].speed);
 }
 
 void motor_setSpeedD(int speed) {
-  motors[3].speed = speed;
-  setMotorSpeed(motors[3], speed);
-  printMotorSpeed("D", speed);
+  setMotorTarget(motors[3], speed);
+  printMotorSpeed("D", motors[3].speed);
 }
 
 int motor_getSpeedA() { return motors[0].speed; }
@@ -103,11 +178,19 @@ int motor_getSpeedB() { return motors[1].speed; }
 int motor_getSpeedC() { return motors[2].speed; }
 int motor_getSpeedD() { return motors[3].speed; }
 
+int motor_getOutput(int index) {
+  if (index < 0 || index >= MOTOR_COUNT) return 0;
+  return motors[index].output;
+}
+
+// Остановка без рампы: аварийный путь не ждёт торможения
 void motor_stopAll() {
   for (int i = 0; i < MOTOR_COUNT; i++) {
     motors[i].speed = 0;
-    analogWrite(motors[i].pins.pinA, LOW);
-    analogWrite(motors[i].pins.pinB, LOW);
+    motors[i].output = 0;
+    ramp_reset(&motors[i].ramp, 0);
+    setMotorSpeed(i, 0);
   }
-  Serial.println("All motors stopped (A, B, C, D)");
+  motorpwm_commit();
+  LOG_I("MOTOR", "All motors stopped (A, B, C, D)");
 }
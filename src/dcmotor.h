@@ -6,11 +6,13 @@
 // Инициализация DC-моторов
 void dc_init();
 
-// Обработка DC-моторов (должна вызываться в loop)
+// Обработка DC-моторов (вызывается планировщиком с периодом DC_LOOP_PERIOD_US)
 void dc_loop();
 
 // Установка скорости мотора A (-255...255)
-// Положительное значение - вперёд, отрицательное - назад
+// Положительное значение - вперёд, отрицательное - назад.
+// Уставка применяется на следующем такте dc_loop с ограничением разгона и рывка
+// (MOTOR_RAMP_ACCEL / MOTOR_RAMP_JERK)
 void motor_setSpeedA(int speed);
 
 // Установка скорости мотора B (-255...255)
@@ -34,7 +36,10 @@ int motor_getSpeedC();
 // Получение текущей скорости мотора D
 int motor_getSpeedD();
 
-// Остановка всех моторов
+// Текущий ШИМ мотора (0-3 — A, B, C, D) после генератора разгона
+int motor_getOutput(int index);
+
+// Остановка всех моторов (сразу, без рампы)
 void motor_stopAll();
 
 #endif
\ No newline at end of file
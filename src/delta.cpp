@@ -0,0 +1,281 @@
+#include "delta.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mbedtls/sha256.h>
+
+// ===== Константы =====
+
+// Буфер базы: разность применяется на месте и сразу уходит в sink
+#define DELTA_BUFFER_SIZE 2048
+
+// ===== Структуры данных =====
+
+enum DeltaStage : uint8_t {
+  STAGE_HEADER = 0,
+  STAGE_RECORD,
+  STAGE_DIFF,
+  STAGE_EXTRA,
+  STAGE_DONE
+};
+
+struct Delta {
+  DeltaBaseRead read;
+  DeltaSink sink;
+  void* context;
+  DeltaStage stage;
+  DeltaStatus status;
+  uint8_t field[DELTA_HEADER_SIZE];    // заголовок или запись
+  uint8_t fieldPos;
+  uint32_t baseSize;
+  uint32_t targetSize;
+  uint8_t targetSha256[DELTA_SHA256_SIZE];
+  uint32_t basePos;                    // указатель в базе
+  uint32_t diffLeft;
+  uint32_t extraLeft;
+  int32_t seek;
+  uint32_t outputBytes;
+  uint32_t baseReadBytes;
+  mbedtls_sha256_context sha256;       // SHA-256 результата
+  uint8_t buffer[DELTA_BUFFER_SIZE];
+};
+
+// ===== Вспомогательные функции =====
+
+static uint32_t readLe32(const uint8_t* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static bool readBase(Delta* delta, uint32_t offset, size_t length) {
+  delta->baseReadBytes += length;
+  if (delta->read(offset, delta->buffer, length, delta->context)) return true;
+  delta->status = DELTA_ERR_READ;
+  return false;
+}
+
+static bool emit(Delta* delta, const uint8_t* data, size_t length) {
+  mbedtls_sha256_update(&delta->sha256, data, length);
+  delta->outputBytes += length;
+  if (delta->sink(data, length, delta->context)) return true;
+  delta->status = DELTA_ERR_SINK;
+  return false;
+}
+
+// SHA-256 всей базы до записи первого байта результата
+static bool verifyBase(Delta* delta, const uint8_t expected[DELTA_SHA256_SIZE]) {
+  mbedtls_sha256_context sha256;
+  mbedtls_sha256_init(&sha256);
+  mbedtls_sha256_starts(&sha256, 0);
+  for (uint32_t offset = 0; offset < delta->baseSize; offset += DELTA_BUFFER_SIZE) {
+    size_t length = delta->baseSize - offset < DELTA_BUFFER_SIZE ? delta->baseSize - offset : DELTA_BUFFER_SIZE;
+    if (!readBase(delta, offset, length)) {
+      mbedtls_sha256_free(&sha256);
+      return false;
+    }
+    mbedtls_sha256_update(&sha256, delta->buffer, length);
+  }
+  uint8_t digest[DELTA_SHA256_SIZE];
+  mbedtls_sha256_finish(&sha256, digest);
+  mbedtls_sha256_free(&sha256);
+
+  if (memcmp(digest, expected, DELTA_SHA256_SIZE) != 0) {
+    delta->status = DELTA_ERR_BASE;
+    return false;
+  }
+  return true;
+}
+
+static void parseHeader(Delta* delta) {
+  const uint8_t* header = delta->field;
+  if (memcmp(header, DELTA_MAGIC, DELTA_MAGIC_SIZE) != 0 || header[4] != DELTA_VERSION) {
+    delta->status = DELTA_ERR_HEADER;
+    return;
+  }
+  delta->baseSize = readLe32(header + 8);
+  delta->targetSize = readLe32(header + 12);
+  memcpy(delta->targetSha256, header + 16 + DELTA_SHA256_SIZE, DELTA_SHA256_SIZE);
+  if (!verifyBase(delta, header + 16)) return;
+
+  delta->stage = delta->targetSize > 0 ? STAGE_RECORD : STAGE_DONE;
+  delta->fieldPos = 0;
+}
+
+// Следующая запись или конец, если результат собран
+static void nextRecord(Delta* delta) {
+  int64_t basePos = (int64_t)delta->basePos + delta->seek;
+  if (basePos < 0 || basePos > delta->baseSize) {
+    delta->status = DELTA_ERR_DATA;
+    return;
+  }
+  delta->basePos = (uint32_t)basePos;
+  delta->stage = delta->outputBytes == delta->targetSize ? STAGE_DONE : STAGE_RECORD;
+  delta->fieldPos = 0;
+}
+
+static void parseRecord(Delta* delta) {
+  delta->diffLeft = readLe32(delta->field);
+  delta->extraLeft = readLe32(delta->field + 4);
+  delta->seek = (int32_t)readLe32(delta->field + 8);
+
+  // Пределы проверяются до записи: повреждённый патч не должен читать или писать мимо
+  if (delta->diffLeft > delta->baseSize - delta->basePos ||
+      (uint64_t)delta->diffLeft + delta->extraLeft > delta->targetSize - delta->outputBytes) {
+    delta->status = DELTA_ERR_DATA;
+    return;
+  }
+  if (delta->diffLeft > 0) {
+    delta->stage = STAGE_DIFF;
+  } else if (delta->extraLeft > 0) {
+    delta->stage = STAGE_EXTRA;
+  } else {
+    nextRecord(delta);
+  }
+}
+
+// Заголовок и записи собираются побайтно: могут попасть на границу частей
+static size_t collectField(Delta* delta, const uint8_t* data, size_t length, uint8_t size) {
+  size_t left = size - delta->fieldPos;
+  size_t count = left < length ? left : length;
+  memcpy(delta->field + delta->fieldPos, data, count);
+  delta->fieldPos += count;
+  if (delta->fieldPos == size) {
+    if (delta->stage == STAGE_HEADER) {
+      parseHeader(delta);
+    } else {
+      parseRecord(delta);
+    }
+  }
+  return count;
+}
+
+static size_t applyDiff(Delta* delta, const uint8_t* data, size_t length) {
+  size_t count = delta->diffLeft < length ? delta->diffLeft : length;
+  if (count > DELTA_BUFFER_SIZE) count = DELTA_BUFFER_SIZE;
+  if (!readBase(delta, delta->basePos, count)) return count;
+
+  for (size_t i = 0; i < count; i++) delta->buffer[i] += data[i];
+  if (!emit(delta, delta->buffer, count)) return count;
+
+  delta->basePos += count;
+  delta->diffLeft -= count;
+  if (delta->diffLeft == 0) {
+    if (delta->extraLeft > 0) {
+      delta->stage = STAGE_EXTRA;
+    } else {
+      nextRecord(delta);
+    }
+  }
+  return count;
+}
+
+static size_t copyExtra(Delta* delta, const uint8_t* data, size_t length) {
+  size_t count = delta->extraLeft < length ? delta->extraLeft : length;
+  if (!emit(delta, data, count)) return count;
+
+  delta->extraLeft -= count;
+  if (delta->extraLeft == 0) nextRecord(delta);
+  return count;
+}
+
+// ===== Публичные функции =====
+
+bool delta_isDelta(const uint8_t* data, size_t length) {
+  return length >= DELTA_MAGIC_SIZE && memcmp(data, DELTA_MAGIC, DELTA_MAGIC_SIZE) == 0;
+}
+
+Delta* delta_create(DeltaBaseRead read, DeltaSink sink, void* context) {
+  Delta* delta = (Delta*)malloc(sizeof(Delta));
+  if (delta == NULL) return NULL;
+
+  delta->read = read;
+  delta->sink = sink;
+  delta->context = context;
+  delta->stage = STAGE_HEADER;
+  delta->status = DELTA_OK;
+  delta->fieldPos = 0;
+  delta->baseSize = 0;
+  delta->targetSize = 0;
+  delta->basePos = 0;
+  delta->diffLeft = 0;
+  delta->extraLeft = 0;
+  delta->seek = 0;
+  delta->outputBytes = 0;
+  delta->baseReadBytes = 0;
+  mbedtls_sha256_init(&delta->sha256);
+  mbedtls_sha256_starts(&delta->sha256, 0);
+  return delta;
+}
+
+void delta_destroy(Delta* delta) {
+  if (delta == NULL) return;
+  mbedtls_sha256_free(&delta->sha256);
+  free(delta);
+}
+
+DeltaStatus delta_write(Delta* delta, const uint8_t* data, size_t length) {
+  size_t pos = 0;
+  while (pos < length && delta->status == DELTA_OK) {
+    switch (delta->stage) {
+      case STAGE_HEADER:
+        pos += collectField(delta, data + pos, length - pos, DELTA_HEADER_SIZE);
+        break;
+      case STAGE_RECORD:
+        pos += collectField(delta, data + pos, length - pos, DELTA_RECORD_SIZE);
+        break;
+      case STAGE_DIFF:
+        pos += applyDiff(delta, data + pos, length - pos);
+        break;
+      case STAGE_EXTRA:
+        pos += copyExtra(delta, data + pos, length - pos);
+        break;
+      default:
+        // Результат собран, а данные ещё идут — патч повреждён
+        delta->status = DELTA_ERR_DATA;
+        break;
+    }
+  }
+  return delta->status;
+}
+
+DeltaStatus delta_finish(Delta* delta) {
+  if (delta->status != DELTA_OK) return delta->status;
+  if (delta->stage != STAGE_DONE) {
+    delta->status = DELTA_ERR_TRUNCATED;
+    return delta->status;
+  }
+
+  uint8_t digest[DELTA_SHA256_SIZE];
+  mbedtls_sha256_finish(&delta->sha256, digest);
+  if (delta->outputBytes != delta->targetSize || memcmp(digest, delta->targetSha256, DELTA_SHA256_SIZE) != 0) {
+    delta->status = DELTA_ERR_RESULT;
+  }
+  return delta->status;
+}
+
+uint32_t delta_outputBytes(const Delta* delta) {
+  return delta->outputBytes;
+}
+
+uint32_t delta_baseReadBytes(const Delta* delta) {
+  return delta->baseReadBytes;
+}
+
+size_t delta_memoryBytes() {
+  return sizeof(Delta);
+}
+
+const char* delta_statusName(DeltaStatus status) {
+  switch (status) {
+    case DELTA_OK: return "ok";
+    case DELTA_ERR_MEMORY: return "Not enough memory for delta";
+    case DELTA_ERR_HEADER: return "Not a delta patch or unsupported version";
+    case DELTA_ERR_BASE: return "Delta base mismatch: running firmware differs";
+    case DELTA_ERR_READ: return "Running partition read failed";
+    case DELTA_ERR_DATA: return "Corrupted delta patch";
+    case DELTA_ERR_RESULT: return "Delta result SHA-256/size mismatch";
+    case DELTA_ERR_TRUNCATED: return "Delta patch truncated";
+    case DELTA_ERR_SINK: return "Write failed";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,78 @@
+#ifndef _DELTA_H
+#define _DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Потоковое применение дельта-патча прошивки (scripts/mkdelta.py) к образу
+// в работающем разделе. Формат — как у bsdiff: записи «diff» (байты базы
+// плюс разность, почти нули для сдвинутых адресов) и «extra» (новые байты),
+// между записями указатель в базе смещается на seek. Патч обычно сжат gzip
+// и проходит через gunzip.h до delta_write().
+//
+// Заголовок (little-endian, DELTA_HEADER_SIZE байт):
+//   "RDLT", версия, 3 байта резерва, размер базы, размер результата,
+//   SHA-256 базы, SHA-256 результата
+// Запись: diffLen (u32), extraLen (u32), seek (i32), diffLen байт разности,
+//   extraLen новых байт
+//
+// SHA-256 базы проверяется по заголовку до первой записи в раздел обновления,
+// SHA-256 и размер результата — в delta_finish(). Байты патча после последней
+// записи — ошибка DELTA_ERR_DATA.
+
+// ===== Константы =====
+
+#define DELTA_MAGIC "RDLT"
+#define DELTA_MAGIC_SIZE 4
+#define DELTA_VERSION 1
+#define DELTA_HEADER_SIZE 80
+#define DELTA_RECORD_SIZE 12
+#define DELTA_SHA256_SIZE 32
+
+// ===== Структуры данных =====
+
+enum DeltaStatus : uint8_t {
+  DELTA_OK = 0,
+  DELTA_ERR_MEMORY,       // нет памяти под состояние
+  DELTA_ERR_HEADER,       // не патч или неподдерживаемая версия
+  DELTA_ERR_BASE,         // работающая прошивка не та, от которой строился патч
+  DELTA_ERR_READ,         // ошибка чтения базы
+  DELTA_ERR_DATA,         // запись выходит за пределы базы или результата, данные после результата
+  DELTA_ERR_RESULT,       // SHA-256 или размер результата не совпали с заголовком
+  DELTA_ERR_TRUNCATED,    // патч закончился раньше результата
+  DELTA_ERR_SINK          // sink вернул false
+};
+
+// Чтение length байт базы со смещения offset; false — ошибка чтения
+typedef bool (*DeltaBaseRead)(uint32_t offset, uint8_t* data, size_t length, void* context);
+
+// Приёмник восстановленного образа; false — прервать применение
+typedef bool (*DeltaSink)(const uint8_t* data, size_t length, void* context);
+
+struct Delta;
+
+// ===== Функции =====
+
+// true, если данные начинаются с сигнатуры патча
+bool delta_isDelta(const uint8_t* data, size_t length);
+
+// Состояние применения (~2.5 КБ) или NULL при нехватке памяти
+Delta* delta_create(DeltaBaseRead read, DeltaSink sink, void* context);
+void delta_destroy(Delta* delta);
+
+// Очередная часть патча. После ошибки возвращает её же.
+DeltaStatus delta_write(Delta* delta, const uint8_t* data, size_t length);
+
+// Конец патча: результат собран полностью и совпал с заголовком
+DeltaStatus delta_finish(Delta* delta);
+
+// Байт результата, отданных в sink, и байт, прочитанных из базы
+uint32_t delta_outputBytes(const Delta* delta);
+uint32_t delta_baseReadBytes(const Delta* delta);
+
+// Памяти занято состоянием, байт
+size_t delta_memoryBytes();
+
+const char* delta_statusName(DeltaStatus status);
+
+#endif
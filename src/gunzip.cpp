@@ -0,0 +1,240 @@
+#include "gunzip.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rom/miniz.h"
+#include "esp_rom_crc.h"
+
+// ===== Константы =====
+
+#define GZIP_HEADER_SIZE 10
+#define GZIP_TRAILER_SIZE 8
+#define GZIP_METHOD_DEFLATE 8
+
+// Флаги FLG заголовка
+#define GZIP_FLAG_HCRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+// Окно должно быть степенью двойки: позиция в кольце — по маске
+static_assert((TINFL_LZ_DICT_SIZE & (TINFL_LZ_DICT_SIZE - 1)) == 0, "inflate window must be a power of two");
+
+// ===== Структуры данных =====
+
+// Разбор потока: поля заголовка (по флагам), deflate, трейлер
+enum GunzipStage : uint8_t {
+  STAGE_HEADER = 0,
+  STAGE_EXTRA_LENGTH,
+  STAGE_EXTRA,
+  STAGE_NAME,
+  STAGE_COMMENT,
+  STAGE_HEADER_CRC,
+  STAGE_DEFLATE,
+  STAGE_TRAILER,
+  STAGE_DONE
+};
+
+struct Gunzip {
+  tinfl_decompressor inflator;
+  uint8_t window[TINFL_LZ_DICT_SIZE];  // кольцевой словарь и буфер вывода
+  size_t windowPos;
+  GunzipSink sink;
+  void* context;
+  GunzipStage stage;
+  GunzipStatus status;
+  uint8_t flags;
+  uint8_t field[GZIP_HEADER_SIZE];     // заголовок, длина FEXTRA, FHCRC или трейлер
+  uint8_t fieldPos;
+  uint16_t skip;                       // оставшиеся байты FEXTRA
+  uint32_t crc;
+  uint32_t outputBytes;
+};
+
+// ===== Вспомогательные функции =====
+
+static uint32_t readLe32(const uint8_t* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Первое поле заголовка начиная с stage, которое есть по флагам
+static GunzipStage nextField(uint8_t flags, GunzipStage stage) {
+  if (stage <= STAGE_EXTRA_LENGTH && (flags & GZIP_FLAG_EXTRA)) return STAGE_EXTRA_LENGTH;
+  if (stage <= STAGE_NAME && (flags & GZIP_FLAG_NAME)) return STAGE_NAME;
+  if (stage <= STAGE_COMMENT && (flags & GZIP_FLAG_COMMENT)) return STAGE_COMMENT;
+  if (stage <= STAGE_HEADER_CRC && (flags & GZIP_FLAG_HCRC)) return STAGE_HEADER_CRC;
+  return STAGE_DEFLATE;
+}
+
+static void enterStage(Gunzip* gz, GunzipStage stage) {
+  gz->stage = stage;
+  gz->fieldPos = 0;
+  if (stage == STAGE_DEFLATE) tinfl_init(&gz->inflator);
+}
+
+// Заголовок разбирается побайтно: поля переменной длины могут попасть на границу частей
+static size_t parseHeader(Gunzip* gz, const uint8_t* data, size_t length) {
+  size_t i = 0;
+  while (i < length && gz->stage < STAGE_DEFLATE && gz->status == GUNZIP_OK) {
+    uint8_t byte = data[i++];
+    switch (gz->stage) {
+      case STAGE_HEADER:
+        gz->field[gz->fieldPos++] = byte;
+        if (gz->fieldPos < GZIP_HEADER_SIZE) break;
+        if (gz->field[0] != GUNZIP_MAGIC0 || gz->field[1] != GUNZIP_MAGIC1 || gz->field[2] != GZIP_METHOD_DEFLATE) {
+          gz->status = GUNZIP_ERR_HEADER;
+          break;
+        }
+        gz->flags = gz->field[3];
+        enterStage(gz, nextField(gz->flags, STAGE_EXTRA_LENGTH));
+        break;
+
+      case STAGE_EXTRA_LENGTH:
+        gz->field[gz->fieldPos++] = byte;
+        if (gz->fieldPos < 2) break;
+        gz->skip = gz->field[0] | (gz->field[1] << 8);
+        enterStage(gz, gz->skip > 0 ? STAGE_EXTRA : nextField(gz->flags, STAGE_NAME));
+        break;
+
+      case STAGE_EXTRA:
+        if (--gz->skip == 0) enterStage(gz, nextField(gz->flags, STAGE_NAME));
+        break;
+
+      case STAGE_NAME:
+        if (byte == 0) enterStage(gz, nextField(gz->flags, STAGE_COMMENT));
+        break;
+
+      case STAGE_COMMENT:
+        if (byte == 0) enterStage(gz, nextField(gz->flags, STAGE_HEADER_CRC));
+        break;
+
+      case STAGE_HEADER_CRC:
+        if (++gz->fieldPos == 2) enterStage(gz, STAGE_DEFLATE);
+        break;
+
+      default:
+        break;
+    }
+  }
+  return i;
+}
+
+// Распаковка в кольцевое окно; каждая заполненная часть окна сразу уходит в sink
+static size_t inflateData(Gunzip* gz, const uint8_t* data, size_t length) {
+  size_t consumed = 0;
+  for (;;) {
+    size_t inBytes = length - consumed;
+    size_t outBytes = TINFL_LZ_DICT_SIZE - gz->windowPos;
+    tinfl_status status = tinfl_decompress(&gz->inflator, data + consumed, &inBytes, gz->window,
+                                           gz->window + gz->windowPos, &outBytes, TINFL_FLAG_HAS_MORE_INPUT);
+    consumed += inBytes;
+
+    if (outBytes > 0) {
+      uint8_t* out = gz->window + gz->windowPos;
+      gz->crc = esp_rom_crc32_le(gz->crc, out, outBytes);
+      gz->outputBytes += outBytes;
+      gz->windowPos = (gz->windowPos + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+      if (!gz->sink(out, outBytes, gz->context)) {
+        gz->status = GUNZIP_ERR_SINK;
+        return consumed;
+      }
+    }
+
+    if (status == TINFL_STATUS_DONE) {
+      enterStage(gz, STAGE_TRAILER);
+      return consumed;
+    }
+    if (status < 0) {
+      gz->status = GUNZIP_ERR_DATA;
+      return consumed;
+    }
+    // Вход исчерпан; иначе (HAS_MORE_OUTPUT) окно дошло до конца — продолжаем с начала
+    if (status == TINFL_STATUS_NEEDS_MORE_INPUT) return consumed;
+  }
+}
+
+static size_t parseTrailer(Gunzip* gz, const uint8_t* data, size_t length) {
+  size_t i = 0;
+  while (i < length && gz->fieldPos < GZIP_TRAILER_SIZE) {
+    gz->field[gz->fieldPos++] = data[i++];
+  }
+  if (gz->fieldPos == GZIP_TRAILER_SIZE) {
+    // ISIZE — длина по модулю 2^32
+    if (readLe32(gz->field) != gz->crc || readLe32(gz->field + 4) != gz->outputBytes) {
+      gz->status = GUNZIP_ERR_CRC;
+    }
+    gz->stage = STAGE_DONE;
+  }
+  return i;
+}
+
+// ===== Публичные функции =====
+
+bool gunzip_isGzip(const uint8_t* data, size_t length) {
+  return length >= 2 && data[0] == GUNZIP_MAGIC0 && data[1] == GUNZIP_MAGIC1;
+}
+
+Gunzip* gunzip_create(GunzipSink sink, void* context) {
+  Gunzip* gz = (Gunzip*)malloc(sizeof(Gunzip));
+  if (gz == NULL) return NULL;
+
+  gz->windowPos = 0;
+  gz->sink = sink;
+  gz->context = context;
+  gz->status = GUNZIP_OK;
+  gz->flags = 0;
+  gz->skip = 0;
+  gz->crc = 0;
+  gz->outputBytes = 0;
+  enterStage(gz, STAGE_HEADER);
+  return gz;
+}
+
+void gunzip_destroy(Gunzip* gz) {
+  free(gz);
+}
+
+GunzipStatus gunzip_write(Gunzip* gz, const uint8_t* data, size_t length) {
+  size_t pos = 0;
+  while (pos < length && gz->status == GUNZIP_OK) {
+    if (gz->stage < STAGE_DEFLATE) {
+      pos += parseHeader(gz, data + pos, length - pos);
+    } else if (gz->stage == STAGE_DEFLATE) {
+      pos += inflateData(gz, data + pos, length - pos);
+    } else if (gz->stage == STAGE_TRAILER) {
+      pos += parseTrailer(gz, data + pos, length - pos);
+    } else {
+      // Данные после трейлера (следующие члены gzip) не поддерживаются и пропускаются
+      break;
+    }
+  }
+  return gz->status;
+}
+
+GunzipStatus gunzip_finish(Gunzip* gz) {
+  if (gz->status != GUNZIP_OK) return gz->status;
+  if (gz->stage != STAGE_DONE) gz->status = GUNZIP_ERR_TRUNCATED;
+  return gz->status;
+}
+
+uint32_t gunzip_outputBytes(const Gunzip* gz) {
+  return gz->outputBytes;
+}
+
+size_t gunzip_memoryBytes() {
+  return sizeof(Gunzip);
+}
+
+const char* gunzip_statusName(GunzipStatus status) {
+  switch (status) {
+    case GUNZIP_OK: return "ok";
+    case GUNZIP_ERR_MEMORY: return "Not enough memory for decompression";
+    case GUNZIP_ERR_HEADER: return "Not a gzip/deflate stream";
+    case GUNZIP_ERR_DATA: return "Corrupted compressed data";
+    case GUNZIP_ERR_CRC: return "Decompressed CRC32/size mismatch";
+    case GUNZIP_ERR_TRUNCATED: return "Compressed stream truncated";
+    case GUNZIP_ERR_SINK: return "Write failed";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef _GUNZIP_H
+#define _GUNZIP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Потоковая распаковка gzip (RFC 1952) частями произвольного размера.
+// Inflate — tinfl из ROM (miniz), окно словаря — кольцевой буфер 32 КБ
+// в куче, поэтому память не зависит от размера образа. Распакованные данные
+// передаются в sink по мере готовности; CRC32 и длина из трейлера проверяются
+// в gunzip_finish().
+
+// ===== Константы =====
+
+#define GUNZIP_MAGIC0 0x1F
+#define GUNZIP_MAGIC1 0x8B
+
+// ===== Структуры данных =====
+
+enum GunzipStatus : uint8_t {
+  GUNZIP_OK = 0,
+  GUNZIP_ERR_MEMORY,      // нет памяти под окно и состояние inflate
+  GUNZIP_ERR_HEADER,      // не gzip или метод сжатия не deflate
+  GUNZIP_ERR_DATA,        // повреждённый поток deflate
+  GUNZIP_ERR_CRC,         // CRC32 или длина не совпали с трейлером
+  GUNZIP_ERR_TRUNCATED,   // поток закончился раньше трейлера
+  GUNZIP_ERR_SINK         // sink вернул false
+};
+
+// Приёмник распакованных данных; false — прервать распаковку
+typedef bool (*GunzipSink)(const uint8_t* data, size_t length, void* context);
+
+struct Gunzip;
+
+// ===== Функции =====
+
+// true, если данные начинаются с сигнатуры gzip
+bool gunzip_isGzip(const uint8_t* data, size_t length);
+
+// Состояние распаковщика (окно + inflate, ~43 КБ) или NULL при нехватке памяти
+Gunzip* gunzip_create(GunzipSink sink, void* context);
+void gunzip_destroy(Gunzip* gz);
+
+// Очередная часть сжатого потока. После ошибки возвращает её же.
+GunzipStatus gunzip_write(Gunzip* gz, const uint8_t* data, size_t length);
+
+// Конец входных данных: поток завершён и трейлер совпал
+GunzipStatus gunzip_finish(Gunzip* gz);
+
+// Байт распакованных данных, отданных в sink
+uint32_t gunzip_outputBytes(const Gunzip* gz);
+
+// Памяти занято распаковщиком, байт
+size_t gunzip_memoryBytes();
+
+const char* gunzip_statusName(GunzipStatus status);
+
+#endif
@@ -1,25 +1,196 @@
+#include "lidar.h"
 #include "pins.h"
 #include "config.h"
+#include "scheduler.h"
+#include "sample_ring.h"
+#include "snapshot.h"
 
 #include "Adafruit_VL53L0X.h"
 #include <Wire.h>
 
 // Адрес мультиплексора TCA9548A (обычно 0x70)
 #define TCA_ADDR 0x70
+#define TCA_CHANNEL_NONE 0xFF
 
-Adafruit_VL53L0X lox = Adafruit_VL53L0X();
+// Каналы мультиплексора с датчиками (бит i — канал i), переопределяется в config.h
+#ifndef LIDAR_CHANNEL_MASK
+#define LIDAR_CHANNEL_MASK 0x01
+#endif
+
+// Частота публикации кадра по всем направлениям, переопределяется в config.h
+#ifndef LIDAR_FRAME_RATE_HZ
+#define LIDAR_FRAME_RATE_HZ 20
+#endif
+
+// Непрерывный режим: датчики меряют сами, задача лишь опрашивает готовность
+// результатов — без блокировки на время замера (~20-30 мс).
+// Старт датчиков разнесён по фазе на LIDAR_TIMING_BUDGET_US / N, поэтому
+// замеры идут параллельно, а результаты готовы в разные моменты — за один
+// опрос обычно читается один датчик и переключается один канал.
+#define LIDAR_CONTINUOUS_PERIOD_MS 0   // 0 — замеры подряд (back-to-back)
+#define LIDAR_POLL_PERIOD_US 2000
+#define LIDAR_POLL_BUDGET_US 1500
+#define LIDAR_PRIORITY 1
+#define LIDAR_FRAME_PERIOD_US (1000000UL / LIDAR_FRAME_RATE_HZ)
+#define LIDAR_TIMEOUT_US (3 * LIDAR_TIMING_BUDGET_US)        // результат не готов слишком долго
+#define LIDAR_FRAME_MAX_AGE_US (3 * LIDAR_TIMING_BUDGET_US)  // отсчёт старше — не попадает в кадр
+
+#define LIDAR_RING_SIZE 64
+
+// ===== Структуры данных =====
+
+struct LidarSensor {
+  Adafruit_VL53L0X lox;
+  uint64_t expectedUs;    // ожидаемая готовность следующего результата
+  uint64_t deadlineUs;    // после этого момента без результата — таймаут
+  uint64_t sampleUs;      // время последнего отсчёта
+  uint16_t rangeMm;
+  uint8_t status;
+  LidarSensorStats stats;
+};
+
+// ===== Глобальные переменные =====
+
+static LidarSensor sensors[LIDAR_MAX_SENSORS];
+static uint8_t activeChannel = TCA_CHANNEL_NONE;   // кэш выбранного канала мультиплексора
+
+static SampleRing<LidarSample, LIDAR_RING_SIZE> samples;
+static Snapshot<LidarFrame> frameSnapshot;
+static LidarFrame frame;
+static uint64_t nextFrameUs = 0;
+
+static LidarStats stats;
+static uint64_t rateWindowStartUs = 0;
+static uint32_t rateWindowSamples = 0;
 
 // --- Функция переключения канала мультиплексора ---
-void tcaSelect(uint8_t channel) {
-  if (channel > 7) return; // У мультиплексора только 8 каналов (0-7)
-  
+// Запись пропускается, если канал уже выбран. false — ошибка I2C.
+static bool tcaSelect(uint8_t channel) {
+  if (channel > 7) return false; // У мультиплексора только 8 каналов (0-7)
+  if (channel == activeChannel) {
+    stats.muxSkipped++;
+    return true;
+  }
+
   Wire1.beginTransmission(TCA_ADDR);
   // Мы отправляем 1 байт, где каждый бит соответствует каналу
   // 1 << channel означает: для канала 0 отправим 0b00000001, для канала 1 - 0b00000010 и т.д.
   Wire1.write(1 << channel); 
-  Wire1.endTransmission();
+  stats.muxSelects++;
+  if (Wire1.endTransmission() != 0) {
+    activeChannel = TCA_CHANNEL_NONE;
+    return false;
+  }
+
+  activeChannel = channel;
+  return true;
+}
+
+// Учёт суммарной частоты отсчётов в окне 1 с
+static void updateRate(uint64_t now) {
+  rateWindowSamples++;
+  if (now - rateWindowStartUs >= 1000000) {
+    stats.rateHz = rateWindowSamples * 1000000ULL / (now - rateWindowStartUs);
+    rateWindowStartUs = now;
+    rateWindowSamples = 0;
+  }
+}
+
+// Опрос одного датчика: выбор канала, проверка готовности и чтение результата
+static void pollSensor(uint8_t channel, uint64_t now) {
+  LidarSensor& sensor = sensors[channel];
+  uint64_t start = esp_timer_get_time();
+
+  if (!tcaSelect(channel)) {
+    sensor.stats.errors++;
+    return;
+  }
+
+  if (!sensor.lox.isRangeComplete()) {
+    if (now > sensor.deadlineUs) {
+      sensor.stats.timeouts++;
+      sensor.deadlineUs = now + LIDAR_TIMEOUT_US;
+    }
+    return;
+  }
+
+  // readRangeResult() не обновляет lox.Status: ошибка драйвера видна только по
+  // результату 0xFFFF при RangeStatus, отличном от «вне зоны видимости» (4).
+  // При ошибке чтения RangeStatus не обновляется и может остаться 4 от прошлого
+  // замера, поэтому «вне зоны видимости» подтверждается снятым флагом готовности
+  // (успешное чтение его сбрасывает)
+  uint16_t range = sensor.lox.readRangeResult();
+  uint8_t status = sensor.lox.readRangeStatus();
+  bool outOfRange = range == LIDAR_RANGE_INVALID && status == LIDAR_STATUS_OUT_OF_RANGE &&
+                    !sensor.lox.isRangeComplete();
+  uint64_t end = esp_timer_get_time();
+
+  if (range == LIDAR_RANGE_INVALID && !outOfRange) {
+    sensor.stats.errors++;
+    status = LIDAR_STATUS_ERROR;
+  }
+
+  uint32_t latency = (uint32_t)(end - start);
+  sensor.stats.lastLatencyUs = latency;
+  if (latency > sensor.stats.maxLatencyUs) sensor.stats.maxLatencyUs = latency;
+
+  sensor.rangeMm = range;
+  sensor.status = status;
+  sensor.sampleUs = end;
+  sensor.expectedUs = end + LIDAR_TIMING_BUDGET_US - LIDAR_POLL_PERIOD_US;
+  sensor.deadlineUs = end + LIDAR_TIMEOUT_US;
+  sensor.stats.samples++;
+
+  LidarSample sample;
+  sample.timestampUs = end;
+  sample.rangeMm = range;
+  sample.status = status;
+  sample.channel = channel;
+  samples.push(sample);
+
+  stats.samples++;
+  if (status == LIDAR_STATUS_OUT_OF_RANGE) {
+    stats.invalid++;
+    sensor.stats.invalid++;
+  }
+  updateRate(end);
+}
+
+// Формирование и публикация согласованного кадра по всем направлениям
+static void publishFrame(uint64_t now) {
+  frame.seq++;
+  frame.timestampUs = now;
+  frame.validMask = 0;
+
+  for (int ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    const LidarSensor& sensor = sensors[ch];
+    frame.rangeMm[ch] = LIDAR_RANGE_INVALID;
+    frame.ageMs[ch] = 0;
+    frame.sampleUs[ch] = sensor.sampleUs;
+    frame.state[ch] = LIDAR_STATE_NONE;
+    if (!sensor.stats.present || sensor.sampleUs == 0) continue;
+
+    uint64_t age = now - sensor.sampleUs;
+    frame.ageMs[ch] = (age / 1000 > 0xFFFF) ? 0xFFFF : (uint16_t)(age / 1000);
+    if (age > LIDAR_FRAME_MAX_AGE_US) {
+      frame.state[ch] = LIDAR_STATE_STALE;
+    } else if (sensor.status == LIDAR_STATUS_ERROR) {
+      frame.state[ch] = LIDAR_STATE_ERROR;
+    } else if (sensor.rangeMm == LIDAR_RANGE_INVALID) {
+      frame.state[ch] = LIDAR_STATE_OUT_OF_RANGE;
+    } else {
+      frame.state[ch] = LIDAR_STATE_OK;
+      frame.rangeMm[ch] = sensor.rangeMm;
+      frame.validMask |= (1 << ch);
+    }
+  }
+
+  frameSnapshot.publish(frame);
+  stats.frames++;
 }
 
+// ===== Публичные функции =====
+
 void lidar_init() {
 
 
@@ -27,39 +198,92 @@ void lidar_init() {
   Wire1.begin(I2C2_SDA, I2C2_SCL); 
 
   Serial.println("Запуск системы с мультиплексором...");
+  memset(&stats, 0, sizeof(stats));
+  memset(&frame, 0, sizeof(frame));
 
-  // 1. ВАЖНО: Сначала выбираем канал, на котором висит датчик (например, канал 0)
-  tcaSelect(0);
+  // 1. Поиск датчиков: выбираем канал и инициализируем датчик, как будто он подключен напрямую
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    if (!(LIDAR_CHANNEL_MASK & (1 << ch))) continue;
 
-  // 2. Теперь инициализируем датчик, как будто он подключен напрямую
-  if (!lox.begin(VL53L0X_I2C_ADDR, false, &Wire1)) {
-    Serial.println(F("Ошибка: VL53L0X не найден на канале 0!"));
+    if (!tcaSelect(ch) || !sensors[ch].lox.begin(VL53L0X_I2C_ADDR, false, &Wire1)) {
+      Serial.println("Ошибка: VL53L0X не найден на канале " + String(ch) + "!");
+      continue;
+    }
+
+    sensors[ch].lox.setMeasurementTimingBudgetMicroSeconds(LIDAR_TIMING_BUDGET_US);
+    sensors[ch].stats.present = true;
+    frame.presentMask |= (1 << ch);
+    stats.sensors++;
+    Serial.println("Датчик на канале " + String(ch) + " найден!");
+  }
+
+  if (stats.sensors == 0) {
+    Serial.println(F("Ошибка: ни одного VL53L0X не найдено"));
     return;
   }
-  
-  Serial.println(F("Датчик на канале 0 найден!"));
+
+  // 2. Непрерывный режим со сдвигом фазы между датчиками
+  uint32_t phaseUs = LIDAR_TIMING_BUDGET_US / stats.sensors;
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    if (!sensors[ch].stats.present) continue;
+
+    tcaSelect(ch);
+    sensors[ch].lox.startRangeContinuous(LIDAR_CONTINUOUS_PERIOD_MS);
+    uint64_t now = esp_timer_get_time();
+    sensors[ch].expectedUs = now + LIDAR_TIMING_BUDGET_US - LIDAR_POLL_PERIOD_US;
+    sensors[ch].deadlineUs = now + LIDAR_TIMEOUT_US;
+    delayMicroseconds(phaseUs);
+  }
+
+  rateWindowStartUs = esp_timer_get_time();
+  nextFrameUs = rateWindowStartUs + LIDAR_FRAME_PERIOD_US;
+
+  Serial.println("Lidar: " + String(stats.sensors) + " sensor(s), phase step " + String(phaseUs) +
+                 " us, frame rate " + String(LIDAR_FRAME_RATE_HZ) + " Hz");
+
+  sched_addJob("lidar", LIDAR_POLL_PERIOD_US, LIDAR_PRIORITY, LIDAR_POLL_BUDGET_US, lidar_loop);
 }
 
+// Опрос готовности: проверяются только датчики, у которых результат уже должен
+// быть готов, начиная с текущего канала мультиплексора (без переключения).
+// Период опроса задаёт планировщик (LIDAR_POLL_PERIOD_US).
 void lidar_loop() {
-  static unsigned long lastLidarRead = 0;
-  const unsigned long lidarInterval = 100; // Интервал между измерениями в мс
-  
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastLidarRead >= lidarInterval) {
-    lastLidarRead = currentMillis;
-    
-    // 1. Выбираем канал датчика
-    tcaSelect(0);
-
-    // 2. Делаем замер
-    VL53L0X_RangingMeasurementData_t measure;
-    lox.rangingTest(&measure, false);
-
-    if (measure.RangeStatus != 4) {
-      Serial.print("Канал 0, Расстояние (мм): ");
-      Serial.println(measure.RangeMilliMeter);
-    } else {
-      Serial.println("Канал 0: Объект вне зоны видимости");
-    }
+  stats.polls++;
+  uint64_t now = esp_timer_get_time();
+
+  uint8_t first = (activeChannel < LIDAR_MAX_SENSORS) ? activeChannel : 0;
+  for (int i = 0; i < LIDAR_MAX_SENSORS; i++) {
+    uint8_t ch = (first + i) % LIDAR_MAX_SENSORS;
+    if (!sensors[ch].stats.present || now < sensors[ch].expectedUs) continue;
+    pollSensor(ch, now);
   }
-}
\ No newline at end of file
+
+  if (now >= nextFrameUs) {
+    // Время кадра — после опроса: отсчёты этого прохода не должны быть «из будущего»
+    publishFrame(esp_timer_get_time());
+    nextFrameUs += LIDAR_FRAME_PERIOD_US;
+    if (nextFrameUs <= now) nextFrameUs = now + LIDAR_FRAME_PERIOD_US;
+  }
+}
+
+bool lidar_getLatest(LidarSample* sample) {
+  return samples.latest(sample);
+}
+
+size_t lidar_getSamples(uint32_t afterSeq, LidarSample* out, size_t max, uint32_t* lastSeq) {
+  return samples.readSince(afterSeq, out, max, lastSeq);
+}
+
+bool lidar_getFrame(LidarFrame* out) {
+  return frameSnapshot.read(out);
+}
+
+void lidar_getStats(LidarStats* out) {
+  if (out) *out = stats;
+}
+
+bool lidar_getSensorStats(uint8_t channel, LidarSensorStats* out) {
+  if (channel >= LIDAR_MAX_SENSORS || out == NULL) return false;
+  *out = sensors[channel].stats;
+  return true;
+}
@@ -1,8 +1,89 @@
 #ifndef _LIDAR_H
 #define _LIDAR_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+// Дальномеры VL53L0X на каналах мультиплексора TCA9548A (до 8 штук по периметру шасси).
+// Канал i соответствует направлению i * 45° (0 — вперёд, по часовой стрелке).
+
+// ===== Константы =====
+
+#define LIDAR_MAX_SENSORS 8
+#define LIDAR_RANGE_INVALID 0xFFFF
+#define LIDAR_STATUS_OUT_OF_RANGE 4     // RangeStatus: объект вне зоны видимости
+#define LIDAR_STATUS_ERROR 0xFF         // ошибка I2C / драйвера при чтении результата
+#define LIDAR_TIMING_BUDGET_US 20000   // время одного замера датчиком
+
+// Состояние направления в кадре
+#define LIDAR_STATE_NONE 0              // датчика нет или отсчётов ещё не было
+#define LIDAR_STATE_OK 1                // свежий корректный отсчёт
+#define LIDAR_STATE_OUT_OF_RANGE 2      // свежий отсчёт: объект вне зоны видимости
+#define LIDAR_STATE_ERROR 3             // последнее чтение — ошибка I2C / драйвера
+#define LIDAR_STATE_STALE 4             // отсчёт старше LIDAR_FRAME_MAX_AGE_US
+
+// ===== Структуры данных =====
+
+// Отсчёт дальномера с меткой времени
+struct LidarSample {
+  uint64_t timestampUs;   // esp_timer_get_time() в момент чтения результата
+  uint16_t rangeMm;       // LIDAR_RANGE_INVALID — объект вне зоны видимости / ошибка
+  uint8_t status;         // RangeStatus датчика (0 — корректный замер) или LIDAR_STATUS_ERROR
+  uint8_t channel;        // канал мультиплексора TCA9548A
+};
+
+// Согласованный кадр расстояний по всем направлениям
+struct LidarFrame {
+  uint32_t seq;                              // номер кадра
+  uint64_t timestampUs;                      // момент формирования кадра
+  uint16_t rangeMm[LIDAR_MAX_SENSORS];       // LIDAR_RANGE_INVALID — нет данных
+  uint16_t ageMs[LIDAR_MAX_SENSORS];         // возраст отсчёта на момент кадра
+  uint64_t sampleUs[LIDAR_MAX_SENSORS];      // момент чтения отсчёта (0 — не было)
+  uint8_t state[LIDAR_MAX_SENSORS];          // LIDAR_STATE_*
+  uint8_t presentMask;                       // датчики, найденные при инициализации
+  uint8_t validMask;                         // направления со свежим корректным отсчётом
+};
+
+// Статистика одного датчика
+struct LidarSensorStats {
+  bool present;
+  uint32_t samples;       // прочитано отсчётов
+  uint32_t invalid;       // отсчётов вне зоны видимости
+  uint32_t errors;        // ошибок I2C / драйвера
+  uint32_t timeouts;      // результат не готов дольше LIDAR_TIMEOUT_US
+  uint32_t lastLatencyUs; // время чтения результата (выбор канала + чтение), мкс
+  uint32_t maxLatencyUs;
+};
+
+// Общая статистика
+struct LidarStats {
+  uint32_t samples;       // всего отсчётов
+  uint32_t invalid;       // отсчётов вне зоны видимости
+  uint32_t polls;         // опросов готовности
+  uint32_t rateHz;        // суммарная частота отсчётов за последнюю секунду
+  uint32_t frames;        // опубликовано кадров
+  uint32_t muxSelects;    // записей выбора канала в TCA9548A
+  uint32_t muxSkipped;    // пропущено записей (канал уже выбран)
+  uint8_t sensors;        // найдено датчиков
+};
+
+// Инициализация датчиков в непрерывном режиме и регистрация опроса в планировщике
 void lidar_init();
+
+// Неблокирующий опрос готовности результатов (вызывается планировщиком)
 void lidar_loop();
 
+// Последний отсчёт любого датчика (без блокировок). false — отсчётов ещё не было.
+bool lidar_getLatest(LidarSample* sample);
+
+// Отсчёты новее afterSeq (до max штук). В *lastSeq — номер последнего прочитанного.
+size_t lidar_getSamples(uint32_t afterSeq, LidarSample* samples, size_t max, uint32_t* lastSeq);
+
+// Последний кадр по всем направлениям (без блокировок). false — кадров ещё не было.
+bool lidar_getFrame(LidarFrame* frame);
+
+// Статистика
+void lidar_getStats(LidarStats* stats);
+bool lidar_getSensorStats(uint8_t channel, LidarSensorStats* stats);
 
-#endif
\ No newline at end of file
+#endif
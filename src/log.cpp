@@ -0,0 +1,132 @@
+#include "log.h"
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// ===== Константы =====
+
+#define LOG_RECORD_SIZE 128      // байт на запись, включая "[TAG] " и '\0'
+#define LOG_RECORD_COUNT 64      // записей в кольцевом буфере (степень двойки)
+#define LOG_TASK_CORE 0
+#define LOG_TASK_PRIORITY 1      // ниже сетевой задачи и планировщика
+#define LOG_TASK_STACK 3072
+#define LOG_IDLE_DELAY_MS 10
+
+static_assert((LOG_RECORD_COUNT & (LOG_RECORD_COUNT - 1)) == 0, "LOG_RECORD_COUNT must be a power of two");
+
+// ===== Структуры данных =====
+
+struct LogRecord {
+  volatile bool ready;     // запись сформирована и может выводиться
+  uint8_t length;
+  char text[LOG_RECORD_SIZE];
+};
+
+// ===== Глобальные переменные =====
+
+static LogRecord records[LOG_RECORD_COUNT];
+static uint32_t head = 0;        // следующая свободная запись (под spinlock)
+static uint32_t tail = 0;        // следующая запись для вывода (только задача вывода)
+static uint8_t runtimeLevel = LOG_LEVEL;
+static LogStats stats = {0, 0, 0, 0};
+
+// Короткая секция только на резервирование слота: писатели на обоих ядрах
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+// Задача вывода: записи в порядке резервирования, затем сообщение о потерях
+static void logTask(void* arg) {
+  uint32_t reportedDropped = 0;
+
+  for (;;) {
+    bool idle = true;
+
+    while (true) {
+      LogRecord& record = records[tail & (LOG_RECORD_COUNT - 1)];
+      portENTER_CRITICAL(&logMux);
+      bool available = (tail != head) && record.ready;
+      portEXIT_CRITICAL(&logMux);
+      if (!available) break;
+
+      Serial.write((const uint8_t*)record.text, record.length);
+      Serial.write('\n');
+
+      portENTER_CRITICAL(&logMux);
+      record.ready = false;
+      tail++;
+      portEXIT_CRITICAL(&logMux);
+      idle = false;
+    }
+
+    uint32_t dropped = stats.dropped;
+    if (dropped != reportedDropped) {
+      Serial.printf("[LOG] %u record(s) dropped\n", (unsigned)(dropped - reportedDropped));
+      reportedDropped = dropped;
+    }
+
+    if (idle) vTaskDelay(pdMS_TO_TICKS(LOG_IDLE_DELAY_MS));
+  }
+}
+
+// ===== Публичные функции =====
+
+void log_init() {
+  xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, NULL,
+                          LOG_TASK_PRIORITY, NULL, LOG_TASK_CORE);
+}
+
+void log_write(uint8_t level, const char* tag, const char* fmt, ...) {
+  if (level > runtimeLevel) return;
+
+  portENTER_CRITICAL(&logMux);
+  uint32_t pending = head - tail;
+  if (pending >= LOG_RECORD_COUNT) {
+    stats.dropped++;
+    portEXIT_CRITICAL(&logMux);
+    return;
+  }
+  LogRecord& record = records[head & (LOG_RECORD_COUNT - 1)];
+  head++;
+  stats.written++;
+  if (pending + 1 > stats.maxPending) stats.maxPending = pending + 1;
+  portEXIT_CRITICAL(&logMux);
+
+  // Форматирование — вне критической секции, в зарезервированный слот
+  int prefix = snprintf(record.text, LOG_RECORD_SIZE, "[%s] ", tag);
+  if (prefix < 0) prefix = 0;
+  // Тег длиннее записи snprintf обрезал: сообщение начинается с последнего
+  // байта (остаётся только '\0'), а не за пределами записи
+  bool truncated = prefix >= LOG_RECORD_SIZE;
+  if (truncated) prefix = LOG_RECORD_SIZE - 1;
+
+  va_list args;
+  va_start(args, fmt);
+  int body = vsnprintf(record.text + prefix, LOG_RECORD_SIZE - prefix, fmt, args);
+  va_end(args);
+  if (body < 0) body = 0;
+
+  int length = prefix + body;
+  truncated = truncated || length >= LOG_RECORD_SIZE;
+  record.length = truncated ? LOG_RECORD_SIZE - 1 : length;
+
+  portENTER_CRITICAL(&logMux);
+  if (truncated) stats.truncated++;
+  record.ready = true;
+  portEXIT_CRITICAL(&logMux);
+}
+
+void log_setLevel(uint8_t level) {
+  runtimeLevel = (level > LOG_LEVEL) ? LOG_LEVEL : level;
+}
+
+uint8_t log_getLevel() {
+  return runtimeLevel;
+}
+
+void log_getStats(LogStats* out) {
+  if (out == NULL) return;
+  portENTER_CRITICAL(&logMux);
+  *out = stats;
+  portEXIT_CRITICAL(&logMux);
+}
@@ -0,0 +1,58 @@
+#ifndef _LOG_H
+#define _LOG_H
+
+#include <stdint.h>
+
+// Отложенное логирование без выделения памяти.
+// Запись форматируется (printf) в заранее выделенный кольцевой буфер и
+// выводится в Serial низкоприоритетной задачей — вызывающий код не ждёт UART.
+// При переполнении буфера записи отбрасываются и подсчитываются.
+//
+// Уровни отсекаются на этапе компиляции (LOG_LEVEL, например -DLOG_LEVEL=LOG_LEVEL_WARN)
+// и во время работы (log_setLevel, не выше LOG_LEVEL).
+
+// ===== Уровни =====
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// ===== Макросы =====
+
+#define LOG_AT(level, tag, fmt, ...) \
+  do { if (LOG_LEVEL >= (level)) log_write((level), (tag), fmt, ##__VA_ARGS__); } while (0)
+
+#define LOG_E(tag, fmt, ...) LOG_AT(LOG_LEVEL_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOG_W(tag, fmt, ...) LOG_AT(LOG_LEVEL_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOG_I(tag, fmt, ...) LOG_AT(LOG_LEVEL_INFO, tag, fmt, ##__VA_ARGS__)
+#define LOG_D(tag, fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+// ===== Структуры данных =====
+
+struct LogStats {
+  uint32_t written;       // записей помещено в буфер
+  uint32_t dropped;       // записей отброшено (буфер заполнен)
+  uint32_t truncated;     // записей, обрезанных до LOG_RECORD_SIZE
+  uint32_t maxPending;    // максимальное число записей, ожидавших вывода
+};
+
+// Запуск задачи вывода логов (записи до вызова накапливаются в буфере)
+void log_init();
+
+// Форматирование записи в буфер. Используйте макросы LOG_E/W/I/D.
+void log_write(uint8_t level, const char* tag, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+// Уровень во время работы (не выше LOG_LEVEL)
+void log_setLevel(uint8_t level);
+uint8_t log_getLevel();
+
+// Статистика буфера
+void log_getStats(LogStats* stats);
+
+#endif
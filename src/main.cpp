@@ -2,10 +2,17 @@
 
 #include "rwifi.h"
 #include "api.h"
+#include "apiota.h"
+#include "wsctl.h"
 #include "servo.h"
 #include "dcmotor.h"
 #include "lidar.h"
 #include "ui.h"
+#include "control.h"
+#include "scheduler.h"
+#include "scan.h"
+#include "log.h"
+#include "safety.h"
 
 // ===== Константы =====
 
@@ -13,9 +20,29 @@
 #define SERIAL_INIT_DELAY_MS 1000
 #define LOOP_DELAY_MS 1
 
+// Сеть (WiFi стек, HTTP, WebSocket) работает на ядре 0,
+// планировщик периодических задач (scheduler.cpp) — на ядре 1
+#define NET_TASK_CORE 0
+#define NET_TASK_PRIORITY 2
+#define NET_TASK_STACK 8192
+
+// ===== Задачи =====
+
+// Сетевая задача: обслуживает HTTP API и WebSocket. Железо не трогает —
+// команды уходят в задачу управления через control_post().
+static void networkTask(void* arg) {
+  for (;;) {
+    wifi_loop();
+    apiota_loop();
+    wsctl_loop();
+    vTaskDelay(pdMS_TO_TICKS(LOOP_DELAY_MS));
+  }
+}
+
 void setup() {
   Serial.begin(SERIAL_BAUD_RATE);
   delay(SERIAL_INIT_DELAY_MS);
+  log_init();
 
   Serial.println("\n========================================");
   Serial.println("   ESP32-S3 Robot Controller v2.0");
@@ -26,9 +53,17 @@ void setup() {
   ui_init();
   wifi_init();
   api_init();
+  wsctl_init();
   servo_init();
   dc_init();
+  safety_init();
   lidar_init();
+  scan_init();
+
+  control_init();
+  sched_start();
+  xTaskCreatePinnedToCore(networkTask, "network", NET_TASK_STACK, NULL,
+                          NET_TASK_PRIORITY, NULL, NET_TASK_CORE);
 
   Serial.println("\n✓ All systems initialized");
   Serial.print("Total initialization took ");
@@ -38,8 +73,6 @@ void setup() {
 }
 
 void loop() {
-  wifi_loop();
-  api_loop();
-  lidar_loop();
-  delay(LOOP_DELAY_MS);
+  // Вся работа выполняется в сетевой задаче и задаче планировщика
+  vTaskDelete(NULL);
 }
@@ -0,0 +1,45 @@
+#ifndef _MOTORMIX_H
+#define _MOTORMIX_H
+
+#include <stdint.h>
+
+// Пересчёт скорости мотора (-255...255) в скважности двух входов H-моста.
+// Не зависит от Arduino и железа (ШИМ — motorpwm.h) и собирается на хосте.
+
+// ===== Константы =====
+
+#define MOTORMIX_SPEED_MAX 255
+
+// ===== Структуры данных =====
+
+struct MotorDuty {
+  uint32_t forward;   // скважность входа IA (вперёд)
+  uint32_t reverse;   // скважность входа IB (назад)
+};
+
+// ===== Функции =====
+
+// Максимальная скважность для разрешения ШИМ в битах
+static inline uint32_t motormix_maxDuty(uint8_t resolutionBits) {
+  return ((uint32_t)1 << resolutionBits) - 1;
+}
+
+// Скорость вне диапазона ограничивается; ±255 даёт полную скважность,
+// промежуточные значения масштабируются с округлением к ближайшему
+static inline MotorDuty motormix_duty(int speed, uint32_t maxDuty) {
+  if (speed > MOTORMIX_SPEED_MAX) speed = MOTORMIX_SPEED_MAX;
+  if (speed < -MOTORMIX_SPEED_MAX) speed = -MOTORMIX_SPEED_MAX;
+
+  uint32_t magnitude = (uint32_t)(speed < 0 ? -speed : speed);
+  uint32_t duty = (magnitude * maxDuty + MOTORMIX_SPEED_MAX / 2) / MOTORMIX_SPEED_MAX;
+
+  MotorDuty result = {0, 0};
+  if (speed > 0) {
+    result.forward = duty;
+  } else if (speed < 0) {
+    result.reverse = duty;
+  }
+  return result;
+}
+
+#endif
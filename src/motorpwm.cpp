@@ -0,0 +1,152 @@
+#include "motorpwm.h"
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+
+#include "config.h"
+#include "log.h"
+
+// ===== Константы =====
+
+// Частота ШИМ моторов и разрешение, переопределяются в config.h
+#ifndef MOTOR_PWM_FREQ_HZ
+#define MOTOR_PWM_FREQ_HZ 20000          // выше слышимого диапазона
+#endif
+
+#ifndef MOTOR_PWM_RESOLUTION_BITS
+#define MOTOR_PWM_RESOLUTION_BITS 10
+#endif
+
+#define MOTORPWM_SPEED_MODE LEDC_LOW_SPEED_MODE
+#define MOTORPWM_TIMER LEDC_TIMER_0
+#define MOTORPWM_FIRST_CHANNEL LEDC_CHANNEL_0
+#define MOTORPWM_SOURCE_CLOCK_HZ 80000000    // APB
+
+#if MOTOR_PWM_RESOLUTION_BITS < 1 || MOTOR_PWM_RESOLUTION_BITS > 14
+#error "MOTOR_PWM_RESOLUTION_BITS must be 1..14"
+#endif
+
+#if (MOTORPWM_SOURCE_CLOCK_HZ / MOTOR_PWM_FREQ_HZ) < (1 << MOTOR_PWM_RESOLUTION_BITS)
+#error "MOTOR_PWM_FREQ_HZ is too high for MOTOR_PWM_RESOLUTION_BITS (freq * 2^bits must not exceed 80 MHz)"
+#endif
+
+// ===== Глобальные переменные =====
+
+static int channelCount = 0;
+static uint32_t duties[MOTORPWM_MAX_CHANNELS];
+static uint32_t applied[MOTORPWM_MAX_CHANNELS];
+static bool killed = false;
+
+// Обновление каналов не должно прерываться: иначе часть каналов
+// применит новую скважность на периоде позже остальных.
+// Также сериализует commit (задача управления) и kill (задача safety)
+static portMUX_TYPE commitMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+static ledc_channel_t channelOf(int index) {
+  return (ledc_channel_t)(MOTORPWM_FIRST_CHANNEL + index);
+}
+
+// ===== Публичные функции =====
+
+bool motorpwm_init(const int* pins, int count) {
+  if (count > MOTORPWM_MAX_CHANNELS) {
+    LOG_E("PWM", "Too many channels: %d (max %d)", count, MOTORPWM_MAX_CHANNELS);
+    return false;
+  }
+
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = MOTORPWM_SPEED_MODE;
+  timer.duty_resolution = (ledc_timer_bit_t)MOTOR_PWM_RESOLUTION_BITS;
+  timer.timer_num = MOTORPWM_TIMER;
+  timer.freq_hz = MOTOR_PWM_FREQ_HZ;
+  timer.clk_cfg = LEDC_AUTO_CLK;
+
+  esp_err_t err = ledc_timer_config(&timer);
+  if (err != ESP_OK) {
+    LOG_E("PWM", "Timer config failed: %s", esp_err_to_name(err));
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    ledc_channel_config_t channel = {};
+    channel.gpio_num = pins[i];
+    channel.speed_mode = MOTORPWM_SPEED_MODE;
+    channel.channel = channelOf(i);
+    channel.intr_type = LEDC_INTR_DISABLE;
+    channel.timer_sel = MOTORPWM_TIMER;
+    channel.duty = 0;
+    channel.hpoint = 0;
+
+    err = ledc_channel_config(&channel);
+    if (err != ESP_OK) {
+      LOG_E("PWM", "Channel %d (GPIO %d) config failed: %s", i, pins[i], esp_err_to_name(err));
+      return false;
+    }
+    duties[i] = 0;
+    applied[i] = 0;
+  }
+
+  channelCount = count;
+  LOG_I("PWM", "LEDC timer %d: %u Hz, %d bit, %d channels",
+        MOTORPWM_TIMER, (unsigned)motorpwm_getFrequency(), MOTOR_PWM_RESOLUTION_BITS, count);
+  return true;
+}
+
+uint32_t motorpwm_maxDuty() {
+  return ((uint32_t)1 << MOTOR_PWM_RESOLUTION_BITS) - 1;
+}
+
+void motorpwm_setDuty(int channel, uint32_t duty) {
+  if (channel < 0 || channel >= channelCount) return;
+  duties[channel] = duty > motorpwm_maxDuty() ? motorpwm_maxDuty() : duty;
+}
+
+void motorpwm_commit() {
+  // Скважность записывается в теневые регистры всех изменившихся каналов,
+  // затем флаги обновления выставляются подряд: каналы одного таймера
+  // принимают значения на ближайшей общей границе периода
+  portENTER_CRITICAL(&commitMux);
+  if (killed) {
+    portEXIT_CRITICAL(&commitMux);
+    return;
+  }
+  for (int i = 0; i < channelCount; i++) {
+    if (duties[i] != applied[i]) {
+      ledc_set_duty(MOTORPWM_SPEED_MODE, channelOf(i), duties[i]);
+    }
+  }
+  for (int i = 0; i < channelCount; i++) {
+    if (duties[i] != applied[i]) {
+      ledc_update_duty(MOTORPWM_SPEED_MODE, channelOf(i));
+      applied[i] = duties[i];
+    }
+  }
+  portEXIT_CRITICAL(&commitMux);
+}
+
+void motorpwm_kill() {
+  portENTER_CRITICAL(&commitMux);
+  killed = true;
+  for (int i = 0; i < channelCount; i++) {
+    ledc_set_duty(MOTORPWM_SPEED_MODE, channelOf(i), 0);
+  }
+  for (int i = 0; i < channelCount; i++) {
+    ledc_update_duty(MOTORPWM_SPEED_MODE, channelOf(i));
+    duties[i] = 0;
+    applied[i] = 0;
+  }
+  portEXIT_CRITICAL(&commitMux);
+}
+
+void motorpwm_release() {
+  portENTER_CRITICAL(&commitMux);
+  killed = false;
+  portEXIT_CRITICAL(&commitMux);
+}
+
+uint32_t motorpwm_getFrequency() {
+  if (channelCount == 0) return 0;
+  return ledc_get_freq(MOTORPWM_SPEED_MODE, MOTORPWM_TIMER);
+}
@@ -0,0 +1,40 @@
+#ifndef _MOTORPWM_H
+#define _MOTORPWM_H
+
+#include <stdint.h>
+
+// ШИМ моторов на периферии LEDC: один таймер, по два канала на мотор (IA, IB).
+// Частота и разрешение задаются MOTOR_PWM_FREQ_HZ / MOTOR_PWM_RESOLUTION_BITS.
+// Скважности сначала записываются для всех каналов (motorpwm_setDuty),
+// затем фиксируются одним обновлением (motorpwm_commit) — каналы общего
+// таймера принимают новые значения на одной и той же границе периода.
+// Вызывается только из задачи управления (кроме motorpwm_kill/release).
+
+// ===== Константы =====
+
+#define MOTORPWM_MAX_CHANNELS 8
+
+// ===== Публичные функции =====
+
+// Настройка таймера и каналов: pins[i] — GPIO канала i. false — ошибка LEDC
+bool motorpwm_init(const int* pins, int count);
+
+// Максимальная скважность (2^MOTOR_PWM_RESOLUTION_BITS - 1)
+uint32_t motorpwm_maxDuty();
+
+// Запись скважности канала без применения
+void motorpwm_setDuty(int channel, uint32_t duty);
+
+// Одновременное применение записанных скважностей всех каналов
+void motorpwm_commit();
+
+// Аварийное снятие ШИМ: все каналы в 0 сразу, motorpwm_commit игнорируется
+// до motorpwm_release. Вызывается из любой задачи (не из прерывания)
+void motorpwm_kill();
+
+void motorpwm_release();
+
+// Фактическая частота таймера, Гц (0 — не инициализирован)
+uint32_t motorpwm_getFrequency();
+
+#endif
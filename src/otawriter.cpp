@@ -0,0 +1,197 @@
+#include "otawriter.h"
+
+#include <Arduino.h>
+
+#include "log.h"
+#include "config.h"
+
+// ===== Константы =====
+
+// Байт в каждом из двух буферов: больше — реже переключения, но дольше последний сброс
+#ifndef OTA_WRITER_BUFFER_SIZE
+#define OTA_WRITER_BUFFER_SIZE 32768
+#endif
+
+#define OTA_WRITER_TASK_CORE 0
+#define OTA_WRITER_TASK_PRIORITY 1    // ниже async_tcp и сетевой задачи, как вывод логов
+#define OTA_WRITER_TASK_STACK 6144    // inflate, SHA-256, Update.write
+#define OTA_WRITER_BUFFERS 2
+#define OTA_WRITER_NONE -1
+
+// ===== Структуры данных =====
+
+struct OtaWriterBuffer {
+  uint8_t* data;
+  size_t length;
+};
+
+// ===== Глобальные переменные =====
+
+static OtaWriterBuffer buffers[OTA_WRITER_BUFFERS];
+static int fillIndex = 0;                       // буфер, который заполняет приём
+static int flushIndex = OTA_WRITER_NONE;        // буфер в задаче записи
+static bool failed = false;
+static OtaWriterSink writerSink = NULL;
+static void* writerContext = NULL;
+static OtaWriterStats stats;
+
+static TaskHandle_t writerTaskHandle = NULL;
+static TaskHandle_t waiterTaskHandle = NULL;    // ждёт освобождения буфера (async_tcp)
+
+// flushIndex, failed, waiterTaskHandle и статистику меняют обе задачи
+static portMUX_TYPE writerMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+static void writerTask(void* arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    portENTER_CRITICAL(&writerMux);
+    int index = flushIndex;
+    bool skip = failed;
+    portEXIT_CRITICAL(&writerMux);
+    if (index == OTA_WRITER_NONE) continue;
+
+    // После ошибки буферы только освобождаются: обработчик больше не вызывается
+    bool ok = true;
+    uint32_t elapsed = 0;
+    if (!skip) {
+      uint64_t start = esp_timer_get_time();
+      ok = writerSink(buffers[index].data, buffers[index].length, writerContext);
+      elapsed = (uint32_t)(esp_timer_get_time() - start);
+      LOG_D("OTA", "Flushed %u bytes in %u us", (unsigned)buffers[index].length, (unsigned)elapsed);
+    }
+
+    portENTER_CRITICAL(&writerMux);
+    if (!ok) failed = true;
+    if (!skip) {
+      stats.flushes++;
+      stats.flushUs += elapsed;
+      if (elapsed > stats.maxFlushUs) stats.maxFlushUs = elapsed;
+    }
+    flushIndex = OTA_WRITER_NONE;
+    TaskHandle_t waiter = waiterTaskHandle;
+    waiterTaskHandle = NULL;
+    portEXIT_CRITICAL(&writerMux);
+
+    if (waiter != NULL) xTaskNotifyGive(waiter);
+  }
+}
+
+static bool isFailed() {
+  portENTER_CRITICAL(&writerMux);
+  bool result = failed;
+  portEXIT_CRITICAL(&writerMux);
+  return result;
+}
+
+// Ожидание, пока задача записи освободит свой буфер; время ожидания, мкс.
+// Вызывающая задача (async_tcp) блокируется на уведомлении от задачи записи
+// без опроса и на это время не обслуживает другие соединения.
+static uint32_t waitIdle() {
+  uint64_t start = 0;
+  for (;;) {
+    portENTER_CRITICAL(&writerMux);
+    bool busy = flushIndex != OTA_WRITER_NONE;
+    if (busy) waiterTaskHandle = xTaskGetCurrentTaskHandle();
+    portEXIT_CRITICAL(&writerMux);
+    if (!busy) break;
+
+    if (start == 0) start = esp_timer_get_time();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  return start == 0 ? 0 : (uint32_t)(esp_timer_get_time() - start);
+}
+
+// Заполненный буфер — в запись, приём продолжает в другой.
+// Ожидание здесь — stall: запись не успевает за приёмом.
+static void submit() {
+  uint32_t waited = waitIdle();
+  portENTER_CRITICAL(&writerMux);
+  if (waited > 0) stats.stalls++;
+  stats.stallUs += waited;
+  if (waited > stats.maxStallUs) stats.maxStallUs = waited;
+  flushIndex = fillIndex;
+  portEXIT_CRITICAL(&writerMux);
+  xTaskNotifyGive(writerTaskHandle);
+
+  fillIndex = (fillIndex + 1) % OTA_WRITER_BUFFERS;
+  buffers[fillIndex].length = 0;
+}
+
+static void freeBuffers() {
+  for (int i = 0; i < OTA_WRITER_BUFFERS; i++) {
+    free(buffers[i].data);
+    buffers[i].data = NULL;
+    buffers[i].length = 0;
+  }
+}
+
+// ===== Публичные функции =====
+
+bool otawriter_begin(OtaWriterSink sink, void* context) {
+  memset(&stats, 0, sizeof(stats));
+  stats.bufferSize = OTA_WRITER_BUFFER_SIZE;
+  stats.psram = psramFound();
+
+  // PSRAM: 64 КБ буферов не должны отнимать внутреннюю кучу у WiFi и TCP
+  for (int i = 0; i < OTA_WRITER_BUFFERS; i++) {
+    buffers[i].data = (uint8_t*)(stats.psram ? ps_malloc(OTA_WRITER_BUFFER_SIZE) : malloc(OTA_WRITER_BUFFER_SIZE));
+    buffers[i].length = 0;
+    if (buffers[i].data == NULL) {
+      freeBuffers();
+      return false;
+    }
+  }
+
+  if (writerTaskHandle == NULL &&
+      xTaskCreatePinnedToCore(writerTask, "otawriter", OTA_WRITER_TASK_STACK, NULL, OTA_WRITER_TASK_PRIORITY,
+                              &writerTaskHandle, OTA_WRITER_TASK_CORE) != pdPASS) {
+    writerTaskHandle = NULL;
+    freeBuffers();
+    return false;
+  }
+
+  writerSink = sink;
+  writerContext = context;
+  fillIndex = 0;
+  flushIndex = OTA_WRITER_NONE;
+  waiterTaskHandle = NULL;
+  failed = false;
+  return true;
+}
+
+bool otawriter_write(const uint8_t* data, size_t length) {
+  while (length > 0) {
+    OtaWriterBuffer& buffer = buffers[fillIndex];
+    size_t count = OTA_WRITER_BUFFER_SIZE - buffer.length;
+    if (count > length) count = length;
+    memcpy(buffer.data + buffer.length, data, count);
+    buffer.length += count;
+    data += count;
+    length -= count;
+
+    if (buffer.length == OTA_WRITER_BUFFER_SIZE) submit();
+  }
+  return !isFailed();
+}
+
+bool otawriter_finish() {
+  if (buffers[fillIndex].length > 0) submit();
+  waitIdle();
+  freeBuffers();
+  return !isFailed();
+}
+
+void otawriter_abort() {
+  // Буфер, который уже в обработке, дописывается: обработчик нельзя прервать посередине
+  waitIdle();
+  freeBuffers();
+}
+
+void otawriter_getStats(OtaWriterStats* result) {
+  portENTER_CRITICAL(&writerMux);
+  *result = stats;
+  portEXIT_CRITICAL(&writerMux);
+}
@@ -0,0 +1,51 @@
+#ifndef _OTAWRITER_H
+#define _OTAWRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Двойная буферизация записи OTA: приём (задача async_tcp) только копирует
+// данные в один из двух больших буферов (PSRAM), а заполненный буфер
+// обрабатывает задача "otawriter" на ядре 0 — распаковка, дельта, Update.write
+// и стирание/программирование flash. Пока один буфер пишется, приём заполняет
+// другой; если оба заняты, приём ждёт (задержка считается как stall), и TCP
+// получает обратное давление вместо блокировки на каждой части. Ожидание —
+// блокировка задачи async_tcp на уведомлении от задачи записи: пока идёт
+// стирание flash, ждут и остальные HTTP-клиенты.
+//
+// Одна загрузка за раз: begin -> write... -> finish или abort.
+
+// ===== Структуры данных =====
+
+// Обработчик заполненного буфера (в задаче otawriter); false — ошибка, дальше не вызывается
+typedef bool (*OtaWriterSink)(const uint8_t* data, size_t length, void* context);
+
+struct OtaWriterStats {
+  uint32_t bufferSize;
+  bool psram;             // буферы в PSRAM (иначе во внутренней куче)
+  uint32_t flushes;       // буферов обработано
+  uint32_t flushUs;       // суммарное время обработки, мкс
+  uint32_t maxFlushUs;
+  uint32_t stalls;        // раз приём ждал свободный буфер
+  uint32_t stallUs;       // суммарное ожидание приёма, мкс
+  uint32_t maxStallUs;
+};
+
+// ===== Функции =====
+
+// Буферы и (при первом вызове) задача записи; false — нет памяти
+bool otawriter_begin(OtaWriterSink sink, void* context);
+
+// Копия данных в буфер приёма. false — обработчик вернул ошибку (загрузку прервать).
+bool otawriter_write(const uint8_t* data, size_t length);
+
+// Обработка остатка и ожидание задачи записи; false — обработчик вернул ошибку
+bool otawriter_finish();
+
+// Ожидание текущей обработки без остатка и освобождение буферов
+void otawriter_abort();
+
+// Статистика последней загрузки
+void otawriter_getStats(OtaWriterStats* stats);
+
+#endif
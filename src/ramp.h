@@ -0,0 +1,125 @@
+#ifndef _RAMP_H
+#define _RAMP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Генератор плавного изменения уставки с ограничением ускорения и рывка.
+// Только целочисленная арифметика, фиксированная точка Q8 (1/256 единицы),
+// постоянное время шага без циклов — стоимость такта не зависит от уставки.
+// Не зависит от Arduino и собирается на хосте.
+//
+// value — текущее значение, rate — изменение за такт (ускорение),
+// rate меняется не больше чем на jerk за такт и не превышает accel.
+// Торможение начинается заранее, чтобы подойти к цели без перерегулирования
+// (одно деление на такт — для расчёта пути торможения).
+
+// ===== Константы =====
+
+#define RAMP_FRAC_BITS 8
+#define RAMP_ONE (1 << RAMP_FRAC_BITS)
+
+// ===== Структуры данных =====
+
+struct RampLimits {
+  int32_t accel;    // макс. изменение значения за такт, Q8 (0 — без ограничения)
+  int32_t jerk;     // макс. изменение accel за такт, Q8 (0 — без ограничения рывка)
+};
+
+struct Ramp {
+  int32_t value;    // текущее значение, Q8
+  int32_t rate;     // изменение за прошлый такт, Q8
+  int32_t target;   // уставка, Q8
+};
+
+// ===== Функции =====
+
+static inline int32_t ramp_toFixed(int value) {
+  return (int32_t)value * RAMP_ONE;
+}
+
+// Округление к нулю: малые остатки не дают ненулевой ШИМ
+static inline int ramp_toInt(int32_t value) {
+  return (int)(value / RAMP_ONE);
+}
+
+// Пересчёт ограничений из единиц в секунду (и в секунду²) в Q8 за такт
+static inline RampLimits ramp_limits(uint32_t accelPerSec, uint32_t jerkPerSec2, uint32_t tickUs) {
+  RampLimits limits;
+  int64_t accel = (int64_t)accelPerSec * RAMP_ONE * tickUs / 1000000;
+  int64_t jerk = (int64_t)jerkPerSec2 * RAMP_ONE * tickUs / 1000000 * tickUs / 1000000;
+  limits.accel = (accelPerSec > 0 && accel < 1) ? 1 : (int32_t)accel;
+  limits.jerk = (jerkPerSec2 > 0 && jerk < 1) ? 1 : (int32_t)jerk;
+  return limits;
+}
+
+// Путь до остановки, если со следующего такта снижать rate на jerk:
+// (rate - j) + (rate - 2j) + ... + (rate - nj), n = rate / j
+static inline int64_t ramp_brakingDistance(int32_t rate, int32_t jerk) {
+  int64_t n = rate / jerk;
+  return n * rate - jerk * n * (n + 1) / 2;
+}
+
+static inline void ramp_reset(Ramp* ramp, int32_t value) {
+  ramp->value = value;
+  ramp->rate = 0;
+  ramp->target = value;
+}
+
+// Один такт. Возвращает новое значение (Q8).
+static inline int32_t ramp_step(Ramp* ramp, const RampLimits* limits) {
+  int32_t error = ramp->target - ramp->value;
+  if (error == 0 && ramp->rate == 0) return ramp->value;
+
+  if (limits->accel <= 0) {
+    ramp_reset(ramp, ramp->target);
+    return ramp->value;
+  }
+
+  int32_t dir = (error > 0) - (error < 0);
+  int32_t absError = abs(error);
+
+  if (limits->jerk <= 0) {
+    // Только ограничение скорости изменения: трапеция
+    int32_t step = absError < limits->accel ? absError : limits->accel;
+    ramp->rate = dir * step;
+    ramp->value += ramp->rate;
+    return ramp->value;
+  }
+
+  int32_t jerk = limits->jerk;
+  int32_t absRate = abs(ramp->rate);
+
+  // Рядом с целью и почти без движения — встаём точно в уставку
+  if (absError <= jerk && absRate <= jerk) {
+    ramp_reset(ramp, ramp->target);
+    return ramp->value;
+  }
+
+  if (ramp->rate * dir >= 0) {
+    // Движение к цели: наибольший rate из {rate + j, rate, rate - j}, при котором
+    // ещё успеваем затормозить до цели, снижая rate на jerk за такт
+    int32_t faster = absRate + jerk < limits->accel ? absRate + jerk : limits->accel;
+    int32_t slower = absRate > jerk ? absRate - jerk : 0;
+    int32_t next = slower;
+    if (faster + ramp_brakingDistance(faster, jerk) <= absError) {
+      next = faster;
+    } else if (absRate <= limits->accel && absRate + ramp_brakingDistance(absRate, jerk) <= absError) {
+      next = absRate;
+    }
+    ramp->rate = dir * next;
+  } else {
+    // Движение от цели (уставка сменила знак): разворот с рывком jerk
+    ramp->rate += dir * jerk;
+  }
+
+  ramp->value += ramp->rate;
+
+  // Достигли или пересекли цель — останавливаемся в ней
+  if ((int64_t)(ramp->value - ramp->target) * dir >= 0) {
+    ramp_reset(ramp, ramp->target);
+  }
+  return ramp->value;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "reflex.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+#include "lidar.h"
+#include "scan.h"
+#include "log.h"
+
+// ===== Константы =====
+
+// Рефлекс и его пороги, переопределяются в config.h
+#ifndef REFLEX_ENABLED
+#define REFLEX_ENABLED 1
+#endif
+
+// Канал дальномера, смотрящего вперёд (направление 0°)
+#ifndef REFLEX_LIDAR_CHANNEL
+#define REFLEX_LIDAR_CHANNEL 0
+#endif
+
+#ifndef REFLEX_STOP_MM
+#define REFLEX_STOP_MM 150
+#endif
+
+#ifndef REFLEX_SPEED_MM_S
+#define REFLEX_SPEED_MM_S 1000
+#endif
+
+#ifndef REFLEX_DECEL_MM_S2
+#define REFLEX_DECEL_MM_S2 2000
+#endif
+
+#ifndef REFLEX_MAX_AGE_MS
+#define REFLEX_MAX_AGE_MS 200
+#endif
+
+#ifndef REFLEX_STALE_SPEED
+#define REFLEX_STALE_SPEED 80
+#endif
+
+#define REFLEX_REACTION_MS 10       // такт dc_loop
+
+// ===== Глобальные переменные =====
+
+static const ReflexConfig reflexConfig = {
+  REFLEX_STOP_MM, REFLEX_SPEED_MM_S, REFLEX_DECEL_MM_S2,
+  REFLEX_REACTION_MS, REFLEX_MAX_AGE_MS, REFLEX_STALE_SPEED
+};
+
+// Пишется задачей управления, читается обработчиками HTTP
+static ReflexStats stats = {false, REFLEX_SPEED_MAX, REFLEX_RANGE_NONE, 0, 0, 0, 0};
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Момент чтения отсчёта, по которому посчитано ограничение текущего такта (0 — нет)
+static uint64_t tickSampleUs = 0;
+
+// ===== Вспомогательные функции =====
+
+// Дальномер рефлекса сейчас крутится на pan-сервоприводе и смотрит не вперёд
+static bool isScanning() {
+  if (scan_getLidarChannel() != REFLEX_LIDAR_CHANNEL) return false;
+  ScanConfig config;
+  scan_getConfig(&config);
+  return config.enabled;
+}
+
+// ===== Публичные функции =====
+
+int reflex_update() {
+  if (!REFLEX_ENABLED) return REFLEX_SPEED_MAX;
+
+  // Без ограничения — только при свежем «вне зоны видимости»; нет кадра, датчик
+  // не найден при запуске, ошибка датчика, устаревший отсчёт и сканирование
+  // дают staleSpeed. Робот без переднего дальномера собирается с REFLEX_ENABLED 0
+  LidarFrame frame;
+  uint8_t state = LIDAR_STATE_NONE;
+  if (lidar_getFrame(&frame) && (frame.presentMask & (1 << REFLEX_LIDAR_CHANNEL)) && !isScanning()) {
+    state = frame.state[REFLEX_LIDAR_CHANNEL];
+  }
+
+  uint64_t now = esp_timer_get_time();
+  uint16_t range = REFLEX_RANGE_NONE;
+  uint32_t ageMs = REFLEX_AGE_UNKNOWN;
+  tickSampleUs = 0;
+  if (state == LIDAR_STATE_OK || state == LIDAR_STATE_OUT_OF_RANGE) {
+    tickSampleUs = frame.sampleUs[REFLEX_LIDAR_CHANNEL];
+    ageMs = (uint32_t)((now - tickSampleUs) / 1000);
+    if (state == LIDAR_STATE_OK) range = frame.rangeMm[REFLEX_LIDAR_CHANNEL];
+  }
+
+  int limit = reflex_maxForward(&reflexConfig, range, ageMs);
+  bool active = limit < REFLEX_SPEED_MAX;
+
+  portENTER_CRITICAL(&statsMux);
+  bool wasActive = stats.active;
+  stats.active = active;
+  stats.limit = limit;
+  stats.rangeMm = range;
+  if (active && !wasActive) stats.overrides++;
+  portEXIT_CRITICAL(&statsMux);
+
+  if (active && !wasActive) {
+    if (ageMs == REFLEX_AGE_UNKNOWN) {
+      LOG_W("REFLEX", "Forward speed limited to %d: no fresh sample (state %u)", limit, state);
+    } else {
+      LOG_W("REFLEX", "Forward speed limited to %d: range %u mm, age %u ms", limit, range, (unsigned)ageMs);
+    }
+  } else if (!active && wasActive) {
+    LOG_I("REFLEX", "Forward limit released: range %u mm", range);
+  }
+  return limit;
+}
+
+void reflex_countClamp(bool pwmCut) {
+  uint64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL(&statsMux);
+  stats.clamps++;
+  // Реакция: от чтения отсчёта до такта, в котором урезанный ШИМ применён
+  if (pwmCut && tickSampleUs != 0) {
+    stats.lastReactionUs = (uint32_t)(now - tickSampleUs);
+    if (stats.lastReactionUs > stats.maxReactionUs) stats.maxReactionUs = stats.lastReactionUs;
+  }
+  portEXIT_CRITICAL(&statsMux);
+}
+
+void reflex_getStats(ReflexStats* out) {
+  if (out == NULL) return;
+
+  portENTER_CRITICAL(&statsMux);
+  *out = stats;
+  portEXIT_CRITICAL(&statsMux);
+}
+
+void reflex_getConfig(ReflexConfig* out) {
+  if (out) *out = reflexConfig;
+}
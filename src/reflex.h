@@ -0,0 +1,78 @@
+#ifndef _REFLEX_H
+#define _REFLEX_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Рефлекс предотвращения столкновений: между уставками и генератором разгона
+// (dc_loop) ограничивает скорость вперёд так, чтобы робот успел остановиться
+// перед препятствием по последнему кадру дальномера. Применяется в том же
+// такте, в котором виден кадр: превышение ограничения снимается сразу, без рампы.
+//
+// Допустимая скорость v — корень уравнения v·t + v²/(2a) = range - stopMm,
+// где t — возраст отсчёта плюс время реакции, a — торможение робота.
+// reflex_maxForward() не зависит от Arduino и собирается на хосте.
+
+// ===== Константы =====
+
+#define REFLEX_SPEED_MAX 255
+#define REFLEX_RANGE_NONE 0xFFFF    // нет отражения в зоне видимости
+#define REFLEX_AGE_UNKNOWN UINT32_MAX  // отсчёта нет: ошибка датчика, устарел, сканирование
+
+// ===== Структуры данных =====
+
+struct ReflexConfig {
+  uint16_t stopMm;            // минимальное расстояние до препятствия после остановки
+  uint16_t speedMmPerSec;     // скорость робота при ШИМ 255
+  uint16_t decelMmPerSec2;    // торможение при снятии ШИМ
+  uint16_t reactionMs;        // задержка от кадра до снятия ШИМ (такт управления)
+  uint16_t maxAgeMs;          // отсчёт старше — препятствие неизвестно
+  uint8_t staleSpeed;         // ограничение, пока отсчёта нет
+};
+
+struct ReflexStats {
+  bool active;                // ограничение сейчас действует
+  int16_t limit;              // текущее ограничение скорости вперёд (0-255)
+  uint16_t rangeMm;           // последнее расстояние вперёд
+  uint32_t overrides;         // срабатываний (переходов в ограничение)
+  uint32_t clamps;            // тактов, в которых уставка была урезана
+  uint32_t lastReactionUs;    // от чтения отсчёта дальномера до применения урезанного ШИМ
+  uint32_t maxReactionUs;
+};
+
+// ===== Функции =====
+
+// Наибольшая скорость вперёд (0-255) при расстоянии rangeMm, измеренном ageMs назад.
+// REFLEX_RANGE_NONE — подтверждённое «вне зоны видимости»; если отсчёта нет,
+// ageMs = REFLEX_AGE_UNKNOWN и действует staleSpeed
+static inline int reflex_maxForward(const ReflexConfig* config, uint16_t rangeMm, uint32_t ageMs) {
+  if (ageMs > config->maxAgeMs) return config->staleSpeed;
+  if (rangeMm == REFLEX_RANGE_NONE) return REFLEX_SPEED_MAX;
+  if (rangeMm <= config->stopMm) return 0;
+
+  float distance = rangeMm - config->stopMm;
+  float decel = config->decelMmPerSec2;
+  float latency = (ageMs + config->reactionMs) / 1000.0f;
+  float speed = decel * (sqrtf(latency * latency + 2.0f * distance / decel) - latency);
+
+  int limit = (int)(speed * REFLEX_SPEED_MAX / config->speedMmPerSec);
+  return limit > REFLEX_SPEED_MAX ? REFLEX_SPEED_MAX : limit;
+}
+
+// ===== Публичные функции =====
+
+// Ограничение скорости вперёд на текущий такт по последнему кадру дальномера
+// (вызывается из dc_loop). REFLEX_SPEED_MAX — ограничения нет
+int reflex_update();
+
+// Учёт такта, в котором уставка или ШИМ были урезаны ограничением (вызывается
+// после применения ШИМ). pwmCut — ШИМ снижен: время от чтения отсчёта этого
+// такта до сих пор записывается как реакция
+void reflex_countClamp(bool pwmCut);
+
+void reflex_getStats(ReflexStats* stats);
+
+// Пороги рефлекса из config.h
+void reflex_getConfig(ReflexConfig* config);
+
+#endif
@@ -0,0 +1,235 @@
+#include "safety.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+#include "motorpwm.h"
+#include "log.h"
+
+// ===== Константы =====
+
+// Окно deadman: без кадров управления дольше — плавная остановка, переопределяется в config.h
+#ifndef DEADMAN_TIMEOUT_MS
+#define DEADMAN_TIMEOUT_MS 500
+#endif
+
+// Сколько ждать плавной остановки до принудительного снятия ШИМ
+#ifndef DEADMAN_HARD_STOP_MS
+#define DEADMAN_HARD_STOP_MS 1000
+#endif
+
+// Кнопка аварийной остановки (-1 — не подключена) и её активный уровень
+#ifndef ESTOP_PIN
+#define ESTOP_PIN -1
+#endif
+
+#ifndef ESTOP_ACTIVE_LEVEL
+#define ESTOP_ACTIVE_LEVEL LOW
+#endif
+
+#define SAFETY_DEADMAN_CHECK_US 10000
+#define SAFETY_TIMER_FREQ_HZ 1000000
+
+#define SAFETY_TASK_CORE 1
+#define SAFETY_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define SAFETY_TASK_STACK 3072
+
+// Биты уведомления задачи
+#define SAFETY_EVENT_ESTOP   0x01
+#define SAFETY_EVENT_DEADMAN 0x02
+
+// ===== Глобальные переменные =====
+
+static TaskHandle_t safetyTaskHandle = NULL;
+static hw_timer_t* deadmanTimer = NULL;
+
+// Время в мкс хранится младшими 32 битами: атомарное чтение из прерывания
+static volatile uint32_t lastFeedUs = 0;
+static volatile bool deadmanArmed = false;
+static volatile bool deadmanTripped = false;
+static volatile bool estopActive = false;
+static uint32_t deadmanTripUs = 0;
+
+// Ожидающая обработки аварийная остановка (самая ранняя)
+static uint8_t pendingSource = SAFETY_SOURCE_NONE;
+static uint32_t pendingTriggerUs = 0;
+
+static SafetyStats stats = {false, SAFETY_SOURCE_NONE, false, DEADMAN_TIMEOUT_MS, 0, 0, 0, 0, 0};
+
+// Защищает ожидающую остановку и статистику (прерывания, сеть, задача safety)
+static portMUX_TYPE safetyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+static void IRAM_ATTR onDeadmanTimer() {
+  if (!deadmanArmed) return;
+  if ((uint32_t)esp_timer_get_time() - lastFeedUs < DEADMAN_TIMEOUT_MS * 1000UL) return;
+
+  deadmanArmed = false;
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(safetyTaskHandle, SAFETY_EVENT_DEADMAN, eSetBits, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void IRAM_ATTR onEstopPin() {
+  uint32_t now = (uint32_t)esp_timer_get_time();
+
+  portENTER_CRITICAL_ISR(&safetyMux);
+  if (pendingSource == SAFETY_SOURCE_NONE) {
+    pendingSource = SAFETY_SOURCE_GPIO;
+    pendingTriggerUs = now;
+  }
+  portEXIT_CRITICAL_ISR(&safetyMux);
+
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(safetyTaskHandle, SAFETY_EVENT_ESTOP, eSetBits, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Снятие ШИМ и учёт задержки от события до остановки
+static void cutMotors(uint8_t source, uint32_t triggerUs) {
+  motorpwm_kill();
+  uint32_t latency = (uint32_t)esp_timer_get_time() - triggerUs;
+  estopActive = true;
+  deadmanTripped = false;
+
+  portENTER_CRITICAL(&safetyMux);
+  stats.estops++;
+  stats.estopSource = source;
+  stats.lastStopLatencyUs = latency;
+  if (latency > stats.maxStopLatencyUs) stats.maxStopLatencyUs = latency;
+  portEXIT_CRITICAL(&safetyMux);
+
+  LOG_W("SAFETY", "Emergency stop (%s), latency %u us", safety_sourceName(source), (unsigned)latency);
+}
+
+static void handleEstop() {
+  portENTER_CRITICAL(&safetyMux);
+  uint8_t source = pendingSource;
+  uint32_t triggerUs = pendingTriggerUs;
+  pendingSource = SAFETY_SOURCE_NONE;
+  portEXIT_CRITICAL(&safetyMux);
+
+  if (source != SAFETY_SOURCE_NONE) cutMotors(source, triggerUs);
+}
+
+static void handleDeadman() {
+  if (estopActive) return;
+
+  deadmanTripUs = (uint32_t)esp_timer_get_time();
+  deadmanTripped = true;
+
+  portENTER_CRITICAL(&safetyMux);
+  stats.deadmanTrips++;
+  portEXIT_CRITICAL(&safetyMux);
+
+  LOG_W("SAFETY", "Deadman: no control frames for %u ms, stopping motors", (unsigned)DEADMAN_TIMEOUT_MS);
+}
+
+// Задача управления не остановила моторы вовремя (зависла или перегружена)
+static void checkHardStop() {
+  if (!deadmanTripped) return;
+  if ((uint32_t)esp_timer_get_time() - deadmanTripUs < DEADMAN_HARD_STOP_MS * 1000UL) return;
+  cutMotors(SAFETY_SOURCE_DEADMAN, deadmanTripUs + DEADMAN_HARD_STOP_MS * 1000UL);
+}
+
+// Задача с наивысшим приоритетом: остановка не ждёт такта управления и сети
+static void safetyTask(void* arg) {
+  for (;;) {
+    uint32_t events = 0;
+    TickType_t wait = deadmanTripped ? pdMS_TO_TICKS(DEADMAN_HARD_STOP_MS) : portMAX_DELAY;
+    xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+
+    if (events & SAFETY_EVENT_ESTOP) handleEstop();
+    if (events & SAFETY_EVENT_DEADMAN) handleDeadman();
+    checkHardStop();
+  }
+}
+
+// ===== Публичные функции =====
+
+void safety_init() {
+  xTaskCreatePinnedToCore(safetyTask, "safety", SAFETY_TASK_STACK, NULL,
+                          SAFETY_TASK_PRIORITY, &safetyTaskHandle, SAFETY_TASK_CORE);
+
+  deadmanTimer = timerBegin(SAFETY_TIMER_FREQ_HZ);
+  timerAttachInterrupt(deadmanTimer, &onDeadmanTimer);
+  timerAlarm(deadmanTimer, SAFETY_DEADMAN_CHECK_US, true, 0);
+
+  if (ESTOP_PIN >= 0) {
+    pinMode(ESTOP_PIN, ESTOP_ACTIVE_LEVEL == LOW ? INPUT_PULLUP : INPUT_PULLDOWN);
+    attachInterrupt(ESTOP_PIN, onEstopPin, ESTOP_ACTIVE_LEVEL == LOW ? FALLING : RISING);
+  }
+
+  Serial.println("Safety: deadman " + String(DEADMAN_TIMEOUT_MS) + " ms, e-stop pin " + String(ESTOP_PIN));
+}
+
+void safety_feed(bool moving) {
+  // Время записывается до взвода: прерывание не увидит взведённый deadman со старым временем
+  lastFeedUs = (uint32_t)esp_timer_get_time();
+  if (moving) deadmanTripped = false;
+  deadmanArmed = moving;
+}
+
+void safety_estop(SafetySource source, int64_t receivedUs) {
+  if (safetyTaskHandle == NULL) {
+    cutMotors(source, (uint32_t)receivedUs);
+    return;
+  }
+
+  portENTER_CRITICAL(&safetyMux);
+  if (pendingSource == SAFETY_SOURCE_NONE) {
+    pendingSource = source;
+    pendingTriggerUs = (uint32_t)receivedUs;
+  }
+  portEXIT_CRITICAL(&safetyMux);
+
+  xTaskNotify(safetyTaskHandle, SAFETY_EVENT_ESTOP, eSetBits);
+}
+
+bool safety_clearEstop() {
+  if (ESTOP_PIN >= 0 && digitalRead(ESTOP_PIN) == ESTOP_ACTIVE_LEVEL) return false;
+
+  deadmanArmed = false;
+  estopActive = false;
+  motorpwm_release();
+  LOG_I("SAFETY", "Emergency stop cleared");
+  return true;
+}
+
+bool safety_isEstopped() {
+  return estopActive;
+}
+
+bool safety_isDeadmanTripped() {
+  return deadmanTripped;
+}
+
+void safety_notifyStopped() {
+  if (!deadmanTripped) return;
+  deadmanTripped = false;
+
+  portENTER_CRITICAL(&safetyMux);
+  stats.lastRampDownMs = ((uint32_t)esp_timer_get_time() - deadmanTripUs) / 1000;
+  portEXIT_CRITICAL(&safetyMux);
+}
+
+void safety_getStats(SafetyStats* out) {
+  if (out == NULL) return;
+
+  portENTER_CRITICAL(&safetyMux);
+  *out = stats;
+  portEXIT_CRITICAL(&safetyMux);
+  out->estop = estopActive;
+  out->deadmanTripped = deadmanTripped;
+}
+
+const char* safety_sourceName(uint8_t source) {
+  switch (source) {
+    case SAFETY_SOURCE_GPIO: return "gpio";
+    case SAFETY_SOURCE_WS: return "ws";
+    case SAFETY_SOURCE_API: return "api";
+    case SAFETY_SOURCE_DEADMAN: return "deadman";
+    default: return "none";
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef _SAFETY_H
+#define _SAFETY_H
+
+#include <stdint.h>
+
+// Защита движения: deadman и аварийная остановка.
+//
+// Deadman: аппаратный таймер раз в SAFETY_DEADMAN_CHECK_US проверяет время
+// последнего кадра управления с ненулевой скоростью (safety_feed). Если кадров
+// нет дольше DEADMAN_TIMEOUT_MS, моторы плавно останавливаются генератором
+// разгона (dc_loop); если задача управления не довела их до нуля за
+// DEADMAN_HARD_STOP_MS — ШИМ снимается как при аварийной остановке.
+//
+// Аварийная остановка (GPIO ESTOP_PIN, кадр WebSocket, POST /api/estop):
+// источник будит задачу "safety" с наивысшим приоритетом, которая сразу
+// обнуляет ШИМ (motorpwm_kill), не дожидаясь такта управления и HTTP.
+// Состояние защёлкивается до safety_clearEstop().
+
+// ===== Константы =====
+
+// Источники остановки
+enum SafetySource : uint8_t {
+  SAFETY_SOURCE_NONE = 0,
+  SAFETY_SOURCE_GPIO,       // кнопка на ESTOP_PIN
+  SAFETY_SOURCE_WS,         // кадр CTL_FRAME_TYPE_ESTOP
+  SAFETY_SOURCE_API,        // POST /api/estop
+  SAFETY_SOURCE_DEADMAN     // задача управления не остановила моторы после срабатывания deadman
+};
+
+// ===== Структуры данных =====
+
+struct SafetyStats {
+  bool estop;                   // аварийная остановка активна
+  uint8_t estopSource;          // SafetySource последней аварийной остановки
+  bool deadmanTripped;          // deadman сработал, моторы останавливаются
+  uint32_t deadmanTimeoutMs;
+  uint32_t estops;              // аварийных остановок
+  uint32_t deadmanTrips;        // срабатываний deadman
+  uint32_t lastStopLatencyUs;   // от события (прерывание / приём кадра) до снятия ШИМ
+  uint32_t maxStopLatencyUs;
+  uint32_t lastRampDownMs;      // от срабатывания deadman до нулевого ШИМ
+};
+
+// ===== Публичные функции =====
+
+// Задача "safety", таймер deadman и прерывание ESTOP_PIN
+void safety_init();
+
+// Принят валидный кадр управления. moving — в нём есть ненулевая скорость
+// (взводит deadman); кадр с нулевыми скоростями deadman снимает
+void safety_feed(bool moving);
+
+// Аварийная остановка из любой задачи; receivedUs — время приёма команды
+// (esp_timer_get_time) для расчёта задержки
+void safety_estop(SafetySource source, int64_t receivedUs);
+
+// Сброс аварийной остановки. false — кнопка ESTOP_PIN всё ещё нажата
+bool safety_clearEstop();
+
+bool safety_isEstopped();
+
+// Deadman сработал: задача управления должна плавно остановить моторы
+bool safety_isDeadmanTripped();
+
+// Моторы остановлены после срабатывания deadman (вызывается из dc_loop)
+void safety_notifyStopped();
+
+void safety_getStats(SafetyStats* stats);
+
+const char* safety_sourceName(uint8_t source);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _SAMPLE_RING_H
+#define _SAMPLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Кольцевой буфер последних N отсчётов: один писатель, любое число читателей.
+// Писатель никогда не ждёт читателей — старые отсчёты перезаписываются.
+// Каждый слот защищён собственным счётчиком версии (seqlock), поэтому читатель
+// либо получает целый отсчёт, либо узнаёт, что слот уже перезаписан.
+// Не зависит от Arduino/FreeRTOS и собирается на хосте.
+// N — ёмкость, должна быть степенью двойки.
+template <typename T, size_t N>
+class SampleRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SampleRing capacity must be a power of two");
+
+ public:
+  SampleRing() : written(0) {
+    for (size_t i = 0; i < N; i++) slots[i].seq.store(0, std::memory_order_relaxed);
+  }
+
+  // Добавление отсчёта (только писатель). Возвращает его порядковый номер (с 1).
+  uint32_t push(const T& value) {
+    uint32_t seq = written.load(std::memory_order_relaxed) + 1;
+    Slot& slot = slots[seq & (N - 1)];
+
+    slot.seq.store(0, std::memory_order_relaxed);          // слот недействителен на время записи
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.value = value;
+    slot.seq.store(seq, std::memory_order_release);
+    written.store(seq, std::memory_order_release);
+    return seq;
+  }
+
+  // Последний отсчёт. false — отсчётов ещё не было.
+  bool latest(T* out, uint32_t* seqOut = nullptr) const {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+      uint32_t seq = written.load(std::memory_order_acquire);
+      if (seq == 0) return false;
+      if (read(seq, out)) {
+        if (seqOut) *seqOut = seq;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Чтение отсчёта с порядковым номером seq. false — ещё не записан или уже перезаписан.
+  bool read(uint32_t seq, T* out) const {
+    if (seq == 0) return false;
+    const Slot& slot = slots[seq & (N - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != seq) return false;
+    *out = slot.value;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == seq;
+  }
+
+  // Чтение до max отсчётов новее afterSeq в порядке поступления.
+  // В *lastSeq возвращается номер последнего прочитанного (для следующего вызова).
+  // Отсчёты, перезаписанные до чтения, пропускаются.
+  size_t readSince(uint32_t afterSeq, T* out, size_t max, uint32_t* lastSeq) const {
+    uint32_t newest = written.load(std::memory_order_acquire);
+    if (afterSeq >= newest) {
+      if (lastSeq) *lastSeq = afterSeq;
+      return 0;
+    }
+
+    uint32_t first = afterSeq + 1;
+    if (newest - afterSeq > N) first = newest - N + 1;   // самые старые уже перезаписаны
+
+    size_t count = 0;
+    uint32_t seq = first;
+    for (; seq <= newest && count < max; seq++) {
+      if (read(seq, &out[count])) count++;
+    }
+    if (lastSeq) *lastSeq = seq - 1;
+    return count;
+  }
+
+  // Всего записано отсчётов
+  uint32_t count() const { return written.load(std::memory_order_acquire); }
+
+ private:
+  static const int MAX_READ_ATTEMPTS = 4;
+
+  struct Slot {
+    std::atomic<uint32_t> seq;   // 0 — слот пуст или пишется
+    T value;
+  };
+
+  std::atomic<uint32_t> written;
+  Slot slots[N];
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "scan.h"
+#include "config.h"
+
+#include <Arduino.h>
+
+#include "scheduler.h"
+#include "snapshot.h"
+#include "spsc_queue.h"
+#include "servo.h"
+#include "lidar.h"
+
+// ===== Константы =====
+
+// Канал мультиплексора с дальномером, закреплённым на pan-сервоприводе
+#ifndef SCAN_LIDAR_CHANNEL
+#define SCAN_LIDAR_CHANNEL 0
+#endif
+
+#define SCAN_PERIOD_US 2000
+#define SCAN_BUDGET_US 500
+#define SCAN_PRIORITY 1
+#define SCAN_QUEUE_SIZE 128
+#define SCAN_SAMPLE_TIMEOUT_US (3 * LIDAR_TIMING_BUDGET_US)
+#define SCAN_SAMPLES_PER_READ 8
+
+#define SCAN_DEFAULT_START 30
+#define SCAN_DEFAULT_END 150
+#define SCAN_DEFAULT_STEP 5
+#define SCAN_DEFAULT_SETTLE_MS 60
+
+enum ScanState : uint8_t {
+  SCAN_IDLE = 0,
+  SCAN_MOVE,      // команда сервоприводу
+  SCAN_SETTLE,    // ожидание успокоения
+  SCAN_MEASURE    // ожидание свежего отсчёта дальномера
+};
+
+// ===== Глобальные переменные =====
+
+static Snapshot<ScanConfig> configSnapshot;
+static SpscQueue<ScanPoint, SCAN_QUEUE_SIZE> pointQueue;
+
+// Состояние — только в задаче планировщика
+static ScanConfig config = {false, SCAN_DEFAULT_START, SCAN_DEFAULT_END, SCAN_DEFAULT_STEP, SCAN_DEFAULT_SETTLE_MS};
+static uint32_t configSeq = 0;
+static ScanState state = SCAN_IDLE;
+static uint16_t angle = 0;
+static int8_t direction = 1;
+static uint16_t sweep = 0;
+static uint16_t restorePan = 90;
+static uint64_t settleEndUs = 0;
+static uint64_t measureDeadlineUs = 0;
+static uint32_t lidarSeq = 0;
+static uint64_t sweepStartUs = 0;
+static uint32_t sweepPoints = 0;
+
+static ScanStats stats;
+
+// ===== Вспомогательные функции =====
+
+static uint32_t expectedPointsPerSec(const ScanConfig& c) {
+  // Отсчёт берётся не раньше, чем через один полный замер после успокоения
+  uint32_t pointUs = (uint32_t)c.settleMs * 1000 + LIDAR_TIMING_BUDGET_US;
+  return 1000000UL / pointUs;
+}
+
+static void emitPoint(uint64_t timestampUs, uint16_t rangeMm) {
+  ScanPoint point;
+  point.timestampUs = timestampUs;
+  point.angleCdeg = angle * 100;
+  point.rangeMm = rangeMm;
+  point.sweep = sweep;
+  if (!pointQueue.push(point)) stats.dropped++;
+  stats.points++;
+  sweepPoints++;
+}
+
+// Переход к следующему углу; на краях дуги — разворот и завершение прохода
+static void advanceAngle(uint64_t now) {
+  int next = angle + direction * config.stepDeg;
+  if (next > config.endAngle || next < config.startAngle) {
+    direction = -direction;
+    next = angle + direction * config.stepDeg;
+    next = constrain(next, config.startAngle, config.endAngle);
+
+    stats.sweeps++;
+    stats.lastSweepMs = (uint32_t)((now - sweepStartUs) / 1000);
+    if (now > sweepStartUs) {
+      stats.pointsPerSec = (uint32_t)(sweepPoints * 1000000ULL / (now - sweepStartUs));
+    }
+    sweep++;
+    sweepStartUs = now;
+    sweepPoints = 0;
+  }
+  angle = next;
+}
+
+// Применение новой конфигурации: старт, перезапуск или остановка скана
+static void applyConfig(const ScanConfig& next) {
+  uint16_t panAngle, tiltAngle;
+  camera_getTarget(&panAngle, &tiltAngle);
+
+  if (next.enabled && !config.enabled) {
+    restorePan = panAngle;
+  } else if (!next.enabled && config.enabled) {
+    camera_setAngle(restorePan, tiltAngle, SERVO_MOVE_PROFILED);
+  }
+
+  config = next;
+  stats.expectedPointsPerSec = expectedPointsPerSec(config);
+  state = config.enabled ? SCAN_MOVE : SCAN_IDLE;
+  angle = config.startAngle;
+  direction = 1;
+  sweepStartUs = esp_timer_get_time();
+  sweepPoints = 0;
+}
+
+// Поиск отсчёта нужного датчика, весь замер которого прошёл после успокоения.
+// timestampUs — момент чтения результата, замер занял LIDAR_TIMING_BUDGET_US до
+// него; отсчёт, прочитанный сразу после успокоения, мерился ещё при движении.
+static bool findFreshSample(LidarSample* found) {
+  uint64_t freshAfterUs = settleEndUs + LIDAR_TIMING_BUDGET_US;
+  LidarSample buffer[SCAN_SAMPLES_PER_READ];
+  size_t count;
+  bool ok = false;
+
+  do {
+    count = lidar_getSamples(lidarSeq, buffer, SCAN_SAMPLES_PER_READ, &lidarSeq);
+    for (size_t i = 0; i < count && !ok; i++) {
+      if (buffer[i].channel == SCAN_LIDAR_CHANNEL && buffer[i].timestampUs >= freshAfterUs) {
+        *found = buffer[i];
+        ok = true;
+      }
+    }
+  } while (count == SCAN_SAMPLES_PER_READ && !ok);
+
+  return ok;
+}
+
+static void scanJob() {
+  uint32_t seq = configSnapshot.sequence();
+  if (seq != configSeq) {
+    ScanConfig next;
+    if (configSnapshot.read(&next)) {
+      configSeq = seq;
+      applyConfig(next);
+    }
+  }
+
+  uint64_t now = esp_timer_get_time();
+
+  switch (state) {
+    case SCAN_IDLE:
+      break;
+
+    case SCAN_MOVE: {
+      // Шаг скана — сразу: время успокоения settleMs рассчитано на скачок
+      uint16_t panAngle, tiltAngle;
+      camera_getTarget(&panAngle, &tiltAngle);
+      camera_setAngle(angle, tiltAngle, SERVO_MOVE_IMMEDIATE);
+      settleEndUs = now + (uint64_t)config.settleMs * 1000;
+      state = SCAN_SETTLE;
+      break;
+    }
+
+    case SCAN_SETTLE:
+      if (now >= settleEndUs) {
+        // Отсчёты, снятые до успокоения, отсеиваются по метке времени в findFreshSample()
+        measureDeadlineUs = now + SCAN_SAMPLE_TIMEOUT_US;
+        state = SCAN_MEASURE;
+      }
+      break;
+
+    case SCAN_MEASURE: {
+      LidarSample sample;
+      if (findFreshSample(&sample)) {
+        emitPoint(sample.timestampUs, sample.rangeMm);
+      } else if (now >= measureDeadlineUs) {
+        stats.timeouts++;
+        emitPoint(now, LIDAR_RANGE_INVALID);
+      } else {
+        break;
+      }
+      advanceAngle(now);
+      state = SCAN_MOVE;
+      break;
+    }
+  }
+}
+
+// ===== Публичные функции =====
+
+void scan_init() {
+  memset(&stats, 0, sizeof(stats));
+  stats.expectedPointsPerSec = expectedPointsPerSec(config);
+  sched_addJob("scan", SCAN_PERIOD_US, SCAN_PRIORITY, SCAN_BUDGET_US, scanJob);
+}
+
+bool scan_configure(const ScanConfig& next) {
+  if (next.startAngle > 180 || next.endAngle > 180 || next.startAngle >= next.endAngle) return false;
+  if (next.stepDeg == 0 || next.stepDeg > next.endAngle - next.startAngle) return false;
+
+  configSnapshot.publish(next);
+  return true;
+}
+
+uint8_t scan_getLidarChannel() {
+  return SCAN_LIDAR_CHANNEL;
+}
+
+void scan_getConfig(ScanConfig* out) {
+  if (out == NULL) return;
+  if (!configSnapshot.read(out)) {
+    *out = {false, SCAN_DEFAULT_START, SCAN_DEFAULT_END, SCAN_DEFAULT_STEP, SCAN_DEFAULT_SETTLE_MS};
+  }
+}
+
+void scan_getStats(ScanStats* out) {
+  if (out) *out = stats;
+}
+
+bool scan_popPoint(ScanPoint* point) {
+  return pointQueue.pop(*point);
+}
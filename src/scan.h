@@ -0,0 +1,57 @@
+#ifndef _SCAN_H
+#define _SCAN_H
+
+#include <stdint.h>
+
+// Режим скана: pan-сервопривод камеры шагает по дуге, после успокоения
+// на каждом шаге берётся свежий отсчёт дальномера SCAN_LIDAR_CHANNEL.
+// Точки (угол, расстояние, время) передаются клиентам WebSocket бинарными
+// кадрами CTL_FRAME_TYPE_SCAN (см. ctlframe.h).
+//
+// Компромисс скорость/разрешение: время одной точки ≈ settleMs + LIDAR_TIMING_BUDGET_US,
+// число точек за проход = (endAngle - startAngle) / stepDeg + 1.
+
+// ===== Структуры данных =====
+
+struct ScanConfig {
+  bool enabled;
+  uint8_t startAngle;     // 0-180°
+  uint8_t endAngle;       // 0-180°, больше startAngle
+  uint8_t stepDeg;        // шаг, ≥ 1°
+  uint16_t settleMs;      // ожидание после команды сервоприводу
+};
+
+struct ScanPoint {
+  uint64_t timestampUs;
+  uint16_t angleCdeg;     // фактически заданный угол, сотые доли градуса
+  uint16_t rangeMm;       // LIDAR_RANGE_INVALID — нет отражения / нет отсчёта
+  uint16_t sweep;
+};
+
+struct ScanStats {
+  uint32_t points;        // всего точек
+  uint32_t sweeps;        // завершённых проходов
+  uint32_t timeouts;      // шагов без свежего отсчёта
+  uint32_t dropped;       // точек, не поместившихся в очередь передачи
+  uint32_t pointsPerSec;  // фактическая скорость за последний проход
+  uint32_t lastSweepMs;   // длительность последнего прохода
+  uint32_t expectedPointsPerSec; // оценка для текущей конфигурации
+};
+
+// Регистрация задачи скана в планировщике
+void scan_init();
+
+// Установка конфигурации (из обработчика HTTP, один писатель). false — некорректные параметры.
+bool scan_configure(const ScanConfig& config);
+
+// Канал мультиплексора дальномера на pan-сервоприводе (SCAN_LIDAR_CHANNEL)
+uint8_t scan_getLidarChannel();
+
+// Текущая конфигурация и статистика
+void scan_getConfig(ScanConfig* config);
+void scan_getStats(ScanStats* stats);
+
+// Извлечение очередной точки для передачи (только сетевая задача)
+bool scan_popPoint(ScanPoint* point);
+
+#endif
@@ -0,0 +1,153 @@
+#include "scheduler.h"
+
+#include <Arduino.h>
+
+// ===== Константы =====
+
+#define SCHED_TASK_CORE 1
+#define SCHED_TASK_PRIORITY 5
+#define SCHED_TASK_STACK 6144
+#define SCHED_TIMER_FREQ_HZ 1000000
+
+// ===== Структуры данных =====
+
+struct SchedJob {
+  SchedJobFunc func;
+  uint64_t nextReleaseUs;
+  uint64_t totalUs;
+  SchedJobStats stats;
+};
+
+// ===== Глобальные переменные =====
+
+static SchedJob jobs[SCHED_MAX_JOBS];
+static int jobCount = 0;
+
+static hw_timer_t* schedTimer = NULL;
+static TaskHandle_t schedTaskHandle = NULL;
+
+// Защищает статистику при чтении из обработчиков HTTP на другом ядре
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+static void IRAM_ATTR onSchedTimer() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(schedTaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void runJob(SchedJob& job, uint64_t now) {
+  uint32_t jitter = (uint32_t)(now - job.nextReleaseUs);
+
+  uint64_t start = esp_timer_get_time();
+  job.func();
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+  // Следующий запуск — по сетке периода; пропущенные периоды не догоняем
+  job.nextReleaseUs += job.stats.periodUs;
+  uint32_t missed = 0;
+  while (job.nextReleaseUs <= now) {
+    job.nextReleaseUs += job.stats.periodUs;
+    missed++;
+  }
+
+  portENTER_CRITICAL(&statsMux);
+  SchedJobStats& s = job.stats;
+  s.runs++;
+  s.missed += missed;
+  s.lastUs = elapsed;
+  if (elapsed > s.wcetUs) s.wcetUs = elapsed;
+  if (elapsed > s.budgetUs) s.overruns++;
+  job.totalUs += elapsed;
+  s.avgUs = (uint32_t)(job.totalUs / s.runs);
+  s.lastJitterUs = jitter;
+  if (jitter > s.maxJitterUs) s.maxJitterUs = jitter;
+  portEXIT_CRITICAL(&statsMux);
+}
+
+// Задача планировщика: ждёт такт таймера и запускает созревшие задачи по приоритету
+static void schedTask(void* arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (int i = 0; i < jobCount; i++) {
+      uint64_t now = esp_timer_get_time();
+      if (now >= jobs[i].nextReleaseUs) {
+        runJob(jobs[i], now);
+      }
+    }
+  }
+}
+
+// ===== Публичные функции =====
+
+int sched_addJob(const char* name, uint32_t periodUs, uint8_t priority,
+                 uint32_t budgetUs, SchedJobFunc func) {
+  if (jobCount >= SCHED_MAX_JOBS || func == NULL || periodUs == 0) {
+    Serial.println("Scheduler: cannot add job " + String(name));
+    return -1;
+  }
+
+  // Вставка с сохранением порядка по убыванию приоритета
+  int pos = jobCount;
+  while (pos > 0 && jobs[pos - 1].stats.priority < priority) {
+    jobs[pos] = jobs[pos - 1];
+    pos--;
+  }
+
+  SchedJob& job = jobs[pos];
+  memset(&job, 0, sizeof(job));
+  job.func = func;
+  job.stats.name = name;
+  job.stats.periodUs = periodUs;
+  job.stats.budgetUs = budgetUs;
+  job.stats.priority = priority;
+  jobCount++;
+
+  Serial.println("Scheduler: job '" + String(name) + "' period " + String(periodUs) +
+                 " us, budget " + String(budgetUs) + " us, priority " + String(priority));
+  return pos;
+}
+
+void sched_start() {
+  uint64_t now = esp_timer_get_time();
+  for (int i = 0; i < jobCount; i++) {
+    jobs[i].nextReleaseUs = now;
+  }
+
+  xTaskCreatePinnedToCore(schedTask, "control", SCHED_TASK_STACK, NULL,
+                          SCHED_TASK_PRIORITY, &schedTaskHandle, SCHED_TASK_CORE);
+
+  schedTimer = timerBegin(SCHED_TIMER_FREQ_HZ);
+  timerAttachInterrupt(schedTimer, &onSchedTimer);
+  timerAlarm(schedTimer, SCHED_TICK_US, true, 0);
+
+  Serial.println("Scheduler started: " + String(jobCount) + " jobs, tick " +
+                 String(SCHED_TICK_US) + " us, core " + String(SCHED_TASK_CORE));
+}
+
+int sched_jobCount() {
+  return jobCount;
+}
+
+bool sched_getStats(int index, SchedJobStats* stats) {
+  if (index < 0 || index >= jobCount || stats == NULL) return false;
+
+  portENTER_CRITICAL(&statsMux);
+  *stats = jobs[index].stats;
+  portEXIT_CRITICAL(&statsMux);
+  return true;
+}
+
+void sched_resetStats() {
+  portENTER_CRITICAL(&statsMux);
+  for (int i = 0; i < jobCount; i++) {
+    SchedJobStats& s = jobs[i].stats;
+    s.runs = s.overruns = s.missed = 0;
+    s.lastUs = s.avgUs = s.wcetUs = 0;
+    s.lastJitterUs = s.maxJitterUs = 0;
+    jobs[i].totalUs = 0;
+  }
+  portEXIT_CRITICAL(&statsMux);
+}
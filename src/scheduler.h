@@ -0,0 +1,52 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <stdint.h>
+
+// Кооперативный планировщик периодических задач с фиксированным тактом.
+// Такт задаёт аппаратный таймер; задачи выполняются в задаче FreeRTOS "control"
+// на ядре SCHED_TASK_CORE в порядке приоритета (больше — важнее).
+// Для каждой задачи ведётся статистика: перерасход бюджета, WCET и джиттер запуска.
+
+// ===== Константы =====
+
+#define SCHED_MAX_JOBS 8
+#define SCHED_TICK_US 1000
+
+// ===== Структуры данных =====
+
+typedef void (*SchedJobFunc)();
+
+struct SchedJobStats {
+  const char* name;
+  uint32_t periodUs;
+  uint32_t budgetUs;
+  uint8_t priority;
+  uint32_t runs;          // число запусков
+  uint32_t overruns;      // запусков дольше бюджета
+  uint32_t missed;        // пропущенных периодов (задача не успела стартовать вовремя)
+  uint32_t lastUs;        // время последнего выполнения, мкс
+  uint32_t avgUs;         // среднее время выполнения, мкс
+  uint32_t wcetUs;        // наихудшее время выполнения, мкс
+  uint32_t lastJitterUs;  // задержка старта относительно плановой, мкс
+  uint32_t maxJitterUs;
+};
+
+// Регистрация периодической задачи (до sched_start()).
+// Возвращает индекс задачи или -1, если таблица заполнена.
+int sched_addJob(const char* name, uint32_t periodUs, uint8_t priority,
+                 uint32_t budgetUs, SchedJobFunc func);
+
+// Запуск аппаратного таймера и задачи планировщика
+void sched_start();
+
+// Число зарегистрированных задач
+int sched_jobCount();
+
+// Копия статистики задачи по индексу (порядок — по убыванию приоритета)
+bool sched_getStats(int index, SchedJobStats* stats);
+
+// Сброс накопленной статистики (WCET, джиттер, счётчики)
+void sched_resetStats();
+
+#endif
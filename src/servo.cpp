@@ -1,22 +1,46 @@
 #include <Wire.h>
 #include <Adafruit_PWMServoDriver.h>
 
+#include "servo.h"
+#include "servocal.h"
+#include "ramp.h"
+#include "scheduler.h"
 #include "pins.h"
 #include "config.h"
 
 // ===== Константы =====
 
 #define MAX_SERVOS 16
+#define PCA9685_ADDR 0x40
+#define PCA9685_LED0_ON_L 0x06    // Первый регистр канала 0, по 4 регистра на канал
+#define PCA9685_REGS_PER_CHANNEL 4
 #define CAMERA_PAN_CHANNEL  4
 #define CAMERA_TILT_CHANNEL 5
 
 #define SERVO_ANGLE_MIN 20
 #define SERVO_ANGLE_MAX 160
 
-// SG92R 180°: типичные значения PWM для 50Hz
+// SG92R 180°: типичные значения PWM для 50Hz (калибровка по умолчанию)
 #define SG92R_PWM_MIN 140
 #define SG92R_PWM_MAX 480
 
+static_assert(MAX_SERVOS == SERVOCAL_CHANNELS, "one calibration table per PCA9685 channel");
+
+// Кадр траекторий — период импульсов PCA9685 при 50 Гц
+#define SERVO_FRAME_US 20000
+#define SERVO_FRAME_BUDGET_US 3000
+#define SERVO_FRAME_PRIORITY 2
+
+// Ограничения профиля по умолчанию для всех каналов: °/с и °/с² (0 — без ограничения),
+// переопределяются в config.h и через API
+#ifndef SERVO_MAX_SPEED
+#define SERVO_MAX_SPEED 360
+#endif
+
+#ifndef SERVO_MAX_ACCEL
+#define SERVO_MAX_ACCEL 2400
+#endif
+
 // Опциональный макрос для отладочного вывода
 // Раскомментируйте для включения подробных сообщений
 // #define SERVO_DEBUG
@@ -31,21 +55,19 @@
 
 // ===== Глобальные объекты =====
 
-Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver(0x40, Wire);
+Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver(PCA9685_ADDR, Wire);
 
 // ===== Структуры данных =====
 
+// Траектория канала: положение — генератор ramp.h в градусах Q8,
+// его ограничение изменения за такт — скорость, ограничение рывка — ускорение
 struct ServoConfig {
-  uint16_t currentAngle;
-};
-
-struct CameraConfig {
-  uint16_t panAngle;
-  uint16_t tiltAngle;
-  uint16_t panMin;
-  uint16_t panMax;
-  uint16_t tiltMin;
-  uint16_t tiltMax;
+  uint16_t currentAngle;   // текущее положение, округлённое до градуса
+  uint16_t pulse;          // последний выставленный импульс
+  uint16_t maxSpeed;       // °/с (0 — без ограничения)
+  uint16_t maxAccel;       // °/с² (0 — без ограничения)
+  Ramp ramp;
+  RampLimits limits;
 };
 
 // ===== Глобальные переменные =====
@@ -53,17 +75,25 @@ struct CameraConfig {
 ServoConfig servoConfigs[MAX_SERVOS];
 int correction[MAX_SERVOS] = SERVO_CORRECTION;
 
-CameraConfig cameraConfig = {
-  .panAngle = 90,
-  .tiltAngle = 90,
-  .panMin = SG92R_PWM_MIN,
-  .panMax = SG92R_PWM_MAX,
-  .tiltMin = SG92R_PWM_MIN,
-  .tiltMax = SG92R_PWM_MAX,
-};
+// Скомпилированная калибровка: импульс по углу для каждого канала (servocal.h).
+// Пишет и читает только задача управления.
+static uint16_t pulseTable[MAX_SERVOS][SERVOCAL_ANGLES];
 
 String inputString = "";
 
+// Последние записанные в PCA9685 импульсы (для пропуска неизменившихся каналов)
+static uint16_t channelPulse[MAX_SERVOS];
+static uint16_t channelWrittenMask = 0;
+
+// Каналы, траектория которых ещё не дошла до цели
+static uint16_t movingMask = 0;
+
+// Каналы, запись которых не прошла по I2C: повторяются в следующем кадре servo_loop()
+static uint16_t retryMask = 0;
+
+static ServoBusStats busStats = {0, 0, 0, 0, 0, 0, 0, 0};
+static uint32_t i2cClockHz = 100000;
+
 // ===== Вспомогательные функции =====
 
 // Проверка валидности номера сервопривода
@@ -72,27 +102,235 @@ static bool isValidServoNum(uint8_t servoNum) {
 }
 
 
+// Оценка времени на шине (мкс) для транзакции из байтов адреса, регистра и данных:
+// 9 тактов на байт (8 бит + ACK) плюс START/STOP
+static uint32_t i2cTransactionUs(uint32_t dataBytes) {
+  uint32_t bits = (2 + dataBytes) * 9 + 2;
+  return (bits * 1000000UL) / i2cClockHz;
+}
+
+// Пакетная запись импульсов в PCA9685.
+// Каналы с неизменившимся импульсом пропускаются. Все изменившиеся каналы пишутся
+// одной транзакцией начиная с первого изменившегося канала (автоинкремент регистров
+// MODE1.AI включает Adafruit_PWMServoDriver::setPWMFreq()). Неизменившиеся каналы
+// внутри диапазона переписываются своим текущим значением — это дешевле отдельной
+// транзакции. Если внутри диапазона есть канал, который ещё ни разу не писался,
+// диапазон разбивается на несколько транзакций.
+// Кэш channelPulse/channelWrittenMask обновляется только после успешной транзакции;
+// каналы неудачной транзакции попадают в retryMask.
+static void writePulses(uint16_t mask, const uint16_t pulses[]) {
+  uint16_t pending[MAX_SERVOS];
+  uint16_t changedMask = 0;
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    pending[ch] = channelPulse[ch];
+    if (!(mask & (1 << ch))) continue;
+    if ((channelWrittenMask & (1 << ch)) && channelPulse[ch] == pulses[ch]) {
+      busStats.channelsSkipped++;
+      continue;
+    }
+    changedMask |= (1 << ch);
+    pending[ch] = pulses[ch];
+  }
+
+  busStats.updates++;
+  busStats.lastChannels = 0;
+  busStats.lastSavedUs = 0;
+  if (changedMask == 0) return;
+
+  unsigned long start = micros();
+  uint32_t changedCount = 0;
+  uint32_t bytesWritten = 0;
+  uint32_t transactions = 0;
+
+  int ch = 0;
+  while (ch < MAX_SERVOS) {
+    if (!(changedMask & (1 << ch))) {
+      ch++;
+      continue;
+    }
+
+    // Начало серии: идём вперёд, пока впереди есть изменившиеся каналы,
+    // а промежуточные каналы имеют известное значение
+    int last = ch;
+    for (int next = ch + 1; next < MAX_SERVOS; next++) {
+      uint16_t bit = 1 << next;
+      if (changedMask & bit) {
+        last = next;
+      } else if (!(channelWrittenMask & bit)) {
+        break;
+      }
+    }
+
+    Wire.beginTransmission(PCA9685_ADDR);
+    Wire.write(PCA9685_LED0_ON_L + PCA9685_REGS_PER_CHANNEL * ch);
+    uint16_t rangeMask = 0;
+    for (int i = ch; i <= last; i++) {
+      uint16_t pulse = pending[i];
+      Wire.write(0);              // ON_L
+      Wire.write(0);              // ON_H
+      Wire.write(pulse & 0xFF);   // OFF_L
+      Wire.write(pulse >> 8);     // OFF_H
+      rangeMask |= (1 << i);
+    }
+    rangeMask &= changedMask;
+
+    if (Wire.endTransmission() == 0) {
+      for (int i = ch; i <= last; i++) channelPulse[i] = pending[i];
+      channelWrittenMask |= rangeMask;
+      retryMask &= ~rangeMask;
+      changedCount += __builtin_popcount(rangeMask);
+    } else {
+      // Что дошло до PCA9685, неизвестно: каналы считаются незаписанными
+      channelWrittenMask &= ~rangeMask;
+      retryMask |= rangeMask;
+      busStats.errors++;
+    }
+
+    bytesWritten += PCA9685_REGS_PER_CHANNEL * (last - ch + 1);
+    transactions++;
+    ch = last + 1;
+  }
+
+  // Экономия относительно записи каждого канала отдельным setPWM()
+  uint32_t individualUs = changedCount * i2cTransactionUs(PCA9685_REGS_PER_CHANNEL);
+  uint32_t burstUs = transactions * i2cTransactionUs(0) + (bytesWritten * 9 * 1000000UL) / i2cClockHz;
+
+  busStats.channelsWritten += changedCount;
+  busStats.lastChannels = changedCount;
+  busStats.lastBurstUs = micros() - start;
+  busStats.lastSavedUs = (individualUs > burstUs) ? individualUs - burstUs : 0;
+  busStats.totalSavedUs += busStats.lastSavedUs;
+}
+
+// Калибровка по умолчанию: прямая SG92R через две точки, для рулевых
+// сервоприводов — со сдвигом угла SERVO_CORRECTION (как прежний map())
+static void buildDefaultCalibrations(ServoCalibration defaults[MAX_SERVOS]) {
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    ServoCalibration& calibration = defaults[ch];
+    memset(&calibration, 0, sizeof(calibration));
+    calibration.count = 2;
+    calibration.points[0].angle = 0;
+    calibration.points[0].pulse = map(correction[ch], 0, 180, SG92R_PWM_MIN, SG92R_PWM_MAX);
+    calibration.points[1].angle = SERVOCAL_ANGLE_MAX;
+    calibration.points[1].pulse = map(SERVOCAL_ANGLE_MAX + correction[ch], 0, 180, SG92R_PWM_MIN, SG92R_PWM_MAX);
+  }
+}
+
+// Импульс для положения в градусах Q8: между целыми градусами таблицы — линейно
+static uint16_t pulseAt(int ch, int32_t value) {
+  int32_t angle = value >> RAMP_FRAC_BITS;
+  if (angle < 0) return pulseTable[ch][0];
+  if (angle >= SERVOCAL_ANGLE_MAX) return pulseTable[ch][SERVOCAL_ANGLE_MAX];
+
+  int32_t frac = value & (RAMP_ONE - 1);
+  int32_t from = pulseTable[ch][angle];
+  int32_t to = pulseTable[ch][angle + 1];
+  return (uint16_t)(from + (((to - from) * frac + RAMP_ONE / 2) >> RAMP_FRAC_BITS));
+}
+
+// Текущее положение канала -> импульс в pulses[ch]
+static void updatePosition(int ch, uint16_t pulses[]) {
+  ServoConfig& servo = servoConfigs[ch];
+  servo.currentAngle = (uint16_t)((servo.ramp.value + RAMP_ONE / 2) >> RAMP_FRAC_BITS);
+  servo.pulse = pulseAt(ch, servo.ramp.value);
+  pulses[ch] = servo.pulse;
+}
+
+// Новые цели каналов mask. Немедленное перемещение (или канал без ограничения
+// скорости) пишется в PCA9685 сразу, профилированное — в кадрах servo_loop()
+static void setTargets(uint16_t mask, const uint16_t angles[], ServoMove move) {
+  uint16_t pulses[MAX_SERVOS];
+  uint16_t immediateMask = 0;
+
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    uint16_t bit = 1 << ch;
+    if (!(mask & bit)) continue;
+
+    ServoConfig& servo = servoConfigs[ch];
+    int32_t target = ramp_toFixed(angles[ch]);
+    if (move == SERVO_MOVE_IMMEDIATE || servo.limits.accel <= 0) {
+      ramp_reset(&servo.ramp, target);
+      updatePosition(ch, pulses);
+      movingMask &= ~bit;
+      immediateMask |= bit;
+    } else {
+      servo.ramp.target = target;
+      movingMask |= bit;
+    }
+  }
+
+  if (immediateMask) writePulses(immediateMask, pulses);
+}
+
 // ===== Публичные функции API =====
 
-void servo_setAngle(uint8_t servoNum, uint16_t angle) {
+void servo_setAngles(uint16_t mask, const uint16_t angles[], ServoMove move) {
+  uint16_t targets[MAX_SERVOS];
+
+  for (int i = 0; i < MAX_SERVOS; i++) {
+    if (!(mask & (1 << i))) continue;
+
+    targets[i] = constrain(angles[i], SERVO_ANGLE_MIN, SERVO_ANGLE_MAX);
+
+    DEBUG_PRINT("Servo ");
+    DEBUG_PRINT(i);
+    DEBUG_PRINT(" -> ");
+    DEBUG_PRINT(targets[i]);
+    DEBUG_PRINTLN("°");
+  }
+
+  setTargets(mask, targets, move);
+}
+
+void servo_setAngle(uint8_t servoNum, uint16_t angle, ServoMove move) {
   if (!isValidServoNum(servoNum)) {
     DEBUG_PRINTLN("Error: Servo number out of range");
     return;
   }
-  
-  angle = constrain(angle, SERVO_ANGLE_MIN, SERVO_ANGLE_MAX);
-  int realAngle = angle + correction[servoNum];
-  
-  uint16_t pulse = map(realAngle, 0, 180, SG92R_PWM_MIN, SG92R_PWM_MAX);
-  
-  pwm.setPWM(servoNum, 0, pulse);
-  servoConfigs[servoNum].currentAngle = angle;
-  
-  DEBUG_PRINT("Servo ");
-  DEBUG_PRINT(servoNum);
-  DEBUG_PRINT(" -> ");
-  DEBUG_PRINT(angle);
-  DEBUG_PRINTLN("°");
+
+  uint16_t angles[MAX_SERVOS];
+  angles[servoNum] = angle;
+  servo_setAngles(1 << servoNum, angles, move);
+}
+
+void servo_setProfile(uint16_t mask, uint16_t maxSpeed, uint16_t maxAccel) {
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    if (!(mask & (1 << ch))) continue;
+    ServoConfig& servo = servoConfigs[ch];
+    servo.maxSpeed = maxSpeed;
+    servo.maxAccel = maxAccel;
+    servo.limits = ramp_limits(maxSpeed, maxAccel, SERVO_FRAME_US);
+  }
+}
+
+void servo_getProfile(uint8_t servoNum, uint16_t* maxSpeed, uint16_t* maxAccel) {
+  if (!isValidServoNum(servoNum)) return;
+  if (maxSpeed) *maxSpeed = servoConfigs[servoNum].maxSpeed;
+  if (maxAccel) *maxAccel = servoConfigs[servoNum].maxAccel;
+}
+
+void servo_applyCalibration(uint16_t mask) {
+  uint16_t pulses[MAX_SERVOS];
+  uint16_t rewriteMask = 0;
+
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    if (!(mask & (1 << ch))) continue;
+
+    ServoCalibration calibration;
+    servocal_get(ch, &calibration, NULL);
+    servocal_compile(&calibration, pulseTable[ch]);
+
+    // Уже выставленный канал сразу переходит на новую калибровку
+    if (!(channelWrittenMask & (1 << ch))) continue;
+    updatePosition(ch, pulses);
+    rewriteMask |= (1 << ch);
+  }
+
+  if (rewriteMask) writePulses(rewriteMask, pulses);
+}
+
+void servo_getBusStats(ServoBusStats* stats) {
+  if (stats) *stats = busStats;
 }
 
 uint16_t servo_getAngle(uint8_t servoNum) {
@@ -100,48 +338,56 @@ uint16_t servo_getAngle(uint8_t servoNum) {
   return servoConfigs[servoNum].currentAngle;
 }
 
-// ===== Функции управления камерой =====
-
-// Преобразование угла (0-180) в PWM значение
-static uint16_t angleToPWM(uint16_t angle, uint16_t minPWM, uint16_t maxPWM) {
-  return map(angle, 0, 180, minPWM, maxPWM);
+uint16_t servo_getTarget(uint8_t servoNum) {
+  if (!isValidServoNum(servoNum)) return 0;
+  return (uint16_t)ramp_toInt(servoConfigs[servoNum].ramp.target);
 }
 
-void camera_setAngle(uint16_t panAngle, uint16_t tiltAngle) {
-  panAngle = constrain(panAngle, 0, 180);
-  tiltAngle = constrain(tiltAngle, 0, 180);
-
-  uint16_t panPWM = angleToPWM(panAngle, cameraConfig.panMin, cameraConfig.panMax);
-  uint16_t tiltPWM = angleToPWM(tiltAngle, cameraConfig.tiltMin, cameraConfig.tiltMax);
+uint16_t servo_getMovingMask() {
+  return movingMask;
+}
 
-  pwm.setPWM(CAMERA_PAN_CHANNEL, 0, panPWM);
-  pwm.setPWM(CAMERA_TILT_CHANNEL, 0, tiltPWM);
+// ===== Функции управления камерой =====
 
-  cameraConfig.panAngle = panAngle;
-  cameraConfig.tiltAngle = tiltAngle;
+void camera_setAngle(uint16_t panAngle, uint16_t tiltAngle, ServoMove move) {
+  uint16_t angles[MAX_SERVOS];
+  angles[CAMERA_PAN_CHANNEL] = constrain(panAngle, 0, 180);
+  angles[CAMERA_TILT_CHANNEL] = constrain(tiltAngle, 0, 180);
+  setTargets((1 << CAMERA_PAN_CHANNEL) | (1 << CAMERA_TILT_CHANNEL), angles, move);
 
   DEBUG_PRINT("Camera set: PAN=");
-  DEBUG_PRINT(panAngle);
-  DEBUG_PRINT("° (");
-  DEBUG_PRINT(panPWM);
-  DEBUG_PRINT("), TILT=");
-  DEBUG_PRINT(tiltAngle);
-  DEBUG_PRINT("° (");
-  DEBUG_PRINT(tiltPWM);
-  DEBUG_PRINTLN(")");
+  DEBUG_PRINT(angles[CAMERA_PAN_CHANNEL]);
+  DEBUG_PRINT("°, TILT=");
+  DEBUG_PRINT(angles[CAMERA_TILT_CHANNEL]);
+  DEBUG_PRINTLN("°");
 }
 
 void camera_getAngle(uint16_t* panAngle, uint16_t* tiltAngle) {
-  if (panAngle) *panAngle = cameraConfig.panAngle;
-  if (tiltAngle) *tiltAngle = cameraConfig.tiltAngle;
+  if (panAngle) *panAngle = servoConfigs[CAMERA_PAN_CHANNEL].currentAngle;
+  if (tiltAngle) *tiltAngle = servoConfigs[CAMERA_TILT_CHANNEL].currentAngle;
+}
+
+void camera_getTarget(uint16_t* panAngle, uint16_t* tiltAngle) {
+  if (panAngle) *panAngle = servo_getTarget(CAMERA_PAN_CHANNEL);
+  if (tiltAngle) *tiltAngle = servo_getTarget(CAMERA_TILT_CHANNEL);
 }
 
 void camera_setPWM(uint16_t panPWM, uint16_t tiltPWM) {
   panPWM = constrain(panPWM, SG92R_PWM_MIN, SG92R_PWM_MAX);
   tiltPWM = constrain(tiltPWM, SG92R_PWM_MIN, SG92R_PWM_MAX);
 
-  pwm.setPWM(CAMERA_PAN_CHANNEL, 0, panPWM);
-  pwm.setPWM(CAMERA_TILT_CHANNEL, 0, tiltPWM);
+  // Точный импульс прерывает траекторию: кадры не перепишут его до новой цели
+  uint16_t cameraMask = (1 << CAMERA_PAN_CHANNEL) | (1 << CAMERA_TILT_CHANNEL);
+  movingMask &= ~cameraMask;
+  ramp_reset(&servoConfigs[CAMERA_PAN_CHANNEL].ramp, servoConfigs[CAMERA_PAN_CHANNEL].ramp.value);
+  ramp_reset(&servoConfigs[CAMERA_TILT_CHANNEL].ramp, servoConfigs[CAMERA_TILT_CHANNEL].ramp.value);
+  servoConfigs[CAMERA_PAN_CHANNEL].pulse = panPWM;
+  servoConfigs[CAMERA_TILT_CHANNEL].pulse = tiltPWM;
+
+  uint16_t pulses[MAX_SERVOS];
+  pulses[CAMERA_PAN_CHANNEL] = panPWM;
+  pulses[CAMERA_TILT_CHANNEL] = tiltPWM;
+  writePulses(cameraMask, pulses);
 
   DEBUG_PRINT("Camera set PWM: PAN=");
   DEBUG_PRINT(panPWM);
@@ -150,12 +396,8 @@ void camera_setPWM(uint16_t panPWM, uint16_t tiltPWM) {
 }
 
 void camera_getPWM(uint16_t* panPWM, uint16_t* tiltPWM) {
-  if (panPWM) {
-    *panPWM = angleToPWM(cameraConfig.panAngle, cameraConfig.panMin, cameraConfig.panMax);
-  }
-  if (tiltPWM) {
-    *tiltPWM = angleToPWM(cameraConfig.tiltAngle, cameraConfig.tiltMin, cameraConfig.tiltMax);
-  }
+  if (panPWM) *panPWM = servoConfigs[CAMERA_PAN_CHANNEL].pulse;
+  if (tiltPWM) *tiltPWM = servoConfigs[CAMERA_TILT_CHANNEL].pulse;
 }
 
 // ===== Инициализация и цикл =====
@@ -176,24 +418,67 @@ void servo_init() {
   }
   Serial.println("PCA9685 initialized");
   
+  // setPWMFreq() также включает автоинкремент регистров (MODE1.AI),
+  // на котором основана пакетная запись каналов в writePulses()
   pwm.setPWMFreq(50);
   Serial.println("PWM frequency set to 50Hz");
+
+  i2cClockHz = Wire.getClock();
+
+  // Калибровка из NVS (или по умолчанию) -> таблицы угол -> импульс
+  ServoCalibration defaults[MAX_SERVOS];
+  buildDefaultCalibrations(defaults);
+  servocal_init(defaults);
+  servo_applyCalibration(0xFFFF);
   
   for (int i = 0; i < MAX_SERVOS; i++) {
     servoConfigs[i].currentAngle = 0;
+    ramp_reset(&servoConfigs[i].ramp, 0);
   }
+  servo_setProfile(0xFFFF, SERVO_MAX_SPEED, SERVO_MAX_ACCEL);
   
+  // Исходное положение неизвестно — в 90° без профиля
   Serial.println("\nInitializing servos to 90°...");
   for (int i = 0; i < 4; i++) {
-    servo_setAngle(i, 90);
+    servo_setAngle(i, 90, SERVO_MOVE_IMMEDIATE);
     delay(100);
   }
 
-  camera_setAngle(90, 90);
+  camera_setAngle(90, 90, SERVO_MOVE_IMMEDIATE);
+
+  sched_addJob("servo", SERVO_FRAME_US, SERVO_FRAME_PRIORITY, SERVO_FRAME_BUDGET_US, servo_loop);
 
   Serial.println("\n=== System Ready ===");
 }
 
-void loop_servo() {
-  
+// Кадр траекторий: шаг профиля каждого движущегося канала, затем все
+// изменившиеся импульсы пишутся одним пакетным обновлением
+void servo_loop() {
+  if (movingMask == 0 && retryMask == 0) return;
+
+  uint16_t pulses[MAX_SERVOS];
+  uint16_t changedMask = 0;
+
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    uint16_t bit = 1 << ch;
+    if (!(movingMask & bit)) continue;
+
+    ServoConfig& servo = servoConfigs[ch];
+    uint16_t lastPulse = servo.pulse;
+    ramp_step(&servo.ramp, &servo.limits);
+    updatePosition(ch, pulses);
+
+    if (servo.ramp.value == servo.ramp.target && servo.ramp.rate == 0) movingMask &= ~bit;
+    if (servo.pulse != lastPulse) changedMask |= bit;
+  }
+
+  // Повтор неудавшейся записи для остановившихся каналов
+  for (int ch = 0; ch < MAX_SERVOS; ch++) {
+    uint16_t bit = 1 << ch;
+    if (!(retryMask & bit) || (movingMask & bit)) continue;
+    pulses[ch] = servoConfigs[ch].pulse;
+  }
+  changedMask |= retryMask;
+
+  if (changedMask) writePulses(changedMask, pulses);
 }
@@ -3,27 +3,73 @@
 
 #include <stdint.h>
 
+// Перемещение к новому углу: по профилю канала (скорость и ускорение, servo_setProfile)
+// в кадрах servo_loop() или сразу одной записью в PCA9685
+enum ServoMove : uint8_t {
+  SERVO_MOVE_PROFILED = 0,
+  SERVO_MOVE_IMMEDIATE
+};
+
+// Статистика пакетной записи в PCA9685
+struct ServoBusStats {
+  uint32_t updates;          // вызовов пакетной записи
+  uint32_t channelsWritten;  // каналов записано (изменившихся)
+  uint32_t channelsSkipped;  // каналов пропущено (импульс не изменился)
+  uint32_t lastChannels;     // каналов записано в последнем обновлении
+  uint32_t lastBurstUs;      // измеренное время последней пакетной записи, мкс
+  uint32_t lastSavedUs;      // оценка сэкономленного времени шины в последнем обновлении, мкс
+  uint32_t totalSavedUs;     // суммарная оценка сэкономленного времени шины, мкс
+  uint32_t errors;           // транзакций, не подтверждённых PCA9685 (повторяются)
+};
+
 // Инициализация сервоприводов
 void servo_init();
 
-// Обработка команд Serial (должна вызываться в loop)
+// Кадр траекторий 50 Гц (вызывается планировщиком): шаг профиля движущихся
+// каналов, изменившиеся импульсы записываются одной пакетной записью
 void servo_loop();
 
-// Установка угла сервопривода (для API)
-void servo_setAngle(uint8_t servoNum, uint16_t angle);
+// Установка угла сервопривода
+void servo_setAngle(uint8_t servoNum, uint16_t angle, ServoMove move);
+
+// Пакетная установка углов: бит i в mask -> angles[i] применяется к каналу i.
+// Все изменившиеся каналы записываются в PCA9685 одной I2C транзакцией.
+void servo_setAngles(uint16_t mask, const uint16_t angles[], ServoMove move);
+
+// Профиль каналов mask: максимальная скорость, °/с, и ускорение, °/с² (0 — без ограничения).
+// maxSpeed = 0 — любое перемещение выполняется сразу
+void servo_setProfile(uint16_t mask, uint16_t maxSpeed, uint16_t maxAccel);
+void servo_getProfile(uint8_t servoNum, uint16_t* maxSpeed, uint16_t* maxAccel);
+
+// Пересборка таблиц угол -> импульс каналов из mask по текущей калибровке (servocal.h);
+// выставленные каналы сразу переписываются с новым импульсом
+void servo_applyCalibration(uint16_t mask);
 
-// Получение текущего угла сервопривода
+// Получение статистики пакетной записи
+void servo_getBusStats(ServoBusStats* stats);
+
+// Получение текущего угла сервопривода (положение на траектории)
 uint16_t servo_getAngle(uint8_t servoNum);
 
+// Цель траектории канала
+uint16_t servo_getTarget(uint8_t servoNum);
+
+// Каналы, ещё не дошедшие до цели
+uint16_t servo_getMovingMask();
+
 // ===== Функции для управления камерой (SG92R 180°) =====
 
 // Установка угла камеры (Pan/Tilt) в градусах (0-180)
-void camera_setAngle(uint16_t panAngle, uint16_t tiltAngle);
+void camera_setAngle(uint16_t panAngle, uint16_t tiltAngle, ServoMove move);
 
-// Получение текущих углов камеры
+// Получение текущих углов камеры (положение на траектории)
 void camera_getAngle(uint16_t* panAngle, uint16_t* tiltAngle);
 
-// Установка точного значения PWM для камеры (для совместимости с API)
+// Цели траекторий камеры
+void camera_getTarget(uint16_t* panAngle, uint16_t* tiltAngle);
+
+// Установка точного значения PWM для камеры (для совместимости с API), сразу,
+// с остановкой траектории
 void camera_setPWM(uint16_t panPWM, uint16_t tiltPWM);
 
 // Получение текущих значений PWM камеры
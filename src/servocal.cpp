@@ -0,0 +1,211 @@
+#include "servocal.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+#include "log.h"
+
+// ===== Константы =====
+
+#define SERVOCAL_NAMESPACE "servocal"
+#define SERVOCAL_RECORD_VERSION 1
+
+// ===== Структуры данных =====
+
+// Запись NVS одного канала (ключ "ch<N>")
+struct ServoCalRecord {
+  uint8_t version;
+  ServoCalibration calibration;
+};
+
+// ===== Глобальные переменные =====
+
+static ServoCalibration defaultCalibrations[SERVOCAL_CHANNELS];
+static ServoCalibration calibrations[SERVOCAL_CHANNELS];
+static uint16_t customMask = 0;
+
+// Точки пишет async_tcp (API), читает задача управления при пересборке таблицы
+static portMUX_TYPE calMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Вспомогательные функции =====
+
+static void channelKey(uint8_t channel, char* key, size_t size) {
+  snprintf(key, size, "ch%u", channel);
+}
+
+static bool loadRecord(Preferences& prefs, uint8_t channel, ServoCalibration* calibration) {
+  char key[8];
+  channelKey(channel, key, sizeof(key));
+  if (prefs.getBytesLength(key) != sizeof(ServoCalRecord)) return false;
+
+  ServoCalRecord record;
+  prefs.getBytes(key, &record, sizeof(record));
+  if (record.version != SERVOCAL_RECORD_VERSION || servocal_validate(&record.calibration) != SERVOCAL_OK) {
+    LOG_W("SERVOCAL", "Channel %u: invalid NVS record ignored", channel);
+    return false;
+  }
+  *calibration = record.calibration;
+  return true;
+}
+
+static bool saveRecord(uint8_t channel, const ServoCalibration* calibration) {
+  ServoCalRecord record;
+  memset(&record, 0, sizeof(record));
+  record.version = SERVOCAL_RECORD_VERSION;
+  record.calibration = *calibration;
+
+  char key[8];
+  channelKey(channel, key, sizeof(key));
+  Preferences prefs;
+  bool saved = prefs.begin(SERVOCAL_NAMESPACE, false) && prefs.putBytes(key, &record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  return saved;
+}
+
+static void removeRecord(uint8_t channel) {
+  char key[8];
+  channelKey(channel, key, sizeof(key));
+  Preferences prefs;
+  if (prefs.begin(SERVOCAL_NAMESPACE, false)) {
+    if (prefs.isKey(key)) prefs.remove(key);
+    prefs.end();
+  }
+}
+
+// Деление с округлением к ближайшему для числителя любого знака
+static int32_t divRound(int32_t numerator, int32_t denominator) {
+  return numerator >= 0 ? (numerator + denominator / 2) / denominator
+                        : -((-numerator + denominator / 2) / denominator);
+}
+
+// ===== Публичные функции =====
+
+void servocal_init(const ServoCalibration defaults[SERVOCAL_CHANNELS]) {
+  memcpy(defaultCalibrations, defaults, sizeof(defaultCalibrations));
+  memcpy(calibrations, defaults, sizeof(calibrations));
+  customMask = 0;
+
+  Preferences prefs;
+  if (!prefs.begin(SERVOCAL_NAMESPACE, true)) {
+    // Пространства ещё нет — калибровка не сохранялась
+    Serial.println("Servo calibration: defaults");
+    return;
+  }
+  for (uint8_t ch = 0; ch < SERVOCAL_CHANNELS; ch++) {
+    if (loadRecord(prefs, ch, &calibrations[ch])) customMask |= (1 << ch);
+  }
+  prefs.end();
+
+  Serial.printf("Servo calibration: %d channel(s) from NVS\n", __builtin_popcount(customMask));
+}
+
+ServoCalResult servocal_validate(const ServoCalibration* calibration) {
+  if (calibration->count < 2 || calibration->count > SERVOCAL_MAX_POINTS) return SERVOCAL_ERR_COUNT;
+  for (uint8_t i = 0; i < calibration->count; i++) {
+    const ServoCalPoint& point = calibration->points[i];
+    if (point.angle > SERVOCAL_ANGLE_MAX) return SERVOCAL_ERR_ORDER;
+    if (i > 0 && point.angle <= calibration->points[i - 1].angle) return SERVOCAL_ERR_ORDER;
+    if (point.pulse < SERVOCAL_PULSE_MIN || point.pulse > SERVOCAL_PULSE_MAX) return SERVOCAL_ERR_PULSE;
+  }
+  return SERVOCAL_OK;
+}
+
+void servocal_compile(const ServoCalibration* calibration, uint16_t table[SERVOCAL_ANGLES]) {
+  const ServoCalPoint* points = calibration->points;
+  uint8_t last = calibration->count - 1;
+  uint8_t segment = 0;
+
+  for (int angle = 0; angle <= SERVOCAL_ANGLE_MAX; angle++) {
+    if (angle <= points[0].angle) {
+      table[angle] = points[0].pulse;
+      continue;
+    }
+    if (angle >= points[last].angle) {
+      table[angle] = points[last].pulse;
+      continue;
+    }
+    while (angle > points[segment + 1].angle) segment++;
+
+    const ServoCalPoint& from = points[segment];
+    const ServoCalPoint& to = points[segment + 1];
+    int32_t delta = divRound((angle - from.angle) * ((int32_t)to.pulse - from.pulse), to.angle - from.angle);
+    table[angle] = (uint16_t)(from.pulse + delta);
+  }
+}
+
+bool servocal_get(uint8_t channel, ServoCalibration* calibration, bool* custom) {
+  if (channel >= SERVOCAL_CHANNELS) return false;
+  portENTER_CRITICAL(&calMux);
+  if (calibration != NULL) *calibration = calibrations[channel];
+  if (custom != NULL) *custom = customMask & (1 << channel);
+  portEXIT_CRITICAL(&calMux);
+  return true;
+}
+
+ServoCalResult servocal_set(uint8_t channel, const ServoCalibration* calibration, bool save) {
+  if (channel >= SERVOCAL_CHANNELS) return SERVOCAL_ERR_CHANNEL;
+  ServoCalResult result = servocal_validate(calibration);
+  if (result != SERVOCAL_OK) return result;
+
+  if (save && !saveRecord(channel, calibration)) return SERVOCAL_ERR_STORAGE;
+
+  portENTER_CRITICAL(&calMux);
+  calibrations[channel] = *calibration;
+  customMask |= (1 << channel);
+  portEXIT_CRITICAL(&calMux);
+
+  LOG_I("SERVOCAL", "Channel %u: %u point(s)%s", channel, calibration->count, save ? ", saved" : "");
+  return SERVOCAL_OK;
+}
+
+ServoCalResult servocal_reset(uint8_t channel, bool save) {
+  if (channel >= SERVOCAL_CHANNELS) return SERVOCAL_ERR_CHANNEL;
+
+  if (save) removeRecord(channel);
+
+  portENTER_CRITICAL(&calMux);
+  calibrations[channel] = defaultCalibrations[channel];
+  customMask &= ~(1 << channel);
+  portEXIT_CRITICAL(&calMux);
+
+  LOG_I("SERVOCAL", "Channel %u: default calibration", channel);
+  return SERVOCAL_OK;
+}
+
+ServoCalResult servocal_save(uint8_t channel) {
+  if (channel >= SERVOCAL_CHANNELS) return SERVOCAL_ERR_CHANNEL;
+
+  ServoCalibration calibration;
+  bool custom = false;
+  servocal_get(channel, &calibration, &custom);
+  if (!custom) {
+    removeRecord(channel);
+    return SERVOCAL_OK;
+  }
+  if (!saveRecord(channel, &calibration)) return SERVOCAL_ERR_STORAGE;
+
+  LOG_I("SERVOCAL", "Channel %u: saved", channel);
+  return SERVOCAL_OK;
+}
+
+void servocal_restore(uint8_t channel, const ServoCalibration* calibration, bool custom) {
+  if (channel >= SERVOCAL_CHANNELS) return;
+
+  portENTER_CRITICAL(&calMux);
+  calibrations[channel] = *calibration;
+  if (custom) customMask |= (1 << channel);
+  else customMask &= ~(1 << channel);
+  portEXIT_CRITICAL(&calMux);
+}
+
+const char* servocal_resultName(ServoCalResult result) {
+  switch (result) {
+    case SERVOCAL_OK: return "ok";
+    case SERVOCAL_ERR_CHANNEL: return "Invalid channel (0-15)";
+    case SERVOCAL_ERR_COUNT: return "Need 2-8 points";
+    case SERVOCAL_ERR_ORDER: return "Angles must increase within 0-180";
+    case SERVOCAL_ERR_PULSE: return "Pulse out of range (80-600)";
+    case SERVOCAL_ERR_STORAGE: return "NVS write failed";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef _SERVOCAL_H
+#define _SERVOCAL_H
+
+#include <stdint.h>
+
+// Калибровка сервоприводов: по каждому каналу PCA9685 — кусочно-линейная
+// зависимость импульса от угла по 2-8 опорным точкам. Калибровка хранится в NVS
+// (Preferences, пространство "servocal") и компилируется в таблицу угол -> импульс,
+// так что в горячем пути servo.cpp остаётся одно обращение к таблице.
+// Точки меняются из API (задача async_tcp), таблицы пересобирает задача управления.
+
+// ===== Константы =====
+
+#define SERVOCAL_CHANNELS 16
+#define SERVOCAL_MAX_POINTS 8
+#define SERVOCAL_ANGLE_MAX 180
+#define SERVOCAL_ANGLES (SERVOCAL_ANGLE_MAX + 1)
+
+// Допустимые импульсы, отсчёты PCA9685 при 50 Гц (4096 на 20 мс): ~0.4-2.9 мс
+#define SERVOCAL_PULSE_MIN 80
+#define SERVOCAL_PULSE_MAX 600
+
+// ===== Структуры данных =====
+
+struct ServoCalPoint {
+  uint8_t angle;      // 0-180°
+  uint16_t pulse;     // OFF-отсчёт PCA9685
+};
+
+struct ServoCalibration {
+  uint8_t count;                              // опорных точек, 2..SERVOCAL_MAX_POINTS
+  ServoCalPoint points[SERVOCAL_MAX_POINTS];  // по возрастанию угла
+};
+
+enum ServoCalResult : uint8_t {
+  SERVOCAL_OK = 0,
+  SERVOCAL_ERR_CHANNEL,       // номер канала вне 0..15
+  SERVOCAL_ERR_COUNT,         // меньше 2 или больше SERVOCAL_MAX_POINTS точек
+  SERVOCAL_ERR_ORDER,         // углы не возрастают или больше 180
+  SERVOCAL_ERR_PULSE,         // импульс вне SERVOCAL_PULSE_MIN..MAX
+  SERVOCAL_ERR_STORAGE        // не удалось записать NVS
+};
+
+// ===== Функции =====
+
+// Загрузка калибровок из NVS; для каналов без записи — defaults (прямая из SERVO_CORRECTION)
+void servocal_init(const ServoCalibration defaults[SERVOCAL_CHANNELS]);
+
+ServoCalResult servocal_validate(const ServoCalibration* calibration);
+
+// Таблица угол -> импульс: линейная интерполяция между точками с округлением,
+// за пределами крайних точек — импульс крайней точки
+void servocal_compile(const ServoCalibration* calibration, uint16_t table[SERVOCAL_ANGLES]);
+
+// Текущая калибровка канала; custom — задана через API (а не по умолчанию)
+bool servocal_get(uint8_t channel, ServoCalibration* calibration, bool* custom);
+
+// Новая калибровка канала; save — сохранить в NVS (иначе действует до перезагрузки)
+ServoCalResult servocal_set(uint8_t channel, const ServoCalibration* calibration, bool save);
+
+// Возврат к калибровке по умолчанию; save — удалить запись NVS
+ServoCalResult servocal_reset(uint8_t channel, bool save);
+
+// Запись текущей калибровки канала в NVS (для калибровки по умолчанию — удаление записи)
+ServoCalResult servocal_save(uint8_t channel);
+
+// Возврат прежней калибровки канала без записи в NVS (откат неприменённого изменения)
+void servocal_restore(uint8_t channel, const ServoCalibration* calibration, bool custom);
+
+const char* servocal_resultName(ServoCalResult result);
+
+#endif
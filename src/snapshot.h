@@ -0,0 +1,47 @@
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Двойной буфер снимка состояния: один писатель публикует целиком собранный
+// снимок, читатели получают согласованную копию без блокировок.
+// Писатель всегда пишет в неактивный буфер и затем переключает индекс;
+// читатель повторяет копирование, если за время копирования вышел новый снимок.
+// Не зависит от Arduino/FreeRTOS и собирается на хосте.
+template <typename T>
+class Snapshot {
+ public:
+  Snapshot() : version(0) {}
+
+  // Публикация нового снимка (только писатель)
+  void publish(const T& value) {
+    uint32_t next = version.load(std::memory_order_relaxed) + 1;
+    buffers[next & 1] = value;
+    version.store(next, std::memory_order_release);
+  }
+
+  // Чтение последнего снимка. false — снимок ещё не публиковался
+  // или писатель обгонял читателя на всех попытках.
+  bool read(T* out) const {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+      uint32_t v = version.load(std::memory_order_acquire);
+      if (v == 0) return false;
+      *out = buffers[v & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version.load(std::memory_order_relaxed) == v) return true;
+    }
+    return false;
+  }
+
+  // Номер последнего опубликованного снимка (0 — ещё не было)
+  uint32_t sequence() const { return version.load(std::memory_order_acquire); }
+
+ private:
+  static const int MAX_READ_ATTEMPTS = 4;
+
+  std::atomic<uint32_t> version;
+  T buffers[2];
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free очередь "один производитель — один потребитель".
+// Производитель вызывает только push(), потребитель — только pop().
+// Не зависит от Arduino/FreeRTOS и собирается на хосте.
+// N — ёмкость, должна быть степенью двойки.
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+ public:
+  SpscQueue() : head(0), tail(0), dropped(0) {}
+
+  // Добавление элемента (производитель). false — очередь заполнена, элемент отброшен.
+  bool push(const T& item) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    if (h - t >= N) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Извлечение элемента (потребитель). false — очередь пуста.
+  bool pop(T& item) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    if (t == h) return false;
+    item = buffer[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Приблизительное число элементов (точно только из потока производителя/потребителя)
+  size_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return N; }
+
+  // Число элементов, отброшенных из-за переполнения
+  uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<size_t> head;   // пишет только производитель
+  std::atomic<size_t> tail;   // пишет только потребитель
+  std::atomic<uint32_t> dropped;
+  T buffer[N];
+};
+
+#endif
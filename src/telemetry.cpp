@@ -0,0 +1,234 @@
+#include "telemetry.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdarg.h>
+
+#include "ctlframe.h"
+#include "control.h"
+#include "lidar.h"
+#include "scheduler.h"
+
+// ===== Константы =====
+
+#define TELEMETRY_JSON_SECTION 160    // наибольший фрагмент JSON одной секции
+#define TELEMETRY_JSON_HEADER 48
+
+// ===== Структуры данных =====
+
+// Секция снимка в обеих кодировках
+struct TelemetrySection {
+  uint8_t binary[20];
+  uint8_t binaryLength;
+  char json[TELEMETRY_JSON_SECTION];
+  uint8_t jsonLength;
+};
+
+// ===== Глобальные переменные =====
+
+static TelemetrySection sections[CTL_TELEM_SECTIONS];
+static CtlTelemetryHeader header;
+static char jsonHeader[TELEMETRY_JSON_HEADER];
+static size_t jsonHeaderLength = 0;
+static bool hasBinary = false;
+static bool hasJson = false;
+
+static TelemetryStats stats = {0, 0, 0, 0, 0};
+
+// ===== Вспомогательные функции =====
+
+static void setBinary(int index, const void* data, size_t length) {
+  memcpy(sections[index].binary, data, length);
+  sections[index].binaryLength = length;
+}
+
+// Фрагмент JSON без фигурных скобок: "key":value
+static void setJson(int index, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int length = vsnprintf(sections[index].json, TELEMETRY_JSON_SECTION, fmt, args);
+  va_end(args);
+  sections[index].jsonLength = (length > 0 && length < TELEMETRY_JSON_SECTION) ? length : 0;
+}
+
+static void findJob(const char* name, SchedJobStats* stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (int i = 0; i < sched_jobCount(); i++) {
+    if (sched_getStats(i, stats) && strcmp(stats->name, name) == 0) return;
+  }
+  memset(stats, 0, sizeof(*stats));
+}
+
+static uint16_t clampUs(uint32_t us) {
+  return us > 0xFFFF ? 0xFFFF : us;
+}
+
+static void encodeMotors(const ControlState& state, bool binary, bool json) {
+  CtlTelemMotors motors;
+  for (int i = 0; i < CTL_FRAME_MOTORS; i++) {
+    motors.speed[i] = state.motor[i];
+    motors.output[i] = state.motorOutput[i];
+  }
+  if (binary) setBinary(0, &motors, sizeof(motors));
+  if (json) {
+    setJson(0, "\"motors\":{\"speed\":[%d,%d,%d,%d],\"output\":[%d,%d,%d,%d]}",
+            motors.speed[0], motors.speed[1], motors.speed[2], motors.speed[3],
+            motors.output[0], motors.output[1], motors.output[2], motors.output[3]);
+  }
+}
+
+static void encodeServos(const ControlState& state, bool binary, bool json) {
+  CtlTelemServos servos;
+  for (int i = 0; i < CTL_FRAME_SERVO_PAN; i++) {
+    servos.angle[i] = state.servoAngle[i];
+  }
+  servos.angle[CTL_FRAME_SERVO_PAN] = state.panAngle;
+  servos.angle[CTL_FRAME_SERVO_TILT] = state.tiltAngle;
+  if (binary) setBinary(1, &servos, sizeof(servos));
+  if (json) {
+    setJson(1, "\"servos\":[%u,%u,%u,%u,%u,%u]",
+            servos.angle[0], servos.angle[1], servos.angle[2],
+            servos.angle[3], servos.angle[4], servos.angle[5]);
+  }
+}
+
+static void encodeLidar(bool binary, bool json) {
+  CtlTelemLidar lidar;
+  LidarFrame frame;
+  memset(&lidar, 0, sizeof(lidar));
+  if (lidar_getFrame(&frame)) {
+    for (int i = 0; i < CTL_TELEM_LIDAR_DIRECTIONS; i++) {
+      lidar.rangeMm[i] = frame.rangeMm[i];
+    }
+    lidar.validMask = frame.validMask;
+  } else {
+    for (int i = 0; i < CTL_TELEM_LIDAR_DIRECTIONS; i++) {
+      lidar.rangeMm[i] = LIDAR_RANGE_INVALID;
+    }
+  }
+  if (binary) setBinary(2, &lidar, sizeof(lidar));
+  if (json) {
+    // Нет данных — null
+    char ranges[CTL_TELEM_LIDAR_DIRECTIONS][8];
+    for (int i = 0; i < CTL_TELEM_LIDAR_DIRECTIONS; i++) {
+      if (lidar.validMask & (1 << i)) {
+        snprintf(ranges[i], sizeof(ranges[i]), "%u", lidar.rangeMm[i]);
+      } else {
+        strcpy(ranges[i], "null");
+      }
+    }
+    setJson(2, "\"lidar\":[%s,%s,%s,%s,%s,%s,%s,%s]",
+            ranges[0], ranges[1], ranges[2], ranges[3],
+            ranges[4], ranges[5], ranges[6], ranges[7]);
+  }
+}
+
+static void encodeTiming(const ControlState& state, bool binary, bool json) {
+  SchedJobStats control, dc;
+  findJob("control", &control);
+  findJob("dc", &dc);
+
+  CtlTelemTiming timing;
+  timing.controlTick = state.tick;
+  timing.controlLastUs = clampUs(control.lastUs);
+  timing.controlWcetUs = clampUs(control.wcetUs);
+  timing.dcWcetUs = clampUs(dc.wcetUs);
+  timing.maxJitterUs = clampUs(control.maxJitterUs);
+  if (binary) setBinary(3, &timing, sizeof(timing));
+  if (json) {
+    setJson(3, "\"timing\":{\"tick\":%u,\"control_us\":%u,\"control_wcet_us\":%u,\"dc_wcet_us\":%u,\"max_jitter_us\":%u}",
+            (unsigned)timing.controlTick, timing.controlLastUs, timing.controlWcetUs,
+            timing.dcWcetUs, timing.maxJitterUs);
+  }
+}
+
+static void encodeSystem(uint32_t nowMs, uint8_t wsClients, bool binary, bool json) {
+  CtlTelemSystem system;
+  system.freeHeap = ESP.getFreeHeap();
+  system.uptimeMs = nowMs;
+  system.rssi = WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0;
+  system.wsClients = wsClients;
+  system.reserved = 0;
+  if (binary) setBinary(4, &system, sizeof(system));
+  if (json) {
+    setJson(4, "\"system\":{\"heap\":%u,\"uptime_ms\":%u,\"rssi\":%d,\"ws_clients\":%u}",
+            (unsigned)system.freeHeap, (unsigned)system.uptimeMs, system.rssi, system.wsClients);
+  }
+}
+
+// ===== Публичные функции =====
+
+void telemetry_update(uint32_t nowMs, uint8_t wsClients, bool binary, bool json) {
+  uint64_t start = esp_timer_get_time();
+
+  ControlState state;
+  if (!control_getState(&state)) memset(&state, 0, sizeof(state));
+
+  stats.snapshots++;
+  header.magic = CTL_FRAME_MAGIC;
+  header.type = CTL_FRAME_TYPE_TELEMETRY;
+  header.reserved = 0;
+  header.seq = stats.snapshots;
+  header.timestampMs = nowMs;
+
+  encodeMotors(state, binary, json);
+  encodeServos(state, binary, json);
+  encodeLidar(binary, json);
+  encodeTiming(state, binary, json);
+  encodeSystem(nowMs, wsClients, binary, json);
+
+  if (json) {
+    int length = snprintf(jsonHeader, sizeof(jsonHeader), "{\"seq\":%u,\"t\":%u",
+                          (unsigned)header.seq, (unsigned)nowMs);
+    jsonHeaderLength = length > 0 ? length : 0;
+  }
+  hasBinary = binary;
+  hasJson = json;
+
+  stats.lastEncodeUs = (uint32_t)(esp_timer_get_time() - start);
+  if (stats.lastEncodeUs > stats.maxEncodeUs) stats.maxEncodeUs = stats.lastEncodeUs;
+}
+
+size_t telemetry_build(uint8_t format, uint8_t mask, uint8_t* out, size_t size) {
+  size_t length = 0;
+
+  if (format == CTL_TELEM_FORMAT_BINARY) {
+    if (!hasBinary || size < sizeof(header)) return 0;
+    CtlTelemetryHeader* frame = (CtlTelemetryHeader*)out;
+    memcpy(frame, &header, sizeof(header));
+    frame->mask = mask;
+    length = sizeof(header);
+
+    for (int i = 0; i < CTL_TELEM_SECTIONS; i++) {
+      if (!(mask & (1 << i))) continue;
+      if (length + sections[i].binaryLength > size) return 0;
+      memcpy(out + length, sections[i].binary, sections[i].binaryLength);
+      length += sections[i].binaryLength;
+    }
+    return length;
+  }
+
+  // JSON: {"seq":..,"t":.. + ,"секция":... + }
+  if (!hasJson || size < jsonHeaderLength + 1) return 0;
+  memcpy(out, jsonHeader, jsonHeaderLength);
+  length = jsonHeaderLength;
+
+  for (int i = 0; i < CTL_TELEM_SECTIONS; i++) {
+    if (!(mask & (1 << i)) || sections[i].jsonLength == 0) continue;
+    if (length + 1 + sections[i].jsonLength + 1 > size) return 0;
+    out[length++] = ',';
+    memcpy(out + length, sections[i].json, sections[i].jsonLength);
+    length += sections[i].jsonLength;
+  }
+  out[length++] = '}';
+  return length;
+}
+
+void telemetry_countFrame(size_t length) {
+  stats.frames++;
+  stats.bytes += length;
+}
+
+void telemetry_getStats(TelemetryStats* out) {
+  if (out) *out = stats;
+}
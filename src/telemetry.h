@@ -0,0 +1,42 @@
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Снимок телеметрии для потоковой передачи клиентам (wsctl.h/cpp).
+// telemetry_update() собирает снимок один раз за такт и сразу кодирует каждую
+// секцию (CTL_TELEM_*) в бинарный вид и во фрагмент JSON. Кадр для клиента
+// собирается копированием готовых секций по его маске — без повторной
+// сериализации на каждого подписчика. Вызывается только из сетевой задачи.
+
+// ===== Константы =====
+
+// Наибольший кадр: заголовок и все секции (JSON длиннее бинарного)
+#define TELEMETRY_MAX_FRAME 512
+
+// ===== Структуры данных =====
+
+struct TelemetryStats {
+  uint32_t snapshots;       // собрано снимков
+  uint32_t frames;          // отправлено кадров (всем клиентам)
+  uint32_t bytes;           // отправлено байт
+  uint32_t lastEncodeUs;    // сбор и кодирование последнего снимка, мкс
+  uint32_t maxEncodeUs;
+};
+
+// ===== Публичные функции =====
+
+// Новый снимок; binary / json — какие кодировки нужны подписчикам этого такта
+void telemetry_update(uint32_t nowMs, uint8_t wsClients, bool binary, bool json);
+
+// Кадр текущего снимка из секций mask (CTL_TELEM_*) в формате format
+// (CTL_TELEM_FORMAT_*). Возвращает длину или 0, если кодировка не подготовлена
+size_t telemetry_build(uint8_t format, uint8_t mask, uint8_t* out, size_t size);
+
+// Учёт отправленного кадра
+void telemetry_countFrame(size_t length);
+
+void telemetry_getStats(TelemetryStats* stats);
+
+#endif
@@ -1,46 +1,348 @@
 #include "ui.h"
+#include "config.h"
 #include <LittleFS.h>
+#include <Preferences.h>
+#include "log.h"
 
-#define FORMAT_LITTLEFS_IF_FAILED false
+// Встроенные в прошивку файлы (генерируются scripts/build_assets.py в каталог сборки)
+#if __has_include("webassets.h")
+#include "webassets.h"
+#define UI_EMBEDDED_ASSETS 1
+#else
+#define UI_EMBEDDED_ASSETS 0
+#define WEB_ASSETS_COUNT 0
+#endif
+
+// ===== Константы =====
+
+// LittleFS перекрывает встроенные файлы (разработка UI без перепрошивки).
+// Без встроенных файлов LittleFS — единственный источник.
+#ifndef UI_LITTLEFS_OVERRIDE
+#define UI_LITTLEFS_OVERRIDE (!UI_EMBEDDED_ASSETS)
+#endif
+
+// Манифест собирается scripts/build_assets.py: строки "<путь> <хэш>"
+#define UI_MANIFEST_PATH "/assets.manifest"
+#define UI_MAX_ASSETS 16
+#define UI_PATH_LENGTH 32
+#define UI_HASH_LENGTH 16
+
+// Флаг NVS: образ LittleFS загружен по OTA и перекрывает встроенные файлы
+#define UI_PREFS_NAMESPACE "ui"
+#define UI_PREFS_FS_OVERRIDE "fs_override"
+
+#define UI_CACHE_IMMUTABLE "public, max-age=31536000, immutable"  // URL с ?v=<хэш>
+#define UI_CACHE_REVALIDATE "no-cache"                             // проверка по ETag
+
+// ===== Структуры данных =====
+
+struct UiAsset {
+  char path[UI_PATH_LENGTH];
+  char hash[UI_HASH_LENGTH + 1];
+};
+
+// ===== Глобальные переменные =====
+
+static UiAsset assets[UI_MAX_ASSETS];
+static int assetCount = 0;
+static bool fsMounted = false;
+static bool fsEnabled = false;     // LittleFS используется: UI_LITTLEFS_OVERRIDE или образ по OTA
+// Ответов, ещё читающих открытый файл LittleFS. Меняется только в задаче async_tcp
+// (serveFile и отключение клиента), там же, где проверяется перед ui_unmountFs()
+static uint32_t fsResponses = 0;
+
+static UiStats stats = {0, 0, false, 0, 0, 0, 0, 0};
 
 // ===== Вспомогательные функции =====
 
 // Установка заголовков для отключения кэширования
-static void setNoCacheHeaders(WebServer& server) {
-  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  server.sendHeader("Pragma", "no-cache");
-  server.sendHeader("Expires", "0");
+static void setNoCacheHeaders(AsyncWebServerResponse* response) {
+  response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+  response->addHeader("Pragma", "no-cache");
+  response->addHeader("Expires", "0");
+}
+
+// Чтение манифеста хэшей (без него файлы раздаются без кэширования, как раньше)
+static void loadManifest() {
+  assetCount = 0;
+  File file = LittleFS.open(UI_MANIFEST_PATH, "r");
+  if (!file) return;
+
+  char line[UI_PATH_LENGTH + UI_HASH_LENGTH + 8];
+  while (file.available() && assetCount < UI_MAX_ASSETS) {
+    size_t length = file.readBytesUntil('\n', line, sizeof(line) - 1);
+    line[length] = '\0';
+
+    char* space = strchr(line, ' ');
+    if (space == NULL || space - line >= UI_PATH_LENGTH || strlen(space + 1) != UI_HASH_LENGTH) continue;
+
+    UiAsset& asset = assets[assetCount++];
+    *space = '\0';
+    strcpy(asset.path, line);
+    strcpy(asset.hash, space + 1);
+  }
+  file.close();
+}
+
+static const UiAsset* findAsset(const String& path) {
+  for (int i = 0; i < assetCount; i++) {
+    if (path.equals(assets[i].path)) return &assets[i];
+  }
+  return NULL;
+}
+
+// Сильный ETag различает представления: сжатое и несжатое
+static void formatEtag(char* etag, size_t size, const char* hash, bool gzip) {
+  snprintf(etag, size, "\"%s%s\"", hash, gzip ? "-gz" : "");
+}
+
+static bool isNotModified(AsyncWebServerRequest* request, const char* etag) {
+  return request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) >= 0;
+}
+
+// Заголовки кэширования по хэшу: immutable для URL с актуальным ?v=, иначе проверка по ETag
+static void addCacheHeaders(AsyncWebServerRequest* request, AsyncWebServerResponse* response,
+                            const char* hash, const char* etag, bool vary) {
+  if (request->arg("v").equals(hash)) {
+    response->addHeader("Cache-Control", UI_CACHE_IMMUTABLE);
+  } else {
+    response->addHeader("Cache-Control", UI_CACHE_REVALIDATE);
+  }
+  response->addHeader("ETag", etag);
+  if (vary) response->addHeader("Vary", "Accept-Encoding");
+}
+
+// Ответ 304, если у клиента актуальная версия
+static bool sendNotModified(AsyncWebServerRequest* request, const char* hash, const char* etag, bool vary) {
+  if (!isNotModified(request, etag)) return false;
+
+  AsyncWebServerResponse* response = request->beginResponse(304);
+  addCacheHeaders(request, response, hash, etag, vary);
+  request->send(response);
+  stats.notModified++;
+  return true;
+}
+
+static bool fsHasFile(const String& path) {
+  return fsMounted && (LittleFS.exists(path) || LittleFS.exists(path + ".gz"));
+}
+
+// Раздача файла из LittleFS: .gz вариант при наличии, ETag/304 и кэширование по манифесту
+static void serveFile(AsyncWebServerRequest* request, const String& path, const char* contentType) {
+  String gzPath = path + ".gz";
+  bool hasGz = LittleFS.exists(gzPath);
+  bool acceptsGzip = request->hasHeader("Accept-Encoding") &&
+                     request->header("Accept-Encoding").indexOf("gzip") >= 0;
+  // Сборка кладёт только .gz; несжатый файл остаётся для разработки и старых клиентов
+  bool useGz = hasGz && (acceptsGzip || !LittleFS.exists(path));
+
+  const UiAsset* asset = findAsset(path);
+  char etag[UI_HASH_LENGTH + 6];
+  if (asset != NULL) {
+    formatEtag(etag, sizeof(etag), asset->hash, useGz);
+    if (sendNotModified(request, asset->hash, etag, hasGz)) {
+      LOG_I("UI", "Not modified: %s", path.c_str());
+      return;
+    }
+  }
+
+  File file = LittleFS.open(useGz ? gzPath : path, "r");
+  if (!file) {
+    LOG_E("UI", "ERROR: File not found - %s", path.c_str());
+    request->send(404, "text/plain", "File not found: " + path);
+    return;
+  }
+
+  // Ответ владеет файлом и читает его по мере отправки; для *.gz
+  // сервер сам добавляет Content-Encoding: gzip
+  AsyncWebServerResponse* response = request->beginResponse(file, path, contentType);
+  if (asset != NULL) {
+    addCacheHeaders(request, response, asset->hash, etag, hasGz);
+  } else {
+    setNoCacheHeaders(response);
+  }
+  request->send(response);
+  // Библиотека закрывает соединение после ответа: файл освобождён к отключению
+  fsResponses++;
+  request->onDisconnect([]() { fsResponses--; });
+  stats.servedFs++;
+  LOG_I("UI", "File sent: %s%s", path.c_str(), useGz ? " (gzip)" : "");
+}
+
+#if UI_EMBEDDED_ASSETS
+static const WebAsset* findEmbedded(const String& path) {
+  for (int i = 0; i < WEB_ASSETS_COUNT; i++) {
+    if (path.equals(WEB_ASSETS[i].path)) return &WEB_ASSETS[i];
+  }
+  return NULL;
 }
 
+// Раздача встроенного файла прямо из flash, без копирования в RAM.
+// Встроен только gzip-вариант — его понимают все браузеры.
+static void serveEmbedded(AsyncWebServerRequest* request, const WebAsset* asset) {
+  char etag[UI_HASH_LENGTH + 6];
+  formatEtag(etag, sizeof(etag), asset->hash, true);
+  if (sendNotModified(request, asset->hash, etag, false)) {
+    LOG_I("UI", "Not modified: %s", asset->path);
+    return;
+  }
+
+  // Ответ читает данные из flash по частям по мере отправки
+  AsyncWebServerResponse* response = request->beginResponse(200, asset->mimeType, asset->data, asset->length);
+  response->addHeader("Content-Encoding", "gzip");
+  addCacheHeaders(request, response, asset->hash, etag, false);
+  request->send(response);
+  stats.servedEmbedded++;
+  LOG_I("UI", "File sent: %s (flash)", asset->path);
+}
+#endif
+
+// LittleFS (если файл там есть), затем встроенные файлы
+static void serveAsset(AsyncWebServerRequest* request, const String& path, const char* contentType) {
+  int64_t start = esp_timer_get_time();
+
+  if (fsHasFile(path)) {
+    serveFile(request, path, contentType);
+  } else {
+#if UI_EMBEDDED_ASSETS
+    const WebAsset* asset = findEmbedded(path);
+    if (asset != NULL) {
+      serveEmbedded(request, asset);
+    } else
+#endif
+    {
+      LOG_E("UI", "ERROR: File not found - %s", path.c_str());
+      request->send(404, "text/plain", "File not found: " + path);
+    }
+  }
+
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+  stats.lastServeUs = elapsed;
+  if (elapsed > stats.maxServeUs) stats.maxServeUs = elapsed;
+}
+
+static bool loadFsOverride() {
+  Preferences prefs;
+  if (!prefs.begin(UI_PREFS_NAMESPACE, true)) return false;
+  bool enabled = prefs.getBool(UI_PREFS_FS_OVERRIDE, false);
+  prefs.end();
+  return enabled;
+}
+
+static void saveFsOverride(bool enabled) {
+  Preferences prefs;
+  if (!prefs.begin(UI_PREFS_NAMESPACE, false)) return;
+  prefs.putBool(UI_PREFS_FS_OVERRIDE, enabled);
+  prefs.end();
+}
+
+static void mountFs() {
+  // Без форматирования: испорченный раздел не должен стирать данные при загрузке
+  fsMounted = LittleFS.begin(false);
+  if (fsMounted) loadManifest();
+  stats.fsOverride = fsMounted;
+}
+
+#if !UI_EMBEDDED_ASSETS
+// Тип содержимого по расширению (маршруты из манифеста LittleFS)
+static const char* mimeTypeOf(const char* path) {
+  const char* dot = strrchr(path, '.');
+  if (dot == NULL) return "application/octet-stream";
+  if (strcmp(dot, ".html") == 0) return "text/html";
+  if (strcmp(dot, ".js") == 0) return "application/javascript";
+  if (strcmp(dot, ".css") == 0) return "text/css";
+  return "application/octet-stream";
+}
+#endif
+
 // ===== Публичные функции =====
 
 bool ui_init() {
-  Serial.println("\n=== LittleFS Initialization ===");
-  unsigned long start = millis();
-
-  if (!LittleFS.begin(FORMAT_LITTLEFS_IF_FAILED)) {
-    Serial.println("LittleFS init failed, trying with format...");
-    if (!LittleFS.begin(true)) {
-      Serial.println("ERROR: LittleFS initialization failed");
-      return false;
+  Serial.println("\n=== UI Initialization ===");
+  int64_t start = esp_timer_get_time();
+
+  stats.embeddedAssets = WEB_ASSETS_COUNT;
+  Serial.println("Embedded assets: " + String(WEB_ASSETS_COUNT) + " file(s)");
+
+  fsEnabled = UI_LITTLEFS_OVERRIDE || loadFsOverride();
+  if (fsEnabled) {
+    mountFs();
+    if (fsMounted) {
+      Serial.println("LittleFS override mounted, manifest: " + String(assetCount) + " file(s)");
+    } else {
+      Serial.println("WARNING: LittleFS mount failed, using embedded assets");
     }
   }
 
-  Serial.print("LittleFS initialized in ");
-  Serial.print(millis() - start);
-  Serial.println(" ms");
+  stats.initUs = (uint32_t)(esp_timer_get_time() - start);
+  Serial.println("UI initialized in " + String(stats.initUs) + " us");
 
   if (!ui_fileExists("/index.html")) {
     Serial.println("WARNING: /index.html not found!");
     return false;
   }
 
-  Serial.println("index.html found");
   Serial.println("===============================\n");
   return true;
 }
 
+void ui_registerRoutes(AsyncWebServer& server) {
+  server.on("/", HTTP_GET, [](AsyncWebServerRequest* request) { ui_serveIndex(request); });
+
+#if UI_EMBEDDED_ASSETS
+  for (int i = 0; i < WEB_ASSETS_COUNT; i++) {
+    const WebAsset* asset = &WEB_ASSETS[i];
+    server.on(asset->path, HTTP_GET, [asset](AsyncWebServerRequest* request) {
+      serveAsset(request, asset->path, asset->mimeType);
+    });
+  }
+#else
+  for (int i = 0; i < assetCount; i++) {
+    const UiAsset* asset = &assets[i];
+    server.on(asset->path, HTTP_GET, [asset](AsyncWebServerRequest* request) {
+      serveAsset(request, asset->path, mimeTypeOf(asset->path));
+    });
+  }
+#endif
+}
+
+void ui_getStats(UiStats* out) {
+  if (out == NULL) return;
+  *out = stats;
+}
+
+bool ui_unmountFs() {
+  // Дескрипторы отправляемых файлов после LittleFS.end() стали бы чужими
+  if (fsMounted && fsResponses > 0) return false;
+  if (fsMounted) LittleFS.end();
+  fsMounted = false;
+  assetCount = 0;
+  stats.fsOverride = false;
+  return true;
+}
+
+bool ui_remountFs(bool updated) {
+  // Не отключалась: загрузка отклонена, пока отправлялись файлы
+  if (fsMounted) return true;
+  if (!fsEnabled && !updated) return true;
+  mountFs();
+  if (fsMounted && updated && !fsEnabled) {
+    fsEnabled = true;
+    saveFsOverride(true);
+  }
+  LOG_I("UI", "LittleFS %s, manifest: %d file(s)", fsMounted ? "remounted" : "mount failed", assetCount);
+  return fsMounted;
+}
+
+void ui_resetFsOverride() {
+  if (loadFsOverride()) saveFsOverride(false);
+}
+
 String getUIHTML() {
+  if (!fsMounted) {
+    return String("<html><body><h1>Error: LittleFS not mounted</h1></body></html>");
+  }
+
   File file = LittleFS.open("/index.html", "r");
 
   if (!file) {
@@ -58,37 +360,20 @@ String getUIHTML() {
 }
 
 bool ui_fileExists(const String& path) {
-  return LittleFS.exists(path);
+  if (fsHasFile(path)) return true;
+#if UI_EMBEDDED_ASSETS
+  return findEmbedded(path) != NULL;
+#else
+  return false;
+#endif
 }
 
-void ui_serveStaticFile(WebServer& server, const String& path, const String& contentType) {
-  Serial.println("[UI] Serving static file: " + path);
-  
-  File file = LittleFS.open(path, "r");
-  if (!file) {
-    Serial.println("[UI] ERROR: File not found - " + path);
-    server.send(404, "text/plain", "File not found: " + path);
-    return;
-  }
-  
-  setNoCacheHeaders(server);
-  server.streamFile(file, contentType);
-  file.close();
-  Serial.println("[UI] File sent: " + path);
+void ui_serveStaticFile(AsyncWebServerRequest* request, const String& path, const String& contentType) {
+  LOG_I("UI", "Serving static file: %s", path.c_str());
+  serveAsset(request, path, contentType.c_str());
 }
 
-void ui_serveIndex(WebServer& server) {
-  Serial.println("[UI] Serving index.html");
-  
-  File file = LittleFS.open("/index.html", "r");
-  if (!file) {
-    Serial.println("[UI] ERROR: Failed to open index.html");
-    server.send(500, "text/plain", "Error: File not found");
-    return;
-  }
-  
-  setNoCacheHeaders(server);
-  server.streamFile(file, "text/html");
-  file.close();
-  Serial.println("[UI] index.html sent");
+void ui_serveIndex(AsyncWebServerRequest* request) {
+  LOG_I("UI", "Serving index.html");
+  serveAsset(request, "/index.html", "text/html");
 }
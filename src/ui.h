@@ -3,21 +3,55 @@
 
 #include <Arduino.h>
 #include <FS.h>
-#include <WebServer.h>
+#include <ESPAsyncWebServer.h>
 
-// Инициализация файловой системы
+// ===== Структуры данных =====
+
+struct UiStats {
+  uint32_t initUs;            // время ui_init (монтирование LittleFS, манифест)
+  uint32_t embeddedAssets;    // файлов, встроенных в прошивку
+  bool fsOverride;            // LittleFS смонтирована и перекрывает встроенные файлы
+  uint32_t servedEmbedded;    // ответов из flash
+  uint32_t servedFs;          // ответов из LittleFS
+  uint32_t notModified;       // ответов 304
+  uint32_t lastServeUs;       // время обработки последнего запроса файла
+  uint32_t maxServeUs;
+};
+
+// Инициализация: встроенные файлы и (опционально) LittleFS поверх них
 bool ui_init();
 
+// Маршруты для всех файлов интерфейса и "/" (вызывать после ui_init)
+void ui_registerRoutes(AsyncWebServer& server);
+
+// Статистика раздачи файлов
+void ui_getStats(UiStats* stats);
+
+// Обновление образа LittleFS по OTA: перед записью раздела файловая система
+// отключается (раздаются встроенные файлы), после — монтируется без форматирования.
+// updated — записан новый образ: он перекрывает встроенные файлы и после
+// перезагрузки (флаг в NVS), иначе восстанавливается прежнее состояние.
+// false — образ не монтируется.
+// ui_unmountFs() возвращает false, пока ответы ещё читают файлы LittleFS:
+// раздел тогда не отключается и записывать его нельзя.
+bool ui_unmountFs();
+bool ui_remountFs(bool updated);
+
+// Сброс перекрытия, включённого загрузкой образа: новая прошивка приносит свои
+// встроенные файлы (UI_LITTLEFS_OVERRIDE не затрагивается)
+void ui_resetFsOverride();
+
 // Получение HTML страницы из файловой системы (устарело, использовать ui_serveIndex)
 String getUIHTML();
 
 // Проверка наличия файла
 bool ui_fileExists(const String& path);
 
-// Раздача статических файлов из LittleFS
-void ui_serveStaticFile(WebServer& server, const String& path, const String& contentType);
+// Раздача файла интерфейса: LittleFS, если файл там есть, иначе встроенный во flash
+// (.gz вариант, ETag/304, кэширование по хэшу)
+void ui_serveStaticFile(AsyncWebServerRequest* request, const String& path, const String& contentType);
 
 // Раздача главной страницы (потоковая)
-void ui_serveIndex(WebServer& server);
+void ui_serveIndex(AsyncWebServerRequest* request);
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef _WEBASSET_H
+#define _WEBASSET_H
+
+#include <stdint.h>
+
+// Файл веб-интерфейса, встроенный в прошивку (таблица WEB_ASSETS в webassets.h,
+// генерируется scripts/build_assets.py). Данные — gzip, лежат во flash.
+
+struct WebAsset {
+  const char* path;          // URL, например "/main.js"
+  const char* mimeType;
+  const char* hash;          // SHA-256 содержимого, 16 hex-символов (ETag и ?v=)
+  const uint8_t* data;       // gzip
+  uint32_t length;
+};
+
+#endif
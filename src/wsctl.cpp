@@ -0,0 +1,254 @@
+#include "wsctl.h"
+#include "config.h"
+
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+
+#include "ctlframe.h"
+#include "control.h"
+#include "scan.h"
+#include "safety.h"
+#include "telemetry.h"
+#include "log.h"
+
+// ===== Константы =====
+
+#ifndef WS_PORT
+#define WS_PORT (HTTP_PORT + 1)
+#endif
+
+#define WSCTL_LOG_ENABLED true
+
+// ===== Глобальные объекты =====
+
+static WebSocketsServer wsServer(WS_PORT);
+
+// ===== Глобальные переменные =====
+
+// Последний принятый seq для каждого клиента (сбрасывается при подключении)
+static uint16_t lastSeq[WEBSOCKETS_SERVER_CLIENT_MAX];
+static bool hasSeq[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+// Подписка клиента на телеметрию (rateHz = 0 — не подписан)
+struct TelemetrySub {
+  uint8_t rateHz;
+  uint8_t format;
+  uint8_t mask;
+  uint32_t nextMs;
+};
+
+static TelemetrySub subs[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+// Буфер кадра телеметрии (собирается по очереди для каждого клиента)
+static uint8_t telemetryFrame[TELEMETRY_MAX_FRAME];
+
+static WsCtlStats stats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+// ===== Вспомогательные функции =====
+
+#define WSCTL_LOG(fmt, ...) \
+  do { if (WSCTL_LOG_ENABLED) LOG_I("WS", fmt, ##__VA_ARGS__); } while (0)
+
+static void sendAck(uint8_t num, uint16_t seq) {
+  CtlAck ack = {CTL_FRAME_MAGIC, CTL_FRAME_TYPE_ACK, seq};
+  wsServer.sendBIN(num, (const uint8_t*)&ack, sizeof(ack));
+}
+
+// Преобразование кадра в команду для задачи управления
+static void buildCommand(const CtlFrame& frame, ControlCommand* command) {
+  control_initCommand(command, CONTROL_CMD_SETPOINT);
+
+  if (frame.flags & CTL_FLAG_MOTORS) {
+    command->motorMask = (1 << CTL_FRAME_MOTORS) - 1;
+    for (int i = 0; i < CTL_FRAME_MOTORS; i++) {
+      command->motor[i] = frame.motor[i];
+    }
+  }
+
+  // Рулевые серво 0-3 — одной пакетной записью в PCA9685
+  command->servoMask = frame.servoMask & ((1 << CTL_FRAME_SERVO_PAN) - 1);
+  for (int i = 0; i < CTL_FRAME_SERVO_PAN; i++) {
+    command->servo[i] = frame.servo[i];
+  }
+
+  if (frame.servoMask & (1 << CTL_FRAME_SERVO_PAN)) {
+    command->cameraMask |= CONTROL_CAMERA_PAN;
+    command->pan = frame.servo[CTL_FRAME_SERVO_PAN];
+  }
+  if (frame.servoMask & (1 << CTL_FRAME_SERVO_TILT)) {
+    command->cameraMask |= CONTROL_CAMERA_TILT;
+    command->tilt = frame.servo[CTL_FRAME_SERVO_TILT];
+  }
+}
+
+static void handleBinary(uint8_t num, const uint8_t* payload, size_t length) {
+  int64_t receivedUs = esp_timer_get_time();
+  stats.framesReceived++;
+
+  if (ctlframe_isSubscribe(payload, length)) {
+    const CtlSubscribe* frame = (const CtlSubscribe*)payload;
+    subs[num].rateHz = frame->rateHz;
+    subs[num].format = frame->format;
+    subs[num].mask = frame->mask;
+    subs[num].nextMs = millis();
+    WSCTL_LOG("Client #%u telemetry: %u Hz, %s, mask 0x%02x", num, frame->rateHz,
+              frame->format == CTL_TELEM_FORMAT_JSON ? "json" : "binary", frame->mask);
+    return;
+  }
+
+  if (ctlframe_isEstop(payload, length)) {
+    safety_estop(SAFETY_SOURCE_WS, receivedUs);
+    stats.estops++;
+    CtlEstop estop;
+    memcpy(&estop, payload, sizeof(estop));
+    sendAck(num, estop.seq);
+    return;
+  }
+
+  CtlFrame frame;
+  if (length != sizeof(frame)) {
+    stats.framesInvalid++;
+    return;
+  }
+  memcpy(&frame, payload, sizeof(frame));
+
+  if (!ctlframe_isValid(&frame, length)) {
+    stats.framesInvalid++;
+    return;
+  }
+
+  // Кадр, пришедший позже более нового, устарел — уставки уже перезаписаны
+  if (hasSeq[num] && !ctlframe_isNewer(frame.seq, lastSeq[num])) {
+    stats.framesStale++;
+    return;
+  }
+  lastSeq[num] = frame.seq;
+  hasSeq[num] = true;
+
+  ControlCommand command;
+  buildCommand(frame, &command);
+  if (!control_post(command)) {
+    stats.framesDropped++;
+    return;
+  }
+  stats.framesApplied++;
+  sendAck(num, frame.seq);
+}
+
+static void onWsEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+
+  switch (type) {
+    case WStype_CONNECTED:
+      hasSeq[num] = false;
+      subs[num].rateHz = 0;
+      stats.clients++;
+      WSCTL_LOG("Client #%u connected from %s", num, wsServer.remoteIP(num).toString().c_str());
+      break;
+
+    case WStype_DISCONNECTED:
+      hasSeq[num] = false;
+      subs[num].rateHz = 0;
+      if (stats.clients > 0) stats.clients--;
+      WSCTL_LOG("Client #%u disconnected", num);
+      break;
+
+    case WStype_BIN:
+      handleBinary(num, payload, length);
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Передача накопленных точек скана всем клиентам кадрами CTL_FRAME_TYPE_SCAN
+static void streamScanPoints() {
+  uint8_t buffer[sizeof(CtlScanHeader) + CTL_SCAN_MAX_POINTS * sizeof(CtlScanPoint)];
+  CtlScanHeader* header = (CtlScanHeader*)buffer;
+  CtlScanPoint* points = (CtlScanPoint*)(buffer + sizeof(CtlScanHeader));
+
+  ScanPoint point;
+  uint8_t count = 0;
+  while (scan_popPoint(&point)) {
+    // Точки разных проходов не смешиваются в одном кадре
+    if (count > 0 && (count == CTL_SCAN_MAX_POINTS || header->sweep != point.sweep)) {
+      if (stats.clients > 0) {
+        wsServer.broadcastBIN(buffer, sizeof(CtlScanHeader) + count * sizeof(CtlScanPoint));
+      }
+      count = 0;
+    }
+
+    if (count == 0) {
+      header->magic = CTL_FRAME_MAGIC;
+      header->type = CTL_FRAME_TYPE_SCAN;
+      header->sweep = point.sweep;
+      header->reserved = 0;
+    }
+
+    points[count].timestampMs = (uint32_t)(point.timestampUs / 1000);
+    points[count].angleCdeg = point.angleCdeg;
+    points[count].rangeMm = point.rangeMm;
+    count++;
+    header->count = count;
+  }
+
+  if (count > 0 && stats.clients > 0) {
+    wsServer.broadcastBIN(buffer, sizeof(CtlScanHeader) + count * sizeof(CtlScanPoint));
+  }
+}
+
+// Телеметрия: один снимок на такт для всех клиентов, у которых подошёл срок;
+// каждому — кадр из готовых секций по его маске и формату
+static void streamTelemetry() {
+  uint32_t now = millis();
+  bool due[WEBSOCKETS_SERVER_CLIENT_MAX];
+  bool binary = false;
+  bool json = false;
+
+  for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    due[i] = subs[i].rateHz > 0 && (int32_t)(now - subs[i].nextMs) >= 0;
+    if (!due[i]) continue;
+    if (subs[i].format == CTL_TELEM_FORMAT_JSON) json = true;
+    else binary = true;
+  }
+  if (!binary && !json) return;
+
+  telemetry_update(now, stats.clients, binary, json);
+
+  for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (!due[i]) continue;
+
+    // Следующий срок — по сетке частоты; отставшего клиента не догоняем
+    uint32_t period = 1000 / subs[i].rateHz;
+    subs[i].nextMs += period;
+    if ((int32_t)(now - subs[i].nextMs) >= 0) subs[i].nextMs = now + period;
+
+    size_t length = telemetry_build(subs[i].format, subs[i].mask, telemetryFrame, sizeof(telemetryFrame));
+    if (length == 0) continue;
+
+    bool sent = subs[i].format == CTL_TELEM_FORMAT_JSON
+                    ? wsServer.sendTXT(i, (const char*)telemetryFrame, length)
+                    : wsServer.sendBIN(i, telemetryFrame, length);
+    if (sent) telemetry_countFrame(length);
+    else stats.telemetryDropped++;
+  }
+}
+
+// ===== Публичные функции =====
+
+void wsctl_init() {
+  wsServer.begin();
+  wsServer.onEvent(onWsEvent);
+  Serial.println("WebSocket control server started on port " + String(WS_PORT));
+}
+
+void wsctl_loop() {
+  wsServer.loop();
+  streamScanPoints();
+  streamTelemetry();
+}
+
+void wsctl_getStats(WsCtlStats* out) {
+  if (out) *out = stats;
+}
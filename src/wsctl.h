@@ -0,0 +1,27 @@
+#ifndef _WSCTL_H
+#define _WSCTL_H
+
+#include <stdint.h>
+
+// Статистика WebSocket канала управления
+struct WsCtlStats {
+  uint32_t framesReceived;   // всего бинарных кадров
+  uint32_t framesApplied;    // передано в задачу управления
+  uint32_t framesDropped;    // отброшено из-за переполнения очереди команд
+  uint32_t framesStale;      // отброшено как устаревшие (seq не новее последнего)
+  uint32_t framesInvalid;    // отброшено как некорректные
+  uint32_t estops;           // кадров аварийной остановки
+  uint32_t telemetryDropped; // кадров телеметрии, не принятых сокетом
+  uint8_t clients;           // подключённых клиентов
+};
+
+// Инициализация WebSocket сервера управления (порт WS_PORT)
+void wsctl_init();
+
+// Обработка WebSocket клиентов (должна вызываться в loop)
+void wsctl_loop();
+
+// Получение статистики канала
+void wsctl_getStats(WsCtlStats* stats);
+
+#endif
@@ -0,0 +1,153 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include "native_hal.h"
+#include "api.h"
+#include "dcmotor.h"
+#include "lidar.h"
+#include "safety.h"
+#include "servo.h"
+
+// Микробенчмарки горячих путей на хосте: такт dc_loop() с рампой на всех
+// моторах, кадр servo_loop() с профилированным движением всех каналов,
+// опрос lidar_loop() и обработка GET /api/status маршрутами сервера.
+// Задачи вызываются тестом напрямую, планировщик не запускается.
+// Границы — с большим запасом: тест ловит регрессии на порядки
+// (лишние аллокации, блокировки, запись всех каналов), а не проценты.
+
+// ===== Константы =====
+
+#define TEST_DC_TICKS 200000
+#define TEST_DC_REVERSE_TICKS 1000      // смена направления: рампа всё время в движении
+#define TEST_MAX_DC_TICK_NS 5000
+
+#define TEST_SERVO_FRAMES 20000
+#define TEST_SERVO_MASK 0xFFFF
+#define TEST_MAX_SERVO_FRAME_NS 50000
+
+#define TEST_LIDAR_POLLS 20000
+#define TEST_MAX_LIDAR_POLL_NS 20000
+
+#define TEST_HTTP_REQUESTS 2000
+#define TEST_MAX_HTTP_REQUEST_NS 500000
+
+#define TEST_RANGE_MM 400
+
+// ===== Глобальные переменные =====
+
+// Результаты бенчмарков: компилятор не должен выбросить вызовы
+static volatile int benchSink;
+
+// ===== Вспомогательные функции =====
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t report(const char* name, uint64_t elapsedNs, uint32_t count) {
+  uint32_t opNs = (uint32_t)(elapsedNs / count);
+  char message[96];
+  snprintf(message, sizeof(message), "%s: %u ns/op", name, (unsigned)opNs);
+  TEST_MESSAGE(message);
+  return opNs;
+}
+
+static void setAllMotors(int speed) {
+  motor_setSpeedA(speed);
+  motor_setSpeedB(speed);
+  motor_setSpeedC(speed);
+  motor_setSpeedD(-speed);
+}
+
+// ===== Тесты =====
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_benchmark_dc_tick() {
+  uint32_t updates = hal_ledcGetUpdates();
+  uint64_t start = nowNs();
+  for (int i = 0; i < TEST_DC_TICKS; i++) {
+    if (i % TEST_DC_REVERSE_TICKS == 0) setAllMotors((i / TEST_DC_REVERSE_TICKS) & 1 ? -255 : 255);
+    dc_loop();
+  }
+  uint64_t elapsed = nowNs() - start;
+  benchSink = motor_getOutput(0);
+  motor_stopAll();
+
+  // Такты дошли до LEDC: ШИМ менялся
+  TEST_ASSERT_GREATER_THAN_UINT32(updates, hal_ledcGetUpdates());
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_DC_TICK_NS, report("dc_loop", elapsed, TEST_DC_TICKS));
+}
+
+static void test_benchmark_servo_frame() {
+  uint16_t angles[16];
+  uint32_t writes = hal_pca9685GetChannelWrites();
+  uint64_t start = nowNs();
+  for (int i = 0; i < TEST_SERVO_FRAMES; i++) {
+    // Новая цель, как только каналы доехали: в каждом кадре идёт движение
+    if (servo_getMovingMask() == 0) {
+      uint16_t angle = servo_getTarget(0) == 0 ? 180 : 0;
+      for (int ch = 0; ch < 16; ch++) angles[ch] = angle;
+      servo_setAngles(TEST_SERVO_MASK, angles, SERVO_MOVE_PROFILED);
+    }
+    servo_loop();
+  }
+  uint64_t elapsed = nowNs() - start;
+  benchSink = servo_getAngle(0);
+
+  TEST_ASSERT_GREATER_THAN_UINT32(writes, hal_pca9685GetChannelWrites());
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_SERVO_FRAME_NS, report("servo_loop", elapsed, TEST_SERVO_FRAMES));
+}
+
+static void test_benchmark_lidar_poll() {
+  LidarStats before;
+  lidar_getStats(&before);
+  uint64_t start = nowNs();
+  for (int i = 0; i < TEST_LIDAR_POLLS; i++) lidar_loop();
+  uint64_t elapsed = nowNs() - start;
+
+  LidarStats after;
+  lidar_getStats(&after);
+  benchSink = (int)after.polls;
+  TEST_ASSERT_EQUAL_UINT32(before.polls + TEST_LIDAR_POLLS, after.polls);
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_LIDAR_POLL_NS, report("lidar_loop", elapsed, TEST_LIDAR_POLLS));
+}
+
+static void test_benchmark_http_status() {
+  uint64_t start = nowNs();
+  int code = 0;
+  for (int i = 0; i < TEST_HTTP_REQUESTS; i++) code = hal_httpRequest("GET", "/api/status").code;
+  uint64_t elapsed = nowNs() - start;
+  benchSink = code;
+
+  TEST_ASSERT_EQUAL(200, code);
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_HTTP_REQUEST_NS,
+                               report("GET /api/status", elapsed, TEST_HTTP_REQUESTS));
+}
+
+int main() {
+  for (uint8_t ch = 0; ch < 8; ch++) hal_vl53l0xSetRange(ch, TEST_RANGE_MM);
+  api_init();
+  servo_init();
+  dc_init();
+  safety_init();
+  lidar_init();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_benchmark_dc_tick);
+  RUN_TEST(test_benchmark_servo_frame);
+  RUN_TEST(test_benchmark_lidar_poll);
+  RUN_TEST(test_benchmark_http_status);
+  // Задача safety не завершается: выход без ожидания потоков
+  int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
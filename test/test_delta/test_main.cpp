@@ -0,0 +1,146 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include <mbedtls/sha256.h>
+
+#include "delta.h"
+
+// Потоковое применение дельта-патча: патч собирается тестом в формате
+// scripts/mkdelta.py и подаётся частями по TEST_CHUNK байт (поля заголовка
+// и записей попадают на границы частей). Целый патч, данные после последней
+// записи и обрезанный патч.
+
+// ===== Константы =====
+
+#define TEST_BASE_SIZE 4096
+#define TEST_EXTRA_SIZE 16
+#define TEST_TARGET_SIZE (TEST_BASE_SIZE + TEST_EXTRA_SIZE)
+#define TEST_PATCH_MAX (DELTA_HEADER_SIZE + DELTA_RECORD_SIZE + TEST_TARGET_SIZE + 16)
+#define TEST_CHUNK 7
+
+// ===== Глобальные переменные =====
+
+static uint8_t base[TEST_BASE_SIZE];
+static uint8_t target[TEST_TARGET_SIZE];
+static uint8_t output[TEST_TARGET_SIZE];
+static size_t outputLength = 0;
+
+static uint8_t patch[TEST_PATCH_MAX];
+static size_t patchLength = 0;
+
+// ===== Вспомогательные функции =====
+
+static bool readBase(uint32_t offset, uint8_t* data, size_t length, void* context) {
+  (void)context;
+  if (offset + length > TEST_BASE_SIZE) return false;
+  memcpy(data, base + offset, length);
+  return true;
+}
+
+static bool sink(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  if (outputLength + length > TEST_TARGET_SIZE) return false;
+  memcpy(output + outputLength, data, length);
+  outputLength += length;
+  return true;
+}
+
+static void sha256(const uint8_t* data, size_t length, uint8_t* digest) {
+  mbedtls_sha256_context context;
+  mbedtls_sha256_init(&context);
+  mbedtls_sha256_starts(&context, 0);
+  mbedtls_sha256_update(&context, data, length);
+  mbedtls_sha256_finish(&context, digest);
+  mbedtls_sha256_free(&context);
+}
+
+static void putLe32(uint8_t* data, uint32_t value) {
+  for (int i = 0; i < 4; i++) data[i] = (uint8_t)(value >> (8 * i));
+}
+
+// База с изменёнными байтами и новым хвостом: одна запись diff + extra
+static void buildPatch() {
+  for (size_t i = 0; i < TEST_BASE_SIZE; i++) base[i] = (uint8_t)(i * 31 + 7);
+  memcpy(target, base, TEST_BASE_SIZE);
+  for (size_t i = 0; i < TEST_BASE_SIZE; i += 97) target[i] ^= 0x5A;
+  for (size_t i = 0; i < TEST_EXTRA_SIZE; i++) target[TEST_BASE_SIZE + i] = (uint8_t)(0xA0 + i);
+
+  uint8_t* header = patch;
+  memset(header, 0, DELTA_HEADER_SIZE);
+  memcpy(header, DELTA_MAGIC, DELTA_MAGIC_SIZE);
+  header[4] = DELTA_VERSION;
+  putLe32(header + 8, TEST_BASE_SIZE);
+  putLe32(header + 12, TEST_TARGET_SIZE);
+  sha256(base, TEST_BASE_SIZE, header + 16);
+  sha256(target, TEST_TARGET_SIZE, header + 16 + DELTA_SHA256_SIZE);
+
+  uint8_t* record = patch + DELTA_HEADER_SIZE;
+  putLe32(record, TEST_BASE_SIZE);
+  putLe32(record + 4, TEST_EXTRA_SIZE);
+  putLe32(record + 8, 0);
+
+  uint8_t* data = record + DELTA_RECORD_SIZE;
+  for (size_t i = 0; i < TEST_BASE_SIZE; i++) data[i] = (uint8_t)(target[i] - base[i]);
+  memcpy(data + TEST_BASE_SIZE, target + TEST_BASE_SIZE, TEST_EXTRA_SIZE);
+  patchLength = DELTA_HEADER_SIZE + DELTA_RECORD_SIZE + TEST_TARGET_SIZE;
+}
+
+// Подача length байт патча частями; результат delta_finish() или первая ошибка
+static DeltaStatus apply(size_t length) {
+  outputLength = 0;
+  Delta* delta = delta_create(readBase, sink, NULL);
+  TEST_ASSERT_NOT_NULL(delta);
+
+  DeltaStatus status = DELTA_OK;
+  for (size_t pos = 0; pos < length && status == DELTA_OK; pos += TEST_CHUNK) {
+    size_t chunk = length - pos < TEST_CHUNK ? length - pos : TEST_CHUNK;
+    status = delta_write(delta, patch + pos, chunk);
+  }
+  if (status == DELTA_OK) status = delta_finish(delta);
+  delta_destroy(delta);
+  return status;
+}
+
+// ===== Тесты =====
+
+void setUp() {
+  buildPatch();
+}
+
+void tearDown() {}
+
+static void test_patch_rebuilds_target() {
+  TEST_ASSERT_EQUAL(DELTA_OK, apply(patchLength));
+  TEST_ASSERT_EQUAL(TEST_TARGET_SIZE, outputLength);
+  TEST_ASSERT_EQUAL_MEMORY(target, output, TEST_TARGET_SIZE);
+}
+
+static void test_data_after_last_record_is_rejected() {
+  patch[patchLength] = 0;
+  TEST_ASSERT_EQUAL(DELTA_ERR_DATA, apply(patchLength + 1));
+
+  // Лишняя запись нулевой длины — тоже повреждённый патч
+  memset(patch + patchLength, 0, DELTA_RECORD_SIZE);
+  TEST_ASSERT_EQUAL(DELTA_ERR_DATA, apply(patchLength + DELTA_RECORD_SIZE));
+}
+
+static void test_truncated_patch_is_rejected() {
+  TEST_ASSERT_EQUAL(DELTA_ERR_TRUNCATED, apply(patchLength - 1));
+  TEST_ASSERT_EQUAL(DELTA_ERR_TRUNCATED, apply(DELTA_HEADER_SIZE + DELTA_RECORD_SIZE / 2));
+}
+
+static void test_wrong_base_is_rejected() {
+  base[100] ^= 0xFF;
+  TEST_ASSERT_EQUAL(DELTA_ERR_BASE, apply(patchLength));
+  TEST_ASSERT_EQUAL(0, outputLength);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_patch_rebuilds_target);
+  RUN_TEST(test_data_after_last_record_is_rejected);
+  RUN_TEST(test_truncated_patch_is_rejected);
+  RUN_TEST(test_wrong_base_is_rejected);
+  return UNITY_END();
+}
@@ -0,0 +1,239 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "native_hal.h"
+#include "lidar.h"
+
+// Опрос VL53L0X в непрерывном режиме на фейковых датчиках native_hal:
+// частота отсчётов без блокировки на замер, переключение каналов TCA9548A,
+// «вне зоны видимости», ошибка чтения результата и устаревший датчик.
+// Датчики — каналы LIDAR_CHANNEL_MASK из config.h; lidar_loop() вызывается
+// тестом с периодом опроса вместо планировщика.
+
+// ===== Константы =====
+
+#define TEST_POLL_PERIOD_US 2000
+#define TEST_BASE_RANGE_MM 300
+#define TEST_FRAME_MAX_AGE_MS (3 * LIDAR_TIMING_BUDGET_US / 1000)
+
+// ===== Глобальные переменные =====
+
+static uint8_t presentMask = 0;
+static uint8_t firstChannel = 0;
+static uint32_t maxLoopUs = 0;
+
+// ===== Вспомогательные функции =====
+
+static void runFor(uint32_t ms) {
+  uint64_t end = esp_timer_get_time() + (uint64_t)ms * 1000;
+  while ((uint64_t)esp_timer_get_time() < end) {
+    uint64_t start = esp_timer_get_time();
+    lidar_loop();
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    if (elapsed > maxLoopUs) maxLoopUs = elapsed;
+    delayMicroseconds(TEST_POLL_PERIOD_US);
+  }
+}
+
+static LidarSensorStats sensorStats(uint8_t channel) {
+  LidarSensorStats stats;
+  lidar_getSensorStats(channel, &stats);
+  return stats;
+}
+
+static LidarFrame latestFrame() {
+  LidarFrame frame;
+  TEST_ASSERT_TRUE(lidar_getFrame(&frame));
+  return frame;
+}
+
+static void resetSensors() {
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    hal_vl53l0xSetRange(ch, TEST_BASE_RANGE_MM + ch * 10, 0);
+    hal_vl53l0xSetReadError(ch, false);
+    hal_vl53l0xSetPresent(ch, true);
+  }
+}
+
+// ===== Тесты =====
+
+void setUp() {
+  resetSensors();
+  runFor(3 * LIDAR_TIMING_BUDGET_US / 1000);
+}
+
+void tearDown() {}
+
+static void test_continuous_polling_reads_every_sensor() {
+  uint32_t before[LIDAR_MAX_SENSORS];
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) before[ch] = sensorStats(ch).samples;
+  maxLoopUs = 0;
+
+  runFor(500);
+
+  // Замер идёт в датчике: ~1 отсчёт на бюджет времени, опрос не ждёт замера
+  uint32_t expected = 500000 / LIDAR_TIMING_BUDGET_US;
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    LidarSensorStats stats = sensorStats(ch);
+    if (!(presentMask & (1 << ch))) {
+      TEST_ASSERT_EQUAL_UINT32(0, stats.samples);
+      continue;
+    }
+    uint32_t samples = stats.samples - before[ch];
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(expected / 2, samples);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(expected + 2, samples);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+  }
+  TEST_ASSERT_LESS_THAN_UINT32(LIDAR_TIMING_BUDGET_US / 4, maxLoopUs);
+
+  LidarFrame frame = latestFrame();
+  TEST_ASSERT_EQUAL_HEX8(presentMask, frame.presentMask);
+  TEST_ASSERT_EQUAL_HEX8(presentMask, frame.validMask);
+  for (uint8_t ch = 0; ch < LIDAR_MAX_SENSORS; ch++) {
+    if (presentMask & (1 << ch)) TEST_ASSERT_EQUAL_UINT16(TEST_BASE_RANGE_MM + ch * 10, frame.rangeMm[ch]);
+  }
+}
+
+static void test_mux_switched_at_most_once_per_sample() {
+  LidarStats before;
+  lidar_getStats(&before);
+
+  runFor(300);
+
+  LidarStats after;
+  lidar_getStats(&after);
+  uint32_t samples = after.samples - before.samples;
+  uint32_t selects = after.muxSelects - before.muxSelects;
+  TEST_ASSERT_GREATER_THAN_UINT32(0, samples);
+  if (after.sensors == 1) {
+    // Единственный канал выбран при старте и больше не переписывается
+    TEST_ASSERT_EQUAL_UINT32(0, selects);
+  } else {
+    // Обычно один выбор канала на отсчёт; лишние — опрос датчика, чей результат
+    // ещё не готов (фаза сдвигается на джиттер опроса)
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(samples + samples / 2, selects);
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(before.muxSkipped, after.muxSkipped);
+
+  // В мультиплексоре выбран ровно один канал с датчиком
+  uint8_t selected = hal_tca9548aGetSelected();
+  TEST_ASSERT_EQUAL(1, __builtin_popcount(selected));
+  TEST_ASSERT_TRUE(selected & presentMask);
+}
+
+static void test_out_of_range_is_not_an_error() {
+  LidarSensorStats before = sensorStats(firstChannel);
+  hal_vl53l0xSetRange(firstChannel, 8190, LIDAR_STATUS_OUT_OF_RANGE);
+  runFor(100);
+
+  LidarSensorStats after = sensorStats(firstChannel);
+  TEST_ASSERT_GREATER_THAN_UINT32(before.invalid, after.invalid);
+  TEST_ASSERT_EQUAL_UINT32(before.errors, after.errors);
+
+  LidarFrame frame = latestFrame();
+  TEST_ASSERT_EQUAL_UINT16(LIDAR_RANGE_INVALID, frame.rangeMm[firstChannel]);
+  TEST_ASSERT_FALSE(frame.validMask & (1 << firstChannel));
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_OUT_OF_RANGE, frame.state[firstChannel]);
+}
+
+static void test_read_error_is_counted_and_dropped() {
+  LidarSensorStats before = sensorStats(firstChannel);
+  uint32_t lastSeq = 0;
+  LidarSample samples[64];
+  lidar_getSamples(0, samples, 64, &lastSeq);
+
+  hal_vl53l0xSetReadError(firstChannel, true);
+  runFor(100);
+
+  LidarSensorStats after = sensorStats(firstChannel);
+  TEST_ASSERT_GREATER_THAN_UINT32(before.errors, after.errors);
+  TEST_ASSERT_EQUAL_UINT32(before.invalid, after.invalid);
+
+  // Отсчёты с ошибкой помечены и не дают дальность
+  size_t count = lidar_getSamples(lastSeq, samples, 64, &lastSeq);
+  uint32_t errorSamples = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (samples[i].channel != firstChannel) continue;
+    TEST_ASSERT_EQUAL_UINT8(LIDAR_STATUS_ERROR, samples[i].status);
+    TEST_ASSERT_EQUAL_UINT16(LIDAR_RANGE_INVALID, samples[i].rangeMm);
+    errorSamples++;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, errorSamples);
+
+  LidarFrame frame = latestFrame();
+  TEST_ASSERT_FALSE(frame.validMask & (1 << firstChannel));
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_ERROR, frame.state[firstChannel]);
+
+  // После восстановления шины канал снова в кадре
+  hal_vl53l0xSetReadError(firstChannel, false);
+  runFor(100);
+  frame = latestFrame();
+  TEST_ASSERT_TRUE(frame.validMask & (1 << firstChannel));
+  TEST_ASSERT_EQUAL_UINT16(TEST_BASE_RANGE_MM + firstChannel * 10, frame.rangeMm[firstChannel]);
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_OK, frame.state[firstChannel]);
+}
+
+static void test_read_error_after_out_of_range_is_an_error() {
+  // RangeStatus 4 от прошлого замера не должен выдавать ошибку за «вне зоны видимости»
+  hal_vl53l0xSetRange(firstChannel, 8190, LIDAR_STATUS_OUT_OF_RANGE);
+  runFor(100);
+  LidarSensorStats before = sensorStats(firstChannel);
+
+  hal_vl53l0xSetReadError(firstChannel, true);
+  runFor(100);
+
+  LidarSensorStats after = sensorStats(firstChannel);
+  TEST_ASSERT_GREATER_THAN_UINT32(before.errors, after.errors);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(before.invalid + 1, after.invalid);
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_ERROR, latestFrame().state[firstChannel]);
+
+  hal_vl53l0xSetReadError(firstChannel, false);
+  runFor(100);
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_OUT_OF_RANGE, latestFrame().state[firstChannel]);
+}
+
+static void test_silent_sensor_goes_stale() {
+  LidarSensorStats before = sensorStats(firstChannel);
+  hal_vl53l0xSetPresent(firstChannel, false);
+  runFor(200);
+
+  // Датчик не отвечает: таймауты, а отсчёт старше предела выпадает из кадра
+  LidarSensorStats after = sensorStats(firstChannel);
+  TEST_ASSERT_GREATER_THAN_UINT32(before.timeouts, after.timeouts);
+  TEST_ASSERT_EQUAL_UINT32(before.samples, after.samples);
+
+  LidarFrame frame = latestFrame();
+  TEST_ASSERT_FALSE(frame.validMask & (1 << firstChannel));
+  TEST_ASSERT_EQUAL_UINT16(LIDAR_RANGE_INVALID, frame.rangeMm[firstChannel]);
+  TEST_ASSERT_GREATER_THAN_UINT32(TEST_FRAME_MAX_AGE_MS, frame.ageMs[firstChannel]);
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_STALE, frame.state[firstChannel]);
+
+  hal_vl53l0xSetPresent(firstChannel, true);
+  runFor(100);
+  frame = latestFrame();
+  TEST_ASSERT_TRUE(frame.validMask & (1 << firstChannel));
+}
+
+int main() {
+  resetSensors();
+  lidar_init();
+  runFor(100);
+
+  LidarFrame frame;
+  if (lidar_getFrame(&frame)) presentMask = frame.presentMask;
+  while (firstChannel < LIDAR_MAX_SENSORS && !(presentMask & (1 << firstChannel))) firstChannel++;
+
+  UNITY_BEGIN();
+  if (presentMask == 0) {
+    printf("No lidar channels in LIDAR_CHANNEL_MASK\n");
+    return UNITY_END();
+  }
+  RUN_TEST(test_continuous_polling_reads_every_sensor);
+  RUN_TEST(test_mux_switched_at_most_once_per_sample);
+  RUN_TEST(test_out_of_range_is_not_an_error);
+  RUN_TEST(test_read_error_is_counted_and_dropped);
+  RUN_TEST(test_read_error_after_out_of_range_is_an_error);
+  RUN_TEST(test_silent_sensor_goes_stale);
+  return UNITY_END();
+}
@@ -0,0 +1,152 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "native_hal.h"
+#include "motormix.h"
+#include "motorpwm.h"
+
+// Пересчёт скорости в скважности H-моста (motormix.h) и защёлкивание
+// скважностей LEDC (motorpwm): запись без применения, одно обновление
+// на изменившиеся каналы, аварийное снятие ШИМ.
+
+// ===== Константы =====
+
+#define TEST_CHANNELS 4
+#define TEST_MAX_DUTY_10BIT 1023
+
+static const int testPins[TEST_CHANNELS] = {10, 11, 12, 13};
+
+// ===== Вспомогательные функции =====
+
+static void zeroAll() {
+  for (int i = 0; i < TEST_CHANNELS; i++) motorpwm_setDuty(i, 0);
+  motorpwm_commit();
+}
+
+// ===== Тесты =====
+
+void setUp() {
+  motorpwm_release();
+  zeroAll();
+}
+
+void tearDown() {}
+
+static void test_mix_direction_and_scale() {
+  MotorDuty duty = motormix_duty(255, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(TEST_MAX_DUTY_10BIT, duty.forward);
+  TEST_ASSERT_EQUAL_UINT32(0, duty.reverse);
+
+  duty = motormix_duty(-255, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(0, duty.forward);
+  TEST_ASSERT_EQUAL_UINT32(TEST_MAX_DUTY_10BIT, duty.reverse);
+
+  duty = motormix_duty(0, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(0, duty.forward);
+  TEST_ASSERT_EQUAL_UINT32(0, duty.reverse);
+
+  // 128/255 * 1023 = 513.5 — округление к ближайшему
+  duty = motormix_duty(128, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(514, duty.forward);
+  duty = motormix_duty(-1, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(4, duty.reverse);
+}
+
+static void test_mix_clamps_speed_and_is_monotonic() {
+  MotorDuty duty = motormix_duty(1000, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(TEST_MAX_DUTY_10BIT, duty.forward);
+  duty = motormix_duty(-1000, TEST_MAX_DUTY_10BIT);
+  TEST_ASSERT_EQUAL_UINT32(TEST_MAX_DUTY_10BIT, duty.reverse);
+
+  uint32_t last = 0;
+  for (int speed = 0; speed <= MOTORMIX_SPEED_MAX; speed++) {
+    MotorDuty forward = motormix_duty(speed, TEST_MAX_DUTY_10BIT);
+    MotorDuty reverse = motormix_duty(-speed, TEST_MAX_DUTY_10BIT);
+    TEST_ASSERT_EQUAL_UINT32(forward.forward, reverse.reverse);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(last, forward.forward);
+    last = forward.forward;
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, motormix_maxDuty(1));
+  TEST_ASSERT_EQUAL_UINT32(16383, motormix_maxDuty(14));
+}
+
+static void test_set_duty_is_latched_until_commit() {
+  uint32_t updates = hal_ledcGetUpdates();
+  motorpwm_setDuty(0, 100);
+  motorpwm_setDuty(2, 300);
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(0));
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(2));
+  TEST_ASSERT_EQUAL_UINT32(updates, hal_ledcGetUpdates());
+
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(100, hal_ledcGetDuty(0));
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(1));
+  TEST_ASSERT_EQUAL_UINT32(300, hal_ledcGetDuty(2));
+  // Обновляются только изменившиеся каналы
+  TEST_ASSERT_EQUAL_UINT32(updates + 2, hal_ledcGetUpdates());
+
+  // Повторный commit без изменений не трогает LEDC
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(updates + 2, hal_ledcGetUpdates());
+}
+
+static void test_duty_is_clamped_and_channels_checked() {
+  uint32_t max = motorpwm_maxDuty();
+  motorpwm_setDuty(1, max + 500);
+  motorpwm_setDuty(-1, 10);
+  motorpwm_setDuty(TEST_CHANNELS, 10);
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(max, hal_ledcGetDuty(1));
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(TEST_CHANNELS));
+}
+
+static void test_kill_overrides_commit_until_release() {
+  motorpwm_setDuty(0, 200);
+  motorpwm_setDuty(3, 400);
+  motorpwm_commit();
+
+  motorpwm_kill();
+  for (int i = 0; i < TEST_CHANNELS; i++) TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(i));
+
+  // Задача управления ещё пишет скважности — они не применяются
+  motorpwm_setDuty(0, 500);
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(0));
+
+  motorpwm_release();
+  motorpwm_setDuty(0, 500);
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(500, hal_ledcGetDuty(0));
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(3));
+}
+
+static void test_mix_into_pwm_pair() {
+  // Мотор на каналах (0, 1): смена направления — вход вперёд гаснет в том же commit
+  MotorDuty duty = motormix_duty(200, motorpwm_maxDuty());
+  motorpwm_setDuty(0, duty.forward);
+  motorpwm_setDuty(1, duty.reverse);
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(duty.forward, hal_ledcGetDuty(0));
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(1));
+
+  duty = motormix_duty(-200, motorpwm_maxDuty());
+  motorpwm_setDuty(0, duty.forward);
+  motorpwm_setDuty(1, duty.reverse);
+  motorpwm_commit();
+  TEST_ASSERT_EQUAL_UINT32(0, hal_ledcGetDuty(0));
+  TEST_ASSERT_EQUAL_UINT32(duty.reverse, hal_ledcGetDuty(1));
+}
+
+int main() {
+  if (!motorpwm_init(testPins, TEST_CHANNELS)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_mix_direction_and_scale);
+  RUN_TEST(test_mix_clamps_speed_and_is_monotonic);
+  RUN_TEST(test_set_duty_is_latched_until_commit);
+  RUN_TEST(test_duty_is_clamped_and_channels_checked);
+  RUN_TEST(test_kill_overrides_commit_until_release);
+  RUN_TEST(test_mix_into_pwm_pair);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "otawriter.h"
+
+// Двойная буферизация записи OTA: порядок и целостность данных при
+// переключении буферов, ожидание приёма, когда обработчик медленнее
+// (stall), и остановка после ошибки обработчика. Обработчик работает
+// в задаче otawriter (поток native_hal), приём — в главном потоке теста.
+
+// ===== Константы =====
+
+#define TEST_BUFFER_SIZE 32768          // OTA_WRITER_BUFFER_SIZE по умолчанию
+#define TEST_IMAGE_SIZE (5 * TEST_BUFFER_SIZE + 1000)
+#define TEST_CHUNK 1436                 // часть загрузки, как от async_tcp
+#define TEST_FLUSH_DELAY_MS 20          // «стирание flash» на каждый буфер
+
+// ===== Глобальные переменные =====
+
+static uint8_t image[TEST_IMAGE_SIZE];
+static uint8_t written[TEST_IMAGE_SIZE];
+static volatile size_t writtenLength = 0;
+static volatile uint32_t sinkCalls = 0;
+static volatile uint32_t failAtCall = 0;     // 0 — без ошибки
+static volatile uint32_t flushDelayMs = 0;
+
+// ===== Вспомогательные функции =====
+
+static bool sink(const uint8_t* data, size_t length, void* context) {
+  (void)context;
+  uint32_t call = ++sinkCalls;
+  if (flushDelayMs > 0) delay(flushDelayMs);
+  if (call == failAtCall) return false;
+  if (writtenLength + length > TEST_IMAGE_SIZE) return false;
+  memcpy(written + writtenLength, data, length);
+  writtenLength += length;
+  return true;
+}
+
+// Загрузка образа частями; false — otawriter_write сообщил об ошибке
+static bool upload(size_t length) {
+  for (size_t pos = 0; pos < length; pos += TEST_CHUNK) {
+    size_t chunk = length - pos < TEST_CHUNK ? length - pos : TEST_CHUNK;
+    if (!otawriter_write(image + pos, chunk)) return false;
+  }
+  return true;
+}
+
+static OtaWriterStats writerStats() {
+  OtaWriterStats stats;
+  otawriter_getStats(&stats);
+  return stats;
+}
+
+// ===== Тесты =====
+
+void setUp() {
+  for (size_t i = 0; i < TEST_IMAGE_SIZE; i++) image[i] = (uint8_t)(i * 131 + (i >> 9));
+  memset(written, 0, sizeof(written));
+  writtenLength = 0;
+  sinkCalls = 0;
+  failAtCall = 0;
+  flushDelayMs = 0;
+}
+
+void tearDown() {}
+
+static void test_image_written_in_order() {
+  TEST_ASSERT_TRUE(otawriter_begin(sink, NULL));
+  TEST_ASSERT_TRUE(upload(TEST_IMAGE_SIZE));
+  TEST_ASSERT_TRUE(otawriter_finish());
+
+  TEST_ASSERT_EQUAL(TEST_IMAGE_SIZE, writtenLength);
+  TEST_ASSERT_EQUAL_MEMORY(image, written, TEST_IMAGE_SIZE);
+
+  // Полные буферы и остаток
+  OtaWriterStats stats = writerStats();
+  TEST_ASSERT_EQUAL_UINT32(TEST_BUFFER_SIZE, stats.bufferSize);
+  TEST_ASSERT_EQUAL_UINT32(TEST_IMAGE_SIZE / TEST_BUFFER_SIZE + 1, stats.flushes);
+}
+
+static void test_slow_sink_stalls_receiver() {
+  flushDelayMs = TEST_FLUSH_DELAY_MS;
+  TEST_ASSERT_TRUE(otawriter_begin(sink, NULL));
+  uint64_t start = esp_timer_get_time();
+  TEST_ASSERT_TRUE(upload(TEST_IMAGE_SIZE));
+  TEST_ASSERT_TRUE(otawriter_finish());
+  uint32_t uploadUs = (uint32_t)(esp_timer_get_time() - start);
+  TEST_ASSERT_EQUAL_MEMORY(image, written, TEST_IMAGE_SIZE);
+
+  // Приём ждёт на каждом буфере, кроме первого: второй заполняется,
+  // пока пишется первый
+  OtaWriterStats stats = writerStats();
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(TEST_IMAGE_SIZE / TEST_BUFFER_SIZE - 1, stats.stalls);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, stats.maxStallUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(uploadUs, stats.stallUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * TEST_FLUSH_DELAY_MS * 1000, stats.maxStallUs);
+}
+
+static void test_sink_error_stops_upload() {
+  failAtCall = 2;
+  TEST_ASSERT_TRUE(otawriter_begin(sink, NULL));
+  // Ошибка видна приёму на одной из следующих частей или в otawriter_finish()
+  upload(TEST_IMAGE_SIZE);
+  TEST_ASSERT_FALSE(otawriter_finish());
+
+  // После ошибки обработчик больше не вызывается
+  TEST_ASSERT_EQUAL_UINT32(2, sinkCalls);
+  TEST_ASSERT_EQUAL(TEST_BUFFER_SIZE, writtenLength);
+}
+
+static void test_abort_waits_for_flush() {
+  flushDelayMs = TEST_FLUSH_DELAY_MS;
+  TEST_ASSERT_TRUE(otawriter_begin(sink, NULL));
+  TEST_ASSERT_TRUE(upload(TEST_BUFFER_SIZE));
+  otawriter_abort();
+
+  // Буфер, отданный в запись, дописан до освобождения буферов
+  TEST_ASSERT_EQUAL_UINT32(1, sinkCalls);
+  TEST_ASSERT_EQUAL(TEST_BUFFER_SIZE, writtenLength);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_image_written_in_order);
+  RUN_TEST(test_slow_sink_stalls_receiver);
+  RUN_TEST(test_sink_error_stops_upload);
+  RUN_TEST(test_abort_waits_for_flush);
+  return UNITY_END();
+}
@@ -0,0 +1,196 @@
+#include <unity.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ramp.h"
+
+// Генератор ramp.h: пересчёт ограничений, соблюдение ускорения и рывка,
+// выход в уставку без перерегулирования, разворот и микробенчмарк такта
+// в худшей ветви (движение к далёкой цели с ограничением рывка).
+
+// ===== Константы =====
+
+#define TEST_TICK_US 1000                 // такт dc_loop
+#define TEST_ACCEL_PER_SEC 1000           // ШИМ/с, как MOTOR_RAMP_ACCEL по умолчанию
+#define TEST_JERK_PER_SEC2 100000         // ШИМ/с²
+#define TEST_MAX_TICKS 100000
+#define TEST_BENCH_TICKS 2000000
+#define TEST_MAX_TICK_NS 1000             // с запасом: на ESP32 такт — единицы мкс
+
+// ===== Структуры данных =====
+
+// Скорость и рывок — по фактическому изменению значения за такт: в такте выхода
+// в уставку rate уже сброшен, хотя значение ещё сдвинулось
+struct RunResult {
+  int ticks;                // до остановки в уставке
+  int32_t maxRate;          // наибольшее |Δvalue| за такт
+  int32_t maxRateChange;    // наибольшее изменение Δvalue между тактами (с остановкой)
+  bool overshoot;           // значение выходило за уставку
+};
+
+// ===== Глобальные переменные =====
+
+// Результат бенчмарка: компилятор не должен выбросить такты
+static volatile int32_t benchSink;
+
+// ===== Вспомогательные функции =====
+
+static RampLimits testLimits() {
+  return ramp_limits(TEST_ACCEL_PER_SEC, TEST_JERK_PER_SEC2, TEST_TICK_US);
+}
+
+// Шаги до остановки в уставке; перерегулирование — выход за уставку в сторону движения
+static RunResult runToTarget(Ramp* ramp, const RampLimits& limits) {
+  RunResult result = {0, 0, 0, false};
+  int32_t dir = ramp->target > ramp->value ? 1 : -1;
+  int32_t lastStep = ramp->rate;
+  while (result.ticks < TEST_MAX_TICKS && (ramp->value != ramp->target || ramp->rate != 0)) {
+    int32_t value = ramp->value;
+    ramp_step(ramp, &limits);
+    int32_t step = ramp->value - value;
+    result.ticks++;
+    if (abs(step) > result.maxRate) result.maxRate = abs(step);
+    if (abs(step - lastStep) > result.maxRateChange) result.maxRateChange = abs(step - lastStep);
+    if ((int64_t)(ramp->value - ramp->target) * dir > 0) result.overshoot = true;
+    lastStep = step;
+  }
+  if (abs(lastStep) > result.maxRateChange) result.maxRateChange = abs(lastStep);
+  return result;
+}
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// ===== Тесты =====
+
+void setUp() {}
+void tearDown() {}
+
+static void test_limits_convert_to_q8_per_tick() {
+  RampLimits limits = testLimits();
+  // 1000 ШИМ/с за 1 мс = 1 ШИМ за такт; 100000 ШИМ/с² = 0.1 ШИМ за такт²
+  TEST_ASSERT_EQUAL_INT32(RAMP_ONE, limits.accel);
+  TEST_ASSERT_EQUAL_INT32(RAMP_ONE / 10, limits.jerk);
+
+  // Малые ненулевые ограничения не обнуляются, ноль — без ограничения
+  RampLimits tiny = ramp_limits(1, 1, TEST_TICK_US);
+  TEST_ASSERT_EQUAL_INT32(1, tiny.accel);
+  TEST_ASSERT_EQUAL_INT32(1, tiny.jerk);
+  RampLimits none = ramp_limits(0, 0, TEST_TICK_US);
+  TEST_ASSERT_EQUAL_INT32(0, none.accel);
+  TEST_ASSERT_EQUAL_INT32(0, none.jerk);
+}
+
+static void test_accel_and_jerk_are_respected() {
+  RampLimits limits = testLimits();
+  Ramp ramp;
+  ramp_reset(&ramp, 0);
+  ramp.target = ramp_toFixed(255);
+
+  RunResult result = runToTarget(&ramp, limits);
+  TEST_ASSERT_LESS_THAN_INT(TEST_MAX_TICKS, result.ticks);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(limits.accel, result.maxRate);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(limits.jerk, result.maxRateChange);
+  // Дальняя цель: выход на полное ускорение
+  TEST_ASSERT_EQUAL_INT32(limits.accel, result.maxRate);
+}
+
+static void test_reaches_target_without_overshoot() {
+  RampLimits limits = testLimits();
+  const int targets[] = {1, 3, 17, 100, 255, -1, -40, -255};
+  for (int target : targets) {
+    Ramp ramp;
+    ramp_reset(&ramp, 0);
+    ramp.target = ramp_toFixed(target);
+
+    RunResult result = runToTarget(&ramp, limits);
+    TEST_ASSERT_LESS_THAN_INT(TEST_MAX_TICKS, result.ticks);
+    TEST_ASSERT_FALSE(result.overshoot);
+    TEST_ASSERT_EQUAL_INT32(ramp_toFixed(target), ramp.value);
+    TEST_ASSERT_EQUAL_INT32(0, ramp.rate);
+    TEST_ASSERT_EQUAL_INT(target, ramp_toInt(ramp.value));
+  }
+}
+
+static void test_reverses_direction_within_jerk() {
+  RampLimits limits = testLimits();
+  Ramp ramp;
+  ramp_reset(&ramp, 0);
+  ramp.target = ramp_toFixed(255);
+  for (int i = 0; i < 30; i++) ramp_step(&ramp, &limits);
+  TEST_ASSERT_GREATER_THAN_INT32(0, ramp.rate);
+
+  // Полный назад посреди разгона: rate меняет знак не быстрее jerk за такт
+  ramp.target = ramp_toFixed(-255);
+  RunResult result = runToTarget(&ramp, limits);
+  TEST_ASSERT_LESS_THAN_INT(TEST_MAX_TICKS, result.ticks);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(limits.jerk, result.maxRateChange);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(limits.accel, result.maxRate);
+  TEST_ASSERT_FALSE(result.overshoot);
+  TEST_ASSERT_EQUAL_INT32(ramp_toFixed(-255), ramp.value);
+}
+
+static void test_trapezoid_without_jerk_limit() {
+  RampLimits limits = ramp_limits(TEST_ACCEL_PER_SEC, 0, TEST_TICK_US);
+  Ramp ramp;
+  ramp_reset(&ramp, 0);
+  ramp.target = ramp_toFixed(10);
+
+  // Полный шаг accel за такт с первого такта, уставка — ровно через 10 тактов
+  for (int i = 0; i < 10; i++) {
+    ramp_step(&ramp, &limits);
+    TEST_ASSERT_EQUAL_INT32(limits.accel, ramp.rate);
+  }
+  TEST_ASSERT_EQUAL_INT32(ramp.target, ramp.value);
+  ramp_step(&ramp, &limits);
+  TEST_ASSERT_EQUAL_INT32(ramp.target, ramp.value);
+  TEST_ASSERT_EQUAL_INT32(0, ramp.rate);
+}
+
+static void test_no_accel_limit_jumps_to_target() {
+  RampLimits limits = ramp_limits(0, 0, TEST_TICK_US);
+  Ramp ramp;
+  ramp_reset(&ramp, 0);
+  ramp.target = ramp_toFixed(-200);
+  ramp_step(&ramp, &limits);
+  TEST_ASSERT_EQUAL_INT32(ramp_toFixed(-200), ramp.value);
+  TEST_ASSERT_EQUAL_INT32(0, ramp.rate);
+}
+
+// Худший такт: движение к цели с рывком — два расчёта пути торможения (деления)
+static void test_benchmark_worst_case_tick() {
+  RampLimits limits = testLimits();
+  Ramp ramps[4];
+  for (int i = 0; i < 4; i++) {
+    ramp_reset(&ramps[i], 0);
+    ramps[i].target = INT32_MAX / 2;
+  }
+
+  uint64_t start = nowNs();
+  for (int i = 0; i < TEST_BENCH_TICKS; i++) benchSink = ramp_step(&ramps[i & 3], &limits);
+  uint64_t elapsed = nowNs() - start;
+
+  // Цель не достигнута: все такты прошли по ветви с торможением
+  TEST_ASSERT_NOT_EQUAL(ramps[0].target, ramps[0].value);
+  uint32_t tickNs = (uint32_t)(elapsed / TEST_BENCH_TICKS);
+  char message[96];
+  snprintf(message, sizeof(message), "ramp_step worst case: %u ns/tick", (unsigned)tickNs);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_TICK_NS, tickNs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_limits_convert_to_q8_per_tick);
+  RUN_TEST(test_accel_and_jerk_are_respected);
+  RUN_TEST(test_reaches_target_without_overshoot);
+  RUN_TEST(test_reverses_direction_within_jerk);
+  RUN_TEST(test_trapezoid_without_jerk_limit);
+  RUN_TEST(test_no_accel_limit_jumps_to_target);
+  RUN_TEST(test_benchmark_worst_case_tick);
+  return UNITY_END();
+}
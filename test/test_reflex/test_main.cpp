@@ -0,0 +1,255 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "native_hal.h"
+#include "dcmotor.h"
+#include "lidar.h"
+#include "reflex.h"
+
+// Рефлекс предотвращения столкновений на фейковом VL53L0X: трассы расстояний
+// проигрываются через lidar_loop() → reflex_update() → dc_loop(), проверяются
+// худшая задержка от появления препятствия до снятия ШИМ, ограничение при
+// сближении и staleSpeed для датчика с ошибкой и устаревшего отсчёта.
+// Мотор A разгоняется вперёд; lidar_loop() и dc_loop() вызываются тестом
+// с их периодами вместо планировщика.
+
+// ===== Константы =====
+
+#define TEST_CHANNEL 0                  // REFLEX_LIDAR_CHANNEL по умолчанию
+#define TEST_POLL_PERIOD_US 2000        // период lidar_loop
+#define TEST_CONTROL_PERIOD_US 10000    // период dc_loop
+#define TEST_JITTER_US 15000            // запас на планирование потоков хоста
+#define TEST_CLEAR_RANGE_MM 8190
+#define TEST_NEAR_RANGE_MM 100          // ближе stopMm — скорость 0
+#define TEST_REPLAYS 8
+
+// Как в lidar.cpp
+#ifndef LIDAR_FRAME_RATE_HZ
+#define LIDAR_FRAME_RATE_HZ 20
+#endif
+#define TEST_FRAME_PERIOD_US (1000000UL / LIDAR_FRAME_RATE_HZ)
+#define TEST_FRAME_MAX_AGE_US (3 * LIDAR_TIMING_BUDGET_US)
+
+// Обнаружение: идущий замер, следующий замер, опрос, кадр, такт управления
+#define TEST_DETECT_BOUND_US (2 * LIDAR_TIMING_BUDGET_US + TEST_POLL_PERIOD_US + \
+                              TEST_FRAME_PERIOD_US + TEST_CONTROL_PERIOD_US + TEST_JITTER_US)
+
+// Реакция: отсчёт попадает в кадр не позже следующего замера, кадр виден
+// такту управления до публикации следующего
+#define TEST_REACTION_BOUND_US (LIDAR_TIMING_BUDGET_US + TEST_POLL_PERIOD_US + \
+                                TEST_FRAME_PERIOD_US + TEST_JITTER_US)
+
+// Устаревание: отсчёт выпадает из кадра, кадр, такт управления
+#define TEST_STALE_BOUND_US (TEST_FRAME_MAX_AGE_US + LIDAR_TIMING_BUDGET_US + TEST_FRAME_PERIOD_US + \
+                             TEST_CONTROL_PERIOD_US + TEST_JITTER_US)
+
+// ===== Глобальные переменные =====
+
+static ReflexConfig config;
+static uint64_t nextControlUs = 0;
+
+// ===== Вспомогательные функции =====
+
+// Один период опроса дальномера; такт управления — когда подошло его время
+static void tick() {
+  lidar_loop();
+  uint64_t now = esp_timer_get_time();
+  if (now >= nextControlUs) {
+    dc_loop();
+    nextControlUs += TEST_CONTROL_PERIOD_US;
+    if (nextControlUs <= now) nextControlUs = now + TEST_CONTROL_PERIOD_US;
+  }
+  delayMicroseconds(TEST_POLL_PERIOD_US);
+}
+
+static void runFor(uint32_t ms) {
+  uint64_t end = esp_timer_get_time() + (uint64_t)ms * 1000;
+  while ((uint64_t)esp_timer_get_time() < end) tick();
+}
+
+// Время до ШИМ мотора A не выше limit, UINT32_MAX — не дождались
+static uint32_t runUntilOutputAtMost(int limit, uint32_t timeoutMs) {
+  uint64_t start = esp_timer_get_time();
+  uint64_t end = start + (uint64_t)timeoutMs * 1000;
+  while ((uint64_t)esp_timer_get_time() < end) {
+    tick();
+    if (motor_getOutput(0) <= limit) return (uint32_t)(esp_timer_get_time() - start);
+  }
+  return UINT32_MAX;
+}
+
+// Свободный путь и разгон мотора A до полной скорости
+static void driveClear() {
+  hal_vl53l0xSetRange(TEST_CHANNEL, TEST_CLEAR_RANGE_MM, LIDAR_STATUS_OUT_OF_RANGE);
+  motor_setSpeedA(REFLEX_SPEED_MAX);
+  runFor(800);
+  TEST_ASSERT_EQUAL(REFLEX_SPEED_MAX, motor_getOutput(0));
+}
+
+static ReflexStats reflexStats() {
+  ReflexStats stats;
+  reflex_getStats(&stats);
+  return stats;
+}
+
+static LidarFrame latestFrame() {
+  LidarFrame frame;
+  TEST_ASSERT_TRUE(lidar_getFrame(&frame));
+  return frame;
+}
+
+// ===== Тесты =====
+
+void setUp() {
+  hal_vl53l0xSetRange(TEST_CHANNEL, TEST_CLEAR_RANGE_MM, LIDAR_STATUS_OUT_OF_RANGE);
+  hal_vl53l0xSetReadError(TEST_CHANNEL, false);
+  hal_vl53l0xSetPresent(TEST_CHANNEL, true);
+  runFor(200);
+}
+
+void tearDown() {
+  motor_setSpeedA(0);
+  runFor(50);
+}
+
+static void test_max_forward_formula() {
+  TEST_ASSERT_EQUAL(REFLEX_SPEED_MAX, reflex_maxForward(&config, REFLEX_RANGE_NONE, 0));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_maxForward(&config, REFLEX_RANGE_NONE, REFLEX_AGE_UNKNOWN));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_maxForward(&config, REFLEX_RANGE_NONE, config.maxAgeMs + 1));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_maxForward(&config, 2000, REFLEX_AGE_UNKNOWN));
+  TEST_ASSERT_EQUAL(0, reflex_maxForward(&config, config.stopMm, 0));
+  TEST_ASSERT_EQUAL(0, reflex_maxForward(&config, TEST_NEAR_RANGE_MM, 0));
+
+  // Ближе или старше — медленнее
+  int far = reflex_maxForward(&config, 600, 0);
+  int near = reflex_maxForward(&config, 300, 0);
+  int old = reflex_maxForward(&config, 300, 50);
+  TEST_ASSERT_GREATER_THAN(near, far);
+  TEST_ASSERT_GREATER_THAN(old, near);
+  TEST_ASSERT_GREATER_THAN(0, old);
+}
+
+static void test_clear_path_allows_full_speed() {
+  driveClear();
+  TEST_ASSERT_EQUAL(REFLEX_SPEED_MAX, reflex_update());
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_OUT_OF_RANGE, latestFrame().state[TEST_CHANNEL]);
+  TEST_ASSERT_FALSE(reflexStats().active);
+}
+
+static void test_sudden_obstacle_worst_case_latency() {
+  uint32_t worstUs = 0;
+
+  // Препятствие появляется в разных фазах замера, кадра и такта управления
+  for (int i = 0; i < TEST_REPLAYS; i++) {
+    driveClear();
+    runFor(i * 7);
+
+    hal_vl53l0xSetRange(TEST_CHANNEL, TEST_NEAR_RANGE_MM, 0);
+    uint32_t latencyUs = runUntilOutputAtMost(0, 500);
+    TEST_ASSERT_NOT_EQUAL(UINT32_MAX, latencyUs);
+    if (latencyUs > worstUs) worstUs = latencyUs;
+  }
+
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_DETECT_BOUND_US, worstUs);
+
+  ReflexStats stats = reflexStats();
+  TEST_ASSERT_TRUE(stats.active);
+  TEST_ASSERT_EQUAL(0, stats.limit);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(TEST_REPLAYS, stats.overrides);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, stats.maxReactionUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_REACTION_BOUND_US, stats.maxReactionUs);
+}
+
+static void test_approach_trace_stays_under_limit() {
+  driveClear();
+
+  // Сближение 1 мм/мс от 1500 мм до 100 мм: ШИМ не выше ограничения по
+  // расстоянию, которое было TEST_DETECT_BOUND_US назад
+  const int32_t startMm = 1500;
+  uint64_t start = esp_timer_get_time();
+  uint32_t checks = 0;
+  for (;;) {
+    uint32_t elapsedMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    int32_t range = startMm - (int32_t)elapsedMs;
+    if (range < TEST_NEAR_RANGE_MM) break;
+    hal_vl53l0xSetRange(TEST_CHANNEL, range, 0);
+    tick();
+
+    if (elapsedMs * 1000 < TEST_DETECT_BOUND_US) continue;
+    int32_t seenMm = startMm - (int32_t)(elapsedMs - TEST_DETECT_BOUND_US / 1000);
+    TEST_ASSERT_LESS_OR_EQUAL(reflex_maxForward(&config, seenMm, 0), motor_getOutput(0));
+    checks++;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(100, checks);
+
+  hal_vl53l0xSetRange(TEST_CHANNEL, TEST_NEAR_RANGE_MM, 0);
+  TEST_ASSERT_NOT_EQUAL(UINT32_MAX, runUntilOutputAtMost(0, TEST_DETECT_BOUND_US / 1000));
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_REACTION_BOUND_US, reflexStats().maxReactionUs);
+}
+
+static void test_erroring_sensor_gets_stale_speed() {
+  driveClear();
+
+  // Ошибка чтения даёт 0xFFFF, как «вне зоны видимости», но путь не свободен
+  hal_vl53l0xSetReadError(TEST_CHANNEL, true);
+  uint32_t latencyUs = runUntilOutputAtMost(config.staleSpeed, 500);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_DETECT_BOUND_US, latencyUs);
+
+  runFor(300);
+  TEST_ASSERT_EQUAL(config.staleSpeed, motor_getOutput(0));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_update());
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_ERROR, latestFrame().state[TEST_CHANNEL]);
+
+  ReflexStats stats = reflexStats();
+  TEST_ASSERT_TRUE(stats.active);
+  TEST_ASSERT_EQUAL(config.staleSpeed, stats.limit);
+
+  // Шина восстановилась — ограничение снято
+  hal_vl53l0xSetReadError(TEST_CHANNEL, false);
+  runFor(200);
+  TEST_ASSERT_EQUAL(REFLEX_SPEED_MAX, reflex_update());
+  TEST_ASSERT_FALSE(reflexStats().active);
+}
+
+static void test_silent_sensor_gets_stale_speed() {
+  driveClear();
+
+  // Последний отсчёт — «вне зоны видимости», но он стареет: после выпадения
+  // из кадра — staleSpeed, а не полная скорость до maxAgeMs
+  hal_vl53l0xSetPresent(TEST_CHANNEL, false);
+  uint32_t latencyUs = runUntilOutputAtMost(config.staleSpeed, 500);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_STALE_BOUND_US, latencyUs);
+
+  runFor(300);
+  TEST_ASSERT_EQUAL(config.staleSpeed, motor_getOutput(0));
+  TEST_ASSERT_EQUAL_UINT8(LIDAR_STATE_STALE, latestFrame().state[TEST_CHANNEL]);
+
+  hal_vl53l0xSetPresent(TEST_CHANNEL, true);
+  runFor(200);
+  TEST_ASSERT_EQUAL(REFLEX_SPEED_MAX, reflex_update());
+}
+
+int main() {
+  hal_vl53l0xSetRange(TEST_CHANNEL, TEST_CLEAR_RANGE_MM, LIDAR_STATUS_OUT_OF_RANGE);
+  lidar_init();
+  dc_init();
+  reflex_getConfig(&config);
+  nextControlUs = esp_timer_get_time();
+  runFor(100);
+
+  LidarFrame frame;
+  bool present = lidar_getFrame(&frame) && (frame.presentMask & (1 << TEST_CHANNEL));
+
+  UNITY_BEGIN();
+  RUN_TEST(test_max_forward_formula);
+  if (present) {
+    RUN_TEST(test_clear_path_allows_full_speed);
+    RUN_TEST(test_sudden_obstacle_worst_case_latency);
+    RUN_TEST(test_approach_trace_stays_under_limit);
+    RUN_TEST(test_erroring_sensor_gets_stale_speed);
+    RUN_TEST(test_silent_sensor_gets_stale_speed);
+  }
+  return UNITY_END();
+}
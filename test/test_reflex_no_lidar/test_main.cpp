@@ -0,0 +1,89 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "native_hal.h"
+#include "dcmotor.h"
+#include "lidar.h"
+#include "reflex.h"
+
+// Рефлекс без переднего дальномера: датчик REFLEX_LIDAR_CHANNEL не отвечает
+// при запуске. Ни отсутствие кадра, ни отсутствие канала в presentMask не
+// должны давать полную скорость вперёд — только staleSpeed, как при ошибке
+// датчика. lidar_loop() и dc_loop() вызываются тестом с их периодами.
+
+// ===== Константы =====
+
+#define TEST_CHANNEL 0                  // REFLEX_LIDAR_CHANNEL по умолчанию
+#define TEST_POLL_PERIOD_US 2000        // период lidar_loop
+#define TEST_CONTROL_TICKS 5            // тактов dc_loop на период управления
+
+// ===== Глобальные переменные =====
+
+static ReflexConfig config;
+
+// ===== Вспомогательные функции =====
+
+// Разгон мотора A: lidar_loop() каждые 2 мс, dc_loop() каждые 10 мс
+static void runFor(uint32_t ms) {
+  uint32_t ticks = ms * 1000 / TEST_POLL_PERIOD_US;
+  for (uint32_t i = 0; i < ticks; i++) {
+    lidar_loop();
+    if (i % TEST_CONTROL_TICKS == 0) dc_loop();
+    delayMicroseconds(TEST_POLL_PERIOD_US);
+  }
+}
+
+static ReflexStats reflexStats() {
+  ReflexStats stats;
+  reflex_getStats(&stats);
+  return stats;
+}
+
+// ===== Тесты =====
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_no_frame_gets_stale_speed() {
+  // До lidar_init() кадра ещё нет
+  LidarFrame frame;
+  TEST_ASSERT_FALSE(lidar_getFrame(&frame));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_update());
+
+  ReflexStats stats = reflexStats();
+  TEST_ASSERT_TRUE(stats.active);
+  TEST_ASSERT_EQUAL(config.staleSpeed, stats.limit);
+  TEST_ASSERT_EQUAL_UINT16(REFLEX_RANGE_NONE, stats.rangeMm);
+}
+
+static void test_missing_sensor_limits_forward_speed() {
+  lidar_init();
+  dc_init();
+  motor_setSpeedA(REFLEX_SPEED_MAX);
+  runFor(800);
+
+  // Кадра нет (ни одного датчика) или канал не в presentMask
+  LidarFrame frame;
+  if (lidar_getFrame(&frame)) {
+    TEST_ASSERT_FALSE(frame.presentMask & (1 << TEST_CHANNEL));
+  }
+  TEST_ASSERT_EQUAL(config.staleSpeed, motor_getOutput(0));
+  TEST_ASSERT_EQUAL(config.staleSpeed, reflex_update());
+
+  ReflexStats stats = reflexStats();
+  TEST_ASSERT_TRUE(stats.active);
+  TEST_ASSERT_EQUAL(config.staleSpeed, stats.limit);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, stats.clamps);
+}
+
+int main() {
+  hal_vl53l0xSetPresent(TEST_CHANNEL, false);
+  reflex_getConfig(&config);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_no_frame_gets_stale_speed);
+  RUN_TEST(test_missing_sensor_limits_forward_speed);
+  return UNITY_END();
+}
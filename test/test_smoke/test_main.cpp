@@ -0,0 +1,162 @@
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "native_hal.h"
+#include "ctlframe.h"
+#include "safety.h"
+
+// Дымовые тесты прошивки целиком: setup() из main.cpp запускает планировщик
+// и сетевую задачу на потоках native_hal, запросы идут через маршруты HTTP
+// сервера и канал WebSocket, результат проверяется на фейковых LEDC, PCA9685
+// и VL53L0X. Моторы — пары каналов LEDC (IN1/IN2), мотор A — каналы 0 и 1.
+
+// ===== Константы =====
+
+#define TEST_BOOT_MS 300
+#define TEST_TIMEOUT_MS 1000            // меньше DEADMAN_TIMEOUT_MS по умолчанию
+#define TEST_POLL_MS 10
+#define TEST_RANGE_MM 400               // дальше REFLEX_STOP_MM: рефлекс не ограничивает
+#define TEST_SERVO_ANGLE 45
+#define TEST_MOTOR_SPEED 200
+#define TEST_WS_CLIENT 0
+
+// ===== Вспомогательные функции =====
+
+static HalHttpResponse get(const char* url, const char* headers = NULL) {
+  return hal_httpRequest("GET", url, NULL, 0, headers);
+}
+
+static HalHttpResponse post(const char* url, const char* json = "") {
+  return hal_httpRequest("POST", url, (const uint8_t*)json, strlen(json),
+                         "Content-Type: application/json");
+}
+
+static bool contains(const String& text, const char* part) {
+  return text.indexOf(part) >= 0;
+}
+
+static uint32_t motorADuty() {
+  return hal_ledcGetDuty(0) + hal_ledcGetDuty(1);
+}
+
+// Ожидание условия, которое выполняют задачи прошивки; false — не дождались
+template <typename Condition>
+static bool waitFor(Condition condition) {
+  for (uint32_t waited = 0; waited < TEST_TIMEOUT_MS; waited += TEST_POLL_MS) {
+    if (condition()) return true;
+    delay(TEST_POLL_MS);
+  }
+  return condition();
+}
+
+static void stopMotors() {
+  post("/api/motor/stop");
+  waitFor([] { return motorADuty() == 0; });
+}
+
+// ===== Тесты =====
+
+void setUp() {}
+
+void tearDown() {
+  if (safety_isEstopped()) post("/api/estop/reset");
+  stopMotors();
+}
+
+static void test_ui_served_gzipped() {
+  HalHttpResponse response = get("/", "Accept-Encoding: gzip");
+  TEST_ASSERT_EQUAL(200, response.code);
+  TEST_ASSERT_TRUE(contains(response.contentType, "text/html"));
+  TEST_ASSERT_TRUE(contains(response.headers, "Content-Encoding: gzip"));
+  TEST_ASSERT_GREATER_THAN(0, response.body.length());
+}
+
+static void test_status_reports_ok() {
+  HalHttpResponse response = get("/api/status");
+  TEST_ASSERT_EQUAL(200, response.code);
+  TEST_ASSERT_TRUE(contains(response.contentType, "application/json"));
+  TEST_ASSERT_TRUE(contains(response.body, "\"status\":\"ok\""));
+}
+
+static void test_unknown_route_is_not_found() {
+  TEST_ASSERT_EQUAL(404, get("/api/nope").code);
+}
+
+static void test_servo_command_reaches_pca9685() {
+  uint16_t before = hal_pca9685GetOff(0);
+  char json[48];
+  snprintf(json, sizeof(json), "{\"id\":0,\"angle\":%d}", TEST_SERVO_ANGLE);
+  TEST_ASSERT_EQUAL(200, post("/api/servo", json).code);
+  TEST_ASSERT_TRUE(waitFor([before] { return hal_pca9685GetOff(0) != before; }));
+  TEST_ASSERT_EQUAL(200, post("/api/servo", "{\"id\":0,\"angle\":90}").code);
+}
+
+static void test_motor_command_sets_pwm() {
+  char json[48];
+  snprintf(json, sizeof(json), "{\"motorA\":%d}", TEST_MOTOR_SPEED);
+  HalHttpResponse response = post("/api/motor", json);
+  TEST_ASSERT_EQUAL(200, response.code);
+  TEST_ASSERT_TRUE(contains(response.body, "\"success\":true"));
+  TEST_ASSERT_TRUE(waitFor([] { return motorADuty() > 0; }));
+
+  TEST_ASSERT_EQUAL(200, post("/api/motor/stop").code);
+  TEST_ASSERT_TRUE(waitFor([] { return motorADuty() == 0; }));
+}
+
+static void test_ws_setpoint_sets_pwm() {
+  hal_wsConnect(TEST_WS_CLIENT);
+  CtlFrame frame = {};
+  frame.magic = CTL_FRAME_MAGIC;
+  frame.type = CTL_FRAME_TYPE_SETPOINT;
+  frame.seq = 1;
+  frame.flags = CTL_FLAG_MOTORS;
+  frame.motor[0] = TEST_MOTOR_SPEED;
+  hal_wsSendBinary(TEST_WS_CLIENT, (const uint8_t*)&frame, sizeof(frame));
+  TEST_ASSERT_TRUE(waitFor([] { return motorADuty() > 0; }));
+  hal_wsDisconnect(TEST_WS_CLIENT);
+}
+
+static void test_lidar_reports_fake_range() {
+  HalHttpResponse response = get("/api/lidar");
+  TEST_ASSERT_EQUAL(200, response.code);
+  char range[32];
+  snprintf(range, sizeof(range), "\"range_mm\":%d", TEST_RANGE_MM);
+  TEST_ASSERT_TRUE(contains(response.body, range));
+}
+
+static void test_estop_cuts_pwm() {
+  post("/api/motor", "{\"motorA\":200}");
+  TEST_ASSERT_TRUE(waitFor([] { return motorADuty() > 0; }));
+
+  TEST_ASSERT_EQUAL(200, post("/api/estop").code);
+  TEST_ASSERT_TRUE(safety_isEstopped());
+  TEST_ASSERT_TRUE(waitFor([] { return motorADuty() == 0; }));
+
+  TEST_ASSERT_EQUAL(200, post("/api/estop/reset").code);
+  TEST_ASSERT_FALSE(safety_isEstopped());
+}
+
+extern void setup();
+
+int main() {
+  for (uint8_t ch = 0; ch < 8; ch++) hal_vl53l0xSetRange(ch, TEST_RANGE_MM);
+  setup();
+  delay(TEST_BOOT_MS);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_ui_served_gzipped);
+  RUN_TEST(test_status_reports_ok);
+  RUN_TEST(test_unknown_route_is_not_found);
+  RUN_TEST(test_servo_command_reaches_pca9685);
+  RUN_TEST(test_motor_command_sets_pwm);
+  RUN_TEST(test_ws_setpoint_sets_pwm);
+  RUN_TEST(test_lidar_reports_fake_range);
+  RUN_TEST(test_estop_cuts_pwm);
+  // Задачи прошивки не завершаются: выход без ожидания потоков
+  int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
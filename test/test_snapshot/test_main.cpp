@@ -0,0 +1,100 @@
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "snapshot.h"
+
+// Snapshot: чтение до первой публикации, последняя версия, согласованная
+// копия при публикации из другого потока (повтор чтения при обгоне писателем)
+
+// ===== Константы =====
+
+#define TEST_WORDS 64
+#define TEST_PUBLISHES 200000
+
+// ===== Структуры данных =====
+
+// Все слова снимка равны его номеру: разорванная копия видна по несовпадению
+struct TestState {
+  uint32_t words[TEST_WORDS];
+};
+
+static TestState makeState(uint32_t sequence) {
+  TestState state;
+  for (int i = 0; i < TEST_WORDS; i++) state.words[i] = sequence;
+  return state;
+}
+
+static bool isConsistent(const TestState& state) {
+  for (int i = 1; i < TEST_WORDS; i++) {
+    if (state.words[i] != state.words[0]) return false;
+  }
+  return true;
+}
+
+// ===== Тесты =====
+
+void setUp() {}
+void tearDown() {}
+
+static void test_read_before_publish_fails() {
+  Snapshot<TestState> snapshot;
+  TestState state;
+  TEST_ASSERT_FALSE(snapshot.read(&state));
+  TEST_ASSERT_EQUAL_UINT32(0, snapshot.sequence());
+}
+
+static void test_read_returns_latest() {
+  Snapshot<TestState> snapshot;
+  TestState state;
+  for (uint32_t i = 1; i <= 5; i++) {
+    snapshot.publish(makeState(i));
+    TEST_ASSERT_TRUE(snapshot.read(&state));
+    TEST_ASSERT_EQUAL_UINT32(i, state.words[0]);
+    TEST_ASSERT_TRUE(isConsistent(state));
+    TEST_ASSERT_EQUAL_UINT32(i, snapshot.sequence());
+  }
+}
+
+static void test_concurrent_publish_never_tears() {
+  static Snapshot<TestState> snapshot;
+  std::atomic<bool> done(false);
+
+  std::thread writer([&]() {
+    for (uint32_t i = 1; i <= TEST_PUBLISHES; i++) snapshot.publish(makeState(i));
+    done.store(true);
+  });
+
+  uint32_t reads = 0;
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t last = 0;
+  while (!done.load()) {
+    TestState state;
+    // Писатель без пауз может обгонять читателя на всех попытках — тогда
+    // read() возвращает false, а не разорванную копию
+    if (!snapshot.read(&state)) continue;
+    reads++;
+    if (!isConsistent(state)) torn++;
+    if (state.words[0] < last) backwards++;
+    last = state.words[0];
+  }
+  writer.join();
+
+  TestState state;
+  TEST_ASSERT_TRUE(snapshot.read(&state));
+  TEST_ASSERT_EQUAL_UINT32(TEST_PUBLISHES, state.words[0]);
+
+  TEST_ASSERT_GREATER_THAN_UINT32(0, reads);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, backwards);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_read_before_publish_fails);
+  RUN_TEST(test_read_returns_latest);
+  RUN_TEST(test_concurrent_publish_never_tears);
+  return UNITY_END();
+}
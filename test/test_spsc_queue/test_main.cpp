@@ -0,0 +1,108 @@
+#include <unity.h>
+
+#include <thread>
+
+#include "spsc_queue.h"
+
+// SpscQueue: заполнение и опустошение, переход индексов через ёмкость,
+// порядок элементов при одновременной работе производителя и потребителя
+
+// ===== Константы =====
+
+#define TEST_CAPACITY 4
+#define TEST_STREAM_ITEMS 200000
+
+// ===== Тесты =====
+
+void setUp() {}
+void tearDown() {}
+
+static void test_empty_queue_pops_nothing() {
+  SpscQueue<uint32_t, TEST_CAPACITY> queue;
+  uint32_t item = 0xDEAD;
+  TEST_ASSERT_FALSE(queue.pop(item));
+  TEST_ASSERT_EQUAL_UINT32(0xDEAD, item);
+  TEST_ASSERT_EQUAL(0, queue.size());
+  TEST_ASSERT_EQUAL(TEST_CAPACITY, queue.capacity());
+}
+
+static void test_full_queue_drops_and_counts() {
+  SpscQueue<uint32_t, TEST_CAPACITY> queue;
+  for (uint32_t i = 0; i < TEST_CAPACITY; i++) TEST_ASSERT_TRUE(queue.push(i));
+  TEST_ASSERT_EQUAL(TEST_CAPACITY, queue.size());
+
+  TEST_ASSERT_FALSE(queue.push(100));
+  TEST_ASSERT_FALSE(queue.push(101));
+  TEST_ASSERT_EQUAL_UINT32(2, queue.droppedCount());
+  TEST_ASSERT_EQUAL(TEST_CAPACITY, queue.size());
+
+  // Отброшенные элементы не затирают очередь
+  uint32_t item;
+  for (uint32_t i = 0; i < TEST_CAPACITY; i++) {
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(i, item);
+  }
+  TEST_ASSERT_FALSE(queue.pop(item));
+  TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+static void test_wraps_around_capacity() {
+  SpscQueue<uint32_t, TEST_CAPACITY> queue;
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  uint32_t item;
+
+  // Уровень заполнения 3 из 4: индексы много раз проходят через границу буфера
+  for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(queue.push(next++));
+  for (int round = 0; round < 1000; round++) {
+    TEST_ASSERT_TRUE(queue.push(next++));
+    TEST_ASSERT_FALSE(queue.push(0xFFFF));
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(expected++, item);
+    TEST_ASSERT_EQUAL(3, queue.size());
+  }
+  while (queue.pop(item)) TEST_ASSERT_EQUAL_UINT32(expected++, item);
+  TEST_ASSERT_EQUAL_UINT32(next, expected);
+  TEST_ASSERT_EQUAL_UINT32(1000, queue.droppedCount());
+}
+
+static void test_concurrent_stream_keeps_order() {
+  static SpscQueue<uint32_t, 64> queue;
+  uint32_t retries = 0;
+
+  std::thread producer([&]() {
+    for (uint32_t i = 1; i <= TEST_STREAM_ITEMS; i++) {
+      while (!queue.push(i)) {
+        retries++;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 1;
+  bool ordered = true;
+  while (expected <= TEST_STREAM_ITEMS) {
+    uint32_t item;
+    if (!queue.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (item != expected) ordered = false;
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_TRUE(ordered);
+  TEST_ASSERT_EQUAL(0, queue.size());
+  // Каждая неудачная попытка записи считается отброшенной
+  TEST_ASSERT_EQUAL_UINT32(retries, queue.droppedCount());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_queue_pops_nothing);
+  RUN_TEST(test_full_queue_drops_and_counts);
+  RUN_TEST(test_wraps_around_capacity);
+  RUN_TEST(test_concurrent_stream_keeps_order);
+  return UNITY_END();
+}